@@ -0,0 +1,205 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * CSV loader benchmark.
+ *
+ * Loads a CSV file with cmp::loadCsvColumns() using one thread and all
+ * threads, and optionally with a line-by-line iostream parser as a baseline.
+ * A file with four columns is generated in the temp directory if no file is
+ * given. The timings are reported as JSON.
+ *
+ * Usage: cmp_csv_benchmark [--file path] [--size-mb N] [--iterations N]
+ *                          [--baseline 0|1] [--output file]
+ */
+
+#include <juce_core/juce_core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cmp_csv_loader.hpp"
+
+namespace {
+
+struct Settings {
+  std::string file;
+  std::size_t size_mb{2048};
+  std::size_t iterations{3};
+  bool baseline{false};
+  std::string output;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(const Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+juce::File generateCsvFile(const std::size_t size_mb) {
+  auto file = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                  .getChildFile("cmp_csv_benchmark.csv");
+
+  const auto size_bytes = size_mb * 1024u * 1024u;
+  if (file.getSize() >= juce::int64(size_bytes)) return file;
+
+  std::ofstream stream(file.getFullPathName().toStdString(),
+                       std::ios::binary | std::ios::trunc);
+  stream << "time,sine,noise,ramp\n";
+
+  std::mt19937 gen(1);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+
+  std::string rows;
+  std::size_t written = 0u;
+  for (std::size_t i = 0u; written < size_bytes; ++i) {
+    rows += std::to_string(double(i) * 1e-4) + ',' +
+            std::to_string(std::sin(float(i) * 1e-3f)) + ',' +
+            std::to_string(noise(gen)) + ',' + std::to_string(i) + '\n';
+
+    if (rows.size() > (1u << 20u)) {
+      stream << rows;
+      written += rows.size();
+      rows.clear();
+    }
+  }
+  stream << rows;
+
+  return file;
+}
+
+/** The kind of parser this loader replaces. */
+std::vector<std::vector<float>> loadWithIostream(const juce::File& file) {
+  std::ifstream stream(file.getFullPathName().toStdString());
+  std::vector<std::vector<float>> columns;
+
+  std::string line, field;
+  std::getline(stream, line);
+
+  while (std::getline(stream, line)) {
+    std::stringstream line_stream(line);
+    for (std::size_t i = 0u; std::getline(line_stream, field, ','); ++i) {
+      if (columns.size() <= i) columns.resize(i + 1u);
+      columns[i].push_back(std::stof(field));
+    }
+  }
+
+  return columns;
+}
+
+juce::var timeLoader(
+    const std::string& name, const std::size_t iterations,
+    const juce::int64 file_size,
+    const std::function<std::size_t()>& load) {
+  std::vector<double> load_ms;
+  std::size_t num_rows = 0u;
+
+  for (std::size_t i = 0u; i < iterations; ++i) {
+    const auto start = Clock::now();
+    num_rows = load();
+    load_ms.push_back(msSince(start));
+  }
+
+  const auto best_ms = *std::min_element(load_ms.begin(), load_ms.end());
+
+  auto* result = new juce::DynamicObject();
+  result->setProperty("name", juce::String(name));
+  result->setProperty("rows", juce::int64(num_rows));
+  result->setProperty("best_ms", best_ms);
+  result->setProperty("worst_ms",
+                      *std::max_element(load_ms.begin(), load_ms.end()));
+  result->setProperty("best_mb_per_s",
+                      double(file_size) / (1024.0 * 1024.0) / (best_ms / 1e3));
+
+  return juce::var(result);
+}
+
+Settings parseSettings(int argc, char* argv[]) {
+  Settings settings;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const std::string value = argv[i + 1];
+
+    if (key == "--file") {
+      settings.file = value;
+    } else if (key == "--size-mb") {
+      settings.size_mb = std::stoul(value);
+    } else if (key == "--iterations") {
+      settings.iterations = std::max<std::size_t>(std::stoul(value), 1u);
+    } else if (key == "--baseline") {
+      settings.baseline = value == "1";
+    } else if (key == "--output") {
+      settings.output = value;
+    } else {
+      throw std::invalid_argument("Unknown argument: " + key);
+    }
+  }
+
+  return settings;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const auto settings = parseSettings(argc, argv);
+
+  const auto file = settings.file.empty()
+                        ? generateCsvFile(settings.size_mb)
+                        : juce::File(settings.file);
+  const auto file_size = file.getSize();
+
+  juce::Array<juce::var> results;
+
+  const auto max_threads =
+      std::max<std::size_t>(std::thread::hardware_concurrency(), 1u);
+
+  for (const auto num_threads : {std::size_t(1u), max_threads}) {
+    cmp::CsvLoadOptions options;
+    options.num_threads = num_threads;
+
+    results.add(timeLoader(
+        "loader_" + std::to_string(num_threads) + "_threads",
+        settings.iterations, file_size, [&file, &options]() {
+          const auto csv = cmp::loadCsvColumns(file, options);
+          return csv.columns.empty() ? 0u : csv.columns.front().size();
+        }));
+  }
+
+  if (settings.baseline) {
+    results.add(timeLoader("iostream", 1u, file_size, [&file]() {
+      const auto columns = loadWithIostream(file);
+      return columns.empty() ? 0u : columns.front().size();
+    }));
+  }
+
+  auto* root = new juce::DynamicObject();
+  root->setProperty("file", file.getFullPathName());
+  root->setProperty("file_size_mb", double(file_size) / (1024.0 * 1024.0));
+  root->setProperty("loaders", results);
+
+  const auto json = juce::JSON::toString(juce::var(root));
+
+  if (settings.output.empty()) {
+    std::cout << json.toStdString() << std::endl;
+  } else {
+    juce::File(settings.output).replaceWithText(json);
+  }
+
+  return 0;
+}
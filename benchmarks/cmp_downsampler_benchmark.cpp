@@ -0,0 +1,372 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * Downsampler kernel benchmark.
+ *
+ * Times the downsampling kernels of the draw pipeline directly, without
+ * painting, and compares each optimized kernel with the path it replaces.
+ * The outputs of both are compared as well, so a faster kernel with another
+ * result is reported. The timings are reported as JSON.
+ *
+ * Usage: cmp_downsampler_benchmark [--iterations N] [--warmup N]
+ *                                  [--points N] [--width W] [--height H]
+ *                                  [--channels N] [--scenario name]
+ *                                  [--output file]
+ */
+
+#include <juce_core/juce_core.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cmp_datamodels.h"
+#include "cmp_downsampler.h"
+#include "cmp_utils.h"
+
+namespace {
+
+struct Settings {
+  std::size_t iterations{50};
+  std::size_t warmup{3};
+  std::size_t points{4'000'000};
+  int width{1200};
+  int height{800};
+  std::size_t channels{8};
+  std::string scenario;
+  std::string output;
+};
+
+/** An optimized kernel and the path it replaces.
+ *
+ * 'optimized' and 'reference' are timed separately, 'isEqual' is called
+ * after both have run once and compares their outputs.
+ */
+struct Scenario {
+  std::string name;
+  std::function<void()> optimized;
+  std::function<void()> reference;
+  std::function<bool()> isEqual;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(const Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+std::vector<float> sineWithNoise(const std::size_t size, const float periods,
+                                 const unsigned seed) {
+  std::mt19937 gen(seed);
+  std::normal_distribution<float> noise(0.0f, 0.05f);
+  std::vector<float> y(size);
+
+  const auto w = juce::MathConstants<float>::twoPi * periods / float(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    y[i] = std::sin(w * float(i)) + noise(gen);
+  }
+
+  return y;
+}
+
+/** Transforms the indexed data like updateXPixelPoints/updateYPixelPoints. */
+void transformIndexedData(const std::vector<float>& x_data,
+                          const std::vector<float>& y_data,
+                          const cmp::Lim<float> x_lim,
+                          const cmp::Lim<float> y_lim,
+                          const juce::Rectangle<int>& graph_bounds,
+                          const std::vector<std::size_t>& indices,
+                          cmp::PixelPoints& pixel_points) {
+  const auto [x_scale, x_offset] = cmp::getXScaleAndOffset(
+      float(graph_bounds.getWidth()), x_lim, cmp::Scaling::linear);
+  const auto [y_scale, y_offset] = cmp::getYScaleAndOffset(
+      float(graph_bounds.getHeight()), y_lim, cmp::Scaling::linear);
+
+  pixel_points.resize(indices.size());
+  for (std::size_t i = 0u; i < indices.size(); ++i) {
+    pixel_points[i] = {
+        cmp::getXPixelValueLinear(x_data[indices[i]], x_scale, x_offset),
+        cmp::getYPixelValueLinear(y_data[indices[i]], y_scale, y_offset)};
+  }
+}
+
+bool isEqual(const cmp::PixelPoints& lhs, const cmp::PixelPoints& rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                    [](const auto& a, const auto& b) {
+                      return (a.getX() == b.getX() ||
+                              (std::isnan(a.getX()) && std::isnan(b.getX()))) &&
+                             (a.getY() == b.getY() ||
+                              (std::isnan(a.getY()) && std::isnan(b.getY())));
+                    });
+}
+
+std::vector<Scenario> createScenarios(const Settings& settings) {
+  std::vector<Scenario> scenarios;
+
+  const auto graph_bounds = juce::Rectangle<int>(settings.width, settings.height);
+
+  auto x = std::make_shared<std::vector<float>>(settings.points);
+  std::iota(x->begin(), x->end(), 0.0f);
+  const auto x_lim = cmp::Lim<float>(0.0f, float(settings.points));
+
+  struct XYOutput {
+    cmp::PixelPoints pixel_points;
+    std::vector<std::size_t> x_indices, xy_indices, run_positions;
+  };
+
+  const auto isXYOutputEqual = [](const XYOutput& lhs, const XYOutput& rhs) {
+    return lhs.xy_indices == rhs.xy_indices &&
+           lhs.run_positions == rhs.run_positions &&
+           isEqual(lhs.pixel_points, rhs.pixel_points);
+  };
+
+  // The collapse limits are one graph height outside the y-limits, like in
+  // GraphLine.
+  const auto getCollapseYLim = [](const cmp::Lim<float> y_lim) {
+    const auto height = y_lim.max - y_lim.min;
+    return cmp::Lim<float>(y_lim.min - height, y_lim.max + height);
+  };
+
+  auto sine = std::make_shared<std::vector<float>>(
+      sineWithNoise(settings.points, 20.0f, 1));
+
+  // Nothing is collapsed, the single pass that collapses the runs outside the
+  // y-limits against the single pass without collapsing.
+  {
+    const auto y_lim = cmp::Lim<float>(-2.0f, 2.0f);
+    auto optimized = std::make_shared<XYOutput>();
+    auto reference = std::make_shared<XYOutput>();
+
+    scenarios.push_back(
+        {"collapse_wide_y_lim",
+         [=] {
+           cmp::Downsampler<float>::calculateXYPixelPoints(
+               cmp::Scaling::linear, cmp::Scaling::linear, x_lim, y_lim,
+               graph_bounds, *x, *sine, optimized->pixel_points,
+               &optimized->x_indices, &optimized->xy_indices,
+               getCollapseYLim(y_lim), &optimized->run_positions);
+         },
+         [=] {
+           cmp::Downsampler<float>::calculateXYPixelPoints(
+               cmp::Scaling::linear, cmp::Scaling::linear, x_lim, y_lim,
+               graph_bounds, *x, *sine, reference->pixel_points,
+               &reference->x_indices, &reference->xy_indices);
+         },
+         [=] { return isXYOutputEqual(*optimized, *reference); }});
+  }
+
+  // The y-limits are narrower than the data, the single pass against finding
+  // the indices, collapsing them and transforming the kept ones.
+  {
+    const auto y_lim = cmp::Lim<float>(-0.25f, 0.25f);
+    auto optimized = std::make_shared<XYOutput>();
+    auto reference = std::make_shared<XYOutput>();
+
+    scenarios.push_back(
+        {"collapse_narrow_y_lim",
+         [=] {
+           cmp::Downsampler<float>::calculateXYPixelPoints(
+               cmp::Scaling::linear, cmp::Scaling::linear, x_lim, y_lim,
+               graph_bounds, *x, *sine, optimized->pixel_points,
+               &optimized->x_indices, &optimized->xy_indices,
+               getCollapseYLim(y_lim), &optimized->run_positions);
+         },
+         [=] {
+           cmp::Downsampler<float>::calculateXYIdxs(
+               cmp::Scaling::linear, x_lim, graph_bounds, *x, *sine,
+               reference->x_indices, reference->xy_indices);
+           cmp::Downsampler<float>::collapseIdxsOutsideYLim(
+               *sine, getCollapseYLim(y_lim), reference->xy_indices,
+               reference->run_positions);
+           transformIndexedData(*x, *sine, x_lim, y_lim, graph_bounds,
+                                reference->xy_indices, reference->pixel_points);
+         },
+         [=] { return isXYOutputEqual(*optimized, *reference); }});
+  }
+
+  // Lines sharing the x-data, the pixel columns are found once and the
+  // min/max of all lines are found in one sweep, against downsampling each
+  // line on its own in a single pass.
+  if (settings.channels > 0u) {
+    const auto y_lim = cmp::Lim<float>(-2.0f, 2.0f);
+
+    auto y_data = std::make_shared<std::vector<std::vector<float>>>();
+    for (std::size_t i = 0u; i < settings.channels; ++i) {
+      y_data->push_back(
+          sineWithNoise(settings.points, 20.0f + float(i), unsigned(i + 2u)));
+    }
+
+    auto optimized = std::make_shared<std::vector<XYOutput>>(settings.channels);
+    auto reference = std::make_shared<std::vector<XYOutput>>(settings.channels);
+    auto xy_indices = std::make_shared<std::vector<std::vector<std::size_t>>>();
+
+    scenarios.push_back(
+        {"batched_shared_x",
+         [=] {
+           auto& x_indices = optimized->front().x_indices;
+           cmp::Downsampler<float>::calculateXIndices(
+               cmp::Scaling::linear, x_lim, graph_bounds, *x, x_indices);
+           cmp::Downsampler<float>::calculateXYBasedIdxsBatched(
+               x_indices, *y_data, *xy_indices);
+
+           for (std::size_t i = 0u; i < y_data->size(); ++i) {
+             auto& output = (*optimized)[i];
+             output.xy_indices = (*xy_indices)[i];
+             transformIndexedData(*x, (*y_data)[i], x_lim, y_lim,
+                                  graph_bounds, output.xy_indices,
+                                  output.pixel_points);
+           }
+         },
+         [=] {
+           for (std::size_t i = 0u; i < y_data->size(); ++i) {
+             auto& output = (*reference)[i];
+             cmp::Downsampler<float>::calculateXYPixelPoints(
+                 cmp::Scaling::linear, cmp::Scaling::linear, x_lim, y_lim,
+                 graph_bounds, *x, (*y_data)[i], output.pixel_points,
+                 &output.x_indices, &output.xy_indices);
+           }
+         },
+         [=] {
+           return std::equal(optimized->begin(), optimized->end(),
+                             reference->begin(), reference->end(),
+                             isXYOutputEqual) &&
+                  optimized->front().x_indices == reference->front().x_indices;
+         }});
+  }
+
+  return scenarios;
+}
+
+juce::var distributionToVar(std::vector<double> samples) {
+  auto* obj = new juce::DynamicObject();
+
+  if (samples.empty()) return juce::var(obj);
+
+  std::sort(samples.begin(), samples.end());
+
+  const auto percentile = [&samples](const double p) {
+    const auto idx = std::size_t(
+        std::round(p * double(samples.size() - 1)));
+    return samples[idx];
+  };
+
+  const auto mean = std::accumulate(samples.begin(), samples.end(), 0.0) /
+                    double(samples.size());
+
+  obj->setProperty("min", samples.front());
+  obj->setProperty("mean", mean);
+  obj->setProperty("p50", percentile(0.5));
+  obj->setProperty("p90", percentile(0.9));
+  obj->setProperty("max", samples.back());
+
+  return juce::var(obj);
+}
+
+std::vector<double> timeKernel(const std::function<void()>& kernel,
+                               const Settings& settings) {
+  std::vector<double> samples;
+  samples.reserve(settings.iterations);
+
+  for (std::size_t i = 0; i < settings.warmup + settings.iterations; ++i) {
+    const auto start = Clock::now();
+    kernel();
+    const auto time = msSince(start);
+
+    if (i >= settings.warmup) samples.push_back(time);
+  }
+
+  return samples;
+}
+
+juce::var runScenario(const Scenario& scenario, const Settings& settings) {
+  const auto optimized_ms = timeKernel(scenario.optimized, settings);
+  const auto reference_ms = timeKernel(scenario.reference, settings);
+
+  auto* result = new juce::DynamicObject();
+  result->setProperty("name", juce::String(scenario.name));
+  result->setProperty("iterations", int(settings.iterations));
+  result->setProperty("equal", scenario.isEqual());
+  result->setProperty("optimized_ms", distributionToVar(optimized_ms));
+  result->setProperty("reference_ms", distributionToVar(reference_ms));
+
+  return juce::var(result);
+}
+
+Settings parseSettings(int argc, char* argv[]) {
+  Settings settings;
+
+  for (int i = 1; i < argc; i += 2) {
+    const std::string key = argv[i];
+    if (i + 1 >= argc) throw std::invalid_argument("Missing value: " + key);
+    const std::string value = argv[i + 1];
+
+    if (key == "--iterations") {
+      settings.iterations = std::stoul(value);
+    } else if (key == "--warmup") {
+      settings.warmup = std::stoul(value);
+    } else if (key == "--points") {
+      settings.points = std::stoul(value);
+    } else if (key == "--width") {
+      settings.width = std::stoi(value);
+    } else if (key == "--height") {
+      settings.height = std::stoi(value);
+    } else if (key == "--channels") {
+      settings.channels = std::stoul(value);
+    } else if (key == "--scenario") {
+      settings.scenario = value;
+    } else if (key == "--output") {
+      settings.output = value;
+    } else {
+      throw std::invalid_argument("Unknown argument: " + key);
+    }
+  }
+
+  return settings;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const auto settings = parseSettings(argc, argv);
+
+  juce::Array<juce::var> results;
+  for (const auto& scenario : createScenarios(settings)) {
+    if (!settings.scenario.empty() && settings.scenario != scenario.name) {
+      continue;
+    }
+
+    results.add(runScenario(scenario, settings));
+  }
+
+  auto* root = new juce::DynamicObject();
+  root->setProperty("points", int(settings.points));
+  root->setProperty("width", settings.width);
+  root->setProperty("height", settings.height);
+  root->setProperty("channels", int(settings.channels));
+  root->setProperty("warmup", int(settings.warmup));
+  root->setProperty("scenarios", results);
+
+  const auto json = juce::JSON::toString(juce::var(root));
+
+  if (settings.output.empty()) {
+    std::cout << json.toStdString() << std::endl;
+  } else {
+    juce::File(settings.output).replaceWithText(json);
+  }
+
+  return 0;
+}
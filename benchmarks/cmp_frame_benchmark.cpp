@@ -0,0 +1,379 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * End-to-end frame benchmark.
+ *
+ * Builds a Plot headless, runs a set of realistic scenarios and paints the
+ * whole component tree into a juce::Image for every iteration. The timings of
+ * each stage are reported as JSON.
+ *
+ * Usage: cmp_frame_benchmark [--iterations N] [--warmup N] [--width W]
+ *                            [--height H] [--scenario name] [--output file]
+ */
+
+#include <juce_core/juce_core.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cmp_datamodels.h"
+#include "cmp_plot.h"
+
+namespace {
+
+struct Settings {
+  std::size_t iterations{100};
+  std::size_t warmup{5};
+  int width{1200};
+  int height{800};
+  std::string scenario;
+  std::string output;
+};
+
+/** A single benchmark scenario.
+ *
+ * 'setup' is called once before the first iteration and 'update' is called
+ * every iteration. The time of 'update' is reported as the update stage and
+ * the time it takes to paint the component tree as the paint stage.
+ */
+struct Scenario {
+  std::string name;
+  std::function<std::unique_ptr<cmp::Plot>()> create_plot;
+  std::function<void(cmp::Plot& plot)> setup;
+  std::function<void(cmp::Plot& plot, const std::size_t iteration)> update;
+};
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(const Clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+std::vector<float> sineWithNoise(const std::size_t size, const float periods,
+                                 const unsigned seed) {
+  std::mt19937 gen(seed);
+  std::normal_distribution<float> noise(0.0f, 0.05f);
+  std::vector<float> y(size);
+
+  const auto w = juce::MathConstants<float>::twoPi * periods / float(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    y[i] = std::sin(w * float(i)) + noise(gen);
+  }
+
+  return y;
+}
+
+std::vector<float> ramp(const std::size_t size, const float start = 1.0f) {
+  std::vector<float> x(size);
+  std::iota(x.begin(), x.end(), start);
+  return x;
+}
+
+std::unique_ptr<cmp::Plot> createLinearPlot() {
+  return std::make_unique<cmp::Plot>();
+}
+
+std::vector<Scenario> createScenarios() {
+  std::vector<Scenario> scenarios;
+
+  // One static line with a lot of points, replotted every frame.
+  {
+    auto y = std::make_shared<std::vector<float>>(
+        sineWithNoise(1'000'000, 10.0f, 1));
+    scenarios.push_back(
+        {"static_huge_line", createLinearPlot, [](cmp::Plot&) {},
+         [y](cmp::Plot& plot, std::size_t) { plot.plot({*y}); }});
+  }
+
+  // 64 channels updated every frame, like a multi channel scope.
+  {
+    constexpr std::size_t num_channels = 64;
+    constexpr std::size_t num_points = 4096;
+
+    auto y = std::make_shared<std::vector<std::vector<float>>>();
+    for (std::size_t c = 0; c < num_channels; ++c) {
+      y->push_back(sineWithNoise(num_points, 4.0f, unsigned(c)));
+      for (auto& v : y->back()) v += float(c);
+    }
+
+    scenarios.push_back(
+        {"realtime_64_channels", createLinearPlot,
+         [y](cmp::Plot& plot) {
+           plot.yLim(-1.0f, float(num_channels));
+           plot.plot(*y);
+         },
+         [y](cmp::Plot& plot, std::size_t) {
+           for (auto& channel : *y) {
+             std::rotate(channel.begin(), channel.begin() + 64, channel.end());
+           }
+           plot.plotUpdateYOnly(*y);
+         }});
+  }
+
+  // Markers on every pixel point.
+  {
+    auto y =
+        std::make_shared<std::vector<float>>(sineWithNoise(2'000, 3.0f, 2));
+    scenarios.push_back(
+        {"markers", createLinearPlot, [](cmp::Plot&) {},
+         [y](cmp::Plot& plot, std::size_t) {
+           cmp::GraphAttribute ga;
+           ga.marker = cmp::Marker(cmp::Marker::Type::Circle);
+           plot.plot({*y}, {}, {ga});
+         }});
+  }
+
+  // Dashed graph line.
+  {
+    auto y =
+        std::make_shared<std::vector<float>>(sineWithNoise(100'000, 20.0f, 3));
+    scenarios.push_back(
+        {"dashed", createLinearPlot, [](cmp::Plot&) {},
+         [y](cmp::Plot& plot, std::size_t) {
+           cmp::GraphAttribute ga;
+           ga.dashed_lengths = std::vector<float>{4.0f, 4.0f, 8.0f, 4.0f};
+           plot.plot({*y}, {}, {ga});
+         }});
+  }
+
+  // Gradient below the graph line.
+  {
+    auto y =
+        std::make_shared<std::vector<float>>(sineWithNoise(100'000, 20.0f, 4));
+    scenarios.push_back(
+        {"gradient", createLinearPlot, [](cmp::Plot&) {},
+         [y](cmp::Plot& plot, std::size_t) {
+           cmp::GraphAttribute ga;
+           ga.gradient_colours = std::make_pair(juce::Colours::blue,
+                                                juce::Colours::transparentBlack);
+           plot.plot({*y}, {}, {ga});
+         }});
+  }
+
+  // Area filled between two graph lines.
+  {
+    auto y1 =
+        std::make_shared<std::vector<float>>(sineWithNoise(100'000, 5.0f, 5));
+    auto y2 = std::make_shared<std::vector<float>>(*y1);
+    for (auto& v : *y2) v += 1.0f;
+
+    scenarios.push_back({"fill_between", createLinearPlot, [](cmp::Plot&) {},
+                         [y1, y2](cmp::Plot& plot, std::size_t) {
+                           plot.plot({*y1, *y2});
+                           plot.fillBetween({{0, 1}});
+                         }});
+  }
+
+  // Logarithmic x- and y-axis.
+  {
+    auto x = std::make_shared<std::vector<float>>(ramp(100'000));
+    auto y = std::make_shared<std::vector<float>>(x->size());
+    std::transform(x->begin(), x->end(), y->begin(),
+                   [](const float v) { return 1.0f + std::sqrt(v); });
+
+    scenarios.push_back(
+        {"log_axes",
+         [] { return std::make_unique<cmp::LogLog>(); },
+         [](cmp::Plot& plot) {
+           plot.xLim(1.0f, 100'000.0f);
+           plot.yLim(1.0f, 1'000.0f);
+         },
+         [x, y](cmp::Plot& plot, std::size_t) { plot.plot({*y}, {*x}); }});
+  }
+
+  // Panning over a large line. The update stage is the x-limit change.
+  {
+    constexpr auto num_points = 1'000'000.0f;
+    constexpr auto window = num_points / 20.0f;
+
+    auto y = std::make_shared<std::vector<float>>(
+        sineWithNoise(std::size_t(num_points), 50.0f, 6));
+
+    scenarios.push_back(
+        {"pan_sequence", createLinearPlot,
+         [y](cmp::Plot& plot) {
+           plot.yLim(-1.5f, 1.5f);
+           plot.plot({*y});
+         },
+         [](cmp::Plot& plot, std::size_t iteration) {
+           const auto step = window / 10.0f;
+           const auto start = std::fmod(float(iteration) * step,
+                                        num_points - window) + 1.0f;
+           plot.xLim(start, start + window);
+         }});
+  }
+
+  // Zooming in around the center of a large line, restarting when the view
+  // is only a few points wide.
+  {
+    constexpr auto num_points = 1'000'000.0f;
+
+    auto y = std::make_shared<std::vector<float>>(
+        sineWithNoise(std::size_t(num_points), 50.0f, 7));
+
+    scenarios.push_back(
+        {"zoom_sequence", createLinearPlot,
+         [y](cmp::Plot& plot) {
+           plot.yLim(-1.5f, 1.5f);
+           plot.plot({*y});
+         },
+         [](cmp::Plot& plot, std::size_t iteration) {
+           constexpr auto steps_per_cycle = 24u;
+           const auto zoom =
+               std::pow(0.7f, float(iteration % steps_per_cycle));
+           const auto center = num_points / 2.0f;
+           const auto half_width = std::max(num_points * zoom / 2.0f, 8.0f);
+           plot.xLim(center - half_width, center + half_width);
+         }});
+  }
+
+  return scenarios;
+}
+
+juce::var distributionToVar(std::vector<double> samples) {
+  auto* obj = new juce::DynamicObject();
+
+  if (samples.empty()) return juce::var(obj);
+
+  std::sort(samples.begin(), samples.end());
+
+  const auto percentile = [&samples](const double p) {
+    const auto idx = std::size_t(
+        std::round(p * double(samples.size() - 1)));
+    return samples[idx];
+  };
+
+  const auto mean = std::accumulate(samples.begin(), samples.end(), 0.0) /
+                    double(samples.size());
+
+  obj->setProperty("min", samples.front());
+  obj->setProperty("mean", mean);
+  obj->setProperty("p50", percentile(0.5));
+  obj->setProperty("p90", percentile(0.9));
+  obj->setProperty("p99", percentile(0.99));
+  obj->setProperty("max", samples.back());
+
+  return juce::var(obj);
+}
+
+juce::var runScenario(const Scenario& scenario, const Settings& settings) {
+  auto plot = scenario.create_plot();
+  plot->setBounds(0, 0, settings.width, settings.height);
+  plot->setVisible(true);
+  scenario.setup(*plot);
+
+  juce::Image image(juce::Image::ARGB, settings.width, settings.height, true);
+
+  std::vector<double> update_ms, paint_ms, frame_ms;
+  update_ms.reserve(settings.iterations);
+  paint_ms.reserve(settings.iterations);
+  frame_ms.reserve(settings.iterations);
+
+  for (std::size_t i = 0; i < settings.warmup + settings.iterations; ++i) {
+    const auto frame_start = Clock::now();
+
+    scenario.update(*plot, i);
+    const auto update_time = msSince(frame_start);
+
+    const auto paint_start = Clock::now();
+    {
+      juce::Graphics g(image);
+      plot->paintEntireComponent(g, true);
+    }
+    const auto paint_time = msSince(paint_start);
+    const auto frame_time = msSince(frame_start);
+
+    if (i >= settings.warmup) {
+      update_ms.push_back(update_time);
+      paint_ms.push_back(paint_time);
+      frame_ms.push_back(frame_time);
+    }
+  }
+
+  auto* stages = new juce::DynamicObject();
+  stages->setProperty("update_ms", distributionToVar(update_ms));
+  stages->setProperty("paint_ms", distributionToVar(paint_ms));
+
+  auto* result = new juce::DynamicObject();
+  result->setProperty("name", juce::String(scenario.name));
+  result->setProperty("iterations", int(settings.iterations));
+  result->setProperty("stages", juce::var(stages));
+  result->setProperty("frame_ms", distributionToVar(frame_ms));
+
+  return juce::var(result);
+}
+
+Settings parseSettings(int argc, char* argv[]) {
+  Settings settings;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const std::string value = argv[i + 1];
+
+    if (key == "--iterations") {
+      settings.iterations = std::stoul(value);
+    } else if (key == "--warmup") {
+      settings.warmup = std::stoul(value);
+    } else if (key == "--width") {
+      settings.width = std::stoi(value);
+    } else if (key == "--height") {
+      settings.height = std::stoi(value);
+    } else if (key == "--scenario") {
+      settings.scenario = value;
+    } else if (key == "--output") {
+      settings.output = value;
+    } else {
+      throw std::invalid_argument("Unknown argument: " + key);
+    }
+  }
+
+  return settings;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  auto gui_scope = juce::ScopedJuceInitialiser_GUI();
+
+  const auto settings = parseSettings(argc, argv);
+
+  juce::Array<juce::var> results;
+  for (const auto& scenario : createScenarios()) {
+    if (!settings.scenario.empty() && settings.scenario != scenario.name) {
+      continue;
+    }
+
+    results.add(runScenario(scenario, settings));
+  }
+
+  auto* root = new juce::DynamicObject();
+  root->setProperty("width", settings.width);
+  root->setProperty("height", settings.height);
+  root->setProperty("warmup", int(settings.warmup));
+  root->setProperty("scenarios", results);
+
+  const auto json = juce::JSON::toString(juce::var(root));
+
+  if (settings.output.empty()) {
+    std::cout << json.toStdString() << std::endl;
+  } else {
+    juce::File(settings.output).replaceWithText(json);
+  }
+
+  return 0;
+}
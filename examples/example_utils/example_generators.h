@@ -0,0 +1,403 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file example_generators.h
+ *
+ * @brief Streaming generators of synthetic data for examples and benchmarks.
+ *
+ * All generators produce the samples in chunks using 'fill()', so sequences of
+ * 1e9 samples or more can be generated without holding them in memory. The
+ * random numbers are computed from the seed and the sample index. Therefore the
+ * output is reproducible for a given seed and independent of the chunk sizes
+ * used when filling.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <numbers>
+#include <span>
+#include <vector>
+
+namespace cmp {
+
+/** @brief Counter based random numbers, i.e. a hash of seed and index. */
+struct CounterRandom {
+  static constexpr std::uint64_t splitmix64(std::uint64_t x) noexcept {
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+  }
+
+  /** Uniform random value in [0, 1). */
+  static double uniform(const std::uint64_t seed,
+                        const std::uint64_t index) noexcept {
+    const auto bits = splitmix64(seed ^ splitmix64(index));
+    return double(bits >> 11) * 0x1.0p-53;
+  }
+
+  /** Normal distributed random value with mean 0 and standard deviation 1. */
+  static double normal(const std::uint64_t seed,
+                       const std::uint64_t index) noexcept {
+    const auto u1 = std::max(uniform(seed, 2u * index), 1e-300);
+    const auto u2 = uniform(seed, 2u * index + 1u);
+    return std::sqrt(-2.0 * std::log(u1)) *
+           std::cos(2.0 * std::numbers::pi * u2);
+  }
+};
+
+/**
+ * @brief Base class of the streaming generators.
+ *
+ * The derived class implements 'ValueType generate(std::uint64_t index)' which
+ * is called once per sample in increasing index order, and optionally
+ * 'resetState()' if it keeps a state between the samples.
+ */
+template <class ValueType, class Derived>
+class StreamingGenerator {
+ public:
+  /** @brief Fill the next samples
+   *
+   * @param destination the samples are written to the start of this span.
+   * @return the number of samples written. Less than the size of destination
+   * when the end of the sequence is reached.
+   */
+  std::size_t fill(std::span<ValueType> destination) {
+    const auto num_samples = std::size_t(
+        std::min<std::uint64_t>(destination.size(), m_length - m_position));
+
+    auto& derived = static_cast<Derived&>(*this);
+    for (std::size_t i = 0; i < num_samples; ++i) {
+      destination[i] = derived.generate(m_position++);
+    }
+
+    return num_samples;
+  }
+
+  /** @brief Get the next chunk of samples
+   *
+   * @param chunk_size the maximum number of samples.
+   * @return the samples, empty when the sequence is exhausted.
+   */
+  std::vector<ValueType> nextChunk(const std::size_t chunk_size) {
+    std::vector<ValueType> chunk(chunk_size);
+    chunk.resize(fill(chunk));
+    return chunk;
+  }
+
+  /** @brief Restart the sequence from the first sample. */
+  void reset() {
+    m_position = 0u;
+    static_cast<Derived&>(*this).resetState();
+  }
+
+  std::uint64_t getPosition() const noexcept { return m_position; }
+
+  std::uint64_t getLength() const noexcept { return m_length; }
+
+  bool isExhausted() const noexcept { return m_position >= m_length; }
+
+ protected:
+  explicit StreamingGenerator(const std::uint64_t length) : m_length{length} {}
+
+  void resetState() {}
+
+ private:
+  std::uint64_t m_position{0u};
+  const std::uint64_t m_length;
+};
+
+/** @brief Gaussian white noise. */
+template <class ValueType>
+class NoiseGenerator
+    : public StreamingGenerator<ValueType, NoiseGenerator<ValueType>> {
+ public:
+  NoiseGenerator(const std::uint64_t length, const std::uint64_t seed,
+                 const ValueType mean = 0, const ValueType std_dev = 1)
+      : StreamingGenerator<ValueType, NoiseGenerator>(length),
+        m_seed{seed},
+        m_mean{mean},
+        m_std_dev{std_dev} {}
+
+  ValueType generate(const std::uint64_t index) const noexcept {
+    return m_mean + m_std_dev * ValueType(CounterRandom::normal(m_seed, index));
+  }
+
+ private:
+  const std::uint64_t m_seed;
+  const ValueType m_mean, m_std_dev;
+};
+
+/** @brief Random walk with gaussian steps. */
+template <class ValueType>
+class RandomWalkGenerator
+    : public StreamingGenerator<ValueType, RandomWalkGenerator<ValueType>> {
+ public:
+  RandomWalkGenerator(const std::uint64_t length, const std::uint64_t seed,
+                      const ValueType step_std_dev = 1,
+                      const ValueType start = 0)
+      : StreamingGenerator<ValueType, RandomWalkGenerator>(length),
+        m_seed{seed},
+        m_step_std_dev{step_std_dev},
+        m_start{start},
+        m_value{start} {}
+
+  ValueType generate(const std::uint64_t index) noexcept {
+    // Accumulated in double to not loose the small steps for long sequences.
+    m_value += double(m_step_std_dev) * CounterRandom::normal(m_seed, index);
+    return ValueType(m_value);
+  }
+
+  void resetState() { m_value = double(m_start); }
+
+ private:
+  const std::uint64_t m_seed;
+  const ValueType m_step_std_dev, m_start;
+  double m_value;
+};
+
+/** @brief Linear chirp sweeping from start to end frequency over the length.
+ *
+ * The frequencies are given in cycles per sample, i.e. 0.5 is the Nyquist
+ * frequency.
+ */
+template <class ValueType>
+class ChirpGenerator
+    : public StreamingGenerator<ValueType, ChirpGenerator<ValueType>> {
+ public:
+  ChirpGenerator(const std::uint64_t length, const double start_frequency,
+                 const double end_frequency, const ValueType amplitude = 1)
+      : StreamingGenerator<ValueType, ChirpGenerator>(length),
+        m_start_frequency{start_frequency},
+        m_half_rate{(end_frequency - start_frequency) /
+                    (2.0 * double(std::max<std::uint64_t>(length, 1u)))},
+        m_amplitude{amplitude} {}
+
+  ValueType generate(const std::uint64_t index) const noexcept {
+    // The phase is computed in cycles and wrapped, which keeps it accurate
+    // for indices above 1e9.
+    const auto i = double(index);
+    const auto cycles = m_start_frequency * i + m_half_rate * (i * i);
+    const auto phase = cycles - std::floor(cycles);
+    return m_amplitude * ValueType(std::sin(2.0 * std::numbers::pi * phase));
+  }
+
+ private:
+  const double m_start_frequency, m_half_rate;
+  const ValueType m_amplitude;
+};
+
+/** @brief Low level noise with sparse spikes of random height. */
+template <class ValueType>
+class SparseSpikeGenerator
+    : public StreamingGenerator<ValueType, SparseSpikeGenerator<ValueType>> {
+ public:
+  SparseSpikeGenerator(const std::uint64_t length, const std::uint64_t seed,
+                       const double spike_probability,
+                       const ValueType spike_amplitude = 1,
+                       const ValueType noise_std_dev = 0)
+      : StreamingGenerator<ValueType, SparseSpikeGenerator>(length),
+        m_seed{seed},
+        m_spike_probability{spike_probability},
+        m_spike_amplitude{spike_amplitude},
+        m_noise_std_dev{noise_std_dev} {}
+
+  ValueType generate(const std::uint64_t index) const noexcept {
+    const auto spike_seed = CounterRandom::splitmix64(m_seed);
+
+    if (CounterRandom::uniform(spike_seed, index) < m_spike_probability) {
+      const auto height = 2.0 * CounterRandom::uniform(~spike_seed, index) - 1.0;
+      return m_spike_amplitude * ValueType(height);
+    }
+
+    return m_noise_std_dev * ValueType(CounterRandom::normal(m_seed, index));
+  }
+
+ private:
+  const std::uint64_t m_seed;
+  const double m_spike_probability;
+  const ValueType m_spike_amplitude, m_noise_std_dev;
+};
+
+/** @brief Piecewise constant steps with random levels. */
+template <class ValueType>
+class StepGenerator
+    : public StreamingGenerator<ValueType, StepGenerator<ValueType>> {
+ public:
+  StepGenerator(const std::uint64_t length, const std::uint64_t seed,
+                const std::uint64_t step_length, const ValueType min = 0,
+                const ValueType max = 1)
+      : StreamingGenerator<ValueType, StepGenerator>(length),
+        m_seed{seed},
+        m_step_length{std::max<std::uint64_t>(step_length, 1u)},
+        m_min{min},
+        m_max{max} {}
+
+  ValueType generate(const std::uint64_t index) const noexcept {
+    const auto level = CounterRandom::uniform(m_seed, index / m_step_length);
+    return m_min + ValueType(level) * (m_max - m_min);
+  }
+
+ private:
+  const std::uint64_t m_seed, m_step_length;
+  const ValueType m_min, m_max;
+};
+
+/** @brief Irregular and increasing x-values.
+ *
+ * The distance between two x-values is 'mean_dx * (1 +- jitter)'.
+ */
+template <class ValueType>
+class IrregularXGenerator
+    : public StreamingGenerator<ValueType, IrregularXGenerator<ValueType>> {
+ public:
+  IrregularXGenerator(const std::uint64_t length, const std::uint64_t seed,
+                      const double mean_dx = 1.0, const double jitter = 0.5,
+                      const double start = 0.0)
+      : StreamingGenerator<ValueType, IrregularXGenerator>(length),
+        m_seed{seed},
+        m_mean_dx{mean_dx},
+        m_jitter{std::clamp(jitter, 0.0, 1.0)},
+        m_start{start},
+        m_x{start} {}
+
+  ValueType generate(const std::uint64_t index) noexcept {
+    if (index > 0u) {
+      const auto u = 2.0 * CounterRandom::uniform(m_seed, index) - 1.0;
+      m_x += m_mean_dx * (1.0 + m_jitter * u);
+    }
+    return ValueType(m_x);
+  }
+
+  void resetState() { m_x = m_start; }
+
+ private:
+  const std::uint64_t m_seed;
+  const double m_mean_dx, m_jitter, m_start;
+  double m_x;
+};
+
+/** @brief Replaces runs of samples of another generator with NaN.
+ *
+ * The sequence is divided into blocks of 'run_length' samples and each block
+ * is dropped with the probability 'dropout_probability'.
+ */
+template <class ValueType, class SourceGenerator>
+class NaNDropoutGenerator
+    : public StreamingGenerator<ValueType,
+                                NaNDropoutGenerator<ValueType, SourceGenerator>> {
+ public:
+  NaNDropoutGenerator(SourceGenerator source, const std::uint64_t seed,
+                      const double dropout_probability,
+                      const std::uint64_t run_length)
+      : StreamingGenerator<ValueType, NaNDropoutGenerator>(source.getLength()),
+        m_source{std::move(source)},
+        m_seed{seed},
+        m_dropout_probability{dropout_probability},
+        m_run_length{std::max<std::uint64_t>(run_length, 1u)} {}
+
+  ValueType generate(const std::uint64_t index) {
+    // Always advance the source to keep stateful sources in sync.
+    const auto value = m_source.generate(index);
+
+    if (CounterRandom::uniform(m_seed, index / m_run_length) <
+        m_dropout_probability) {
+      return std::numeric_limits<ValueType>::quiet_NaN();
+    }
+
+    return value;
+  }
+
+  void resetState() { m_source.reset(); }
+
+ private:
+  SourceGenerator m_source;
+  const std::uint64_t m_seed;
+  const double m_dropout_probability;
+  const std::uint64_t m_run_length;
+};
+
+/** @brief Multi channel generator producing interleaved frames.
+ *
+ * A frame holds one sample of each channel, i.e. the output of 'fill' is
+ * [ch0, ch1, ..., chN, ch0, ch1, ...]. The length is counted in frames.
+ */
+template <class ValueType, class ChannelGenerator>
+class InterleavedFrameGenerator {
+ public:
+  /** @brief Constructor
+   *
+   * @param num_channels the number of channels.
+   * @param create_channel returns the generator of a channel given the channel
+   * index, e.g. the index can be used as seed.
+   */
+  InterleavedFrameGenerator(
+      const std::size_t num_channels,
+      const std::function<ChannelGenerator(std::size_t)>& create_channel) {
+    m_channels.reserve(num_channels);
+    for (std::size_t c = 0; c < num_channels; ++c) {
+      m_channels.push_back(create_channel(c));
+    }
+  }
+
+  /** @brief Fill the next frames
+   *
+   * @param destination must hold a multiple of the number of channels.
+   * @return the number of frames written.
+   */
+  std::size_t fill(std::span<ValueType> destination) {
+    const auto num_channels = m_channels.size();
+    const auto num_frames = destination.size() / num_channels;
+
+    m_scratch.resize(num_frames);
+
+    std::size_t frames_written{num_frames};
+    for (std::size_t c = 0; c < num_channels; ++c) {
+      const auto num_written = m_channels[c].fill(m_scratch);
+      frames_written = std::min(frames_written, num_written);
+
+      for (std::size_t f = 0; f < num_written; ++f) {
+        destination[f * num_channels + c] = m_scratch[f];
+      }
+    }
+
+    return frames_written;
+  }
+
+  /** @brief Get the next frames as one vector per channel, e.g. to be used as
+   * y_data in cmp::Plot::plotUpdateYOnly. */
+  std::vector<std::vector<ValueType>> nextChannels(
+      const std::size_t num_frames) {
+    std::vector<std::vector<ValueType>> channels;
+    channels.reserve(m_channels.size());
+
+    for (auto& channel : m_channels) {
+      channels.push_back(channel.nextChunk(num_frames));
+    }
+
+    return channels;
+  }
+
+  void reset() {
+    for (auto& channel : m_channels) channel.reset();
+  }
+
+  std::size_t getNumChannels() const noexcept { return m_channels.size(); }
+
+ private:
+  std::vector<ChannelGenerator> m_channels;
+  std::vector<ValueType> m_scratch;
+};
+
+}  // namespace cmp
@@ -8,6 +8,8 @@
 #include <random>
 #include <vector>
 
+#include "example_generators.h"
+
 namespace cmp {
 
 /* Get an vector of random values. **/
@@ -0,0 +1,83 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_csv_loader.hpp
+ *
+ * @brief Parallel loader of numeric columns from CSV/TSV files.
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace cmp {
+
+/**
+ * @brief Options used by loadCsvColumns().
+ */
+struct CsvLoadOptions {
+  /** @brief Field delimiter. Detected from the first line if not set, a tab
+   * if the first line contains one, otherwise a comma. */
+  std::optional<char> delimiter;
+
+  /** @brief Whether the first line holds the column names. Detected if not
+   * set, the first line is a header if any of its fields is not a number. */
+  std::optional<bool> has_header;
+
+  /** @brief Number of parsing threads. Zero uses the number of CPU cores. */
+  std::size_t num_threads{0u};
+
+  /** @brief Smallest chunk, in bytes, given to a single thread. */
+  std::size_t min_chunk_size{1u << 20u};
+
+  /** @brief Called on the calling thread with the parsed fraction [0, 1]. */
+  std::function<void(double progress)> progress_callback;
+};
+
+/**
+ * @brief Numeric columns loaded by loadCsvColumns().
+ *
+ * The columns can be passed directly to Plot::plot() as y-data, or one of
+ * them as x-data.
+ */
+struct CsvColumns {
+  /** @brief Column names from the header, empty if there is no header. */
+  std::vector<std::string> names;
+
+  /** @brief One vector per column, all with the same number of rows. */
+  std::vector<std::vector<float>> columns;
+};
+
+/**
+ * @brief Load all numeric columns of a CSV/TSV file.
+ *
+ * The file is memory mapped and split into chunks aligned to newlines that
+ * are parsed in parallel with std::from_chars. The rows of each chunk are
+ * counted first so every thread writes its values directly into the
+ * returned columns.
+ *
+ * Empty and non-numeric fields are loaded as NaN, as are missing fields of
+ * short rows. Fields beyond the number of columns of the first line are
+ * ignored and blank lines are skipped. Quoted fields containing delimiters
+ * or newlines are not supported.
+ *
+ * @param file the CSV/TSV file.
+ * @param options the load options.
+ * @return the loaded columns.
+ * @throws std::runtime_error if the file cannot be read.
+ * @throws std::invalid_argument if the options are invalid.
+ */
+CsvColumns loadCsvColumns(const juce::File &file,
+                          const CsvLoadOptions &options = {});
+
+}  // namespace cmp
@@ -0,0 +1,165 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_npy_reader.hpp
+ *
+ * @brief Memory mapped reader of NumPy .npy and raw binary arrays.
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace cmp {
+
+/**
+ * @brief The element types supported by NpyArray.
+ */
+enum class NpyDataType { float32, float64, int16 };
+
+/**
+ * @brief A 1-D or 2-D array memory mapped from a .npy or raw binary file.
+ *
+ * Opening the array only parses the header and maps the file, the payload is
+ * not read until it is accessed. Like Plot::plot(), the columns of a 2-D array
+ * with shape (num_points, num_lines) are the lines, while a 1-D array is a
+ * single line.
+ *
+ * The payload can be accessed without copying with getData(), or converted
+ * to plot-ready float vectors with getLine() and getLines(). The lines of a
+ * float32 array stored line by line can be plotted without copying with
+ * getLineViews() and Plot::plotBorrowed(). Only little endian data is
+ * supported.
+ *
+ * @code
+ * const auto array = cmp::NpyArray(juce::File("signals.npy"));
+ * plot.plot(array.getLines());
+ *
+ * // A float32 array in Fortran order, or with a single line.
+ * plot.plotBorrowed(array.getLineViews());
+ * @endcode
+ */
+class NpyArray {
+ public:
+  /**
+   * @brief Map a .npy file.
+   *
+   * @param file the .npy file.
+   * @throws std::runtime_error if the file cannot be read, the header is
+   * invalid or the data type or shape is not supported.
+   */
+  explicit NpyArray(const juce::File &file);
+
+  /**
+   * @brief Map a raw binary file without a .npy header.
+   *
+   * @param file the raw binary file.
+   * @param data_type the element type.
+   * @param shape the shape of the array, one or two dimensions.
+   * @param fortran_order true if the array is stored column by column.
+   * @param offset number of bytes before the payload.
+   * @throws std::runtime_error if the file cannot be read.
+   * @throws std::invalid_argument if the shape is not supported or larger
+   * than the file.
+   */
+  NpyArray(const juce::File &file, const NpyDataType data_type,
+           const std::vector<std::size_t> &shape,
+           const bool fortran_order = false, const std::size_t offset = 0u);
+
+  /** @brief Get the element type. */
+  NpyDataType getDataType() const noexcept;
+
+  /** @brief Get the shape, one or two dimensions. */
+  const std::vector<std::size_t> &getShape() const noexcept;
+
+  /** @brief True if the array is stored column by column. */
+  bool isFortranOrder() const noexcept;
+
+  /** @brief Get the number of lines, the number of columns of a 2-D array. */
+  std::size_t getNumLines() const noexcept;
+
+  /** @brief Get the number of points of each line. */
+  std::size_t getNumPointsPerLine() const noexcept;
+
+  /**
+   * @brief Get the mapped payload in storage order without copying.
+   *
+   * The span is valid as long as this array is alive.
+   *
+   * @tparam ValueType float, double or int16_t matching getDataType().
+   * @throws std::invalid_argument if ValueType does not match the data type
+   * or if the payload of a raw file is not aligned for ValueType.
+   */
+  template <class ValueType>
+  std::span<const ValueType> getData() const {
+    if (m_data_type != getDataTypeOf<ValueType>()) {
+      throw std::invalid_argument("The value type does not match the array.");
+    }
+
+    if (reinterpret_cast<std::uintptr_t>(m_payload) % alignof(ValueType)) {
+      throw std::invalid_argument("The payload is not aligned.");
+    }
+
+    return {reinterpret_cast<const ValueType *>(m_payload),
+            getNumLines() * getNumPointsPerLine()};
+  }
+
+  /**
+   * @brief Convert a single line to float.
+   *
+   * @param line_index the index of the line.
+   * @throws std::out_of_range if line_index is out of range.
+   */
+  std::vector<float> getLine(const std::size_t line_index) const;
+
+  /** @brief Convert all lines to float, ready to pass to Plot::plot(). */
+  std::vector<std::vector<float>> getLines() const;
+
+  /**
+   * @brief Get all lines in the mapped payload without copying.
+   *
+   * Ready to pass to Plot::plotBorrowed(). The spans are valid as long as
+   * this array is alive.
+   *
+   * @throws std::invalid_argument if the data type is not float32, if the
+   * lines are not contiguous, i.e. a 2-D array in C order, or if the payload
+   * of a raw file is not aligned for float.
+   */
+  std::vector<std::span<const float>> getLineViews() const;
+
+ private:
+  template <class ValueType>
+  static constexpr NpyDataType getDataTypeOf() noexcept {
+    static_assert(std::is_same_v<ValueType, float> ||
+                      std::is_same_v<ValueType, double> ||
+                      std::is_same_v<ValueType, std::int16_t>,
+                  "Unsupported value type.");
+
+    if constexpr (std::is_same_v<ValueType, float>) return NpyDataType::float32;
+    if constexpr (std::is_same_v<ValueType, double>) return NpyDataType::float64;
+    return NpyDataType::int16;
+  }
+
+  void mapFile(const juce::File &file);
+  void setPayload(const std::size_t offset);
+
+  std::unique_ptr<juce::MemoryMappedFile> m_mapped_file;
+  const char *m_payload{nullptr};
+  NpyDataType m_data_type{NpyDataType::float32};
+  std::vector<std::size_t> m_shape;
+  bool m_fortran_order{false};
+};
+
+}  // namespace cmp
@@ -0,0 +1,281 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_remote_data_source.hpp
+ *
+ * @brief Remote data source answering per pixel column summaries over TCP.
+ *
+ * @details The data stays on the server, a client asks for the summary of
+ * each pixel column of an x-range instead of the raw samples. A column
+ * summary holds the first, last, min and max sample of the column (M4). The
+ * vertical extent and the line into and out of each column are exact, the
+ * x-value of the min and max is not sent and is placed at the column centre.
+ *
+ * Protocol, version 1. All values are little endian, each request is answered
+ * by exactly one response on the same connection:
+ *
+ * Request header:  u32 magic, u32 version, u32 request type.
+ *
+ * get_info request: no payload.
+ * get_info response: u32 magic, u32 status, u32 num_lines, and for each line
+ * u64 generation, u64 num_samples, f32 x_min, f32 x_max.
+ *
+ * get_columns request: u32 line_index, f64 column_width, i64 first_column,
+ * u32 num_columns. Column 'k' covers the x-values [k, k + 1) * column_width.
+ * get_columns response: u32 magic, u32 status, u64 generation,
+ * u64 num_samples, f32 x_max, u32 num_columns, and for each column
+ * u32 num_samples, f32 first_x, f32 first_y, f32 last_x, f32 last_y,
+ * f32 min_y, f32 max_y.
+ *
+ * A response with a status other than ok holds only the magic and the status.
+ * The generation of a line is incremented when the line is replaced, while
+ * appended samples only change the columns from the previous x_max.
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cmp {
+
+namespace remote_protocol {
+
+constexpr std::uint32_t magic = 0x524d5043u;
+constexpr std::uint32_t version = 1u;
+
+/** Max number of columns in one get_columns request. */
+constexpr std::uint32_t max_num_columns = 1u << 16u;
+
+enum class RequestType : std::uint32_t { get_info = 0u, get_columns = 1u };
+
+enum class Status : std::uint32_t {
+  ok = 0u,
+  bad_request = 1u,
+  invalid_line = 2u
+};
+
+}  // namespace remote_protocol
+
+/**
+ * @brief The summary of the samples of one pixel column.
+ */
+struct RemoteColumn {
+  /** The x-range of the column, [x_start, x_end). */
+  float x_start, x_end;
+
+  /** Number of samples in the column, the other values are NaN if zero. */
+  std::uint32_t num_samples;
+
+  float first_x, first_y, last_x, last_y;
+
+  /** NaN samples are skipped. */
+  float min_y, max_y;
+};
+
+/**
+ * @brief Info of a line of a RemoteDataServer.
+ */
+struct RemoteLineInfo {
+  std::uint64_t generation;
+  std::uint64_t num_samples;
+  float x_min, x_max;
+};
+
+/**
+ * @brief Reference server answering the remote data source protocol.
+ *
+ * The lines are stored on the server together with a range statistics index,
+ * so the min/max of a column is resolved without scanning its samples. Each
+ * connection is served on its own thread.
+ *
+ * @code
+ * cmp::RemoteDataServer server;
+ * server.setLine(0, x_data, y_data);
+ * const auto port = server.start(8642);
+ * @endcode
+ */
+class RemoteDataServer {
+ public:
+  RemoteDataServer();
+  ~RemoteDataServer();
+
+  /**
+   * @brief Start listening for clients.
+   *
+   * @param port the port, 0 to pick any free port.
+   * @param local_host_name the address to listen on, loopback by default.
+   * @return the port that the server listens on.
+   * @throws std::runtime_error if the server cannot listen on the port.
+   */
+  int start(const int port = 0,
+            const juce::String &local_host_name = "127.0.0.1");
+
+  /** @brief Stop listening and close all connections. */
+  void stop();
+
+  /**
+   * @brief Replace or add a line, increments the generation of the line.
+   *
+   * @param line_index the index of the line, lines in between are added empty.
+   * @param x_data the x-data, must be sorted in ascending order.
+   * @param y_data the y-data, same size as x_data.
+   * @throws std::invalid_argument if the x-data is not sorted or the sizes
+   * differ.
+   */
+  void setLine(const std::size_t line_index, std::vector<float> x_data,
+               std::vector<float> y_data);
+
+  /**
+   * @brief Append samples to a line.
+   *
+   * @param line_index the index of an existing line.
+   * @param x_data the x-data, sorted and not lower than the last x-value.
+   * @param y_data the y-data, same size as x_data.
+   * @throws std::invalid_argument if the x-data is not sorted, the sizes
+   * differ or the line does not exist.
+   */
+  void appendToLine(const std::size_t line_index,
+                    const std::vector<float> &x_data,
+                    const std::vector<float> &y_data);
+
+ private:
+  struct Line;
+
+  void acceptConnections();
+  void serveConnection(std::unique_ptr<juce::StreamingSocket> socket);
+  juce::MemoryBlock createInfoResponse();
+  juce::MemoryBlock createColumnsResponse(const std::uint32_t line_index,
+                                          const double column_width,
+                                          const std::int64_t first_column,
+                                          const std::uint32_t num_columns);
+
+  std::mutex m_lines_mutex;
+  std::vector<std::unique_ptr<Line>> m_lines;
+
+  std::unique_ptr<juce::StreamingSocket> m_listener;
+  std::atomic<bool> m_is_running{false};
+  std::thread m_accept_thread;
+  std::mutex m_connections_mutex;
+  std::vector<std::thread> m_connection_threads;
+};
+
+/**
+ * @brief Client of the remote data source protocol with a column cache.
+ *
+ * The columns of a request are aligned to a grid of the column width, so
+ * panning at the same zoom level reuses the cached columns and only requests
+ * the new ones. Only the columns before the last x-value of the line are
+ * cached, since appended samples cannot change them, and the cache of a line
+ * is dropped when its generation changes. Each call makes one request, with
+ * no columns if all are cached, to check the generation. The client is not
+ * thread safe.
+ *
+ * @code
+ * cmp::RemoteDataClient client("acquisition-box", 8642);
+ * const auto columns = client.getColumns(0, {0.f, 10.f}, graph_width);
+ * const auto [x_data, y_data] = cmp::RemoteDataClient::toXYData(columns);
+ * plot.plot({y_data}, {x_data});
+ * @endcode
+ */
+class RemoteDataClient {
+ public:
+  /** Max number of cached columns of all lines. */
+  static constexpr std::size_t max_num_cached_columns = 1u << 20u;
+
+  /**
+   * @brief Connect to a server.
+   *
+   * @param host_name the host of the server.
+   * @param port the port of the server.
+   * @param timeout_ms connection timeout in milliseconds.
+   * @throws std::runtime_error if the connection fails.
+   */
+  RemoteDataClient(const juce::String &host_name, const int port,
+                   const int timeout_ms = 3000);
+
+  /**
+   * @brief Get the info of all lines of the server.
+   *
+   * @throws std::runtime_error on connection or protocol errors.
+   */
+  std::vector<RemoteLineInfo> getInfo();
+
+  /**
+   * @brief Get the column summaries of an x-range.
+   *
+   * The range is split in 'num_columns' columns aligned to a grid of the
+   * column width, so one more column may be returned to cover the range.
+   *
+   * @param line_index the index of the line.
+   * @param x_lim the x-range, typically the x-limits of the plot.
+   * @param num_columns the number of columns, typically the graph width.
+   * @throws std::invalid_argument if the line does not exist or the range or
+   * number of columns is invalid.
+   * @throws std::runtime_error on connection or protocol errors.
+   */
+  std::vector<RemoteColumn> getColumns(const std::size_t line_index,
+                                       const std::pair<float, float> x_lim,
+                                       const std::size_t num_columns);
+
+  /** @brief Drop all cached columns. */
+  void clearCache() noexcept;
+
+  /** @brief Get the number of columns received from the server. */
+  std::size_t getNumReceivedColumns() const noexcept;
+
+  /**
+   * @brief Convert column summaries to x/y-data ready to pass to Plot::plot().
+   *
+   * Each column adds its first, min, max and last sample. The min and max are
+   * placed at the centre of the column, so the line between two columns can
+   * be off by up to half a column width.
+   */
+  static std::pair<std::vector<float>, std::vector<float>> toXYData(
+      const std::vector<RemoteColumn> &columns);
+
+ private:
+  /** The cached columns of a line for a column width. */
+  struct ColumnGrid {
+    double column_width;
+    std::map<std::int64_t, RemoteColumn> columns;
+  };
+
+  /** The grids of a line, the most recently used grid is last. */
+  struct LineCache {
+    std::uint64_t generation{0u};
+    std::vector<ColumnGrid> grids;
+  };
+
+  void requestColumns(const std::size_t line_index, const double column_width,
+                      const std::int64_t first_column,
+                      const std::uint32_t num_columns);
+  void updateLineCache(LineCache &line_cache, const std::uint64_t generation);
+  void send(const juce::MemoryBlock &request);
+  void receive(void *data, const std::size_t num_bytes);
+
+  juce::StreamingSocket m_socket;
+  std::vector<LineCache> m_line_caches;
+  std::size_t m_num_cached_columns{0u};
+  std::size_t m_num_received_columns{0u};
+
+  /** The columns of the last request, including the incomplete columns at
+   * the end of a line that are not cached. */
+  std::int64_t m_last_first_column{0};
+  std::vector<RemoteColumn> m_last_columns;
+};
+
+}  // namespace cmp
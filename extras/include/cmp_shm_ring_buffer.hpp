@@ -0,0 +1,324 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_shm_ring_buffer.hpp
+ *
+ * @brief Ring buffer in POSIX shared memory fed by another process.
+ *
+ * @details The shared memory object starts with a 64 byte header followed by
+ * the frames. A frame holds one sample of each channel, interleaved:
+ *
+ * | Offset | Type    | Field                                               |
+ * |--------|---------|-----------------------------------------------------|
+ * | 0      | u32     | magic, 0x53504d43                                   |
+ * | 4      | u32     | version, 1                                          |
+ * | 8      | u32     | data type, see ShmDataType                          |
+ * | 12     | u32     | number of channels                                  |
+ * | 16     | u64     | capacity in frames                                  |
+ * | 24     | u64     | byte offset of the first frame, 64                  |
+ * | 32     | atm u64 | reserve index, frames the producer started writing  |
+ * | 40     | atm u64 | write index, frames written in total                |
+ * | 48     | u64[2]  | reserved                                            |
+ *
+ * Frame 'i' is stored in slot 'i % capacity'. The producer stores the reserve
+ * index, writes the frames and then stores the write index with release
+ * semantics. The consumer loads the write index with acquire semantics,
+ * copies the frames and then loads the reserve index. Frames older than the
+ * reserve index minus the capacity may have been overwritten during the copy
+ * and are discarded. All values are in native byte order.
+ */
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace cmp {
+
+/** @brief The sample types of a shared memory ring buffer. */
+enum class ShmDataType : std::uint32_t { float32 = 0u, float64 = 1u, int16 = 2u };
+
+/** @brief The header at the start of the shared memory object. */
+struct ShmRingBufferHeader {
+  static constexpr std::uint32_t magic_value = 0x53504d43u;
+  static constexpr std::uint32_t version_value = 1u;
+
+  std::uint32_t magic;
+  std::uint32_t version;
+  ShmDataType data_type;
+  std::uint32_t num_channels;
+  std::uint64_t capacity;
+  std::uint64_t data_offset;
+  std::atomic<std::uint64_t> reserve_index;
+  std::atomic<std::uint64_t> write_index;
+  std::uint64_t reserved[2];
+};
+
+static_assert(sizeof(ShmRingBufferHeader) == 64u);
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "The indices are shared between processes.");
+
+/**
+ * @brief Maps a shared memory object, base class of the reader and writer.
+ */
+class ShmRingBuffer {
+ public:
+  ShmRingBuffer(const ShmRingBuffer &) = delete;
+  ShmRingBuffer &operator=(const ShmRingBuffer &) = delete;
+
+  /** @brief Get the name of the shared memory object. */
+  const std::string &getName() const noexcept;
+
+  /** @brief Get the sample type. */
+  ShmDataType getDataType() const noexcept;
+
+  /** @brief Get the number of channels of each frame. */
+  std::size_t getNumChannels() const noexcept;
+
+  /** @brief Get the number of frames that the ring buffer holds. */
+  std::size_t getCapacity() const noexcept;
+
+  /** @brief Get the number of frames written in total. */
+  std::uint64_t getWriteIndex() const noexcept;
+
+ protected:
+  ShmRingBuffer() = default;
+  ~ShmRingBuffer();
+
+  void map(const bool is_writable);
+  std::size_t getSampleSize() const noexcept;
+  char *getSlot(const std::uint64_t frame_index) const noexcept;
+
+  std::string m_name;
+  int m_file_descriptor{-1};
+  void *m_mapping{nullptr};
+  std::size_t m_mapping_size{0u};
+  ShmRingBufferHeader *m_header{nullptr};
+};
+
+/**
+ * @brief Producer of a shared memory ring buffer.
+ *
+ * Creates the shared memory object and removes it when destroyed. Typically
+ * used in the acquisition process, and in tests.
+ *
+ * @code
+ * cmp::ShmRingBufferWriter writer("/daq", cmp::ShmDataType::float32, 4, 1 << 20);
+ * writer.write<float>(interleaved_frames);
+ * @endcode
+ */
+class ShmRingBufferWriter : public ShmRingBuffer {
+ public:
+  /**
+   * @brief Create a shared memory ring buffer.
+   *
+   * @param name the name of the shared memory object, e.g. "/daq".
+   * @param data_type the sample type.
+   * @param num_channels the number of channels of each frame.
+   * @param capacity the number of frames.
+   * @throws std::invalid_argument if the number of channels or the capacity
+   * is zero.
+   * @throws std::runtime_error if the shared memory object cannot be created.
+   */
+  ShmRingBufferWriter(const std::string &name, const ShmDataType data_type,
+                      const std::size_t num_channels,
+                      const std::size_t capacity);
+  ~ShmRingBufferWriter();
+
+  /**
+   * @brief Write interleaved frames.
+   *
+   * @tparam ValueType float, double or int16_t matching the data type.
+   * @param frames the frames, a multiple of the number of channels.
+   * @throws std::invalid_argument if the value type does not match or the
+   * size is not a multiple of the number of channels.
+   */
+  template <class ValueType>
+  void write(std::span<const ValueType> frames) {
+    if (m_header->data_type != getDataTypeOf<ValueType>() ||
+        frames.size() % getNumChannels()) {
+      throw std::invalid_argument("Invalid frames.");
+    }
+
+    writeFrames(frames.data(), frames.size() / getNumChannels());
+  }
+
+  /** @brief Get the shared memory data type of a value type. */
+  template <class ValueType>
+  static constexpr ShmDataType getDataTypeOf() noexcept {
+    static_assert(std::is_same_v<ValueType, float> ||
+                      std::is_same_v<ValueType, double> ||
+                      std::is_same_v<ValueType, std::int16_t>,
+                  "Unsupported value type.");
+
+    if constexpr (std::is_same_v<ValueType, float>) return ShmDataType::float32;
+    if constexpr (std::is_same_v<ValueType, double>) return ShmDataType::float64;
+    return ShmDataType::int16;
+  }
+
+ private:
+  void writeFrames(const void *frames, std::size_t num_frames);
+};
+
+/**
+ * @brief The newest samples of each channel of a shared memory ring buffer.
+ *
+ * A ring indexed window per channel, new samples overwrite the oldest ones
+ * and nothing is shifted, so reading new frames is O(new frames) instead of
+ * O(window size). Each sample is stored twice, 'size' samples apart, so the
+ * window is always one contiguous span from the oldest to the newest sample.
+ * The samples are NaN until they are read.
+ */
+class ShmChannelWindows {
+ public:
+  /**
+   * @brief Create the windows.
+   *
+   * @param num_channels the number of channels of the ring buffer.
+   * @param size the number of samples of each window.
+   * @throws std::invalid_argument if the number of channels or the size is
+   * zero.
+   */
+  ShmChannelWindows(const std::size_t num_channels, const std::size_t size);
+
+  /** @brief Get the number of channels. */
+  std::size_t getNumChannels() const noexcept;
+
+  /** @brief Get the number of samples of each window. */
+  std::size_t getSize() const noexcept;
+
+  /**
+   * @brief Get the window of a channel, oldest sample first.
+   *
+   * Valid until the next read of new frames into the windows.
+   *
+   * @param channel the channel, less than getNumChannels().
+   * @return the samples of the window.
+   */
+  std::span<const float> getWindow(const std::size_t channel) const noexcept;
+
+ private:
+  friend class ShmRingBufferReader;
+
+  /** Writes the samples 'offset' to 'offset + num_samples' after the oldest
+   * sample of a channel, in at most two parts, and their second copies. */
+  template <class WriteFunction>
+  void writeSamples(const std::size_t channel, const std::size_t offset,
+                    const std::size_t num_samples, WriteFunction write) {
+    auto *samples = m_samples[channel].data();
+
+    for (auto i = offset; i < offset + num_samples;) {
+      const auto slot = (m_oldest + i) % m_size;
+      const auto num_written = std::min(offset + num_samples - i, m_size - slot);
+
+      write(samples + slot, i, num_written);
+      std::copy_n(samples + slot, num_written, samples + slot + m_size);
+
+      i += num_written;
+    }
+  }
+
+  void advance(const std::size_t num_samples) noexcept;
+
+  std::size_t m_size;
+  std::size_t m_oldest{0u};
+  std::vector<std::vector<float>> m_samples;
+};
+
+/**
+ * @brief Consumer of a shared memory ring buffer written by another process.
+ *
+ * The new frames are read from the mapped ring once per frame of the GUI, and
+ * converted to float in windows with the newest samples of each channel.
+ * The mapped ring itself is not plotted in place: the frames are interleaved
+ * and of any sample type, while a graph line reads contiguous float samples.
+ * With ShmChannelWindows only the new frames are converted, and the windows
+ * are plotted without copying by plotUpdateYOnlyBorrowed():
+ *
+ * @code
+ * cmp::ShmRingBufferReader reader("/daq");
+ * cmp::ShmChannelWindows windows(reader.getNumChannels(), 10'000);
+ * std::vector<std::span<const float>> y_data(reader.getNumChannels());
+ *
+ * // In a timer callback.
+ * if (reader.readNewFrames(windows) > 0u) {
+ *   for (std::size_t c = 0u; c < y_data.size(); ++c)
+ *     y_data[c] = windows.getWindow(c);
+ *   plot.plotUpdateYOnlyBorrowed(y_data);
+ * }
+ * @endcode
+ */
+class ShmRingBufferReader : public ShmRingBuffer {
+ public:
+  /**
+   * @brief Attach to a shared memory ring buffer.
+   *
+   * Reading starts at the frames written after attaching.
+   *
+   * @param name the name of the shared memory object.
+   * @throws std::runtime_error if the shared memory object cannot be opened
+   * or the header is invalid.
+   */
+  explicit ShmRingBufferReader(const std::string &name);
+
+  /**
+   * @brief Shift the new frames into the windows of the channels.
+   *
+   * The windows keep their size, the oldest samples are shifted out, which
+   * moves the whole window every call. Frames that were overwritten before
+   * they could be read are set to NaN.
+   *
+   * @param windows one window per channel, all of the same size.
+   * @return the number of new frames.
+   * @throws std::invalid_argument if the number of windows does not match the
+   * number of channels or the windows have different sizes.
+   */
+  std::size_t readNewFrames(std::vector<std::vector<float>> &windows);
+
+  /**
+   * @brief Write the new frames over the oldest samples of the windows.
+   *
+   * Nothing is shifted, only the new frames that fit in the windows are
+   * converted. Frames that were overwritten before they could be read are set
+   * to NaN.
+   *
+   * @param windows the windows, one per channel.
+   * @return the number of new frames.
+   * @throws std::invalid_argument if the number of windows does not match the
+   * number of channels.
+   */
+  std::size_t readNewFrames(ShmChannelWindows &windows);
+
+  /** @brief Get the number of frames overwritten before they could be read. */
+  std::uint64_t getNumDroppedFrames() const noexcept;
+
+ private:
+  /** The frames [first_read, last) fit in the windows, the ones before
+   * first_copied were overwritten before they could be read. */
+  struct NewFrames {
+    std::uint64_t num_new, first_read, first_copied, last;
+  };
+
+  NewFrames getNewFrames(const std::size_t window_size);
+  void convertFrames(const std::size_t channel, const std::uint64_t first,
+                     const std::uint64_t last, float *destination) const noexcept;
+  std::uint64_t getNumTornFrames(const NewFrames &new_frames);
+
+  std::uint64_t m_read_index{0u};
+  std::uint64_t m_num_dropped_frames{0u};
+};
+
+}  // namespace cmp
@@ -0,0 +1,317 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "cmp_csv_loader.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <tuple>
+
+namespace cmp {
+
+namespace {
+
+/** Lines are parsed in batches between updates of the shared progress. */
+constexpr std::size_t LINES_PER_PROGRESS_UPDATE = 4096u;
+
+/** More chunks than threads evens out the load between the threads. */
+constexpr std::size_t CHUNKS_PER_THREAD = 4u;
+
+constexpr auto PROGRESS_INTERVAL = std::chrono::milliseconds(50);
+
+struct Chunk {
+  const char *begin;
+  const char *end;
+  std::size_t first_row{0u};
+  std::size_t num_rows{0u};
+};
+
+const char *findLineEnd(const char *begin, const char *end) noexcept {
+  const auto *newline = static_cast<const char *>(
+      std::memchr(begin, '\n', std::size_t(end - begin)));
+  return newline ? newline : end;
+}
+
+const char *findNextLine(const char *begin, const char *end) noexcept {
+  const auto *line_end = findLineEnd(begin, end);
+  return line_end == end ? end : line_end + 1;
+}
+
+bool isBlankLine(const char *begin, const char *end) noexcept {
+  return std::all_of(begin, end, [](const char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+  });
+}
+
+/** Calls 'fn(line_begin, line_end)' for every non-blank line. */
+template <class Fn>
+void forEachLine(const char *begin, const char *end, Fn &&fn) {
+  while (begin < end) {
+    const auto *line_end = findLineEnd(begin, end);
+    if (!isBlankLine(begin, line_end)) fn(begin, line_end);
+    begin = findNextLine(line_end, end);
+  }
+}
+
+/** Removes surrounding spaces, quotes and a trailing carriage return. */
+std::pair<const char *, const char *> trimField(const char *begin,
+                                                const char *end) noexcept {
+  const auto is_trimmed = [](const char c) {
+    return c == ' ' || c == '"' || c == '\r';
+  };
+
+  while (begin != end && is_trimmed(*begin)) ++begin;
+  while (end != begin && is_trimmed(*(end - 1))) --end;
+
+  return {begin, end};
+}
+
+bool tryParseField(const char *begin, const char *end, float &value) noexcept {
+  std::tie(begin, end) = trimField(begin, end);
+
+  // std::from_chars does not accept a leading plus sign.
+  if (begin != end && *begin == '+') ++begin;
+  if (begin == end) return false;
+
+  const auto [ptr, ec] = std::from_chars(begin, end, value);
+  return ec == std::errc() && ptr == end;
+}
+
+float parseField(const char *begin, const char *end) noexcept {
+  auto value = 0.0f;
+  return tryParseField(begin, end, value)
+             ? value
+             : std::numeric_limits<float>::quiet_NaN();
+}
+
+const char *findFieldEnd(const char *begin, const char *end,
+                         const char delimiter) noexcept {
+  while (begin != end && *begin != delimiter) ++begin;
+  return begin;
+}
+
+std::vector<std::string> splitLine(const char *begin, const char *end,
+                                   const char delimiter) {
+  std::vector<std::string> fields;
+
+  for (auto *field_begin = begin;;) {
+    const auto *field_end = findFieldEnd(field_begin, end, delimiter);
+    const auto [trimmed_begin, trimmed_end] = trimField(field_begin, field_end);
+
+    fields.emplace_back(trimmed_begin, trimmed_end);
+    if (field_end == end) break;
+    field_begin = field_end + 1;
+  }
+
+  return fields;
+}
+
+void parseLine(const char *begin, const char *end, const char delimiter,
+               std::vector<std::vector<float>> &columns,
+               const std::size_t row) noexcept {
+  auto *field_begin = begin;
+  auto is_end_of_line = false;
+
+  for (auto &column : columns) {
+    if (is_end_of_line) {
+      column[row] = std::numeric_limits<float>::quiet_NaN();
+      continue;
+    }
+
+    const auto *field_end = findFieldEnd(field_begin, end, delimiter);
+    column[row] = parseField(field_begin, field_end);
+
+    is_end_of_line = field_end == end;
+    field_begin = is_end_of_line ? end : field_end + 1;
+  }
+}
+
+std::vector<Chunk> splitIntoChunks(const char *begin, const char *end,
+                                   const std::size_t num_chunks) {
+  std::vector<Chunk> chunks;
+  const auto size = std::size_t(end - begin);
+
+  auto *chunk_begin = begin;
+  for (std::size_t i = 1u; i <= num_chunks && chunk_begin < end; ++i) {
+    auto *chunk_end = end;
+
+    if (i < num_chunks) {
+      const auto *target = std::max(begin + size * i / num_chunks, chunk_begin);
+      chunk_end = findNextLine(target, end);
+    }
+
+    chunks.push_back({chunk_begin, chunk_end});
+    chunk_begin = chunk_end;
+  }
+
+  return chunks;
+}
+
+/** Runs 'fn(task_index)' for all tasks on 'num_threads' threads and reports
+ * 'progress_bytes' / 'total_bytes' from the calling thread meanwhile. */
+template <class Fn>
+void runParallel(const std::size_t num_threads, const std::size_t num_tasks,
+                 Fn &&fn, const std::atomic<std::size_t> &progress_bytes,
+                 const std::size_t total_bytes,
+                 const std::function<void(double)> &progress_callback) {
+  std::atomic<std::size_t> next_task{0u};
+
+  const auto worker = [&]() {
+    for (auto task = next_task++; task < num_tasks; task = next_task++) {
+      fn(task);
+    }
+  };
+
+  std::vector<std::future<void>> futures;
+  for (std::size_t i = 0u; i < std::min(num_threads, num_tasks); ++i) {
+    futures.push_back(std::async(std::launch::async, worker));
+  }
+
+  for (auto &future : futures) {
+    while (future.wait_for(PROGRESS_INTERVAL) != std::future_status::ready) {
+      if (progress_callback && total_bytes > 0u) {
+        progress_callback(double(progress_bytes.load()) / double(total_bytes));
+      }
+    }
+    future.get();
+  }
+}
+
+}  // namespace
+
+CsvColumns loadCsvColumns(const juce::File &file,
+                          const CsvLoadOptions &options) {
+  if (options.min_chunk_size == 0u) {
+    throw std::invalid_argument("The minimum chunk size must be positive.");
+  }
+
+  if (options.delimiter &&
+      (*options.delimiter == '\n' || *options.delimiter == '\r' ||
+       *options.delimiter == '"')) {
+    throw std::invalid_argument("Invalid delimiter.");
+  }
+
+  CsvColumns csv_columns;
+
+  if (file.existsAsFile() && file.getSize() == 0) return csv_columns;
+
+  const juce::MemoryMappedFile mapped_file(file,
+                                           juce::MemoryMappedFile::readOnly);
+
+  if (mapped_file.getData() == nullptr) {
+    throw std::runtime_error("Could not read: " +
+                             file.getFullPathName().toStdString());
+  }
+
+  const auto *begin = static_cast<const char *>(mapped_file.getData());
+  const auto *end = begin + mapped_file.getSize();
+
+  // Skip the UTF-8 byte order mark.
+  if (end - begin >= 3 && std::memcmp(begin, "\xEF\xBB\xBF", 3) == 0) {
+    begin += 3;
+  }
+
+  // The first non-blank line decides the delimiter, header and the number
+  // of columns.
+  while (begin < end && isBlankLine(begin, findLineEnd(begin, end))) {
+    begin = findNextLine(begin, end);
+  }
+  if (begin >= end) return csv_columns;
+
+  const auto *first_line_end = findLineEnd(begin, end);
+
+  const auto delimiter = options.delimiter.value_or(
+      std::find(begin, first_line_end, '\t') != first_line_end ? '\t' : ',');
+
+  auto first_line_fields = splitLine(begin, first_line_end, delimiter);
+  const auto num_columns = first_line_fields.size();
+
+  const auto has_header = options.has_header.value_or(
+      std::any_of(first_line_fields.begin(), first_line_fields.end(),
+                  [](const std::string &field) {
+                    auto value = 0.0f;
+                    return !field.empty() &&
+                           !tryParseField(field.data(),
+                                          field.data() + field.size(), value);
+                  }));
+
+  if (has_header) {
+    csv_columns.names = std::move(first_line_fields);
+    begin = findNextLine(begin, end);
+  }
+
+  const auto num_threads =
+      options.num_threads > 0u
+          ? options.num_threads
+          : std::max<std::size_t>(std::thread::hardware_concurrency(), 1u);
+
+  const auto total_bytes = std::size_t(end - begin);
+  const auto num_chunks =
+      std::clamp<std::size_t>(total_bytes / options.min_chunk_size, 1u,
+                              num_threads * CHUNKS_PER_THREAD);
+
+  auto chunks = splitIntoChunks(begin, end, num_chunks);
+
+  // Count the rows of each chunk so every thread knows where to write.
+  std::atomic<std::size_t> progress_bytes{0u};
+
+  runParallel(
+      num_threads, chunks.size(),
+      [&chunks](const std::size_t i) {
+        auto &chunk = chunks[i];
+        forEachLine(chunk.begin, chunk.end,
+                    [&chunk](const char *, const char *) { ++chunk.num_rows; });
+      },
+      progress_bytes, total_bytes, {});
+
+  std::size_t num_rows = 0u;
+  for (auto &chunk : chunks) {
+    chunk.first_row = num_rows;
+    num_rows += chunk.num_rows;
+  }
+
+  csv_columns.columns.resize(num_columns);
+  for (auto &column : csv_columns.columns) column.resize(num_rows);
+
+  if (options.progress_callback) options.progress_callback(0.0);
+
+  runParallel(
+      num_threads, chunks.size(),
+      [&](const std::size_t i) {
+        const auto &chunk = chunks[i];
+        auto row = chunk.first_row;
+        auto *batch_begin = chunk.begin;
+
+        forEachLine(chunk.begin, chunk.end,
+                    [&](const char *line_begin, const char *line_end) {
+                      parseLine(line_begin, line_end, delimiter,
+                                csv_columns.columns, row++);
+
+                      if ((row - chunk.first_row) % LINES_PER_PROGRESS_UPDATE ==
+                          0u) {
+                        progress_bytes += std::size_t(line_end - batch_begin);
+                        batch_begin = line_end;
+                      }
+                    });
+
+        progress_bytes += std::size_t(chunk.end - batch_begin);
+      },
+      progress_bytes, total_bytes, options.progress_callback);
+
+  if (options.progress_callback) options.progress_callback(1.0);
+
+  return csv_columns;
+}
+
+}  // namespace cmp
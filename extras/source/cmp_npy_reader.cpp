@@ -0,0 +1,329 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "cmp_npy_reader.hpp"
+
+#include <cstring>
+#include <limits>
+#include <string>
+#include <string_view>
+
+namespace cmp {
+
+namespace {
+
+constexpr std::string_view NPY_MAGIC = "\x93NUMPY";
+
+std::size_t getItemSize(const NpyDataType data_type) noexcept {
+  switch (data_type) {
+    case NpyDataType::float32:
+      return sizeof(float);
+    case NpyDataType::float64:
+      return sizeof(double);
+    case NpyDataType::int16:
+      return sizeof(std::int16_t);
+  }
+
+  return 0u;
+}
+
+std::uint32_t readLittleEndian(const char *data, const std::size_t num_bytes) {
+  std::uint32_t value = 0u;
+  for (std::size_t i = 0u; i < num_bytes; ++i) {
+    value |= std::uint32_t(static_cast<unsigned char>(data[i])) << (8u * i);
+  }
+  return value;
+}
+
+/** Returns the text following "'key':" in the header dictionary. */
+std::string_view findHeaderValue(const std::string_view header,
+                                 const std::string_view key) {
+  const auto key_pos = header.find("'" + std::string(key) + "'");
+  if (key_pos == std::string_view::npos) {
+    throw std::runtime_error("Missing '" + std::string(key) +
+                             "' in the .npy header.");
+  }
+
+  const auto colon_pos = header.find(':', key_pos);
+  if (colon_pos == std::string_view::npos) {
+    throw std::runtime_error("Invalid .npy header.");
+  }
+
+  return header.substr(colon_pos + 1u);
+}
+
+NpyDataType parseDescr(const std::string_view header) {
+  const auto value = findHeaderValue(header, "descr");
+  const auto begin = value.find('\'');
+  const auto end = value.find('\'', begin + 1u);
+  if (begin == std::string_view::npos || end == std::string_view::npos) {
+    throw std::runtime_error("Invalid 'descr' in the .npy header.");
+  }
+
+  const auto descr = value.substr(begin + 1u, end - begin - 1u);
+
+  // Single byte types have no byte order, '|', and '=' is the native order.
+  if (descr.empty() ||
+      (descr[0] == '=' && juce::ByteOrder::isBigEndian()) ||
+      (descr[0] != '<' && descr[0] != '|' && descr[0] != '=')) {
+    throw std::runtime_error("Only little endian .npy files are supported.");
+  }
+
+  const auto type = descr.substr(1u);
+  if (type == "f4") return NpyDataType::float32;
+  if (type == "f8") return NpyDataType::float64;
+  if (type == "i2") return NpyDataType::int16;
+
+  throw std::runtime_error("Unsupported .npy data type: " + std::string(descr));
+}
+
+bool parseFortranOrder(const std::string_view header) {
+  const auto value = findHeaderValue(header, "fortran_order");
+  const auto true_pos = value.find("True");
+  const auto false_pos = value.find("False");
+
+  if (true_pos == std::string_view::npos &&
+      false_pos == std::string_view::npos) {
+    throw std::runtime_error("Invalid 'fortran_order' in the .npy header.");
+  }
+
+  return true_pos < false_pos;
+}
+
+std::vector<std::size_t> parseShape(const std::string_view header) {
+  const auto value = findHeaderValue(header, "shape");
+  const auto begin = value.find('(');
+  const auto end = value.find(')', begin);
+  if (begin == std::string_view::npos || end == std::string_view::npos) {
+    throw std::runtime_error("Invalid 'shape' in the .npy header.");
+  }
+
+  std::vector<std::size_t> shape;
+  std::size_t dim = 0u;
+  bool has_digits = false;
+
+  for (const auto c : value.substr(begin + 1u, end - begin - 1u)) {
+    if (c >= '0' && c <= '9') {
+      const auto digit = std::size_t(c - '0');
+      if (dim > (std::numeric_limits<std::size_t>::max() - digit) / 10u) {
+        throw std::runtime_error("Too large 'shape' in the .npy header.");
+      }
+      dim = dim * 10u + digit;
+      has_digits = true;
+    } else if (c == ',' && has_digits) {
+      shape.push_back(dim);
+      dim = 0u;
+      has_digits = false;
+    }
+  }
+  if (has_digits) shape.push_back(dim);
+
+  // A scalar is stored with the shape ().
+  if (shape.empty()) shape.push_back(1u);
+
+  return shape;
+}
+
+/** Reads element 'index' of the payload, which may be unaligned. */
+template <class ValueType>
+float readAsFloat(const char *payload, const std::size_t index) noexcept {
+  ValueType value;
+  std::memcpy(&value, payload + index * sizeof(ValueType), sizeof(ValueType));
+  return float(value);
+}
+
+/** Calls 'fn' with the element reader of the data type. */
+template <class Fn>
+void visitDataType(const NpyDataType data_type, Fn &&fn) {
+  switch (data_type) {
+    case NpyDataType::float32:
+      fn(readAsFloat<float>);
+      break;
+    case NpyDataType::float64:
+      fn(readAsFloat<double>);
+      break;
+    case NpyDataType::int16:
+      fn(readAsFloat<std::int16_t>);
+      break;
+  }
+}
+
+}  // namespace
+
+NpyArray::NpyArray(const juce::File &file) {
+  mapFile(file);
+
+  const auto *data = static_cast<const char *>(m_mapped_file->getData());
+  const auto size = m_mapped_file->getSize();
+
+  if (size < 10u ||
+      std::string_view(data, NPY_MAGIC.size()) != NPY_MAGIC) {
+    throw std::runtime_error("Not a .npy file: " +
+                             file.getFullPathName().toStdString());
+  }
+
+  // Version 1 stores the header length in two bytes, later versions in four.
+  const auto major_version = static_cast<unsigned char>(data[6]);
+  const auto length_size = major_version == 1u ? 2u : 4u;
+  const auto header_begin = 8u + length_size;
+
+  if (size < header_begin) throw std::runtime_error("Invalid .npy header.");
+
+  const auto header_length = readLittleEndian(data + 8u, length_size);
+  if (size < header_begin + header_length) {
+    throw std::runtime_error("Invalid .npy header.");
+  }
+
+  const auto header = std::string_view(data + header_begin, header_length);
+
+  m_data_type = parseDescr(header);
+  m_fortran_order = parseFortranOrder(header);
+  m_shape = parseShape(header);
+
+  if (m_shape.size() > 2u) {
+    throw std::runtime_error("Only 1-D and 2-D .npy arrays are supported.");
+  }
+
+  try {
+    setPayload(header_begin + header_length);
+  } catch (const std::invalid_argument &e) {
+    throw std::runtime_error(e.what());
+  }
+}
+
+NpyArray::NpyArray(const juce::File &file, const NpyDataType data_type,
+                   const std::vector<std::size_t> &shape,
+                   const bool fortran_order, const std::size_t offset)
+    : m_data_type{data_type}, m_shape{shape}, m_fortran_order{fortran_order} {
+  if (m_shape.empty() || m_shape.size() > 2u) {
+    throw std::invalid_argument("Only 1-D and 2-D arrays are supported.");
+  }
+
+  mapFile(file);
+  setPayload(offset);
+}
+
+void NpyArray::mapFile(const juce::File &file) {
+  m_mapped_file = std::make_unique<juce::MemoryMappedFile>(
+      file, juce::MemoryMappedFile::readOnly);
+
+  if (m_mapped_file->getData() == nullptr) {
+    throw std::runtime_error("Could not read: " +
+                             file.getFullPathName().toStdString());
+  }
+}
+
+void NpyArray::setPayload(const std::size_t offset) {
+  const auto size = m_mapped_file->getSize();
+  if (offset > size) {
+    throw std::invalid_argument("The offset is larger than the file.");
+  }
+
+  // Compared by division, a product of a crafted shape may wrap around.
+  std::size_t num_elements = 1u;
+  for (const auto dim : m_shape) {
+    if (dim != 0u && num_elements > std::numeric_limits<std::size_t>::max() / dim) {
+      throw std::invalid_argument("The array shape is too large.");
+    }
+    num_elements *= dim;
+  }
+
+  if (num_elements > (size - offset) / getItemSize(m_data_type)) {
+    throw std::invalid_argument("The array is larger than the file.");
+  }
+
+  m_payload = static_cast<const char *>(m_mapped_file->getData()) + offset;
+}
+
+NpyDataType NpyArray::getDataType() const noexcept { return m_data_type; }
+
+const std::vector<std::size_t> &NpyArray::getShape() const noexcept {
+  return m_shape;
+}
+
+bool NpyArray::isFortranOrder() const noexcept { return m_fortran_order; }
+
+std::size_t NpyArray::getNumLines() const noexcept {
+  return m_shape.size() == 2u ? m_shape[1] : 1u;
+}
+
+std::size_t NpyArray::getNumPointsPerLine() const noexcept {
+  return m_shape[0];
+}
+
+std::vector<float> NpyArray::getLine(const std::size_t line_index) const {
+  if (line_index >= getNumLines()) {
+    throw std::out_of_range("Line index out of range.");
+  }
+
+  const auto num_points = getNumPointsPerLine();
+  const auto num_lines = getNumLines();
+
+  // A line is contiguous in Fortran order and strided in C order.
+  const auto first = m_fortran_order ? line_index * num_points : line_index;
+  const auto stride = m_fortran_order ? 1u : num_lines;
+
+  std::vector<float> line(num_points);
+
+  visitDataType(m_data_type, [&](const auto read) {
+    for (std::size_t i = 0u; i < num_points; ++i) {
+      line[i] = read(m_payload, first + i * stride);
+    }
+  });
+
+  return line;
+}
+
+std::vector<std::vector<float>> NpyArray::getLines() const {
+  if (m_fortran_order || getNumLines() == 1u) {
+    std::vector<std::vector<float>> lines;
+    lines.reserve(getNumLines());
+
+    for (std::size_t i = 0u; i < getNumLines(); ++i) {
+      lines.push_back(getLine(i));
+    }
+
+    return lines;
+  }
+
+  // Read a C order array row by row to read the payload sequentially.
+  const auto num_points = getNumPointsPerLine();
+  const auto num_lines = getNumLines();
+
+  std::vector<std::vector<float>> lines(num_lines,
+                                        std::vector<float>(num_points));
+
+  visitDataType(m_data_type, [&](const auto read) {
+    for (std::size_t i = 0u; i < num_points; ++i) {
+      for (std::size_t j = 0u; j < num_lines; ++j) {
+        lines[j][i] = read(m_payload, i * num_lines + j);
+      }
+    }
+  });
+
+  return lines;
+}
+
+std::vector<std::span<const float>> NpyArray::getLineViews() const {
+  if (!m_fortran_order && getNumLines() != 1u) {
+    throw std::invalid_argument("The lines are not contiguous.");
+  }
+
+  const auto data = getData<float>();
+  const auto num_points = getNumPointsPerLine();
+
+  std::vector<std::span<const float>> lines;
+  lines.reserve(getNumLines());
+
+  for (std::size_t i = 0u; i < getNumLines(); ++i) {
+    lines.push_back(data.subspan(i * num_points, num_points));
+  }
+
+  return lines;
+}
+
+}  // namespace cmp
@@ -0,0 +1,661 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "cmp_remote_data_source.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "cmp_range_statistics.h"
+
+namespace cmp {
+
+namespace {
+
+/** Timeout of each wait for a request, to check if the server is stopped. */
+constexpr int WAIT_FOR_REQUEST_TIMEOUT_MS = 100;
+
+/** Number of column widths cached per line, i.e. zoom levels. */
+constexpr std::size_t MAX_NUM_GRIDS_PER_LINE = 8u;
+
+/** Column widths within this relative difference share a grid, the width of
+ * a pan with float limits is not exactly the same. */
+constexpr double GRID_WIDTH_TOLERANCE = 1e-4;
+
+constexpr std::size_t REQUEST_HEADER_SIZE = 12u;
+constexpr std::size_t COLUMNS_REQUEST_SIZE = 24u;
+constexpr std::size_t COLUMN_SIZE = 28u;
+constexpr std::size_t LINE_INFO_SIZE = 24u;
+
+constexpr auto NaN = std::numeric_limits<float>::quiet_NaN();
+
+/** Writes little endian values. */
+class Writer {
+ public:
+  explicit Writer(juce::MemoryBlock &block) : m_block{block} {}
+
+  template <class ValueType>
+  Writer &write(const ValueType value) {
+    std::uint64_t bits;
+    if constexpr (sizeof(ValueType) == 4u) {
+      bits = std::bit_cast<std::uint32_t>(value);
+    } else {
+      bits = std::bit_cast<std::uint64_t>(value);
+    }
+
+    unsigned char bytes[sizeof(ValueType)];
+    for (std::size_t i = 0u; i < sizeof(ValueType); ++i) {
+      bytes[i] = static_cast<unsigned char>(bits >> (8u * i));
+    }
+
+    m_block.append(bytes, sizeof(ValueType));
+    return *this;
+  }
+
+ private:
+  juce::MemoryBlock &m_block;
+};
+
+/** Reads little endian values. */
+class Reader {
+ public:
+  explicit Reader(const unsigned char *data) : m_data{data} {}
+
+  template <class ValueType>
+  ValueType read() {
+    std::uint64_t bits = 0u;
+    for (std::size_t i = 0u; i < sizeof(ValueType); ++i) {
+      bits |= std::uint64_t(m_data[i]) << (8u * i);
+    }
+    m_data += sizeof(ValueType);
+
+    if constexpr (sizeof(ValueType) == 4u) {
+      return std::bit_cast<ValueType>(std::uint32_t(bits));
+    } else {
+      return std::bit_cast<ValueType>(bits);
+    }
+  }
+
+ private:
+  const unsigned char *m_data;
+};
+
+bool readExactly(juce::StreamingSocket &socket, void *data,
+                 const std::size_t num_bytes) {
+  return socket.read(data, int(num_bytes), true) == int(num_bytes);
+}
+
+/** Reads without blocking for longer than the request timeout at a time, a
+ * client that stops sending mid-request cannot keep the server from stopping.
+ */
+bool readExactlyWhile(juce::StreamingSocket &socket, void *data,
+                      const std::size_t num_bytes,
+                      const std::atomic<bool> &is_running) {
+  auto *bytes = static_cast<char *>(data);
+  auto num_remaining = int(num_bytes);
+
+  while (num_remaining > 0) {
+    const auto ready = socket.waitUntilReady(true, WAIT_FOR_REQUEST_TIMEOUT_MS);
+    if (ready < 0) return false;
+    if (ready == 0) {
+      if (!is_running) return false;
+      continue;
+    }
+
+    const auto num_read = socket.read(bytes, num_remaining, false);
+    if (num_read <= 0) return false;
+
+    bytes += num_read;
+    num_remaining -= num_read;
+  }
+
+  return true;
+}
+
+bool writeExactly(juce::StreamingSocket &socket,
+                  const juce::MemoryBlock &block) {
+  return socket.write(block.getData(), int(block.getSize())) ==
+         int(block.getSize());
+}
+
+juce::MemoryBlock createStatusResponse(const remote_protocol::Status status) {
+  juce::MemoryBlock response;
+  Writer(response).write(remote_protocol::magic).write(std::uint32_t(status));
+  return response;
+}
+
+void validateLineData(const std::vector<float> &x_data,
+                      const std::vector<float> &y_data) {
+  if (x_data.size() != y_data.size()) {
+    throw std::invalid_argument("The x- and y-data must have the same size.");
+  }
+
+  if (!std::is_sorted(x_data.begin(), x_data.end())) {
+    throw std::invalid_argument("The x-data must be sorted.");
+  }
+}
+
+}  // namespace
+
+/*============================================================================*/
+
+struct RemoteDataServer::Line {
+  std::vector<float> x_data, y_data;
+  RangeStatistics statistics;
+  std::uint64_t generation{0u};
+};
+
+RemoteDataServer::RemoteDataServer() = default;
+
+RemoteDataServer::~RemoteDataServer() { stop(); }
+
+int RemoteDataServer::start(const int port,
+                            const juce::String &local_host_name) {
+  stop();
+
+  m_listener = std::make_unique<juce::StreamingSocket>();
+  if (!m_listener->createListener(port, local_host_name)) {
+    m_listener.reset();
+    throw std::runtime_error("Could not listen on port " +
+                             std::to_string(port) + ".");
+  }
+
+  m_is_running = true;
+  m_accept_thread = std::thread([this] { acceptConnections(); });
+
+  return m_listener->getBoundPort();
+}
+
+void RemoteDataServer::stop() {
+  if (!m_is_running.exchange(false)) return;
+
+  // Wake up the blocking accept with a connection of its own.
+  {
+    juce::StreamingSocket wake_up;
+    wake_up.connect("127.0.0.1", m_listener->getBoundPort(), 100);
+  }
+  m_listener->close();
+  m_accept_thread.join();
+  m_listener.reset();
+
+  // The connection threads exit within one request timeout, also in the
+  // middle of a request.
+  std::vector<std::thread> connection_threads;
+  {
+    const std::lock_guard<std::mutex> lock(m_connections_mutex);
+    connection_threads.swap(m_connection_threads);
+  }
+  for (auto &thread : connection_threads) thread.join();
+}
+
+void RemoteDataServer::setLine(const std::size_t line_index,
+                               std::vector<float> x_data,
+                               std::vector<float> y_data) {
+  validateLineData(x_data, y_data);
+
+  const std::lock_guard<std::mutex> lock(m_lines_mutex);
+
+  while (m_lines.size() <= line_index) {
+    m_lines.push_back(std::make_unique<Line>());
+  }
+
+  auto &line = *m_lines[line_index];
+  line.x_data = std::move(x_data);
+  line.y_data = std::move(y_data);
+  line.statistics = RangeStatistics();
+  line.generation++;
+}
+
+void RemoteDataServer::appendToLine(const std::size_t line_index,
+                                    const std::vector<float> &x_data,
+                                    const std::vector<float> &y_data) {
+  validateLineData(x_data, y_data);
+
+  const std::lock_guard<std::mutex> lock(m_lines_mutex);
+
+  if (line_index >= m_lines.size()) {
+    throw std::invalid_argument("The line does not exist.");
+  }
+
+  auto &line = *m_lines[line_index];
+  if (!x_data.empty() && !line.x_data.empty() &&
+      x_data.front() < line.x_data.back()) {
+    throw std::invalid_argument(
+        "The appended x-data must not be lower than the last x-value.");
+  }
+
+  // The complete blocks of the index stay valid.
+  line.x_data.insert(line.x_data.end(), x_data.begin(), x_data.end());
+  line.y_data.insert(line.y_data.end(), y_data.begin(), y_data.end());
+}
+
+void RemoteDataServer::acceptConnections() {
+  while (m_is_running) {
+    auto socket =
+        std::unique_ptr<juce::StreamingSocket>(m_listener->waitForNextConnection());
+    if (!socket || !m_is_running) continue;
+
+    const std::lock_guard<std::mutex> lock(m_connections_mutex);
+    m_connection_threads.emplace_back(
+        [this, s = socket.release()] { serveConnection(std::unique_ptr<juce::StreamingSocket>(s)); });
+  }
+}
+
+void RemoteDataServer::serveConnection(
+    std::unique_ptr<juce::StreamingSocket> socket) {
+  using namespace remote_protocol;
+
+  while (m_is_running) {
+    unsigned char header[REQUEST_HEADER_SIZE];
+    if (!readExactlyWhile(*socket, header, sizeof(header), m_is_running)) break;
+
+    auto reader = Reader(header);
+    const auto request_magic = reader.read<std::uint32_t>();
+    const auto request_version = reader.read<std::uint32_t>();
+    const auto request_type = RequestType(reader.read<std::uint32_t>());
+
+    // The rest of the stream cannot be parsed after a bad header.
+    if (request_magic != magic || request_version != version) {
+      writeExactly(*socket, createStatusResponse(Status::bad_request));
+      break;
+    }
+
+    juce::MemoryBlock response;
+
+    switch (request_type) {
+      case RequestType::get_info:
+        response = createInfoResponse();
+        break;
+      case RequestType::get_columns: {
+        unsigned char payload[COLUMNS_REQUEST_SIZE];
+        if (!readExactlyWhile(*socket, payload, sizeof(payload), m_is_running))
+          return;
+
+        auto payload_reader = Reader(payload);
+        const auto line_index = payload_reader.read<std::uint32_t>();
+        const auto column_width = payload_reader.read<double>();
+        const auto first_column = payload_reader.read<std::int64_t>();
+        const auto num_columns = payload_reader.read<std::uint32_t>();
+
+        response = createColumnsResponse(line_index, column_width,
+                                         first_column, num_columns);
+        break;
+      }
+      default:
+        writeExactly(*socket, createStatusResponse(Status::bad_request));
+        return;
+    }
+
+    if (!writeExactly(*socket, response)) break;
+  }
+}
+
+juce::MemoryBlock RemoteDataServer::createInfoResponse() {
+  const std::lock_guard<std::mutex> lock(m_lines_mutex);
+
+  juce::MemoryBlock response;
+  auto writer = Writer(response);
+  writer.write(remote_protocol::magic)
+      .write(std::uint32_t(remote_protocol::Status::ok))
+      .write(std::uint32_t(m_lines.size()));
+
+  for (const auto &line : m_lines) {
+    const auto is_empty = line->x_data.empty();
+    writer.write(line->generation)
+        .write(std::uint64_t(line->x_data.size()))
+        .write(is_empty ? NaN : line->x_data.front())
+        .write(is_empty ? NaN : line->x_data.back());
+  }
+
+  return response;
+}
+
+juce::MemoryBlock RemoteDataServer::createColumnsResponse(
+    const std::uint32_t line_index, const double column_width,
+    const std::int64_t first_column, const std::uint32_t num_columns) {
+  using namespace remote_protocol;
+
+  if (!(std::isfinite(column_width) && column_width > 0.0) ||
+      num_columns > max_num_columns) {
+    return createStatusResponse(Status::bad_request);
+  }
+
+  const std::lock_guard<std::mutex> lock(m_lines_mutex);
+
+  if (line_index >= m_lines.size()) {
+    return createStatusResponse(Status::invalid_line);
+  }
+
+  auto &line = *m_lines[line_index];
+  const auto &x_data = line.x_data;
+  const auto &y_data = line.y_data;
+
+  line.statistics.update(y_data);
+
+  juce::MemoryBlock response;
+  response.ensureSize(40u + num_columns * COLUMN_SIZE);
+
+  auto writer = Writer(response);
+  writer.write(magic)
+      .write(std::uint32_t(Status::ok))
+      .write(line.generation)
+      .write(std::uint64_t(x_data.size()))
+      .write(x_data.empty() ? NaN : x_data.back())
+      .write(num_columns);
+
+  // The columns are consecutive, so each search starts at the previous end.
+  auto column_begin = std::lower_bound(x_data.begin(), x_data.end(),
+                                       double(first_column) * column_width);
+
+  for (std::uint32_t c = 0u; c < num_columns; ++c) {
+    const auto x_end = double(first_column + std::int64_t(c) + 1) * column_width;
+    const auto column_end = std::lower_bound(column_begin, x_data.end(), x_end);
+
+    const auto first = std::size_t(std::distance(x_data.begin(), column_begin));
+    const auto last = std::size_t(std::distance(x_data.begin(), column_end));
+
+    if (first == last) {
+      writer.write(std::uint32_t(0u))
+          .write(NaN).write(NaN).write(NaN).write(NaN).write(NaN).write(NaN);
+    } else {
+      const auto statistics = line.statistics.getStatistics(y_data, first, last);
+
+      writer.write(std::uint32_t(last - first))
+          .write(x_data[first])
+          .write(y_data[first])
+          .write(x_data[last - 1u])
+          .write(y_data[last - 1u])
+          .write(statistics ? statistics->min : NaN)
+          .write(statistics ? statistics->max : NaN);
+    }
+
+    column_begin = column_end;
+  }
+
+  return response;
+}
+
+/*============================================================================*/
+
+RemoteDataClient::RemoteDataClient(const juce::String &host_name,
+                                   const int port, const int timeout_ms) {
+  if (!m_socket.connect(host_name, port, timeout_ms)) {
+    throw std::runtime_error("Could not connect to " +
+                             host_name.toStdString() + ":" +
+                             std::to_string(port) + ".");
+  }
+}
+
+std::vector<RemoteLineInfo> RemoteDataClient::getInfo() {
+  juce::MemoryBlock request;
+  Writer(request)
+      .write(remote_protocol::magic)
+      .write(remote_protocol::version)
+      .write(std::uint32_t(remote_protocol::RequestType::get_info));
+  send(request);
+
+  unsigned char header[12];
+  receive(header, 8u);
+
+  auto reader = Reader(header);
+  if (reader.read<std::uint32_t>() != remote_protocol::magic ||
+      reader.read<std::uint32_t>() != std::uint32_t(remote_protocol::Status::ok)) {
+    throw std::runtime_error("Invalid response from the server.");
+  }
+
+  receive(header, 4u);
+  const auto num_lines = Reader(header).read<std::uint32_t>();
+
+  std::vector<unsigned char> payload(num_lines * LINE_INFO_SIZE);
+  receive(payload.data(), payload.size());
+
+  std::vector<RemoteLineInfo> info(num_lines);
+  auto payload_reader = Reader(payload.data());
+  for (auto &line_info : info) {
+    line_info.generation = payload_reader.read<std::uint64_t>();
+    line_info.num_samples = payload_reader.read<std::uint64_t>();
+    line_info.x_min = payload_reader.read<float>();
+    line_info.x_max = payload_reader.read<float>();
+  }
+
+  return info;
+}
+
+std::vector<RemoteColumn> RemoteDataClient::getColumns(
+    const std::size_t line_index, const std::pair<float, float> x_lim,
+    const std::size_t num_columns) {
+  const auto [x_min, x_max] = x_lim;
+  if (num_columns == 0u || num_columns > remote_protocol::max_num_columns ||
+      !(x_max > x_min) || !std::isfinite(x_max - x_min)) {
+    throw std::invalid_argument("Invalid x-range or number of columns.");
+  }
+
+  if (m_line_caches.size() <= line_index) m_line_caches.resize(line_index + 1u);
+  auto &line_cache = m_line_caches[line_index];
+
+  auto column_width = (double(x_max) - double(x_min)) / double(num_columns);
+
+  // Reuse the grid of a previous request at the same zoom level, the most
+  // recently used grid is kept last.
+  auto &grids = line_cache.grids;
+  auto grid_it = std::find_if(grids.begin(), grids.end(), [&](const auto &grid) {
+    return std::abs(grid.column_width - column_width) <=
+           column_width * GRID_WIDTH_TOLERANCE;
+  });
+
+  if (grid_it != grids.end()) {
+    std::rotate(grid_it, grid_it + 1, grids.end());
+  } else {
+    if (grids.size() >= MAX_NUM_GRIDS_PER_LINE) {
+      m_num_cached_columns -= grids.front().columns.size();
+      grids.erase(grids.begin());
+    }
+    grids.push_back({column_width, {}});
+  }
+  column_width = grids.back().column_width;
+
+  const auto first_column = std::int64_t(std::floor(double(x_min) / column_width));
+  const auto end_column = std::max(
+      std::int64_t(std::ceil(double(x_max) / column_width)), first_column + 1);
+
+  if (m_num_cached_columns + std::size_t(end_column - first_column) >
+      max_num_cached_columns) {
+    clearCache();
+  }
+
+  // Request the missing columns, or nothing to check the generation. Once
+  // more if the generation has changed and the cached columns are dropped.
+  for (;;) {
+    const auto &cached_columns = grids.back().columns;
+    auto missing_first = first_column;
+    while (missing_first < end_column && cached_columns.count(missing_first)) {
+      ++missing_first;
+    }
+
+    auto missing_end = end_column;
+    while (missing_end > missing_first &&
+           cached_columns.count(missing_end - 1)) {
+      --missing_end;
+    }
+
+    const auto generation = line_cache.generation;
+    requestColumns(line_index, column_width, missing_first,
+                   std::uint32_t(missing_end - missing_first));
+
+    if (line_cache.generation == generation) break;
+    if (missing_first == first_column && missing_end == end_column) break;
+  }
+
+  std::vector<RemoteColumn> columns;
+  columns.reserve(std::size_t(end_column - first_column));
+
+  const auto &cached_columns = grids.back().columns;
+  for (auto c = first_column; c < end_column; ++c) {
+    if (const auto it = cached_columns.find(c); it != cached_columns.end()) {
+      columns.push_back(it->second);
+    } else {
+      columns.push_back(m_last_columns[std::size_t(c - m_last_first_column)]);
+    }
+  }
+
+  return columns;
+}
+
+void RemoteDataClient::requestColumns(const std::size_t line_index,
+                                      const double column_width,
+                                      const std::int64_t first_column,
+                                      const std::uint32_t num_columns) {
+  juce::MemoryBlock request;
+  Writer(request)
+      .write(remote_protocol::magic)
+      .write(remote_protocol::version)
+      .write(std::uint32_t(remote_protocol::RequestType::get_columns))
+      .write(std::uint32_t(line_index))
+      .write(column_width)
+      .write(first_column)
+      .write(num_columns);
+  send(request);
+
+  unsigned char header[32];
+  receive(header, 8u);
+
+  auto reader = Reader(header);
+  if (reader.read<std::uint32_t>() != remote_protocol::magic) {
+    throw std::runtime_error("Invalid response from the server.");
+  }
+
+  switch (remote_protocol::Status(reader.read<std::uint32_t>())) {
+    case remote_protocol::Status::ok:
+      break;
+    case remote_protocol::Status::invalid_line:
+      throw std::invalid_argument("The line does not exist on the server.");
+    default:
+      throw std::runtime_error("The server rejected the request.");
+  }
+
+  receive(header, 24u);
+  reader = Reader(header);
+  const auto generation = reader.read<std::uint64_t>();
+  reader.read<std::uint64_t>();  // num_samples
+  const auto x_max = reader.read<float>();
+  if (reader.read<std::uint32_t>() != num_columns) {
+    throw std::runtime_error("Invalid response from the server.");
+  }
+
+  std::vector<unsigned char> payload(std::size_t(num_columns) * COLUMN_SIZE);
+  receive(payload.data(), payload.size());
+
+  auto &line_cache = m_line_caches[line_index];
+  updateLineCache(line_cache, generation);
+
+  m_last_first_column = first_column;
+  m_last_columns.resize(num_columns);
+
+  auto &cached_columns = line_cache.grids.back().columns;
+  auto payload_reader = Reader(payload.data());
+
+  for (std::uint32_t c = 0u; c < num_columns; ++c) {
+    auto &column = m_last_columns[c];
+    const auto column_index = first_column + std::int64_t(c);
+
+    column.x_start = float(double(column_index) * column_width);
+    column.x_end = float(double(column_index + 1) * column_width);
+    column.num_samples = payload_reader.read<std::uint32_t>();
+    column.first_x = payload_reader.read<float>();
+    column.first_y = payload_reader.read<float>();
+    column.last_x = payload_reader.read<float>();
+    column.last_y = payload_reader.read<float>();
+    column.min_y = payload_reader.read<float>();
+    column.max_y = payload_reader.read<float>();
+
+    // Only complete columns are cached, samples appended later to the line
+    // cannot end up in a column before its last x-value.
+    if (double(column_index + 1) * column_width <= double(x_max)) {
+      if (cached_columns.insert_or_assign(column_index, column).second)
+        m_num_cached_columns++;
+    }
+  }
+
+  m_num_received_columns += num_columns;
+}
+
+void RemoteDataClient::updateLineCache(LineCache &line_cache,
+                                       const std::uint64_t generation) {
+  if (line_cache.generation != generation) {
+    for (auto &grid : line_cache.grids) {
+      m_num_cached_columns -= grid.columns.size();
+      grid.columns.clear();
+    }
+  }
+
+  line_cache.generation = generation;
+}
+
+void RemoteDataClient::clearCache() noexcept {
+  for (auto &line_cache : m_line_caches) {
+    for (auto &grid : line_cache.grids) grid.columns.clear();
+  }
+
+  m_num_cached_columns = 0u;
+}
+
+std::size_t RemoteDataClient::getNumReceivedColumns() const noexcept {
+  return m_num_received_columns;
+}
+
+std::pair<std::vector<float>, std::vector<float>> RemoteDataClient::toXYData(
+    const std::vector<RemoteColumn> &columns) {
+  std::vector<float> x_data, y_data;
+  x_data.reserve(columns.size() * 4u);
+  y_data.reserve(columns.size() * 4u);
+
+  const auto add = [&](const float x, const float y) {
+    x_data.push_back(x);
+    y_data.push_back(y);
+  };
+
+  for (const auto &column : columns) {
+    if (column.num_samples == 0u) continue;
+
+    add(column.first_x, column.first_y);
+    if (column.num_samples == 1u) continue;
+
+    // The min and max are drawn between the first and last sample, closest to
+    // the first sample first.
+    if (!std::isnan(column.min_y)) {
+      const auto x = std::clamp((column.x_start + column.x_end) / 2.0f,
+                                column.first_x, column.last_x);
+      const auto is_min_first = std::abs(column.first_y - column.min_y) <
+                                std::abs(column.first_y - column.max_y);
+
+      add(x, is_min_first ? column.min_y : column.max_y);
+      add(x, is_min_first ? column.max_y : column.min_y);
+    }
+
+    add(column.last_x, column.last_y);
+  }
+
+  return {x_data, y_data};
+}
+
+void RemoteDataClient::send(const juce::MemoryBlock &request) {
+  if (!writeExactly(m_socket, request)) {
+    throw std::runtime_error("Could not send the request to the server.");
+  }
+}
+
+void RemoteDataClient::receive(void *data, const std::size_t num_bytes) {
+  if (!readExactly(m_socket, data, num_bytes)) {
+    throw std::runtime_error("Could not receive the response from the server.");
+  }
+}
+
+}  // namespace cmp
@@ -0,0 +1,431 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "cmp_shm_ring_buffer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+
+#if !JUCE_WINDOWS
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cmp {
+
+namespace {
+
+constexpr std::size_t DATA_OFFSET = sizeof(ShmRingBufferHeader);
+
+std::string getShmName(const std::string &name) {
+  if (name.empty()) throw std::invalid_argument("The name is empty.");
+  return name.front() == '/' ? name : "/" + name;
+}
+
+std::size_t getSampleSizeOf(const ShmDataType data_type) {
+  switch (data_type) {
+    case ShmDataType::float32:
+      return sizeof(float);
+    case ShmDataType::float64:
+      return sizeof(double);
+    case ShmDataType::int16:
+      return sizeof(std::int16_t);
+    default:
+      throw std::runtime_error("Unsupported data type.");
+  }
+}
+
+/** Copies the frames [first, last) of a channel to 'destination'. */
+template <class ValueType>
+void copyChannel(const ValueType *data, const std::uint64_t capacity,
+                 const std::size_t num_channels, const std::size_t channel,
+                 const std::uint64_t first, const std::uint64_t last,
+                 float *destination) noexcept {
+  for (auto frame = first; frame < last; ++frame) {
+    *destination++ =
+        float(data[std::size_t(frame % capacity) * num_channels + channel]);
+  }
+}
+
+}  // namespace
+
+/*============================================================================*/
+
+ShmRingBuffer::~ShmRingBuffer() {
+#if !JUCE_WINDOWS
+  if (m_mapping) munmap(m_mapping, m_mapping_size);
+  if (m_file_descriptor >= 0) close(m_file_descriptor);
+#endif
+}
+
+const std::string &ShmRingBuffer::getName() const noexcept { return m_name; }
+
+ShmDataType ShmRingBuffer::getDataType() const noexcept {
+  return m_header->data_type;
+}
+
+std::size_t ShmRingBuffer::getNumChannels() const noexcept {
+  return std::size_t(m_header->num_channels);
+}
+
+std::size_t ShmRingBuffer::getCapacity() const noexcept {
+  return std::size_t(m_header->capacity);
+}
+
+std::uint64_t ShmRingBuffer::getWriteIndex() const noexcept {
+  return m_header->write_index.load(std::memory_order_acquire);
+}
+
+std::size_t ShmRingBuffer::getSampleSize() const noexcept {
+  return getSampleSizeOf(m_header->data_type);
+}
+
+char *ShmRingBuffer::getSlot(const std::uint64_t frame_index) const noexcept {
+  return static_cast<char *>(m_mapping) + m_header->data_offset +
+         std::size_t(frame_index % m_header->capacity) * getNumChannels() *
+             getSampleSize();
+}
+
+void ShmRingBuffer::map(const bool is_writable) {
+#if JUCE_WINDOWS
+  juce::ignoreUnused(is_writable);
+  throw std::runtime_error(
+      "Shared memory ring buffers are only supported on POSIX systems.");
+#else
+  m_mapping = mmap(nullptr, m_mapping_size,
+                   is_writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED,
+                   m_file_descriptor, 0);
+
+  if (m_mapping == MAP_FAILED) {
+    m_mapping = nullptr;
+    throw std::runtime_error("Could not map " + m_name + ".");
+  }
+
+  m_header = static_cast<ShmRingBufferHeader *>(m_mapping);
+#endif
+}
+
+/*============================================================================*/
+
+ShmRingBufferWriter::ShmRingBufferWriter(const std::string &name,
+                                         const ShmDataType data_type,
+                                         const std::size_t num_channels,
+                                         const std::size_t capacity) {
+  if (num_channels == 0u || capacity == 0u ||
+      num_channels > std::numeric_limits<std::uint32_t>::max()) {
+    throw std::invalid_argument("Invalid number of channels or capacity.");
+  }
+
+  m_name = getShmName(name);
+  m_mapping_size =
+      DATA_OFFSET + capacity * num_channels * getSampleSizeOf(data_type);
+
+#if !JUCE_WINDOWS
+  // A buffer left behind by a previous producer is replaced.
+  shm_unlink(m_name.c_str());
+  m_file_descriptor =
+      shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+
+  if (m_file_descriptor < 0 ||
+      ftruncate(m_file_descriptor, off_t(m_mapping_size)) != 0) {
+    shm_unlink(m_name.c_str());
+    throw std::runtime_error("Could not create " + m_name + ".");
+  }
+#endif
+
+  map(true);
+
+  m_header = new (m_mapping) ShmRingBufferHeader{};
+  m_header->version = ShmRingBufferHeader::version_value;
+  m_header->data_type = data_type;
+  m_header->num_channels = std::uint32_t(num_channels);
+  m_header->capacity = capacity;
+  m_header->data_offset = DATA_OFFSET;
+  m_header->reserve_index.store(0u, std::memory_order_relaxed);
+  m_header->write_index.store(0u, std::memory_order_relaxed);
+
+  // A reader attaching before this point rejects the header.
+  std::atomic_thread_fence(std::memory_order_release);
+  m_header->magic = ShmRingBufferHeader::magic_value;
+}
+
+ShmRingBufferWriter::~ShmRingBufferWriter() {
+#if !JUCE_WINDOWS
+  shm_unlink(m_name.c_str());
+#endif
+}
+
+void ShmRingBufferWriter::writeFrames(const void *frames,
+                                      std::size_t num_frames) {
+  const auto capacity = m_header->capacity;
+  const auto frame_size = getNumChannels() * getSampleSize();
+  const auto *source = static_cast<const char *>(frames);
+
+  const auto write_index = m_header->write_index.load(std::memory_order_relaxed);
+  const auto end_index = write_index + num_frames;
+
+  // Only the last frames fit, the others count as written and overwritten.
+  if (num_frames > capacity) {
+    source += (num_frames - capacity) * frame_size;
+    num_frames = std::size_t(capacity);
+  }
+
+  m_header->reserve_index.store(end_index, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  // At most two copies, before and after the wrap around.
+  auto frame_index = end_index - num_frames;
+  while (num_frames > 0u) {
+    const auto num_until_wrap =
+        std::size_t(capacity - frame_index % capacity);
+    const auto num_copied = std::min(num_frames, num_until_wrap);
+
+    std::memcpy(getSlot(frame_index), source, num_copied * frame_size);
+
+    source += num_copied * frame_size;
+    frame_index += num_copied;
+    num_frames -= num_copied;
+  }
+
+  m_header->write_index.store(end_index, std::memory_order_release);
+}
+
+/*============================================================================*/
+
+ShmChannelWindows::ShmChannelWindows(const std::size_t num_channels,
+                                     const std::size_t size)
+    : m_size{size},
+      m_samples(num_channels,
+                std::vector<float>(2u * size,
+                                   std::numeric_limits<float>::quiet_NaN())) {
+  if (num_channels == 0u || size == 0u) {
+    throw std::invalid_argument("Invalid number of channels or size.");
+  }
+}
+
+std::size_t ShmChannelWindows::getNumChannels() const noexcept {
+  return m_samples.size();
+}
+
+std::size_t ShmChannelWindows::getSize() const noexcept { return m_size; }
+
+std::span<const float> ShmChannelWindows::getWindow(
+    const std::size_t channel) const noexcept {
+  return {m_samples[channel].data() + m_oldest, m_size};
+}
+
+void ShmChannelWindows::advance(const std::size_t num_samples) noexcept {
+  m_oldest = (m_oldest + num_samples) % m_size;
+}
+
+/*============================================================================*/
+
+ShmRingBufferReader::ShmRingBufferReader(const std::string &name) {
+  m_name = getShmName(name);
+
+#if !JUCE_WINDOWS
+  m_file_descriptor = shm_open(m_name.c_str(), O_RDONLY, 0);
+
+  struct stat file_status {};
+  if (m_file_descriptor < 0 || fstat(m_file_descriptor, &file_status) != 0) {
+    throw std::runtime_error("Could not open " + m_name + ".");
+  }
+
+  m_mapping_size = std::size_t(file_status.st_size);
+#endif
+
+  if (m_mapping_size < DATA_OFFSET) {
+    throw std::runtime_error("The header of " + m_name + " is invalid.");
+  }
+
+  map(false);
+
+  const auto &header = *m_header;
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  if (header.magic != ShmRingBufferHeader::magic_value ||
+      header.version != ShmRingBufferHeader::version_value ||
+      header.data_type > ShmDataType::int16 || header.num_channels == 0u ||
+      header.capacity == 0u || header.data_offset != DATA_OFFSET ||
+      m_mapping_size < DATA_OFFSET + header.capacity * header.num_channels *
+                                         getSampleSize()) {
+    throw std::runtime_error("The header of " + m_name + " is invalid.");
+  }
+
+  m_read_index = getWriteIndex();
+}
+
+ShmRingBufferReader::NewFrames ShmRingBufferReader::getNewFrames(
+    const std::size_t window_size) {
+  const auto write_index = getWriteIndex();
+
+  // The producer has been restarted.
+  if (write_index < m_read_index) m_read_index = write_index;
+
+  const auto capacity = m_header->capacity;
+  const auto num_new_frames = write_index - m_read_index;
+
+  // Frames older than the capacity are already overwritten.
+  auto first_valid = m_read_index;
+  if (num_new_frames > capacity) {
+    m_num_dropped_frames += num_new_frames - capacity;
+    first_valid = write_index - capacity;
+  }
+
+  // Only the frames that fit in the windows are read.
+  const auto num_read = std::min<std::uint64_t>(num_new_frames, window_size);
+  const auto first_read = write_index - num_read;
+
+  return {num_new_frames, first_read, std::max(first_read, first_valid),
+          write_index};
+}
+
+void ShmRingBufferReader::convertFrames(const std::size_t channel,
+                                        const std::uint64_t first,
+                                        const std::uint64_t last,
+                                        float *destination) const noexcept {
+  const auto capacity = m_header->capacity;
+  const auto num_channels = getNumChannels();
+  const auto *data = static_cast<const char *>(m_mapping) + DATA_OFFSET;
+
+  switch (m_header->data_type) {
+    case ShmDataType::float32:
+      copyChannel(reinterpret_cast<const float *>(data), capacity,
+                  num_channels, channel, first, last, destination);
+      break;
+    case ShmDataType::float64:
+      copyChannel(reinterpret_cast<const double *>(data), capacity,
+                  num_channels, channel, first, last, destination);
+      break;
+    case ShmDataType::int16:
+      copyChannel(reinterpret_cast<const std::int16_t *>(data), capacity,
+                  num_channels, channel, first, last, destination);
+      break;
+    default:
+      break;
+  }
+}
+
+std::uint64_t ShmRingBufferReader::getNumTornFrames(
+    const NewFrames &new_frames) {
+  // Frames that the producer may have overwritten during the copy are
+  // discarded.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  const auto reserve_index =
+      m_header->reserve_index.load(std::memory_order_relaxed);
+  const auto capacity = m_header->capacity;
+
+  m_read_index = new_frames.last;
+
+  if (reserve_index <= capacity ||
+      reserve_index - capacity <= new_frames.first_copied) {
+    return 0u;
+  }
+
+  const auto num_torn = std::min(reserve_index - capacity, new_frames.last) -
+                        new_frames.first_copied;
+  m_num_dropped_frames += num_torn;
+
+  return num_torn;
+}
+
+std::size_t ShmRingBufferReader::readNewFrames(
+    std::vector<std::vector<float>> &windows) {
+  const auto num_channels = getNumChannels();
+
+  if (windows.size() != num_channels ||
+      std::any_of(windows.begin(), windows.end(), [&](const auto &window) {
+        return window.size() != windows.front().size();
+      })) {
+    throw std::invalid_argument("One window per channel of the same size.");
+  }
+
+  const auto window_size = windows.front().size();
+  const auto new_frames = getNewFrames(window_size);
+  if (new_frames.num_new == 0u) return 0u;
+
+  const auto num_shifted = std::size_t(new_frames.last - new_frames.first_read);
+  const auto nan_offset = window_size - num_shifted;
+  const auto copy_offset =
+      nan_offset + std::size_t(new_frames.first_copied - new_frames.first_read);
+
+  constexpr auto NaN = std::numeric_limits<float>::quiet_NaN();
+
+  for (std::size_t c = 0u; c < num_channels; ++c) {
+    auto &window = windows[c];
+    std::move(window.begin() + std::ptrdiff_t(num_shifted), window.end(),
+              window.begin());
+    std::fill(window.begin() + std::ptrdiff_t(nan_offset),
+              window.begin() + std::ptrdiff_t(copy_offset), NaN);
+    convertFrames(c, new_frames.first_copied, new_frames.last,
+                  window.data() + copy_offset);
+  }
+
+  if (const auto num_torn = getNumTornFrames(new_frames)) {
+    for (auto &window : windows) {
+      std::fill_n(window.begin() + std::ptrdiff_t(copy_offset),
+                  std::size_t(num_torn), NaN);
+    }
+  }
+
+  return std::size_t(new_frames.num_new);
+}
+
+std::size_t ShmRingBufferReader::readNewFrames(ShmChannelWindows &windows) {
+  const auto num_channels = getNumChannels();
+
+  if (windows.getNumChannels() != num_channels) {
+    throw std::invalid_argument("One window per channel.");
+  }
+
+  const auto window_size = windows.getSize();
+  const auto new_frames = getNewFrames(window_size);
+  if (new_frames.num_new == 0u) return 0u;
+
+  const auto num_read = std::size_t(new_frames.last - new_frames.first_read);
+  const auto num_missing =
+      std::size_t(new_frames.first_copied - new_frames.first_read);
+
+  constexpr auto NaN = std::numeric_limits<float>::quiet_NaN();
+
+  for (std::size_t c = 0u; c < num_channels; ++c) {
+    windows.writeSamples(c, 0u, num_missing, [&](float *destination,
+                                                 std::size_t, std::size_t n) {
+      std::fill_n(destination, n, NaN);
+    });
+    windows.writeSamples(
+        c, num_missing, num_read - num_missing,
+        [&](float *destination, std::size_t offset, std::size_t n) {
+          const auto first = new_frames.first_read + offset;
+          convertFrames(c, first, first + n, destination);
+        });
+  }
+
+  if (const auto num_torn = getNumTornFrames(new_frames)) {
+    for (std::size_t c = 0u; c < num_channels; ++c) {
+      windows.writeSamples(c, num_missing, std::size_t(num_torn),
+                           [&](float *destination, std::size_t, std::size_t n) {
+                             std::fill_n(destination, n, NaN);
+                           });
+    }
+  }
+
+  windows.advance(num_read);
+
+  return std::size_t(new_frames.num_new);
+}
+
+std::uint64_t ShmRingBufferReader::getNumDroppedFrames() const noexcept {
+  return m_num_dropped_frames;
+}
+
+}  // namespace cmp
@@ -7,6 +7,9 @@
 
 #pragma once
 
+#include <array>
+#include <limits>
+#include <span>
 #include <vector>
 #ifdef __cpp_constexpr
 #if __cpp_constexpr >= 201907L
@@ -43,6 +46,7 @@ class PlotLabel;
 class Legend;
 class Trace;
 class GraphArea;
+class Heatmap;
 class PlotLookAndFeel;
 template <typename T>
 class Observable;
@@ -114,6 +118,7 @@ enum class UserInput : uint64_t {
   double_click = 1UL << 19,
   scroll_up = 1UL << 20,
   scroll_down = 1UL << 21,
+  move = 1UL << 22,
 
   // Keyboard button
   shift = 1ULL << 32,
@@ -125,6 +130,7 @@ enum class UserInput : uint64_t {
   legend = 1ULL << 47,
   tracepoint = 1ULL << 48,
   trace_label = 1ULL << 49,
+  measurement_cursor = 1ULL << 50,
 
 };
 
@@ -151,6 +157,8 @@ enum class UserInputAction : uint32_t {
   zoom_in,            /** Zoom in. */
   zoom_out,           /** Zoom out. */
   zoom_reset,         /** Reset the zoom. */
+  zoom_back,          /** Go back to the previous view in the zoom history. */
+  zoom_forward,       /** Go forward to the next view in the zoom history. */
 
   /** Selection area related actions. */
   select_area_start, /** Set start positon for selected area. */
@@ -166,6 +174,12 @@ enum class UserInputAction : uint32_t {
   /** Panning */
   panning, /** Panning. */
 
+  /** Crosshair related actions. */
+  move_crosshair, /** Move the crosshair to the mouse. */
+
+  /** Measurement cursor related actions. */
+  move_measurement_cursor, /** Move a measurement cursor to the mouse. */
+
   /** No action */
   none /** No action. */
 };
@@ -214,6 +228,68 @@ enum class GraphLineType : uint32_t {
   vertical,
 };
 
+/** Enum to define where the steps of a step (staircase) graph line are. */
+enum class StepType : uint32_t {
+  /** The y-value of a point is used from the previous point, i.e. the step is
+     at the previous x-value. */
+  pre,
+  /** The y-value of a point is used until the next point, i.e. the step is at
+     the next x-value. */
+  post,
+  /** The step is halfway between two points. */
+  mid,
+};
+
+/** Enum to define how the bars of a bar graph line are drawn. */
+enum class BarType : uint32_t {
+  /** A filled bar from the baseline to each point. */
+  bar,
+  /** A one pixel wide stem from the baseline to each point, use
+     GraphAttribute::marker to draw a head. */
+  stem,
+};
+
+/** Enum to define how the cells of a heatmap are combined when zoomed out. */
+enum class HeatmapReduction : uint32_t {
+  /** The mean of the combined cells. */
+  mean,
+  /** The smallest of the combined cells. */
+  min,
+  /** The largest of the combined cells, e.g. to keep the peaks of a
+     spectrogram. */
+  max,
+};
+
+/** @brief A struct that defines the bars of a bar or stem graph line. */
+struct BarAttribute {
+  /** Bar or stem. */
+  BarType type{BarType::bar};
+
+  /** Width of a bar in x-data units, not used by stems. */
+  float width{0.8f};
+
+  /** The y-value where the bars start. */
+  float baseline{0.0f};
+};
+
+/** @brief A struct that defines the error bars of a graph line, one error per
+ * sample in the order of the y-data. The errors are distances from the value
+ * and an empty vector means no error bars in that direction. */
+struct ErrorBars {
+  /** The error below each y-value. */
+  std::vector<float> y_lower;
+
+  /** The error above each y-value, the same as 'y_lower' if empty. */
+  std::vector<float> y_upper;
+
+  /** The error to the left of each x-value. */
+  std::vector<float> x_lower;
+
+  /** The error to the right of each x-value, the same as 'x_lower' if
+   * empty. */
+  std::vector<float> x_upper;
+};
+
 /** Enum to define if grid should be drawn or if the grid should be small */
 enum class GridType : uint32_t {
   /** No grid is drawn. */
@@ -423,6 +499,19 @@ struct Marker {
   }
 };
 
+/** Attributes of a heatmap. */
+struct HeatmapAttribute {
+  /** The values mapped to the first and last colour of the colour map, the
+   * min and max of the finite values if not set. */
+  std::optional<Lim_f> value_lim;
+
+  /** Number of colours of the colour map, e.g. 256 or 4096. */
+  std::size_t colour_map_size{256u};
+
+  /** How the cells are combined when there are more cells than pixels. */
+  HeatmapReduction reduction{HeatmapReduction::mean};
+};
+
 /** Attributes of a single graph. */
 struct GraphAttribute {
   /** Colour of the graph_line. */
@@ -452,6 +541,20 @@ struct GraphAttribute {
   /** Creates a vertical linear gradient between top and bottom of the graph
    * area. Only the gradient below the graph line is visible.  */
   std::optional<std::pair<juce::Colour, juce::Colour>> gradient_colours;
+
+  /** The type of marker drawn on the samples that must be kept, set with
+   * Plot::setMustKeepSamples(). */
+  std::optional<cmp::Marker> must_keep_marker;
+
+  /** Draw the graph_line as steps instead of straight lines between the
+   * points. The corners are only added between the plotted pixel points, so
+   * the y-data is not duplicated and is downsampled as a normal graph_line. */
+  std::optional<cmp::StepType> step;
+
+  /** Draw the graph_line as bars or stems from a baseline to each point. The
+   * stems and the bars no wider than a pixel are merged per pixel column, and
+   * all bars of the graph_line are filled in one go. */
+  std::optional<cmp::BarAttribute> bars;
 };
 
 /** @brief A struct that defines between which two graph_lines the area is
@@ -464,7 +567,7 @@ struct GraphSpreadIndex {
 /** @brief A view of the data required to draw a graph_line */
 struct GraphLineDataView {
   GraphLineDataView(const std::vector<float>& _x_data,
-                    const std::vector<float>& _y_data,
+                    std::span<const float> _y_data,
                     const PixelPoints& _pixel_points,
                     const std::vector<std::size_t>& _pixel_point_indices,
                     const GraphAttribute& _graph_attribute);
@@ -475,12 +578,183 @@ struct GraphLineDataView {
                     const std::vector<std::size_t>&&) =
       delete;  // prevents rvalue binding
 
-  const std::vector<float>&x_data, &y_data;
+  const std::vector<float>& x_data;
+  std::span<const float> y_data;
   const PixelPoints& pixel_points;
+
+  /** The data index of each pixel point. Can be empty when an xy-downsampled
+   * graph line is painted, the indices are only kept if the graph line needs
+   * them, e.g. for GraphAttribute::on_pixel_point_paint. */
   const std::vector<std::size_t>& pixel_point_indices;
   const GraphAttribute& graph_attribute;
 };
 
+/** @brief The value of a single graph line at the crosshair. */
+struct CrosshairReadout {
+  /** Index of the graph line. */
+  std::size_t graph_line_index;
+
+  /** The interpolated data value at the x-value of the crosshair. */
+  juce::Point<float> data_value;
+
+  /** The pixel position of 'data_value' relative the graph bounds. */
+  juce::Point<int> pixel_position;
+
+  /** Colour of the graph line. */
+  juce::Colour colour;
+};
+
+/** @brief The statistics of a single graph line between the measurement
+ * cursors. */
+struct MeasurementStatistics {
+  /** Index of the graph line. */
+  std::size_t graph_line_index;
+
+  /** Min, max, mean and RMS of the y-values between the cursors. */
+  float min, max, mean, rms;
+
+  /** Number of samples between the cursors that are not NaN. */
+  std::size_t num_samples;
+
+  /** Colour of the graph line. */
+  juce::Colour colour;
+};
+
+/** The type of a trace derived from a live graph line. */
+enum class DerivedTraceType : uint32_t {
+  max_hold,            /** The max of each sample since the last reset. */
+  min_hold,            /** The min of each sample since the last reset. */
+  exponential_average, /** Exponential moving average of each sample. */
+  average,             /** Average of each sample over the last frames. */
+};
+
+/**
+ * @brief A trace derived from the y-data of a live graph line, e.g. the
+ * max-hold or the average of a spectrum.
+ *
+ * The trace is updated in place every time the y-data of the live line is
+ * updated, and plotted with the x-data of the live line. NaN samples of the
+ * live line are skipped by the holds and the exponential average.
+ */
+struct DerivedTrace {
+  /** The type of the trace. */
+  DerivedTraceType type{DerivedTraceType::max_hold};
+
+  /** Weight of the new frame of an exponential average, between 0 and 1. */
+  float smoothing{0.1f};
+
+  /** Number of frames of an average. */
+  std::size_t num_frames{8u};
+
+  /** Attributes of the trace, the colour of the live line with reduced alpha
+   * is used if the colour is not set. */
+  GraphAttribute graph_attribute;
+};
+
+/** The edge of the signal that triggers. */
+enum class TriggerEdge : uint32_t {
+  rising,  /** The signal crosses the level from below. */
+  falling, /** The signal crosses the level from above. */
+};
+
+/**
+ * @brief A trigger that aligns the graph lines to a level crossing, like an
+ * oscilloscope.
+ *
+ * The trigger is armed when the signal is below 'level - hysteresis' for a
+ * rising edge, or above 'level + hysteresis' for a falling edge, so noise
+ * around the level does not trigger.
+ */
+struct Trigger {
+  /** The edge that triggers. */
+  TriggerEdge edge{TriggerEdge::rising};
+
+  /** The level that the signal crosses. */
+  float level{0.0f};
+
+  /** The distance from the level that arms the trigger, not negative. */
+  float hysteresis{0.0f};
+
+  /** Index of the graph line that is searched, the same index as in
+   * 'y_data'. */
+  std::size_t graph_line_index{0u};
+};
+
+/**
+ * @brief A histogram of latencies in milliseconds.
+ *
+ * The latencies are counted in bins of 'bin_width_ms'. Latencies longer than
+ * the last bin are counted in an overflow bin, the maximum latency is still
+ * stored exactly.
+ */
+struct LatencyHistogram {
+  static constexpr double bin_width_ms = 0.5;
+  static constexpr std::size_t num_bins = 400u;  ///< 0 - 200 ms.
+  static constexpr double range_ms = static_cast<double>(num_bins) * bin_width_ms;
+
+  /** @brief Add a latency in milliseconds.
+   *
+   * NaN and negative latencies are counted as 0 and infinite latencies as the
+   * largest finite latency.
+   */
+  void add(const double latency_ms) noexcept {
+    constexpr auto max_latency_ms = std::numeric_limits<double>::max();
+    const auto ms = latency_ms > 0.0 ? (latency_ms < max_latency_ms ? latency_ms
+                                                                    : max_latency_ms)
+                                     : 0.0;
+    const auto bin = ms < range_ms ? static_cast<std::size_t>(ms / bin_width_ms)
+                                   : num_bins;
+
+    ++counts[bin < num_bins ? bin : num_bins];
+    min_ms = count == 0u || ms < min_ms ? ms : min_ms;
+    max_ms = ms > max_ms ? ms : max_ms;
+    sum_ms += ms;
+    ++count;
+  }
+
+  /** @brief Get the mean latency in milliseconds or 0 if empty. */
+  double getMean() const noexcept {
+    return count == 0u ? 0.0 : sum_ms / static_cast<double>(count);
+  }
+
+  /**
+   * @brief Get the latency at a percentile.
+   *
+   * The upper edge of the bin that contains the percentile is returned,
+   * clamped to the maximum latency.
+   *
+   * @param percentile between 0 and 100.
+   * @return the latency in milliseconds or 0 if empty.
+   */
+  double getPercentile(const double percentile) const noexcept {
+    if (count == 0u) return 0.0;
+
+    const auto p = percentile < 0.0 ? 0.0 : percentile > 100.0 ? 100.0 : percentile;
+    auto rank = static_cast<std::size_t>(p / 100.0 * static_cast<double>(count));
+    rank = rank == 0u ? 1u : rank;
+
+    std::size_t accumulated = 0u;
+    for (std::size_t bin = 0u; bin < num_bins; ++bin) {
+      accumulated += counts[bin];
+      if (accumulated >= rank) {
+        const auto upper_edge = static_cast<double>(bin + 1u) * bin_width_ms;
+        return upper_edge < max_ms ? upper_edge : max_ms;
+      }
+    }
+
+    return max_ms;
+  }
+
+  /** @brief Remove all latencies. */
+  void reset() noexcept { *this = LatencyHistogram(); }
+
+  std::array<std::size_t, num_bins + 1u> counts{};  ///< Last is overflow bin.
+  std::size_t count{0u};
+  double min_ms{0.0};
+  double max_ms{0.0};
+  double sum_ms{0.0};
+};
+
 /**
  * @brief A struct that defines a vector with fast push_back.
  *
@@ -539,7 +813,7 @@ struct fast_vector {
    * @param elem The element to be added to the vector.
    */
   constexpr void push_back_if_not_in_back(const T elem) noexcept {
-    if (vec.back() != elem) vec[index++] = elem;
+    if (index == 0u || vec[index - 1u] != elem) vec[index++] = elem;
   }
 
   fast_vector& operator=(const std::vector<T>& v) {
@@ -64,6 +64,9 @@ class PlotLookAndFeel : public Plot::LookAndFeelMethods {
 
   int getColourFromGraphID(const std::size_t graph_index) const override;
 
+  std::vector<juce::Colour> getHeatmapColourMap(
+      const std::size_t num_colours) const override;
+
   std::size_t getMargin() const noexcept override;
 
   std::size_t getMarginSmall() const noexcept override;
@@ -139,6 +142,44 @@ class PlotLookAndFeel : public Plot::LookAndFeelMethods {
       const juce::Point<int> &end_coordinates,
       const juce::Rectangle<int> &graph_bounds) noexcept override;
 
+  void drawCrosshair(juce::Graphics &g, const juce::Rectangle<int> &graph_bounds,
+                     const float crosshair_x, const float crosshair_x_value,
+                     const std::vector<CrosshairReadout> &readouts) override;
+
+  juce::RectangleList<int> getCrosshairArea(
+      const juce::Rectangle<int> &graph_bounds, const float crosshair_x,
+      const float crosshair_x_value,
+      const std::vector<CrosshairReadout> &readouts) override;
+
+  void drawMeasurementCursors(
+      juce::Graphics &g, const juce::Rectangle<int> &graph_bounds,
+      const std::pair<float, float> cursors_x,
+      const std::vector<MeasurementStatistics> &statistics) override;
+
+  void drawMustKeepMarkers(juce::Graphics &g, const PixelPoints &pixel_points,
+                           const Marker &marker,
+                           const juce::Colour graph_colour) override;
+
+  void drawErrorBars(juce::Graphics &g,
+                     const std::vector<juce::Line<float>> &error_bars,
+                     const juce::Colour graph_colour) override;
+
+  void drawBars(juce::Graphics &g,
+                const juce::RectangleList<float> &bar_rectangles,
+                const GraphLineDataView graph_line_data) override;
+
+  std::vector<juce::Colour> getPersistenceColourMap(
+      const juce::Colour graph_colour,
+      const std::size_t num_colours) const override;
+
+  void drawOverviewGraphLine(juce::Graphics &g,
+                             const std::vector<Lim_f> &column_y_pixels,
+                             const juce::Colour graph_colour) override;
+
+  void drawOverviewWindow(juce::Graphics &g,
+                          const juce::Rectangle<int> &bounds,
+                          const juce::Rectangle<float> &view_window) override;
+
   void updateXPixelPoints(
       const std::vector<std::size_t> &update_only_these_indices,
       const Scaling x_scaling, const Lim<float> x_lim, const juce::Rectangle<int> &graph_bounds,
@@ -149,10 +190,21 @@ class PlotLookAndFeel : public Plot::LookAndFeelMethods {
   void updateYPixelPoints(
       const std::vector<std::size_t> &update_only_these_indices,
       const Scaling y_scaling, const Lim<float> y_lim, const juce::Rectangle<int> &graph_bounds,
-      const std::vector<float> &y_data,
+      std::span<const float> y_data,
       const std::vector<std::size_t> &pixel_points_indices,
       PixelPoints &pixel_points) noexcept override;
 
+  void updateXYDownsampledPixelPoints(
+      const Scaling x_scaling, const Scaling y_scaling,
+      const Lim<float> x_lim, const Lim<float> y_lim,
+      const juce::Rectangle<int> &graph_bounds,
+      const std::vector<float> &x_data, std::span<const float> y_data,
+      const std::optional<Lim<float>> &collapse_y_lim,
+      std::vector<std::size_t> *x_based_indices,
+      std::vector<std::size_t> *pixel_points_indices,
+      std::vector<std::size_t> *collapsed_run_positions,
+      PixelPoints &pixel_points) override;
+
   void updateVerticalGridLineTicksAuto(
       const juce::Rectangle<int> &bounds, const Lim_f &x_lim,
       const Scaling x_scaling, const GridType grid_type,
@@ -12,6 +12,7 @@
 #pragma once
 
 #include <memory>
+#include <span>
 
 #include "cmp_datamodels.h"
 #include "cmp_version.h"
@@ -56,6 +57,12 @@ public:
    */
   void yLim(const float min, const float max);
 
+  /** @brief Get the X-limits of the current view. */
+  Lim_f getXLim() const noexcept;
+
+  /** @brief Get the Y-limits of the current view. */
+  Lim_f getYLim() const noexcept;
+
   /** 
    * @brief Plot y-data or y-data/x-data
    *
@@ -76,6 +83,26 @@ public:
             const std::vector<std::vector<float>> &x_data = {},
             const GraphAttributeList &graph_attribute_list = {});
 
+  /** @brief Plot y-data without copying it
+   *
+   * Same as plot() but the y-data is not copied, it must outlive the plot or
+   * the next call to plot(), plotBorrowed(), plotUpdateYOnly() or
+   * plotUpdateYOnlyBorrowed(). Call it again after changing the y-data in
+   * place. The x-data is copied, or generated if empty. The y-data of a graph
+   * line is still copied if it is smoothed or its points are moved.
+   *
+   * @code
+   * // Plot the float32 columns of a mapped .npy file.
+   * const auto array = cmp::NpyArray(juce::File("signals.npy"));
+   * plot.plotBorrowed(array.getLineViews());
+   * @endcode
+   *
+   * @see plot()
+   */
+  void plotBorrowed(const std::vector<std::span<const float>> &y_data,
+                    const std::vector<std::vector<float>> &x_data = {},
+                    const GraphAttributeList &graph_attribute_list = {});
+
   /** 
    * @brief Draw horizontal line(s)
    *
@@ -109,6 +136,16 @@ public:
    */
   void plotUpdateYOnly(const std::vector<std::vector<float>> &y_data);
 
+  /** @brief Plot, but only update the y-data, without copying it
+   *
+   * Same as plotUpdateYOnly() but the y-data is not copied, see
+   * plotBorrowed() for how long it must live.
+   *
+   * @param y_data spans with the y-values.
+   */
+  void plotUpdateYOnlyBorrowed(
+      const std::vector<std::span<const float>> &y_data);
+
   /** @brief Fill the area between two data lines
    *
    * Steps to use:
@@ -121,6 +158,171 @@ public:
   void fillBetween(const std::vector<GraphSpreadIndex> &graph_spread_indices,
                    const std::vector<juce::Colour> &fill_area_colours = {});
 
+  /** @brief Set the samples that must be kept when downsampling
+   *
+   * The flagged samples are always plotted, e.g. the rare events of a long
+   * signal that would otherwise be lost when zoomed out. The flags are given
+   * per graph line in the order of the y-data and drawn with
+   * GraphAttribute::must_keep_marker if set.
+   *
+   * @param flags one vector per graph line with a flag per sample, true for
+   * the samples that must be kept. An empty vector clears the flags.
+   * @throws std::invalid_argument if there are more vectors than graph lines.
+   */
+  void setMustKeepSamples(const std::vector<std::vector<bool>> &flags);
+
+  /** @brief Set the error bars of the graph lines
+   *
+   * The error bars are downsampled with their graph line. The error bars of
+   * the samples that share a pixel column are merged into one bar spanning
+   * all of their intervals, and all error bars of a graph line are drawn as
+   * one path.
+   *
+   * @code
+   * // Symmetric y-errors of the first graph line.
+   * plot.setErrorBars({{y_errors}});
+   * @endcode
+   *
+   * @param error_bars one cmp::ErrorBars per graph line. An empty
+   * cmp::ErrorBars removes the error bars of that graph line.
+   * @throws std::invalid_argument if there are more error bars than graph
+   * lines or the errors are not one per sample.
+   */
+  void setErrorBars(const std::vector<ErrorBars> &error_bars);
+
+  /** @brief Plot a matrix as a heatmap
+   *
+   * The matrix is drawn as a colour mapped image behind the graph lines. When
+   * zoomed out, the cells are combined with HeatmapAttribute::reduction in a
+   * mip chain, and only the visible part of the matrix is drawn. Replaces the
+   * previous heatmap.
+   *
+   * @code
+   * // A spectrogram with 'num_bins' rows and 'num_frames' columns.
+   * plot.plotHeatmap(std::move(magnitudes_db), num_frames,
+   *                  {0.0f, duration_s}, {0.0f, sample_rate / 2.0f},
+   *                  {.value_lim = cmp::Lim_f(-120.0f, 0.0f)});
+   * @endcode
+   *
+   * @param values the row-major values of the matrix, row 0 is drawn at the
+   * min of the y-extent. NaN is drawn transparent.
+   * @param num_columns the number of columns of the matrix.
+   * @param x_extent the x-values of the left and right edge of the matrix.
+   * @param y_extent the y-values of the bottom and top edge of the matrix.
+   * @param heatmap_attribute the attributes @see HeatmapAttribute
+   * @throws std::invalid_argument if the number of values is not a multiple
+   * of the number of columns or an extent is empty.
+   */
+  void plotHeatmap(std::vector<float> values, const std::size_t num_columns,
+                   const Lim_f &x_extent, const Lim_f &y_extent,
+                   const HeatmapAttribute &heatmap_attribute = {});
+
+  /** @brief Plot a matrix as a heatmap without copying it
+   *
+   * Same as plotHeatmap() but the values are not copied, they must outlive
+   * the plot or the next call to plotHeatmap(), plotHeatmapBorrowed() or
+   * clearHeatmap(). Call it again after changing the values in place, the
+   * values are not copied but the mip chain is rebuilt.
+   *
+   * @see plotHeatmap()
+   */
+  void plotHeatmapBorrowed(std::span<const float> values,
+                           const std::size_t num_columns,
+                           const Lim_f &x_extent, const Lim_f &y_extent,
+                           const HeatmapAttribute &heatmap_attribute = {});
+
+  /** @brief Remove the heatmap. */
+  void clearHeatmap();
+
+  /** @brief Set a trigger to align the graph lines to a level crossing
+   *
+   * Turns the plot into a triggered oscilloscope view. Every time the y-data
+   * is updated, the last level crossing of the trigger line with data for the
+   * whole x-limits around it is searched, and all graph lines are plotted
+   * with the x-value of the crossing at x = 0. The data is not copied, the
+   * graph lines are drawn with an x-offset. Set the x-limits relative the
+   * crossing, e.g. xLim(-100, 900) for 100 samples before it.
+   *
+   * Without a crossing the newest data is shown, see isTriggered().
+   *
+   * @code
+   * // Windows from e.g. cmp::ShmRingBufferReader, twice the plotted length.
+   * plot.setTrigger(cmp::Trigger{cmp::TriggerEdge::rising, 0.0f, 0.05f});
+   * plot.xLim(-100.0f, 900.0f);
+   * plot.plotUpdateYOnly(y_data);
+   * @endcode
+   *
+   * The trigger can be set before plot(), the graph lines are aligned at the
+   * first update of the y-data.
+   *
+   * @param trigger the trigger, or nothing to remove it.
+   * @throws std::range_error if the trigger line index is out of range when
+   * the y-data is updated.
+   */
+  void setTrigger(const std::optional<Trigger> &trigger);
+
+  /** @brief Check if the graph lines were aligned to a level crossing at the
+   * last update of the y-data.
+   *
+   * @return true if a crossing was found.
+   */
+  bool isTriggered() const noexcept;
+
+  /** @brief Set a persistence display like an analog oscilloscope
+   *
+   * Each update of the y-data, e.g. with plotUpdateYOnly(), adds its trace,
+   * also if the repaints are coalesced. The traces of earlier updates fade by
+   * 'decay_per_second' per second of the time between the repaints that show
+   * new traces, so the fade does not depend on the update or frame rate and
+   * the traces that are drawn often glow brighter. The intensities are
+   * coloured by LookAndFeelMethods::getPersistenceColourMap(). The traces are
+   * cleared when the view is changed, e.g. when zooming.
+   *
+   * @param decay_per_second the fraction of the intensity left after a
+   * second, between 0 and 1, or nothing to turn persistence off.
+   * @throws std::invalid_argument if the decay is outside [0, 1).
+   */
+  void setPersistence(const std::optional<float> decay_per_second);
+
+  /** @brief Set fractional octave smoothing of the graph lines
+   *
+   * E.g. 1/3, 1/6 or 1/12 octave smoothing of FFT magnitudes plotted with a
+   * logarithmic x-axis. Each sample is averaged over a window of the given
+   * width in octaves around its x-value, before the y-data is downsampled.
+   * The windows are computed once per x-data and fraction, each update of
+   * the y-data is then smoothed in O(samples). The x-data must be sorted.
+   *
+   * @param octave_fraction the width of the window in octaves, or nothing to
+   * turn smoothing off.
+   * @throws std::invalid_argument if the fraction is not above zero.
+   */
+  void setOctaveSmoothing(const std::optional<float> octave_fraction);
+
+  /** @brief Set traces derived from the y-data of the graph lines
+   *
+   * E.g. the max hold or the average of a spectrum. The derived traces are
+   * updated in place every time the y-data is updated, e.g. with
+   * plotUpdateYOnly(), and drawn behind the graph line. They are downsampled
+   * with the x-indices of their graph line.
+   *
+   * @code
+   * plot.setDerivedTraces({{{cmp::DerivedTraceType::max_hold},
+   *                         {cmp::DerivedTraceType::exponential_average, 0.1f}}});
+   * @endcode
+   *
+   * @param derived_traces one vector of traces per graph line. An empty
+   * vector removes the traces of that graph line.
+   * @throws std::invalid_argument if there are more vectors than graph lines.
+   */
+  void setDerivedTraces(
+      const std::vector<std::vector<DerivedTrace>> &derived_traces);
+
+  /** @brief Start the derived traces over from the next y-data
+   *
+   * E.g. to clear the max hold.
+   */
+  void resetDerivedTraces();
+
   /** @brief Set downsampling type.
    *
    * @see cmp::DownsamplingType for the different types.
@@ -262,6 +464,115 @@ public:
    */
   void setLegend(const std::vector<std::string> &graph_descriptions);
 
+  /** @brief Zoom to a view
+   *
+   *  Same as zooming on a selected area: the view is added to the zoom
+   *  history, while the limits set with xLim() and yLim() are kept as the
+   *  view to reset the zoom to.
+   *
+   *  @param x_lim the x-limits of the view.
+   *  @param y_lim the y-limits of the view.
+   */
+  void zoomTo(const Lim_f &x_lim, const Lim_f &y_lim);
+
+  /** @brief Go back to the previous view in the zoom history
+   *
+   *  Zooming in on a selected area and resetting the zoom adds the new view
+   *  to the zoom history. The pixel points and the grid of recently seen views
+   *  are cached, so going back to a view does not recompute them unless the
+   *  data has changed.
+   *
+   *  @return true if there was a previous view.
+   */
+  bool zoomBack();
+
+  /** @brief Go forward to the next view in the zoom history
+   *
+   *  @see zoomBack.
+   *
+   *  @return true if there was a next view.
+   */
+  bool zoomForward();
+
+  /** @brief Enable or disable the crosshair
+   *
+   *  The crosshair follows the mouse over the graph area and shows the value
+   *  of every graph line at the x-position of the mouse. The values are
+   *  resolved for all graph lines in one batch and drawn in a single overlay
+   *  paint.
+   *
+   *  @param crosshair_enabled true to show the crosshair.
+   *  @return void.
+   */
+  void setCrosshairEnabled(const bool crosshair_enabled);
+
+  /** @brief Get the value of every graph line at a x-value
+   *
+   *  The y-values are interpolated between the two closest data points if the
+   *  x-data of the graph line is sorted. Graph lines without a value at
+   *  'x_value' are left out.
+   *
+   *  @param x_value the x-value.
+   *  @return the readouts of the graph lines.
+   */
+  std::vector<CrosshairReadout> getCrosshairReadouts(const float x_value) const;
+
+  /** @brief Set the two measurement cursors
+   *
+   *  The measurement cursors are two vertical lines that can be moved by
+   *  dragging them. The min, max, mean, RMS and number of samples between the
+   *  cursors are shown for every graph line and updated while dragging. The
+   *  statistics are resolved from an index of each graph line, so the cost
+   *  does not depend on the number of samples between the cursors.
+   *
+   *  @param x_start the x-value of the first cursor.
+   *  @param x_end the x-value of the second cursor.
+   *  @return void.
+   */
+  void setMeasurementCursors(const float x_start, const float x_end);
+
+  /** @brief Remove the measurement cursors.
+   *  @return void.
+   */
+  void removeMeasurementCursors();
+
+  /** @brief Get the x-values of the measurement cursors
+   *
+   *  @return the x-values of the first and second cursor, or nothing if the
+   *  measurement cursors are not set.
+   */
+  std::optional<std::pair<float, float>> getMeasurementCursors() const noexcept;
+
+  /** @brief Get the statistics of every graph line between the measurement
+   *  cursors
+   *
+   *  Graph lines with unsorted x-data or without samples between the cursors
+   *  are left out.
+   *
+   *  @return the statistics, empty if the measurement cursors are not set.
+   */
+  std::vector<MeasurementStatistics> getMeasurementStatistics() const;
+
+  /** @brief Get the input-to-frame latency histogram of a user input action
+   *
+   *  The latency is measured from when the mouse event that triggered the
+   *  action is handled to the end of the first paint of the plot after it,
+   *  whatever its age. Latencies longer than LatencyHistogram::range_ms, e.g.
+   *  while the plot is hidden, are counted in the overflow bin. At most 1024
+   *  measurements are pending, the actions after that are not measured until
+   *  the next paint.
+   *
+   *  @param user_input_action the action to get the latencies for.
+   *  @return the histogram, empty if the action has not been measured.
+   */
+  LatencyHistogram
+  getInputLatencyHistogram(const UserInputAction user_input_action) const;
+
+  /** @brief Remove all measured input-to-frame latencies.
+   *  @return void.
+   */
+  void resetInputLatencyHistograms() noexcept;
+
   //==============================================================================
 
   /** @brief This lambda is triggered when a tracepoint value is changed.
@@ -275,6 +586,15 @@ public:
                      const juce::Point<float> new_trace_point)>
       onTraceValueChange = nullptr;
 
+  /** @brief This lambda is triggered when a measurement cursor is moved.
+   *
+   * @param current_plot poiter to this plot.
+   * @param statistics the statistics between the measurement cursors.
+   */
+  std::function<void(const juce::Component *current_plot,
+                     const std::vector<MeasurementStatistics> &statistics)>
+      onMeasurementCursorsChange = nullptr;
+
   //==============================================================================
 
   /** @brief Color IDs for customizing plot appearance
@@ -302,7 +622,10 @@ public:
     trace_point_frame_colour, /** Colour of the trace point frame colour. */
     legend_label_colour,      /** Colour of the legend label(s). */
     legend_background_colour, /** Colour of the legend background. */
-    zoom_frame_colour         /** Colour of the dashed zoom rectangle. */
+    zoom_frame_colour,        /** Colour of the dashed zoom rectangle. */
+    crosshair_colour,          /** Colour of the crosshair. */
+    measurement_cursor_colour, /** Colour of the measurement cursors. */
+    overview_window_colour     /** Colour of the view window in PlotOverview. */
   };
 
   /** @brief A set of colour IDs to use to change the colour of each plot
@@ -382,6 +705,65 @@ public:
                       const juce::Point<int> &end_coordinates,
                       const juce::Rectangle<int> &graph_bounds) noexcept = 0;
 
+    /** This method draws the crosshair and the readouts of all graph lines.
+     * 'crosshair_x' is relative the graph bounds. */
+    virtual void
+    drawCrosshair(juce::Graphics &g, const juce::Rectangle<int> &graph_bounds,
+                  const float crosshair_x, const float crosshair_x_value,
+                  const std::vector<CrosshairReadout> &readouts) = 0;
+
+    /** Returns the area drawn by drawCrosshair(), i.e. the crosshair, the
+     * readout points and the labels, relative the plot. Only this area is
+     * repainted when the crosshair is moved. */
+    virtual juce::RectangleList<int> getCrosshairArea(
+        const juce::Rectangle<int> &graph_bounds, const float crosshair_x,
+        const float crosshair_x_value,
+        const std::vector<CrosshairReadout> &readouts) = 0;
+
+    /** This method draws the measurement cursors and the statistics between
+     * them. The x-positions of the cursors are relative the graph bounds. */
+    virtual void drawMeasurementCursors(
+        juce::Graphics &g, const juce::Rectangle<int> &graph_bounds,
+        const std::pair<float, float> cursors_x,
+        const std::vector<MeasurementStatistics> &statistics) = 0;
+
+    /** This method draws the markers of the samples that must be kept, see
+     * Plot::setMustKeepSamples(). */
+    virtual void drawMustKeepMarkers(juce::Graphics &g,
+                                     const PixelPoints &pixel_points,
+                                     const Marker &marker,
+                                     const juce::Colour graph_colour) = 0;
+
+    /** This method draws the error bars of a graph line, see
+     * Plot::setErrorBars(). The lines are relative the graph bounds. */
+    virtual void drawErrorBars(juce::Graphics &g,
+                               const std::vector<juce::Line<float>> &error_bars,
+                               const juce::Colour graph_colour) = 0;
+
+    /** This method fills the bars or stems of a graph line, see
+     * GraphAttribute::bars. The bars are relative the graph bounds. */
+    virtual void drawBars(juce::Graphics &g,
+                          const juce::RectangleList<float> &bar_rectangles,
+                          const GraphLineDataView graph_line_data) = 0;
+
+    /** Returns the colours of a persistence display from zero to full
+     * intensity, see Plot::setPersistence(). */
+    virtual std::vector<juce::Colour>
+    getPersistenceColourMap(const juce::Colour graph_colour,
+                            const std::size_t num_colours) const = 0;
+
+    /** This method draws a graph line in PlotOverview as the min/max y-pixel
+     * of each column, the columns without data are NaN. */
+    virtual void
+    drawOverviewGraphLine(juce::Graphics &g,
+                          const std::vector<Lim_f> &column_y_pixels,
+                          const juce::Colour graph_colour) = 0;
+
+    /** This method draws the window of the current view in PlotOverview. */
+    virtual void
+    drawOverviewWindow(juce::Graphics &g, const juce::Rectangle<int> &bounds,
+                       const juce::Rectangle<float> &view_window) = 0;
+
     /** A method to find and get the colour from an id. */
     virtual CONSTEXPR20 juce::Colour
     findAndGetColourFromId(const int colour_id) const noexcept = 0;
@@ -393,6 +775,11 @@ public:
     virtual CONSTEXPR20 int
     getColourFromGraphID(const std::size_t graph_index) const = 0;
 
+    /** Returns the colour map of a heatmap, from the lowest to the highest
+     * value, with 'num_colours' colours. */
+    virtual std::vector<juce::Colour>
+    getHeatmapColourMap(const std::size_t num_colours) const = 0;
+
     /** Get the graph bounds, where the graphs and grids are to be drawn. A plot
      * component can be given to base the graph bounds on the grid anf axis
      * labels. */
@@ -526,10 +913,27 @@ public:
         const std::vector<std::size_t> &update_only_these_indices,
         const Scaling y_scaling, const Lim<float> y_lim,
         const juce::Rectangle<int> &graph_bounds,
-        const std::vector<float> &y_data,
+        std::span<const float> y_data,
         const std::vector<std::size_t> &pixel_points_indices,
         PixelPoints &pixel_points) noexcept = 0;
 
+    /** Updates the pixel points and their data indices when xy-downsampling is
+     *  used. The data is downsampled and transformed in the same pass. If
+     *  'collapse_y_lim' is set, the runs of points outside it are collapsed to
+     *  their first and last point, and the position of the first pixel point
+     *  of each run is written to 'collapsed_run_positions'. The index outputs
+     *  are nullptr if the graph line does not need them. */
+    virtual void updateXYDownsampledPixelPoints(
+        const Scaling x_scaling, const Scaling y_scaling,
+        const Lim<float> x_lim, const Lim<float> y_lim,
+        const juce::Rectangle<int> &graph_bounds,
+        const std::vector<float> &x_data, std::span<const float> y_data,
+        const std::optional<Lim<float>> &collapse_y_lim,
+        std::vector<std::size_t> *x_based_indices,
+        std::vector<std::size_t> *pixel_points_indices,
+        std::vector<std::size_t> *collapsed_run_positions,
+        PixelPoints &pixel_points) = 0;
+
     /** Updates both the vertical and horizontal grid labels. */
     virtual void updateGridLabels(const juce::Rectangle<int> &graph_bounds,
                                   const std::vector<GridLine> &grid_lines,
@@ -554,6 +958,8 @@ public:
   /** @internal */
   void paint(juce::Graphics &g) override;
   /** @internal */
+  void paintOverChildren(juce::Graphics &g) override;
+  /** @internal */
   void parentHierarchyChanged() override;
   /** @internal */
   void lookAndFeelChanged() override;
@@ -566,6 +972,10 @@ public:
   /** @internal */
   void mouseUp(const juce::MouseEvent &event) override;
   /** @internal */
+  void mouseMove(const juce::MouseEvent &event) override;
+  /** @internal */
+  void mouseExit(const juce::MouseEvent &event) override;
+  /** @internal */
   juce::Point<float>
   getMousePositionRelativeToGraphArea(const juce::MouseEvent &event) const;
   /** @internal */
@@ -585,12 +995,18 @@ private:
                             const size_t graph_line_index);
   /** @internal */
   void resizeChildrens();
+
+  /** @internal */
+  Heatmap &getHeatmapForNewData(const std::size_t num_values,
+                                const std::size_t num_columns,
+                                const Lim_f &x_extent, const Lim_f &y_extent);
   /** @internal */
   void resetLookAndFeelChildrens(juce::LookAndFeel *lookandfeel = nullptr);
   /** @internal */
   template <GraphLineType t_graph_line_type>
-  void updateGraphLineYData(const std::vector<std::vector<float>> &y_data,
-                            const GraphAttributeList &graph_attribute_list);
+  void updateGraphLineYData(const std::vector<std::span<const float>> &y_data,
+                            const GraphAttributeList &graph_attribute_list,
+                            const bool borrow_y_data);
   /** @internal */
   template <GraphLineType t_graph_line_type>
   void updateGraphLineXData(const std::vector<std::vector<float>> &x_data);
@@ -603,19 +1019,32 @@ private:
   /** @internal */
   void updateYLim(const Lim_f &new_y_lim);
   /** @internal */
+  void updateXYLim(const Lim_f &new_x_lim, const Lim_f &new_y_lim);
+  /** @internal */
+  void addViewToZoomHistory();
+  /** @internal */
+  void storeViewInGraphLineCaches();
+  /** @internal */
+  void zoomToViewInHistory(const std::size_t zoom_history_index);
+  /** @internal */
+  void updateViewXLim(const Lim_f &new_x_lim);
+  /** @internal */
   void addSelectableTracePoints();
   /** @internal */
+  void updateTriggerXOffset();
+  /** @internal */
   void setTracePointInternal(const juce::Point<float> &trace_point_coordinate,
                              bool is_point_data_point);
   /** @internal */
   template <GraphLineType t_graph_line_type>
-  void plotInternal(const std::vector<std::vector<float>> &y_data,
+  void plotInternal(const std::vector<std::span<const float>> &y_data,
                     const std::vector<std::vector<float>> &x_data,
                     const GraphAttributeList &graph_attributes,
-                    const bool update_y_data_only = false);
+                    const bool update_y_data_only = false,
+                    const bool borrow_y_data = false);
   /** @internal */
   std::vector<std::vector<float>>
-  generateXdataRamp(const std::vector<std::vector<float>> &y_data);
+  generateXdataRamp(const std::vector<std::span<const float>> &y_data);
   /** @internal */
   void syncDownsamplingModeWithMoveType();
   /** @internal */
@@ -651,6 +1080,16 @@ private:
   void moveSelectedTracePoints(const juce::MouseEvent &event);
   /** @internal */
   void panning(const juce::MouseEvent &event);
+  /** @internal */
+  void moveCrosshair(const juce::MouseEvent &event);
+  /** @internal */
+  void repaintCrosshair();
+  /** @internal */
+  void moveMeasurementCursor(const juce::MouseEvent &event);
+  /** @internal */
+  std::optional<std::pair<float, float>> getMeasurementCursorsX() const;
+  /** @internal */
+  void startInputLatencyMeasurement(const UserInputAction user_input_action);
 
   juce::ComponentDragger m_comp_dragger;
   juce::Point<float> m_prev_mouse_position{0.f, 0.f};
@@ -674,12 +1113,14 @@ private:
   std::unique_ptr<Legend> m_legend;
   std::unique_ptr<GraphArea> m_selected_area;
   std::unique_ptr<Trace> m_trace;
+  std::unique_ptr<Heatmap> m_heatmap;
 
   /** Look and feel */
   PlotLookAndFeel *getPlotLookAndFeel();
   std::unique_ptr<PlotLookAndFeel> m_lookandfeel_default;
 
   /** Friend functions */
+  friend class PlotOverview;
   friend const AreLabelsSet areLabelsSet(const Plot *plot) noexcept;
   friend const std::pair<int, int>
   getMaxGridLabelWidth(const Plot *plot) noexcept;
@@ -689,6 +1130,33 @@ private:
   bool m_x_autoscale = true;
   bool m_y_autoscale = true;
   bool m_is_panning_or_zoomed_active = false;
+
+  /** Zoom history as x/y-limits, and the index of the current view. */
+  static constexpr std::size_t max_zoom_history_size = 32u;
+  std::vector<std::pair<Lim_f, Lim_f>> m_zoom_history;
+  std::size_t m_zoom_history_index{0u};
+
+  /** Crosshair, the x-position is relative the graph bounds, and the area it
+   * covered when last painted. */
+  bool m_is_crosshair_enabled = false;
+  std::optional<float> m_crosshair_x;
+  juce::RectangleList<int> m_crosshair_area;
+
+  /** Measurement cursors as x-values, and the cursor being dragged. */
+  std::optional<std::pair<float, float>> m_measurement_cursors;
+  std::optional<std::size_t> m_dragged_measurement_cursor;
+
+  /** Decay per second of the persistence display. */
+  std::optional<float> m_persistence_decay;
+  std::optional<float> m_octave_fraction;
+
+  /** Trigger, and if the last update of the y-data found a crossing. */
+  std::optional<Trigger> m_trigger;
+  bool m_is_triggered{false};
+
+  /** Input-to-frame latency */
+  std::vector<std::pair<UserInputAction, double>> m_pending_input_latencies;
+  std::map<UserInputAction, LatencyHistogram> m_input_latency_histograms;
 };
 
 /**
@@ -0,0 +1,110 @@
+/**
+ * @file cmp_plot_overview.h
+ * @brief Overview component to navigate a Plot
+ * @ingroup CustomMatPlot
+ * @details The overview shows all data of a Plot with the current view
+ *          highlighted. The view can be panned by dragging the highlighted
+ *          window and zoomed by dragging its edges.
+ * @author Frans Rosencrantz
+ * @contact Frans.Rosencrantz@gmail.com
+ */
+
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include "cmp_datamodels.h"
+
+namespace cmp {
+
+class Plot;
+
+/*
+ * @class PlotOverview
+ * @brief A compact overview of all data of a Plot
+ * @details The overview reads the data of the graph lines of the plot, it does
+ *          not hold a copy of it. The min/max of each column of the overview is
+ *          resolved from the same range statistics index as the measurement
+ *          cursors of the plot, and is rendered to an image that is only
+ *          updated when the data, the home limits or the size of the overview
+ *          change. Panning or zooming the plot only repaints the view window.
+ *
+ *          The plot must outlive the overview.
+ *
+ * @code
+ * cmp::Plot plot;
+ * cmp::PlotOverview overview(plot);
+ * addAndMakeVisible(plot);
+ * addAndMakeVisible(overview);
+ * @endcode
+ */
+class PlotOverview : public juce::Component,
+                     public virtual Observer<Lim<float>>,
+                     public virtual Observer<bool> {
+ public:
+  /** @brief Create an overview of a plot.
+   *
+   *  @param plot the plot to navigate, must outlive the overview.
+   */
+  explicit PlotOverview(Plot &plot);
+
+  /** @brief Observer function for when the view of the plot changes.
+   *
+   * @param id the id of the observer.
+   * @param new_value the new limits.
+   * @return void.
+   */
+  void observableValueUpdated(ObserverId id,
+                              const Lim<float> &new_value) override;
+
+  /** @brief Observer function for when the plot is updated.
+   *
+   * @param id the id of the observer.
+   * @param new_value the new value of the observer.
+   * @return void.
+   */
+  void observableValueUpdated(ObserverId id, const bool &new_value) override;
+
+  //==============================================================================
+  /** @internal */
+  void paint(juce::Graphics &g) override;
+  /** @internal */
+  void resized() override;
+  /** @internal */
+  void mouseDown(const juce::MouseEvent &event) override;
+  /** @internal */
+  void mouseDrag(const juce::MouseEvent &event) override;
+  /** @internal */
+  void mouseUp(const juce::MouseEvent &event) override;
+
+ private:
+  /** What a mouse drag on the overview changes. */
+  enum class DragType { pan, move_start, move_end };
+
+  /** The state of the plot that the rendered image shows. */
+  struct RenderKey {
+    Lim_f x_lim, y_lim;
+    Scaling x_scaling, y_scaling;
+    juce::LookAndFeel *lookandfeel;
+    std::vector<std::size_t> data_generations;
+    std::vector<juce::Colour> colours;
+
+    bool operator==(const RenderKey &rhs) const noexcept;
+  };
+
+  RenderKey getRenderKey() const;
+  void render();
+  float getXPixelFromXData(const float x) const;
+  float getXDataFromXPixel(const float x_pixel) const;
+  juce::Rectangle<float> getViewWindow() const;
+
+  Plot &m_plot;
+  juce::Image m_image;
+  std::optional<RenderKey> m_render_key;
+
+  DragType m_drag_type{DragType::pan};
+  Lim_f m_drag_start_x_lim;
+};
+
+}  // namespace cmp
@@ -0,0 +1,78 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_derived_trace.h
+ *
+ * @brief In place update of the traces derived from a live graph line.
+ *
+ * @ingroup CustomMatPlotInternal
+ *
+ * @author Frans Rosencrantz
+ * Contact: Frans.Rosencrantz@gmail.com
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "cmp_datamodels.h"
+
+namespace cmp {
+
+/**
+ * \class DerivedTraceState
+ * \brief Updates the values of a derived trace from the live y-data.
+ *
+ * The values are updated in place with SSE2 or NEON when available. The
+ * holds and the exponential average keep one value per sample, the average
+ * keeps the last 'num_frames' frames and their running sum, which is
+ * recomputed once per 'num_frames' frames so that rounding errors do not
+ * accumulate.
+ */
+class DerivedTraceState {
+ public:
+  explicit DerivedTraceState(const DerivedTrace &derived_trace);
+
+  /** @brief Get the settings of the trace. */
+  const DerivedTrace &getDerivedTrace() const noexcept;
+
+  /** @brief Update the values with a new frame of the live y-data.
+   *
+   * The values start over from the frame if the size of the live y-data
+   * changed or after a reset.
+   *
+   * @param live_y_data the y-data of the live graph line.
+   * @param values the values of the trace, updated in place.
+   * @return void.
+   */
+  void update(std::span<const float> live_y_data,
+              std::vector<float> &values);
+
+  /** @brief Start over from the next frame. */
+  void reset() noexcept;
+
+  /** @brief Get the number of frames since the last reset. */
+  std::size_t getNumFrames() const noexcept;
+
+ private:
+  void updateAverage(std::span<const float> live_y_data,
+                     std::vector<float> &values);
+
+  DerivedTrace m_derived_trace;
+  std::size_t m_num_frames{0u};
+
+  // The frames of an average, oldest first from 'm_history_index'.
+  std::vector<std::vector<float>> m_history;
+  std::vector<float> m_sum;
+  std::size_t m_history_index{0u};
+};
+
+}  // namespace cmp
@@ -21,6 +21,8 @@
 
 #include <cmp_datamodels.h>
 
+#include "cmp_sample_flags.h"
+
 namespace cmp {
 
 /**
@@ -66,6 +68,128 @@ class Downsampler {
    */
   static void calculateXYBasedIdxs(
       const std::vector<std::size_t> &x_idxs,
-      const std::vector<FloatType> &y_data, std::vector<std::size_t> &xy_idxs);
+      std::span<const FloatType> y_data, std::vector<std::size_t> &xy_idxs);
+
+  /** @brief Calculate xy-indices for several y_data sharing the same x-indices
+   *
+   * Same as @see calculateXYBasedIdxs but for a batch of channels that share
+   * the same x-data. The pixel columns are visited once for all channels:
+   * the float channels are swept four at a time, each block of samples is
+   * transposed so the min/max of the four channels are found by the same
+   * vector instructions. Columns with few samples, double data and a single
+   * remaining channel are scanned one channel at a time instead. The output
+   * is only sized for the number of pixel columns instead of the data size
+   * and is identical to calling calculateXYBasedIdxs for each channel.
+   *
+   *  @param x_idxs the x-indices calculated in @see CalculateXIdxs.
+   *  @param y_data_list the y_data to be plotted, all of the same size.
+   *  @param xy_idxs_list indices used to downsample each y_data.
+   *  @return void.
+   */
+  static void calculateXYBasedIdxsBatched(
+      const std::vector<std::size_t> &x_idxs,
+      const std::vector<std::vector<FloatType>> &y_data_list,
+      std::vector<std::vector<std::size_t>> &xy_idxs_list);
+
+  /** @brief Same as above, without copying the y_data into one list. */
+  static void calculateXYBasedIdxsBatched(
+      const std::vector<std::size_t> &x_idxs,
+      const std::vector<std::span<const FloatType>> &y_data_list,
+      std::vector<std::vector<std::size_t>> &xy_idxs_list);
+
+  /** @brief Calculate the xy-downsampled pixel points in one pass
+   *
+   * Gives the same pixel points as @see calculateXIndices followed by
+   * @see calculateXYBasedIdxs and transforming the indexed data to pixel
+   * coordinates, but the data is only read once and no index lists of the
+   * data size are allocated. The indices are only written if requested.
+   *
+   * If 'collapse_y_lim' is set, the runs outside it are collapsed like
+   * @see collapseIdxsOutsideYLim while the indices are found, so only the
+   * kept indices are transformed.
+   *
+   *  @param x_scaling the x-scaling.
+   *  @param y_scaling the y-scaling.
+   *  @param x_lim the x-limits.
+   *  @param y_lim the y-limits.
+   *  @param graph_bounds the graph bounds.
+   *  @param x_data the x_data to be plotted.
+   *  @param y_data the y_data to be plotted.
+   *  @param pixel_points_out the output pixel points.
+   *  @param x_idxs_out the x-indices, or nullptr if not needed.
+   *  @param xy_idxs_out the index of each pixel point, or nullptr if not needed.
+   *  @param collapse_y_lim the y-values outside which the runs are collapsed,
+   *  or nothing to keep all points.
+   *  @param run_positions_out the position of the first pixel point of each
+   *  collapsed run, or nullptr if not needed.
+   *  @return void.
+   */
+  static void calculateXYPixelPoints(
+      const Scaling x_scaling, const Scaling y_scaling,
+      const Lim<FloatType> x_lim, const Lim<FloatType> y_lim,
+      const juce::Rectangle<int> &graph_bounds,
+      const std::vector<FloatType> &x_data,
+      std::span<const FloatType> y_data, PixelPoints &pixel_points_out,
+      std::vector<std::size_t> *x_idxs_out = nullptr,
+      std::vector<std::size_t> *xy_idxs_out = nullptr,
+      const std::optional<Lim<FloatType>> &collapse_y_lim = std::nullopt,
+      std::vector<std::size_t> *run_positions_out = nullptr);
+
+  /** @brief Calculate the x- and xy-indices in one pass
+   *
+   * Gives the same indices as @see calculateXIndices followed by
+   * @see calculateXYBasedIdxs, found in the single pass of
+   * @see calculateXYPixelPoints without transforming them to pixel points.
+   *
+   *  @param x_scaling the x-scaling.
+   *  @param x_lim the x-limits.
+   *  @param graph_bounds the graph bounds.
+   *  @param x_data the x_data to be plotted.
+   *  @param y_data the y_data to be plotted.
+   *  @param x_idxs_out the x-indices.
+   *  @param xy_idxs_out indices used to downsample the data.
+   *  @return void.
+   */
+  static void calculateXYIdxs(const Scaling x_scaling,
+                              const Lim<FloatType> x_lim,
+                              const juce::Rectangle<int> &graph_bounds,
+                              const std::vector<FloatType> &x_data,
+                              std::span<const FloatType> y_data,
+                              std::vector<std::size_t> &x_idxs_out,
+                              std::vector<std::size_t> &xy_idxs_out);
+
+  /** @brief Collapse the runs of indices outside the y-limits
+   *
+   * A run of two or more consecutive indices with a y-value above or below
+   * the limits is replaced by its first and last index, before the indices
+   * are transformed to pixel points. The rest of the run would be drawn
+   * outside the limits, so only the segments into and out of the run are
+   * needed.
+   *
+   *  @param y_data the y_data to be plotted.
+   *  @param y_lim the y-values outside which the runs are collapsed.
+   *  @param idxs the downsampled indices, collapsed in place.
+   *  @param run_positions_out the position in 'idxs' of the first index of
+   *  each collapsed run, its last index is the next one.
+   *  @return true if any run was collapsed.
+   */
+  static bool collapseIdxsOutsideYLim(
+      std::span<const FloatType> y_data, const Lim<FloatType> y_lim,
+      std::vector<std::size_t> &idxs,
+      std::vector<std::size_t> &run_positions_out);
+
+  /** @brief Merge the flagged samples into downsampled indices
+   *
+   * Downsampling only keeps the extremes of each pixel column, which drops
+   * flagged samples with a y-value in between. The flagged samples between
+   * the first and the last index are merged into the indices, found from the
+   * block summary of the flags without visiting unflagged blocks.
+   *
+   *  @param flags the samples that must be kept.
+   *  @param idxs the downsampled indices in increasing order.
+   *  @return true if any index was added.
+   */
+  static bool mergeFlaggedIdxs(const SampleFlags &flags,
+                               std::vector<std::size_t> &idxs);
 };
 }  // namespace cmp
\ No newline at end of file
@@ -22,9 +22,16 @@
 #include <juce_gui_basics/juce_gui_basics.h>
 
 #include <cstddef>
+#include <span>
 
 #include "cmp_datamodels.h"
+#include "cmp_derived_trace.h"
+#include "cmp_octave_smoothing.h"
+#include "cmp_persistence_buffer.h"
+#include "cmp_range_statistics.h"
+#include "cmp_sample_flags.h"
 #include "cmp_utils.h"
+#include "cmp_view_cache.h"
 
 namespace cmp {
 
@@ -67,6 +74,46 @@ public:
       bool check_only_distance_from_x = false,
       bool only_visible_data_points = true) const;
 
+  /** @brief Get the y-value of the graph line at a x-value.
+   *
+   * Uses a binary search and linear interpolation between the two closest
+   * data points if the x-data is sorted, otherwise the y-value of the visible
+   * data point closest in x is returned.
+   *
+   * @param x_value the x-value.
+   * @return the y-value, or nothing if x_value is outside the x-data or the
+   * y-value is NaN.
+   */
+  std::optional<float> getYValueAt(const float x_value) const;
+
+  /** @brief Get the statistics of the y-values between two x-values.
+   *
+   * The statistics are resolved from an index of the y-data that is built on
+   * the first call and only extended when the y-data is appended. The x-data
+   * must be sorted.
+   *
+   * @param x_start the first x-value.
+   * @param x_end the last x-value, can be less than x_start.
+   * @return the statistics, or nothing if the x-data is not sorted or there
+   * are no non-NaN y-values between the x-values.
+   */
+  std::optional<RangeStatistics::Values> getStatisticsBetween(
+      float x_start, float x_end) const;
+
+  /** @brief Check if the x-data is sorted in ascending order.
+   *
+   * @return true if the x-data is sorted.
+   */
+  bool isXDataSorted() const;
+
+  /** @brief Get the data generation.
+   *
+   * The generation is incremented every time the x- or y-data is changed.
+   *
+   * @return the data generation.
+   */
+  std::size_t getDataGeneration() const noexcept;
+
   /** @brief Get data point for a pixel point index.
    *
    *  @param pixel_point_index the pixel point index.
@@ -119,7 +166,104 @@ public:
    *  @param y_values vector of y-values.
    *  @return void.
    */
-  void setYValues(const std::vector<float>& y_values);
+  void setYValues(std::span<const float> y_values);
+
+  /** @brief Set the y-values for the graph-line without copying them
+   *
+   *  The y-values must outlive the graph-line or the next call to
+   *  setYValues() or setYValuesBorrowed(). Call it again after changing the
+   *  values in place. The values are copied if they are smoothed or changed
+   *  through the graph-line, e.g. by setXYValue() or movePixelPoint().
+   *
+   *  @param y_values span of y-values.
+   *  @return void.
+   */
+  void setYValuesBorrowed(std::span<const float> y_values);
+
+  /** @brief Set the samples that must be kept when downsampling
+   *
+   * The flagged samples are always plotted, and drawn with the
+   * must_keep_marker of the graph attribute if set. The flags are indexed as
+   * the x/y-data and kept when the data is changed.
+   *
+   *  @param flags true for the samples that must be kept, empty to clear.
+   *  @return void.
+   */
+  void setMustKeepFlags(const std::vector<bool>& flags);
+
+  /** @brief Set the error bars of the samples
+   *
+   *  @param error_bars the errors, one per sample.
+   *  @return void.
+   */
+  void setErrorBars(const ErrorBars& error_bars);
+
+  /** @brief Get the error bars in pixels, merged per pixel column.
+   *
+   *  @return the error bars relative the graph bounds.
+   */
+  const std::vector<juce::Line<float>>& getErrorBarLines() const noexcept;
+
+  /** @brief Get the bars or stems in pixels, merged per pixel column.
+   *
+   *  @return the bars relative the graph bounds.
+   */
+  const juce::RectangleList<float>& getBarRectangles() const noexcept;
+
+  /** @brief Set the x-offset of the view of the x-data
+   *
+   * The x-data is plotted as 'x - x_offset', e.g. to align it to a trigger
+   * without copying the data. The x-values of the readouts, trace points and
+   * statistics are relative the offset as well.
+   *
+   *  @param x_offset the x-offset.
+   *  @return void.
+   */
+  void setXOffset(const float x_offset) noexcept;
+
+  /** @brief Get the x-offset of the view of the x-data.
+   *
+   *  @return the x-offset.
+   */
+  float getXOffset() const noexcept;
+
+  /** @brief Set the persistence of the traces of earlier updates
+   *
+   *  @param decay_per_second the fraction of the intensity left after a
+   *  second, or nothing to draw only the current trace.
+   *  @return void.
+   */
+  void setPersistence(const std::optional<float> decay_per_second);
+
+  /** @brief Set fractional octave smoothing of the y-data
+   *
+   * The y-data is smoothed before it is downsampled, the unsmoothed y-data
+   * is kept to be smoothed again when the x-data or fraction changes.
+   *
+   *  @param octave_fraction the width of the smoothing window in octaves,
+   *  e.g. 1/3, or nothing to turn smoothing off.
+   *  @return void.
+   */
+  void setOctaveSmoothing(const std::optional<float> octave_fraction);
+
+  /** @brief Set the traces derived from the y-data of this graph line
+   *
+   * The traces are updated in place when the y-data is set, and downsampled
+   * with the same x-indices as this graph line.
+   *
+   *  @param derived_traces the traces, empty to remove them.
+   *  @return void.
+   */
+  void setDerivedTraces(const std::vector<DerivedTrace>& derived_traces);
+
+  /** @brief Start the derived traces over from the next y-data. */
+  void resetDerivedTraces() noexcept;
+
+  /** @brief Get the y-values of the derived traces.
+   *
+   *  @return the y-values of each derived trace.
+   */
+  const std::vector<std::vector<float>>& getDerivedTraceYData() const noexcept;
 
   /** @brief Set the x-values for the graph-line
    *
@@ -128,6 +272,33 @@ public:
    */
   void setXValues(const std::vector<float>& x_values);
 
+  /** @brief Mark the x-values as equal to the x-values of another graph-line
+   *
+   *  Graph-lines with equal x-values are xy-downsampled together by
+   *  @see updateXYDownsampledIndicesBatched. Any later change of the x-values
+   *  of either graph-line ends the sharing.
+   *
+   *  @param graph_line the graph-line with the same x-values.
+   *  @return void.
+   */
+  void shareXValues(const GraphLine& graph_line) noexcept;
+
+  /** @brief Find the xy-downsampled indices of graph-lines with equal x-values
+   *
+   *  The graph-lines that share the x-values, @see shareXValues, the x-limits,
+   *  x-offset, x-scaling and graph bounds also share the pixel columns. Their
+   *  indices are found in one sweep over the y-values of all of them,
+   *  @see Downsampler::calculateXYBasedIdxsBatched, and are used by the next
+   *  update of each graph-line instead of downsampling it on its own. The
+   *  look and feel is then only used to transform the indexed data to pixel
+   *  points. The other graph-lines are left as they are.
+   *
+   *  @param graph_lines the graph-lines to downsample.
+   *  @return void.
+   */
+  static void updateXYDownsampledIndicesBatched(
+      const std::vector<GraphLine*>& graph_lines);
+
   /** @brief Set a single x/y value for the graph-line
    *
    *  @param juce::Point<float> the x/y value.
@@ -138,11 +309,12 @@ public:
 
   /** @brief Get y-values
    *
-   *  Get a const reference of the y-values.
+   *  Get a view of the y-values, the borrowed ones if set with
+   *  setYValuesBorrowed().
    *
-   *  @return a const reference of the y-values.
+   *  @return a view of the y-values.
    */
-  const std::vector<float>& getYData() const noexcept;
+  std::span<const float> getYData() const noexcept;
 
   /** @brief Get x-values
    *
@@ -154,7 +326,10 @@ public:
 
   /** @brief Get the pixel points
    *
-   *  Get a const reference of the calculated pixel points.
+   *  Get a const reference of the calculated pixel points. Runs of samples
+   *  far outside the y-limits are collapsed into the two points where the
+   *  line crosses a line outside the graph bounds, unless the points are
+   *  drawn one by one, e.g. with markers or as bars, or the line is dashed.
    *
    *  @return const reference of the calculated pixel points.
    */
@@ -162,7 +337,9 @@ public:
 
   /* @brief Get the pixel point indices
    *
-   *  Get a const reference of the calculated pixel point indices.
+   *  Get a const reference of the calculated pixel point indices. The
+   *  xy-downsampled indices are only found with the pixel points if the graph
+   *  line needs them, otherwise they are found on the first call.
    *
    *  @return const reference of the calculated pixel point indices.
    */
@@ -177,6 +354,26 @@ public:
    */
   void setColour(const juce::Colour graph_colour);
 
+  /** @brief Defer the updates of the pixel points when the limits change.
+   *
+   *  Used to change both the x- and y-limits and update the pixel points
+   *  once with updateXY() instead of once per limit.
+   *
+   *  @param is_update_deferred true to only store new limits.
+   *  @return void.
+   */
+  void setUpdateDeferred(const bool is_update_deferred) noexcept;
+
+  /** @brief Store the pixel points of the current view in the view cache.
+   *
+   *  Called when the view is added to the zoom history. Nothing is stored if
+   *  the data has changed since the previous call, e.g. when the y-data is
+   *  updated every frame the views are never seen again.
+   *
+   *  @return void.
+   */
+  void storeViewInCache();
+
   /** @brief Update the pixel points indices x-value in the pixel points.
    *
    *  This function updates the pixel points if any new parameter is set. Should
@@ -289,10 +486,74 @@ public:
       const std::vector<size_t>& update_only_these_indices);
   void updateXIndicesAndPixelPointsIntern(
       const std::vector<size_t>& update_only_these_indices);
+  /* Updates all pixel points, xy-downsampling has no partial update since the
+   * pixel points can't be moved, see Plot::setDownsamplingType(). */
+  void updateXYDownsampledPixelPointsIntern();
+  bool needsPixelPointIndices() const noexcept;
+  void updateMissingPixelPointIndices() const;
+
+  /** The downsampled pixel points of a view. */
+  struct CachedPixelPoints {
+    std::vector<std::size_t> x_based_ds_indices, xy_indices;
+    PixelPoints pixel_points;
+  };
+
+  Lim<float> getDataXLim() const noexcept;
+  ViewKey getViewKey() const noexcept;
+  void addPersistenceTrace();
+  void renderPersistence();
+  ViewKey getPersistenceViewKey() const noexcept;
+  void updateOctaveSmoothingWindows();
+  void updateBarRectangles();
+  void updateErrorBarLines();
+  void updateDerivedTracePixelPoints();
+  void updateCollapsedPixelPointsIntern();
+  void clampCollapsedPixelPoints();
+  float getCollapseMargin() const noexcept;
+  Lim<float> getCollapseYLim() const noexcept;
+  bool isCollapsible() const noexcept;
+  bool restorePixelPointsFromViewCache();
+  bool isXYDownsampledBatchable() const noexcept;
+  static std::size_t createXDataId() noexcept;
+  void makeYDataOwned();
 
   std::vector<float> m_x_data, m_y_data;
-  std::vector<std::size_t> m_x_based_ds_indices, m_xy_indices, m_indices_to_update;
+  std::optional<std::span<const float>> m_borrowed_y_data;
+  // Found on demand if left out of the xy-downsampling pass.
+  mutable std::vector<std::size_t> m_x_based_ds_indices, m_xy_indices;
+  mutable bool m_are_pixel_point_indices_missing{false};
+  std::vector<std::size_t> m_indices_to_update;
   PixelPoints m_pixel_points;
+  std::vector<std::size_t> m_collapsed_run_positions;
+  mutable std::optional<bool> m_is_x_data_sorted;
+  mutable RangeStatistics m_range_statistics;
+  SampleFlags m_must_keep_flags;
+  ErrorBars m_error_bars;
+  std::vector<juce::Line<float>> m_error_bar_lines;
+  ViewCache<CachedPixelPoints> m_view_cache;
+  std::size_t m_data_generation{0u};
+  std::optional<std::size_t> m_view_cache_generation;
+  std::size_t m_x_data_id{createXDataId()};
+  std::optional<ViewKey> m_batched_view;
+  float m_x_offset{0.0f};
+  std::vector<DerivedTraceState> m_derived_traces;
+  std::vector<std::vector<float>> m_derived_y_data;
+  std::vector<std::vector<std::size_t>> m_derived_xy_indices;
+  std::vector<PixelPoints> m_derived_pixel_points;
+  std::optional<float> m_persistence_decay;
+  PixelPoints m_step_pixel_points;
+  juce::RectangleList<float> m_bar_rectangles;
+  std::optional<float> m_octave_fraction;
+  FractionalOctaveSmoother m_octave_smoother;
+  std::vector<float> m_unsmoothed_y_data;
+  std::optional<ViewKey> m_persistence_view;
+  PersistenceBuffer m_persistence_buffer, m_pending_persistence_buffer;
+  bool m_has_pending_persistence{false};
+  std::optional<double> m_persistence_decay_time_ms;
+  juce::Image m_persistence_image;
+  std::vector<juce::PixelARGB> m_persistence_colour_map;
+  juce::Colour m_persistence_colour_map_colour;
+  bool m_is_update_deferred{false};
   GraphLineType m_graph_line_type{GraphLineType::normal};
 
   Scaling m_x_scaling, m_y_scaling;
@@ -23,6 +23,7 @@
 
 #include "cmp_datamodels.h"
 #include "cmp_utils.h"
+#include "cmp_view_cache.h"
 
 namespace cmp {
 
@@ -96,6 +97,16 @@ class Grid : public juce::Component,
    */
   void update();
 
+  /** @brief Defer the updates of the grid when the limits change.
+   *
+   *  Used to change both the x- and y-limits and update the grid once with
+   *  update() instead of once per limit.
+   *
+   *  @param is_update_deferred true to only store new limits.
+   *  @return void.
+   */
+  void setUpdateDeferred(const bool is_update_deferred) noexcept;
+
   /** @brief Get the max width of the x and y-labels
    *
    *  @return pair<int, int> where first is the x width and second is the y
@@ -164,6 +175,7 @@ class Grid : public juce::Component,
   void createAutoGridTicks(std::vector<float>& x_ticks,
                            std::vector<float>& y_ticks);
   void createLabels();
+  void createGridLinesAndLabels();
   void updateInternal();
   void addGridLines(const std::vector<float>& ticks,
                     const GridLine::Direction direction);
@@ -188,5 +200,16 @@ class Grid : public juce::Component,
 
   std::vector<std::pair<std::string, juce::Rectangle<int>>> m_y_axis_labels,
       m_x_axis_labels;
+
+  /** The grid lines and labels of a view. */
+  struct CachedGrid {
+    std::vector<GridLine> grid_lines;
+    std::vector<std::pair<std::string, juce::Rectangle<int>>> x_axis_labels,
+        y_axis_labels;
+  };
+
+  ViewCache<CachedGrid> m_view_cache;
+  std::size_t m_generation{0u};
+  bool m_is_update_deferred{false};
 };
 }  // namespace cmp
\ No newline at end of file
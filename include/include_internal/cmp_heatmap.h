@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_heatmap.h
+ *
+ * @brief Component drawing a matrix as a colour mapped image.
+ *
+ * @ingroup CustomMatPlotInternal
+ *
+ * @author Frans Rosencrantz
+ * Contact: Frans.Rosencrantz@gmail.com
+ *
+ */
+
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "cmp_datamodels.h"
+#include "cmp_heatmap_mip_chain.h"
+
+namespace cmp {
+
+/**
+ * \class Heatmap
+ * \brief A class component to draw a row-major matrix as an image on the axes
+ * of the plot. This is a subcomponent to cmp::Plot.
+ *
+ * Only the visible part of the matrix is drawn. Each pixel reads one cell of
+ * the mip chain level with at most two cells per pixel, found with a lookup
+ * table per pixel column and row, and the values are mapped to colours with
+ * a lookup table of 'HeatmapAttribute::colour_map_size' colours.
+ */
+class Heatmap : public juce::Component,
+                public virtual Observer<Scaling>,
+                public virtual Observer<Lim<float>>,
+                public virtual Observer<juce::Rectangle<int>> {
+ public:
+  /** @brief Set a matrix owned by the heatmap.
+   *
+   * Row 0 is drawn at the min of the y-extent.
+   *
+   * @param values the row-major values.
+   * @param num_columns the number of columns.
+   * @param x_extent the x-values of the left and right edge of the matrix.
+   * @param y_extent the y-values of the bottom and top edge of the matrix.
+   * @param heatmap_attribute the attributes.
+   * @return void.
+   */
+  void setData(std::vector<float> values, const std::size_t num_columns,
+               const Lim_f x_extent, const Lim_f y_extent,
+               const HeatmapAttribute &heatmap_attribute);
+
+  /** @brief Set a matrix borrowed by the heatmap, it must outlive the heatmap
+   * or the next call.
+   *
+   * @see setData()
+   */
+  void setBorrowedData(std::span<const float> values,
+                       const std::size_t num_columns, const Lim_f x_extent,
+                       const Lim_f y_extent,
+                       const HeatmapAttribute &heatmap_attribute);
+
+  /** @brief Get the mip chain level drawn at the last paint. */
+  std::size_t getDrawnLevel() const noexcept;
+
+  /** @brief Map values to colour indices.
+   *
+   * The min of the value limits is mapped to index 0 and the max to
+   * 'num_colours - 1', values outside the limits are clamped. NaN is mapped
+   * to 'num_colours', i.e. a transparent colour after the colour map.
+   *
+   * @param values the values.
+   * @param colour_indices the colour indices, as many as the values.
+   * @param size the number of values.
+   * @param value_lim the values of the first and last colour.
+   * @param num_colours the number of colours of the colour map.
+   * @return void.
+   */
+  static void getColourIndices(const float *values,
+                               std::uint32_t *colour_indices,
+                               const std::size_t size, const Lim_f value_lim,
+                               const std::size_t num_colours) noexcept;
+
+  /** @internal */
+  void observableValueUpdated(ObserverId id, const Scaling &new_value) override;
+  /** @internal */
+  void observableValueUpdated(ObserverId id,
+                              const Lim<float> &new_value) override;
+  /** @internal */
+  void observableValueUpdated(ObserverId id,
+                              const juce::Rectangle<int> &new_value) override;
+  /** @internal */
+  void paint(juce::Graphics &g) override;
+  /** @internal */
+  void lookAndFeelChanged() override;
+
+ private:
+  void setDataInternal(const std::size_t num_columns, const Lim_f x_extent,
+                       const Lim_f y_extent,
+                       const HeatmapAttribute &heatmap_attribute);
+  void updateImage();
+
+  juce::LookAndFeel *m_lookandfeel{nullptr};
+
+  std::vector<float> m_owned_values;
+  std::span<const float> m_values;
+  Lim_f m_x_extent, m_y_extent;
+  HeatmapAttribute m_heatmap_attribute;
+  HeatmapMipChain m_mip_chain;
+
+  Lim_f m_x_lim, m_y_lim;
+  Scaling m_x_scaling{Scaling::linear}, m_y_scaling{Scaling::linear};
+  juce::Rectangle<int> m_graph_bounds;
+
+  // The colour map with a transparent colour last, for NaN.
+  std::vector<juce::PixelARGB> m_colour_map;
+
+  bool m_is_image_outdated{true};
+  juce::Image m_image;
+  juce::Point<int> m_image_position;
+  std::size_t m_drawn_level{0u};
+
+  std::vector<std::size_t> m_pixel_columns, m_pixel_rows;
+  std::vector<float> m_line_values;
+  std::vector<std::uint32_t> m_line_colour_indices;
+};
+
+}  // namespace cmp
@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_heatmap_mip_chain.h
+ *
+ * @brief Min, max and mean of a matrix at halved resolutions.
+ *
+ * @ingroup CustomMatPlotInternal
+ *
+ * @author Frans Rosencrantz
+ * Contact: Frans.Rosencrantz@gmail.com
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "cmp_datamodels.h"
+
+namespace cmp {
+
+/**
+ * \class HeatmapMipChain
+ * \brief The levels of a mip chain of a row-major matrix.
+ *
+ * Level 0 is the matrix itself, which is not copied. Each following level has
+ * half the number of rows and columns, rounded up, and holds the min, max and
+ * mean of the 2x2 cells below it, so a zoomed out view reads about one cell
+ * per pixel regardless of the size of the matrix. Non-finite values are left
+ * out, a cell without finite values below it is NaN. The mean of a cell is the mean
+ * of the means below it. The levels take about a third of the memory of the
+ * matrix per reduction.
+ */
+class HeatmapMipChain {
+ public:
+  /** @brief A level of the chain. */
+  struct Level {
+    /** Row-major values of the reduction, 'num_rows * num_columns'. */
+    const float *values;
+    std::size_t num_rows;
+    std::size_t num_columns;
+  };
+
+  /** @brief Build the chain of a matrix.
+   *
+   * The matrix is borrowed and must outlive the chain, or the next build.
+   *
+   * @param values the row-major values.
+   * @param num_rows the number of rows.
+   * @param num_columns the number of columns.
+   * @return void.
+   */
+  void build(std::span<const float> values, const std::size_t num_rows,
+             const std::size_t num_columns);
+
+  /** @brief Get the number of levels, 0 if the matrix is empty. */
+  std::size_t getNumLevels() const noexcept;
+
+  /** @brief Get a level.
+   *
+   * @param level the level, 0 for the matrix itself.
+   * @param reduction the reduction of the cells below, not used by level 0.
+   * @return the level.
+   */
+  Level getLevel(const std::size_t level,
+                 const HeatmapReduction reduction) const noexcept;
+
+  /** @brief Get the min and max of the finite values of the matrix.
+   *
+   * @return the limits, or {NaN, NaN} if there are no finite values.
+   */
+  Lim_f getValueLim() const noexcept;
+
+ private:
+  struct ReducedLevel {
+    std::size_t num_rows;
+    std::size_t num_columns;
+    std::vector<float> min, max, mean;
+  };
+
+  std::span<const float> m_values;
+  std::size_t m_num_rows{0u};
+  std::size_t m_num_columns{0u};
+  std::vector<ReducedLevel> m_levels;
+};
+
+}  // namespace cmp
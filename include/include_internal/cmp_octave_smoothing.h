@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_octave_smoothing.h
+ *
+ * @brief Fractional octave smoothing of e.g. FFT magnitudes.
+ *
+ * @ingroup CustomMatPlotInternal
+ *
+ * @author Frans Rosencrantz
+ * Contact: Frans.Rosencrantz@gmail.com
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace cmp {
+
+/**
+ * \class FractionalOctaveSmoother
+ * \brief Averages each sample over a fraction of an octave around its x-value.
+ *
+ * The window of a sample with the x-value 'f' spans
+ * [f * 2^(-fraction / 2), f * 2^(fraction / 2)]. The bounds of the windows
+ * are found once per x-data and fraction, as fractional sample indices, so
+ * that a window may start and end inside a sample. Each update then takes
+ * the difference of two interpolated prefix sums per sample, i.e. O(samples)
+ * regardless of the window sizes.
+ */
+class FractionalOctaveSmoother {
+ public:
+  /** @brief Compute the windows of the samples.
+   *
+   * The x-data must be sorted in increasing order, otherwise the y-data is
+   * not smoothed. Samples with an x-value of zero or less are not smoothed.
+   *
+   * @param x_data the x-values, e.g. the frequencies of the FFT bins.
+   * @param octave_fraction the width of a window in octaves, e.g. 1/3.
+   * @return void.
+   */
+  void setWindows(const std::vector<float> &x_data,
+                  const float octave_fraction);
+
+  /** @brief Check if the windows were computed for the x-data and fraction.
+   *
+   * @param x_data the x-values.
+   * @param octave_fraction the width of a window in octaves.
+   * @return true if the windows are up to date.
+   */
+  bool hasWindowsFor(const std::vector<float> &x_data,
+                     const float octave_fraction) const noexcept;
+
+  /** @brief Smooth y-data of the same size as the x-data of the windows.
+   *
+   * Non-finite values are left out of the windows, a window without any
+   * finite value results in NaN. If the size does not match, or the x-data
+   * is not sorted, the y-data is copied.
+   *
+   * @param y_data the y-values.
+   * @param smoothed_y_data the smoothed y-values, resized if needed.
+   * @return void.
+   */
+  void smooth(const std::vector<float> &y_data,
+              std::vector<float> &smoothed_y_data);
+
+ private:
+  // Window [first + first_fraction, last + last_fraction) in sample indices.
+  struct Window {
+    std::size_t first;
+    float first_fraction;
+    std::size_t last;
+    float last_fraction;
+  };
+
+  std::vector<float> m_x_data;
+  float m_octave_fraction{0.0f};
+  bool m_is_x_data_sorted{false};
+  std::vector<Window> m_windows;
+
+  // Prefix sums of the finite values and of their count.
+  std::vector<double> m_sums;
+  std::vector<double> m_counts;
+};
+
+}  // namespace cmp
@@ -0,0 +1,101 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_persistence_buffer.h
+ *
+ * @brief Decaying accumulation buffer of rasterized graph lines.
+ *
+ * @ingroup CustomMatPlotInternal
+ *
+ * @author Frans Rosencrantz
+ * Contact: Frans.Rosencrantz@gmail.com
+ *
+ */
+
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <vector>
+
+#include "cmp_datamodels.h"
+
+namespace cmp {
+
+/**
+ * \class PersistenceBuffer
+ * \brief The intensity of each pixel of a persistence (phosphor) display.
+ *
+ * The new traces are added to a separate buffer at O(new points) each, which
+ * is added to the decayed intensities once per frame. So the O(width x height)
+ * work is done per frame regardless of the update rate and of how many earlier
+ * traces are still visible.
+ */
+class PersistenceBuffer {
+ public:
+  /** Number of colours of a colour map, from zero to full intensity. */
+  static constexpr std::size_t colour_map_size = 256u;
+
+  /** @brief Set the size in pixels, the intensities are cleared if the size
+   * is changed.
+   *
+   * @param width the width.
+   * @param height the height.
+   * @return void.
+   */
+  void setSize(const int width, const int height);
+
+  /** @brief Set all intensities to zero. */
+  void clear() noexcept;
+
+  /** @brief Multiply all intensities with a factor.
+   *
+   * @param factor the decay factor, between 0 and 1.
+   * @return void.
+   */
+  void decay(const float factor) noexcept;
+
+  /** @brief Add the line segments between the pixel points.
+   *
+   * Each pixel that a segment passes adds one to the intensity. The segments
+   * are clipped to the buffer, non-finite points break the line.
+   *
+   * @param pixel_points the pixel points.
+   * @return void.
+   */
+  void addLines(const PixelPoints &pixel_points);
+
+  /** @brief Add the intensities of a buffer of the same size.
+   *
+   * @param other the buffer to add, ignored if the size differs.
+   * @return void.
+   */
+  void add(const PersistenceBuffer &other) noexcept;
+
+  /** @brief Render the intensities to an ARGB image of the same size.
+   *
+   * Intensities of one or more get the last colour of the colour map.
+   *
+   * @param image the image, resized if needed.
+   * @param colour_map 'colour_map_size' premultiplied colours.
+   * @return void.
+   */
+  void renderTo(juce::Image &image,
+                const std::vector<juce::PixelARGB> &colour_map) const;
+
+  /** @brief Get the intensity of a pixel. */
+  float getIntensity(const int x, const int y) const noexcept;
+
+ private:
+  void addSegment(juce::Point<float> start, juce::Point<float> end);
+
+  std::vector<float> m_intensities;
+  int m_width{0}, m_height{0};
+};
+
+}  // namespace cmp
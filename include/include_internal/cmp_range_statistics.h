@@ -0,0 +1,100 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_range_statistics.h
+ *
+ * @brief Index for min, max, mean and RMS over any range of y-data.
+ *
+ * @ingroup CustomMatPlotInternal
+ *
+ * @author Frans Rosencrantz
+ * Contact: Frans.Rosencrantz@gmail.com
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace cmp {
+
+/**
+ * \class RangeStatistics
+ * \brief An index to get the statistics of any range of y-data without
+ * scanning the range.
+ *
+ * The data is split in blocks of 'block_size' samples. For each complete block
+ * the prefix sums of y and y² and the prefix count of non-NaN samples are
+ * stored together with a sparse table of the block min/max values. A range is
+ * resolved from the prefix sums and two sparse table lookups plus a scan of at
+ * most two partial blocks, i.e. in constant time independent of the range
+ * length. Storing the prefix sums per block instead of per sample keeps the
+ * memory small for lines with millions of samples.
+ *
+ * The index does not own the data, the same data must be passed to update()
+ * and getStatistics(). NaN values are skipped.
+ */
+class RangeStatistics {
+ public:
+  /** Number of samples per block. */
+  static constexpr std::size_t block_size = 256u;
+
+  /** @brief The statistics of a range of samples. */
+  struct Values {
+    float min, max, mean, rms;
+
+    /** Number of samples in the range that are not NaN. */
+    std::size_t num_samples;
+  };
+
+  /** @brief Index the complete blocks of y_data that are not yet indexed.
+   *
+   * Only the new blocks are indexed if y_data has been appended since the last
+   * update. Call invalidateFrom() first if indexed samples have changed.
+   *
+   * @param y_data the y-data.
+   * @return void.
+   */
+  void update(std::span<const float> y_data);
+
+  /** @brief Drop the index of all blocks from the block containing 'index'.
+   *
+   * @param index the first changed sample.
+   * @return void.
+   */
+  void invalidateFrom(const std::size_t index);
+
+  /** @brief Get the number of samples covered by the index. */
+  std::size_t getNumIndexedSamples() const noexcept;
+
+  /** @brief Get the statistics of the samples [first, last).
+   *
+   * @param y_data the y-data, indexed with update().
+   * @param first the first sample.
+   * @param last one past the last sample.
+   * @return the statistics, or nothing if the range has no non-NaN samples.
+   */
+  std::optional<Values> getStatistics(std::span<const float> y_data,
+                                      std::size_t first,
+                                      std::size_t last) const;
+
+ private:
+  std::size_t getNumBlocks() const noexcept;
+
+  /** Prefix values of the complete blocks, one more than the blocks. */
+  std::vector<double> m_sum{0.0}, m_sum_squared{0.0};
+  std::vector<std::size_t> m_count{0u};
+
+  /** Sparse table, level 'k' holds the min/max of 2^k blocks. */
+  std::vector<std::vector<float>> m_min, m_max;
+};
+
+}  // namespace cmp
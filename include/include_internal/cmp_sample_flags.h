@@ -0,0 +1,115 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_sample_flags.h
+ *
+ * @brief Bitmap of flagged samples with a summary of the flagged blocks.
+ *
+ * @ingroup CustomMatPlotInternal
+ *
+ * @author Frans Rosencrantz
+ * Contact: Frans.Rosencrantz@gmail.com
+ *
+ */
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cmp {
+
+/**
+ * \class SampleFlags
+ * \brief A bitmap with one bit per sample, e.g. the samples that must be kept
+ * when downsampling.
+ *
+ * Each bit of the block summary tells if any of the 64 samples of a word is
+ * flagged, so one summary word covers 4096 samples. Finding the flagged
+ * samples of a range only visits the words of the flagged blocks, i.e. the
+ * unflagged parts of the range are skipped 4096 samples at a time.
+ */
+class SampleFlags {
+ public:
+  /** Number of samples per word of the bitmap. */
+  static constexpr std::size_t samples_per_word = 64u;
+
+  /** @brief Set the flags, one per sample.
+   *
+   * @param flags true for the flagged samples.
+   * @return void.
+   */
+  void assign(const std::vector<bool>& flags);
+
+  /** @brief Remove all flags. */
+  void clear() noexcept;
+
+  /** @brief Check if no sample is flagged. */
+  bool empty() const noexcept;
+
+  /** @brief Get the number of samples, flagged or not. */
+  std::size_t size() const noexcept;
+
+  /** @brief Check if a sample is flagged.
+   *
+   * @param index the index of the sample.
+   * @return true if the sample is flagged, false if not or out of range.
+   */
+  bool test(const std::size_t index) const noexcept;
+
+  /** @brief Call 'fn(index)' for each flagged sample in [first, last) in
+   * increasing order.
+   *
+   * @param first the first sample.
+   * @param last one past the last sample.
+   * @param fn the function to call.
+   * @return void.
+   */
+  template <class Fn>
+  void forEachFlagged(const std::size_t first, std::size_t last,
+                      Fn&& fn) const {
+    if (last > m_size) last = m_size;
+    if (first >= last || m_num_flagged == 0u) return;
+
+    const auto first_word = first / samples_per_word;
+    const auto last_word = (last - 1u) / samples_per_word;
+
+    for (auto block = first_word / samples_per_word;
+         block <= last_word / samples_per_word; ++block) {
+      auto block_bits = m_block_summary[block];
+
+      for (; block_bits; block_bits &= block_bits - 1u) {
+        const auto word = block * samples_per_word +
+                          std::size_t(std::countr_zero(block_bits));
+        if (word < first_word) continue;
+        if (word > last_word) return;
+
+        auto bits = m_words[word];
+        if (word == first_word) bits &= ~0ULL << (first % samples_per_word);
+        if (word == last_word) {
+          const auto num_last = (last - 1u) % samples_per_word + 1u;
+          if (num_last < samples_per_word) bits &= (1ULL << num_last) - 1u;
+        }
+
+        for (; bits; bits &= bits - 1u) {
+          fn(word * samples_per_word + std::size_t(std::countr_zero(bits)));
+        }
+      }
+    }
+  }
+
+ private:
+  std::vector<std::uint64_t> m_words;
+  std::vector<std::uint64_t> m_block_summary;
+  std::size_t m_size{0u};
+  std::size_t m_num_flagged{0u};
+};
+
+}  // namespace cmp
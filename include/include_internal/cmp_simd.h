@@ -0,0 +1,33 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_simd.h
+ *
+ * @brief Detection of the SIMD instruction sets used by the hot loops.
+ *
+ * @details Defines CMP_USE_SSE2 on x86 with SSE2 and CMP_USE_NEON on AArch64,
+ * and includes the intrinsics of the instruction set. Code using them must
+ * have a scalar fallback for when neither is defined.
+ *
+ * @ingroup CustomMatPlotInternal
+ *
+ * @author Frans Rosencrantz
+ * Contact: Frans.Rosencrantz@gmail.com
+ *
+ */
+
+#pragma once
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CMP_USE_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#define CMP_USE_NEON 1
+#include <arm_neon.h>
+#endif
@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_trigger.h
+ *
+ * @brief Level crossing search for triggered plots.
+ *
+ * @ingroup CustomMatPlotInternal
+ *
+ * @author Frans Rosencrantz
+ * Contact: Frans.Rosencrantz@gmail.com
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "cmp_datamodels.h"
+
+namespace cmp {
+
+/**
+ * \class TriggerSearch
+ * \brief Finds the level crossings of a trigger in y-data.
+ *
+ * The search alternates between finding the first sample that arms the
+ * trigger and the first sample that crosses the level. Both are a search for
+ * the first sample on one side of a threshold, which is done with SSE2 or NEON
+ * on 16 samples per iteration when available.
+ */
+class TriggerSearch {
+ public:
+  /** @brief Find the last level crossing of a trigger in a range.
+   *
+   * The samples before 'first' may arm the trigger, but only crossings in
+   * [first, last) are returned. NaN neither arms nor crosses.
+   *
+   * @param trigger the trigger.
+   * @param y_data the y-data.
+   * @param first the first index where a crossing is accepted.
+   * @param last one past the last index where a crossing is accepted.
+   * @return the index of the first sample after the crossing, or nothing if
+   * there is no crossing in the range.
+   */
+  static std::optional<std::size_t> findLastCrossing(
+      const Trigger &trigger, std::span<const float> y_data,
+      const std::size_t first, std::size_t last);
+
+  /** @brief Find the first sample below a threshold.
+   *
+   * @param data the data.
+   * @param first the first index.
+   * @param last one past the last index.
+   * @param threshold the threshold.
+   * @return the index of the first sample below the threshold, or 'last'.
+   */
+  static std::size_t findFirstBelow(const float *data, std::size_t first,
+                                    const std::size_t last,
+                                    const float threshold) noexcept;
+
+  /** @brief Find the first sample at or above a threshold.
+   *
+   * @see findFirstBelow, but at or above.
+   */
+  static std::size_t findFirstAtOrAbove(const float *data, std::size_t first,
+                                        const std::size_t last,
+                                        const float threshold) noexcept;
+
+  /** @brief Find the first sample above a threshold.
+   *
+   * @see findFirstBelow, but above.
+   */
+  static std::size_t findFirstAbove(const float *data, std::size_t first,
+                                    const std::size_t last,
+                                    const float threshold) noexcept;
+
+  /** @brief Find the first sample at or below a threshold.
+   *
+   * @see findFirstBelow, but at or below.
+   */
+  static std::size_t findFirstAtOrBelow(const float *data, std::size_t first,
+                                        const std::size_t last,
+                                        const float threshold) noexcept;
+};
+
+}  // namespace cmp
@@ -83,6 +83,111 @@ struct AreLabelsSet {
 
 /*============================================================================*/
 
+/** @brief Call 'fn(vertex)' for the vertices of a step line through the pixel
+ * points, i.e. the pixel points with the corners of the steps in between.
+ *
+ * @param pixel_points the pixel points.
+ * @param step_type where the steps are.
+ * @param fn the function to call.
+ * @return void.
+ */
+template <class Fn>
+void forEachStepVertex(const PixelPoints& pixel_points,
+                       const StepType step_type, Fn&& fn) {
+  if (pixel_points.empty()) return;
+
+  fn(pixel_points.front());
+  for (auto it = pixel_points.begin() + 1; it != pixel_points.end(); ++it) {
+    const auto& previous = *std::prev(it);
+    const auto& point = *it;
+
+    switch (step_type) {
+      case StepType::pre:
+        fn(juce::Point<float>(previous.getX(), point.getY()));
+        break;
+      case StepType::post:
+        fn(juce::Point<float>(point.getX(), previous.getY()));
+        break;
+      case StepType::mid: {
+        const auto mid_x = (previous.getX() + point.getX()) * 0.5f;
+        fn(juce::Point<float>(mid_x, previous.getY()));
+        fn(juce::Point<float>(mid_x, point.getY()));
+        break;
+      }
+      default:
+        break;
+    }
+
+    fn(point);
+  }
+}
+
+/** @brief Move the collapsed runs of pixel points onto lines outside the graph.
+ *
+ * A run collapsed by Downsampler::collapseIdxsOutsideYLim keeps the pixel
+ * points of its first and last sample. They are moved onto the line above or
+ * below the graph bounds, to where the segments into and out of the run cross
+ * it, so the visible part of the line is unchanged and the rest is drawn
+ * along the line. A run at the start or end of the line is clamped at its own
+ * x-value.
+ *
+ * @param pixel_points the pixel points, with the collapsed runs.
+ * @param run_positions the position of the first pixel point of each run.
+ * @param y_top the y-pixel of the line above the graph bounds.
+ * @param y_bottom the y-pixel of the line below the graph bounds.
+ * @param keep_x true to clamp the runs at the x-values of their first and
+ * last point instead of the crossings, e.g. for step lines.
+ */
+static void clampCollapsedRuns(PixelPoints& pixel_points,
+                               const std::vector<std::size_t>& run_positions,
+                               const float y_top, const float y_bottom,
+                               const bool keep_x) {
+  const auto num_points = pixel_points.size();
+
+  // Runs can be adjacent, the entry of a run is found from the unclamped
+  // last point of the run before.
+  auto last_unclamped = juce::Point<float>();
+  auto last_unclamped_i = num_points;
+
+  for (const auto i : run_positions) {
+    const auto last = i + 1u;
+    if (last >= num_points) break;
+
+    const auto y = pixel_points[i].getY() < (y_top + y_bottom) * 0.5f
+                       ? y_top
+                       : y_bottom;
+
+    // The x-value where the segment from a point outside the run to a point
+    // in the run crosses the line.
+    const auto getCrossingX = [&](const juce::Point<float>& from,
+                                  const juce::Point<float>& to) {
+      const auto t = (y - from.getY()) / (to.getY() - from.getY());
+
+      return keep_x || !std::isfinite(t)
+                 ? to.getX()
+                 : from.getX() + t * (to.getX() - from.getX());
+    };
+
+    auto entry_x = pixel_points[i].getX();
+    if (i > 0u) {
+      const auto& before =
+          i - 1u == last_unclamped_i ? last_unclamped : pixel_points[i - 1u];
+      entry_x = getCrossingX(before, pixel_points[i]);
+    }
+
+    const auto exit_x = last + 1u < num_points
+                            ? getCrossingX(pixel_points[last + 1u],
+                                           pixel_points[last])
+                            : pixel_points[last].getX();
+
+    last_unclamped = pixel_points[last];
+    last_unclamped_i = last;
+
+    pixel_points[i] = {entry_x, y};
+    pixel_points[last] = {exit_x, y};
+  }
+}
+
 static GraphLineDataViewList createGraphLineDataViewList(
     const GraphLines& graph_lines) {
   GraphLineDataViewList graph_line_data_view_list;
@@ -234,6 +339,30 @@ constexpr auto getYScaleAndOffset =
   return {y_scale, y_offset};
 };
 
+static float getXPixelCoordinateFromXData(const float x,
+                                          const juce::Rectangle<float>& bounds,
+                                          const Lim_f x_lim,
+                                          const Scaling x_scaling) noexcept {
+  const auto [x_scale, x_offset] =
+      getXScaleAndOffset(bounds.getWidth(), x_lim, x_scaling);
+
+  return bounds.getX() + (x_scaling == Scaling::logarithmic
+                              ? getXPixelValueLogarithmic(x, x_scale, x_offset)
+                              : getXPixelValueLinear(x, x_scale, x_offset));
+}
+
+static float getYPixelCoordinateFromYData(const float y,
+                                          const juce::Rectangle<float>& bounds,
+                                          const Lim_f y_lim,
+                                          const Scaling y_scaling) noexcept {
+  const auto [y_scale, y_offset] =
+      getYScaleAndOffset(bounds.getHeight(), y_lim, y_scaling);
+
+  return bounds.getY() + (y_scaling == Scaling::logarithmic
+                              ? getYPixelValueLogarithmic(y, y_scale, y_offset)
+                              : getYPixelValueLinear(y, y_scale, y_offset));
+}
+
 /*============================================================================*/
 /*========================= Utility functions ================================*/
 /*============================================================================*/
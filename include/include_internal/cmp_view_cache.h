@@ -0,0 +1,116 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * @file cmp_view_cache.h
+ *
+ * @brief Bounded LRU cache of results computed for a view of the plot.
+ *
+ * @ingroup CustomMatPlotInternal
+ *
+ * @author Frans Rosencrantz
+ * Contact: Frans.Rosencrantz@gmail.com
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <utility>
+
+#include "cmp_datamodels.h"
+
+namespace cmp {
+
+/**
+ * \struct ViewKey
+ * \brief The view that a cached result was computed for.
+ */
+struct ViewKey {
+  Lim_f x_lim, y_lim;
+  juce::Rectangle<int> graph_bounds;
+  Scaling x_scaling, y_scaling;
+
+  /** Incremented by the owner of the cache when the input data or any other
+   * setting that affects the result is changed. */
+  std::size_t generation;
+
+  bool operator==(const ViewKey& rhs) const noexcept {
+    return x_lim == rhs.x_lim && y_lim == rhs.y_lim &&
+           graph_bounds == rhs.graph_bounds && x_scaling == rhs.x_scaling &&
+           y_scaling == rhs.y_scaling && generation == rhs.generation;
+  }
+};
+
+/**
+ * \class ViewCache
+ * \brief A bounded LRU cache of results computed for a view.
+ *
+ * Used to restore the pixel points and grid layout of recently seen views,
+ * e.g. when going back in the zoom history, without recomputing them. The
+ * number of entries is small, so the entries are searched linearly.
+ */
+template <class ValueType>
+class ViewCache {
+ public:
+  /** Number of views kept by default. */
+  static constexpr std::size_t default_capacity = 8u;
+
+  explicit ViewCache(const std::size_t capacity = default_capacity)
+      : m_capacity{capacity} {}
+
+  /** @brief Find the result of a view and mark it as most recently used.
+   *
+   * @param key the view.
+   * @return the result or nullptr if the view is not cached.
+   */
+  const ValueType* find(const ViewKey& key) {
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+      if (it->first == key) {
+        m_entries.splice(m_entries.begin(), m_entries, it);
+        return &m_entries.front().second;
+      }
+    }
+
+    return nullptr;
+  }
+
+  /** @brief Store the result of a view, the least recently used view is
+   * dropped if the cache is full.
+   *
+   * @param key the view.
+   * @param value the result.
+   * @return void.
+   */
+  void insert(const ViewKey& key, ValueType value) {
+    if (m_capacity == 0u) return;
+
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+      if (it->first == key) {
+        m_entries.erase(it);
+        break;
+      }
+    }
+
+    if (m_entries.size() >= m_capacity) m_entries.pop_back();
+
+    m_entries.emplace_front(key, std::move(value));
+  }
+
+  /** @brief Remove all cached views. */
+  void clear() noexcept { m_entries.clear(); }
+
+  /** @brief Get the number of cached views. */
+  std::size_t size() const noexcept { return m_entries.size(); }
+
+ private:
+  std::list<std::pair<ViewKey, ValueType>> m_entries;
+  std::size_t m_capacity;
+};
+
+}  // namespace cmp
@@ -0,0 +1,232 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "cmp_derived_trace.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "cmp_simd.h"
+
+namespace cmp {
+
+namespace {
+
+/** values = max(values, live), a NaN of either picks the other. */
+void updateMaxHold(const float* live, float* values,
+                   const std::size_t size) noexcept {
+  std::size_t i = 0u;
+
+#if CMP_USE_SSE2
+  for (; i + 4u <= size; i += 4u) {
+    const auto l = _mm_loadu_ps(live + i);
+    const auto v = _mm_loadu_ps(values + i);
+    // _mm_max_ps returns the second operand if either is NaN.
+    const auto max = _mm_max_ps(l, v);
+    const auto is_v_nan = _mm_cmpunord_ps(v, v);
+    _mm_storeu_ps(values + i, _mm_or_ps(_mm_and_ps(is_v_nan, l),
+                                        _mm_andnot_ps(is_v_nan, max)));
+  }
+#elif CMP_USE_NEON
+  for (; i + 4u <= size; i += 4u) {
+    vst1q_f32(values + i, vmaxnmq_f32(vld1q_f32(live + i), vld1q_f32(values + i)));
+  }
+#endif
+
+  for (; i < size; ++i) {
+    if (std::isnan(values[i]) || live[i] > values[i]) values[i] = live[i];
+  }
+}
+
+/** values = min(values, live), a NaN of either picks the other. */
+void updateMinHold(const float* live, float* values,
+                   const std::size_t size) noexcept {
+  std::size_t i = 0u;
+
+#if CMP_USE_SSE2
+  for (; i + 4u <= size; i += 4u) {
+    const auto l = _mm_loadu_ps(live + i);
+    const auto v = _mm_loadu_ps(values + i);
+    const auto min = _mm_min_ps(l, v);
+    const auto is_v_nan = _mm_cmpunord_ps(v, v);
+    _mm_storeu_ps(values + i, _mm_or_ps(_mm_and_ps(is_v_nan, l),
+                                        _mm_andnot_ps(is_v_nan, min)));
+  }
+#elif CMP_USE_NEON
+  for (; i + 4u <= size; i += 4u) {
+    vst1q_f32(values + i, vminnmq_f32(vld1q_f32(live + i), vld1q_f32(values + i)));
+  }
+#endif
+
+  for (; i < size; ++i) {
+    if (std::isnan(values[i]) || live[i] < values[i]) values[i] = live[i];
+  }
+}
+
+/** values += smoothing * (live - values), a NaN of either picks the other. */
+void updateExponentialAverage(const float* live, float* values,
+                              const std::size_t size,
+                              const float smoothing) noexcept {
+  std::size_t i = 0u;
+
+#if CMP_USE_SSE2
+  const auto smoothing_4 = _mm_set1_ps(smoothing);
+  for (; i + 4u <= size; i += 4u) {
+    const auto l = _mm_loadu_ps(live + i);
+    const auto v = _mm_loadu_ps(values + i);
+    const auto average =
+        _mm_add_ps(v, _mm_mul_ps(smoothing_4, _mm_sub_ps(l, v)));
+    const auto is_l_nan = _mm_cmpunord_ps(l, l);
+    const auto is_v_nan = _mm_cmpunord_ps(v, v);
+    const auto skip_nan = _mm_or_ps(_mm_and_ps(is_l_nan, v),
+                                    _mm_andnot_ps(is_l_nan, average));
+    _mm_storeu_ps(values + i, _mm_or_ps(_mm_and_ps(is_v_nan, l),
+                                        _mm_andnot_ps(is_v_nan, skip_nan)));
+  }
+#elif CMP_USE_NEON
+  for (; i + 4u <= size; i += 4u) {
+    const auto l = vld1q_f32(live + i);
+    const auto v = vld1q_f32(values + i);
+    const auto average = vmlaq_n_f32(v, vsubq_f32(l, v), smoothing);
+    const auto skip_nan = vbslq_f32(vceqq_f32(l, l), average, v);
+    vst1q_f32(values + i, vbslq_f32(vceqq_f32(v, v), skip_nan, l));
+  }
+#endif
+
+  for (; i < size; ++i) {
+    if (std::isnan(values[i])) {
+      values[i] = live[i];
+    } else if (!std::isnan(live[i])) {
+      values[i] += smoothing * (live[i] - values[i]);
+    }
+  }
+}
+
+/** sum += added - removed. */
+void updateSum(const float* added, const float* removed, float* sum,
+               const std::size_t size) noexcept {
+  std::size_t i = 0u;
+
+#if CMP_USE_SSE2
+  for (; i + 4u <= size; i += 4u) {
+    _mm_storeu_ps(sum + i,
+                  _mm_add_ps(_mm_loadu_ps(sum + i),
+                             _mm_sub_ps(_mm_loadu_ps(added + i),
+                                        _mm_loadu_ps(removed + i))));
+  }
+#elif CMP_USE_NEON
+  for (; i + 4u <= size; i += 4u) {
+    vst1q_f32(sum + i, vaddq_f32(vld1q_f32(sum + i),
+                                 vsubq_f32(vld1q_f32(added + i),
+                                           vld1q_f32(removed + i))));
+  }
+#endif
+
+  for (; i < size; ++i) sum[i] += added[i] - removed[i];
+}
+
+/** values = sum * factor. */
+void scale(const float* sum, float* values, const std::size_t size,
+           const float factor) noexcept {
+  std::size_t i = 0u;
+
+#if CMP_USE_SSE2
+  const auto factor_4 = _mm_set1_ps(factor);
+  for (; i + 4u <= size; i += 4u) {
+    _mm_storeu_ps(values + i, _mm_mul_ps(_mm_loadu_ps(sum + i), factor_4));
+  }
+#elif CMP_USE_NEON
+  for (; i + 4u <= size; i += 4u) {
+    vst1q_f32(values + i, vmulq_n_f32(vld1q_f32(sum + i), factor));
+  }
+#endif
+
+  for (; i < size; ++i) values[i] = sum[i] * factor;
+}
+
+}  // namespace
+
+DerivedTraceState::DerivedTraceState(const DerivedTrace& derived_trace)
+    : m_derived_trace{derived_trace} {
+  m_derived_trace.smoothing = std::clamp(m_derived_trace.smoothing, 0.0f, 1.0f);
+  m_derived_trace.num_frames = std::max<std::size_t>(m_derived_trace.num_frames, 1u);
+}
+
+const DerivedTrace& DerivedTraceState::getDerivedTrace() const noexcept {
+  return m_derived_trace;
+}
+
+void DerivedTraceState::update(std::span<const float> live_y_data,
+                               std::vector<float>& values) {
+  if (values.size() != live_y_data.size()) reset();
+
+  if (m_derived_trace.type == DerivedTraceType::average) {
+    updateAverage(live_y_data, values);
+    return;
+  }
+
+  if (m_num_frames++ == 0u) {
+    values.assign(live_y_data.begin(), live_y_data.end());
+    return;
+  }
+
+  switch (m_derived_trace.type) {
+    case DerivedTraceType::max_hold:
+      updateMaxHold(live_y_data.data(), values.data(), values.size());
+      break;
+    case DerivedTraceType::min_hold:
+      updateMinHold(live_y_data.data(), values.data(), values.size());
+      break;
+    case DerivedTraceType::exponential_average:
+      updateExponentialAverage(live_y_data.data(), values.data(),
+                               values.size(), m_derived_trace.smoothing);
+      break;
+    default:
+      break;
+  }
+}
+
+void DerivedTraceState::updateAverage(std::span<const float> live_y_data,
+                                      std::vector<float>& values) {
+  const auto size = live_y_data.size();
+  const auto num_history_frames = m_derived_trace.num_frames;
+
+  if (m_num_frames == 0u) {
+    m_history.assign(num_history_frames, std::vector<float>(size, 0.0f));
+    m_sum.assign(size, 0.0f);
+    m_history_index = 0u;
+  }
+
+  // Before the history is full the removed frame is all zeros.
+  auto& oldest = m_history[m_history_index];
+  updateSum(live_y_data.data(), oldest.data(), m_sum.data(), size);
+  std::copy(live_y_data.begin(), live_y_data.end(), oldest.begin());
+
+  m_num_frames++;
+  m_history_index = (m_history_index + 1u) % num_history_frames;
+
+  // Recomputed from the history once per lap so rounding errors and NaNs
+  // that have left the history do not stay in the sum.
+  if (m_history_index == 0u) {
+    std::fill(m_sum.begin(), m_sum.end(), 0.0f);
+    for (const auto& frame : m_history) {
+      for (std::size_t i = 0u; i < size; ++i) m_sum[i] += frame[i];
+    }
+  }
+
+  values.resize(size);
+  scale(m_sum.data(), values.data(), size,
+        1.0f / float(std::min(m_num_frames, num_history_frames)));
+}
+
+void DerivedTraceState::reset() noexcept { m_num_frames = 0u; }
+
+std::size_t DerivedTraceState::getNumFrames() const noexcept {
+  return m_num_frames;
+}
+
+}  // namespace cmp
@@ -8,9 +8,16 @@
 #include "cmp_downsampler.h"
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
 
 #include "cmp_datamodels.h"
+#include "cmp_simd.h"
 #include "cmp_utils.h"
 
 namespace cmp {
@@ -29,12 +36,19 @@ namespace {
     };
 
     template<class FloatType>
-    MinMaxIndices<FloatType> findMinMaxIndices(const std::vector<FloatType>& y_data, 
+    MinMaxIndices<FloatType> findMinMaxIndices(std::span<const FloatType> y_data, 
                                    size_t start_idx, 
                                    size_t end_idx) {
-        MinMaxIndices<FloatType> result{start_idx, start_idx, y_data[start_idx], y_data[start_idx]};
-        
-        for (auto idx = start_idx + 1; idx < end_idx; ++idx) {
+        // Start from the first value that is not NaN, otherwise every
+        // comparison below is false and the min/max are never found.
+        auto first_idx = start_idx;
+        while (first_idx + 1 < end_idx && std::isnan(y_data[first_idx])) {
+            ++first_idx;
+        }
+
+        MinMaxIndices<FloatType> result{first_idx, first_idx, y_data[first_idx], y_data[first_idx]};
+
+        for (auto idx = first_idx + 1; idx < end_idx; ++idx) {
             auto y_value = y_data[idx];
             if (y_value < result.min_val) {
                 result.min_val = y_value;
@@ -100,23 +114,20 @@ namespace {
         size_t max_idx;
     };
 
-    template <class FloatType>
-    void processPixelColumn(const std::vector<FloatType>& y_data,
-                           size_t start_idx,
-                           size_t end_idx,
-                           fast_vector<std::size_t>& xy_indices) {
-        if (end_idx - start_idx <= MAX_POINTS_PER_PIXEL) {
-            // For small segments, include all points
-            for (auto i = start_idx; i < end_idx; ++i) {
-                xy_indices.push_back(i);
-            }
-            return;
+    void appendSmallPixelColumn(size_t start_idx,
+                                size_t end_idx,
+                                fast_vector<std::size_t>& xy_indices) {
+        // For small segments, include all points
+        for (auto i = start_idx; i < end_idx; ++i) {
+            xy_indices.push_back(i);
         }
+    }
 
-        // Find min/max points in this column
-        auto [min_idx, max_idx, min_val, max_val] = 
-            findMinMaxIndices(y_data, start_idx, end_idx);
-
+    void appendPixelColumn(size_t start_idx,
+                           size_t end_idx,
+                           size_t min_idx,
+                           size_t max_idx,
+                           fast_vector<std::size_t>& xy_indices) {
         // Always include the start point
         xy_indices.push_back(start_idx);
 
@@ -134,6 +145,396 @@ namespace {
             xy_indices.push_back_if_not_in_back(end_idx - 1);
         }
     }
+
+    template <class FloatType>
+    void processPixelColumn(std::span<const FloatType> y_data,
+                           size_t start_idx,
+                           size_t end_idx,
+                           fast_vector<std::size_t>& xy_indices) {
+        if (end_idx - start_idx <= MAX_POINTS_PER_PIXEL) {
+            appendSmallPixelColumn(start_idx, end_idx, xy_indices);
+            return;
+        }
+
+        // Find min/max points in this column
+        const auto [min_idx, max_idx, min_val, max_val] =
+            findMinMaxIndices(y_data, start_idx, end_idx);
+
+        appendPixelColumn(start_idx, end_idx, min_idx, max_idx, xy_indices);
+    }
+
+    constexpr size_t BATCH_ACCUMULATORS = 8u;  // Independent min/max per channel
+
+    /**
+     * Same result as findMinMaxIndices, but the min/max values and their
+     * indices are tracked in BATCH_ACCUMULATORS independent lanes over the
+     * contiguous samples, a fixed width loop of selects the compiler can turn
+     * into vector instructions. Each lane keeps the first occurrence of its
+     * min/max, and ties between the lanes go to the lowest index, which is
+     * the index findMinMaxIndices keeps since NaN values compare false and a
+     * new min can never be a new max.
+     */
+    template <class FloatType>
+    std::pair<size_t, size_t> findMinMaxIndicesVectorized(std::span<const FloatType> y_data,
+                                                          size_t start_idx,
+                                                          size_t end_idx) {
+        auto first_idx = start_idx;
+        while (first_idx + 1 < end_idx && std::isnan(y_data[first_idx])) {
+            ++first_idx;
+        }
+
+        std::array<FloatType, BATCH_ACCUMULATORS> min_val, max_val;
+        std::array<size_t, BATCH_ACCUMULATORS> min_idx, max_idx;
+        min_val.fill(y_data[first_idx]);
+        max_val.fill(y_data[first_idx]);
+        min_idx.fill(first_idx);
+        max_idx.fill(first_idx);
+
+        const auto* y = y_data.data();
+        auto idx = first_idx;
+        for (; idx + BATCH_ACCUMULATORS <= end_idx; idx += BATCH_ACCUMULATORS) {
+            for (size_t k = 0u; k < BATCH_ACCUMULATORS; ++k) {
+                const auto v = y[idx + k];
+                const auto is_min = v < min_val[k];
+                const auto is_max = v > max_val[k];
+                min_val[k] = is_min ? v : min_val[k];
+                min_idx[k] = is_min ? idx + k : min_idx[k];
+                max_val[k] = is_max ? v : max_val[k];
+                max_idx[k] = is_max ? idx + k : max_idx[k];
+            }
+        }
+        for (; idx < end_idx; ++idx) {
+            if (y[idx] < min_val[0]) {
+                min_val[0] = y[idx];
+                min_idx[0] = idx;
+            } else if (y[idx] > max_val[0]) {
+                max_val[0] = y[idx];
+                max_idx[0] = idx;
+            }
+        }
+
+        size_t min_lane = 0u, max_lane = 0u;
+        for (size_t k = 1u; k < BATCH_ACCUMULATORS; ++k) {
+            if (min_val[k] < min_val[min_lane] ||
+                (min_val[k] == min_val[min_lane] && min_idx[k] < min_idx[min_lane])) {
+                min_lane = k;
+            }
+            if (max_val[k] > max_val[max_lane] ||
+                (max_val[k] == max_val[max_lane] && max_idx[k] < max_idx[max_lane])) {
+                max_lane = k;
+            }
+        }
+
+        return {min_idx[min_lane], max_idx[max_lane]};
+    }
+
+    constexpr size_t SWEEP_CHANNELS = 4u;  // Channels per transposed block
+    constexpr size_t MIN_POINTS_PER_SWEEP_COLUMN = 64u;  // Below this the per channel scan is faster
+
+#if CMP_USE_SSE2 || CMP_USE_NEON
+    /** Min/max values of one sample of each of the SWEEP_CHANNELS channels and
+     * their offsets into the pixel column. */
+    struct SweepAccumulator {
+#if CMP_USE_SSE2
+        __m128 min_val, max_val;
+        __m128i min_offset, max_offset;
+#else
+        float32x4_t min_val, max_val;
+        uint32x4_t min_offset, max_offset;
+#endif
+    };
+
+    SweepAccumulator makeSweepAccumulator() noexcept {
+        constexpr auto inf = std::numeric_limits<float>::infinity();
+#if CMP_USE_SSE2
+        return {_mm_set1_ps(inf), _mm_set1_ps(-inf), _mm_set1_epi32(-1), _mm_set1_epi32(-1)};
+#else
+        return {vdupq_n_f32(inf), vdupq_n_f32(-inf), vdupq_n_u32(UINT32_MAX), vdupq_n_u32(UINT32_MAX)};
+#endif
+    }
+
+    /** Keeps the first occurrence of a value below the min/above the max. */
+    void updateSweepAccumulator(SweepAccumulator& acc,
+#if CMP_USE_SSE2
+                                const __m128 values,
+#else
+                                const float32x4_t values,
+#endif
+                                const uint32_t offset) noexcept {
+#if CMP_USE_SSE2
+        const auto offsets = _mm_set1_epi32(int(offset));
+        const auto is_min = _mm_cmplt_ps(values, acc.min_val);
+        const auto is_max = _mm_cmpgt_ps(values, acc.max_val);
+        acc.min_val = _mm_or_ps(_mm_and_ps(is_min, values), _mm_andnot_ps(is_min, acc.min_val));
+        acc.max_val = _mm_or_ps(_mm_and_ps(is_max, values), _mm_andnot_ps(is_max, acc.max_val));
+        const auto is_min_i = _mm_castps_si128(is_min);
+        const auto is_max_i = _mm_castps_si128(is_max);
+        acc.min_offset = _mm_or_si128(_mm_and_si128(is_min_i, offsets),
+                                      _mm_andnot_si128(is_min_i, acc.min_offset));
+        acc.max_offset = _mm_or_si128(_mm_and_si128(is_max_i, offsets),
+                                      _mm_andnot_si128(is_max_i, acc.max_offset));
+#else
+        const auto offsets = vdupq_n_u32(offset);
+        const auto is_min = vcltq_f32(values, acc.min_val);
+        const auto is_max = vcgtq_f32(values, acc.max_val);
+        acc.min_val = vbslq_f32(is_min, values, acc.min_val);
+        acc.max_val = vbslq_f32(is_max, values, acc.max_val);
+        acc.min_offset = vbslq_u32(is_min, offsets, acc.min_offset);
+        acc.max_offset = vbslq_u32(is_max, offsets, acc.max_offset);
+#endif
+    }
+
+    struct SweepLanes {
+        std::array<float, SWEEP_CHANNELS> min_val, max_val;
+        std::array<uint32_t, SWEEP_CHANNELS> min_offset, max_offset;
+    };
+
+    SweepLanes storeSweepAccumulator(const SweepAccumulator& acc) noexcept {
+        SweepLanes lanes;
+#if CMP_USE_SSE2
+        _mm_storeu_ps(lanes.min_val.data(), acc.min_val);
+        _mm_storeu_ps(lanes.max_val.data(), acc.max_val);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.min_offset.data()), acc.min_offset);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes.max_offset.data()), acc.max_offset);
+#else
+        vst1q_f32(lanes.min_val.data(), acc.min_val);
+        vst1q_f32(lanes.max_val.data(), acc.max_val);
+        vst1q_u32(lanes.min_offset.data(), acc.min_offset);
+        vst1q_u32(lanes.max_offset.data(), acc.max_offset);
+#endif
+        return lanes;
+    }
+
+    /**
+     * findMinMaxIndices of one pixel column in SWEEP_CHANNELS channels in a
+     * single sweep. Blocks of 4x4 samples are transposed so that each vector
+     * holds the same sample of every channel, and the min/max of all the
+     * channels are updated by the same instructions. The even and odd
+     * samples go to separate accumulators that are merged at the end, ties
+     * going to the lowest index, so the updates do not wait on each other.
+     *
+     * The offsets into the column are 32 bit, so the column must be shorter
+     * than UINT32_MAX. A channel without a value below +inf or above -inf,
+     * e.g. only NaN, is left to findMinMaxIndicesVectorized.
+     */
+    void findMinMaxIndicesSweep(
+        const std::array<std::span<const float>, SWEEP_CHANNELS>& y_data,
+        size_t start_idx,
+        size_t end_idx,
+        std::array<std::pair<size_t, size_t>, SWEEP_CHANNELS>& min_max_idxs) noexcept {
+        std::array<SweepAccumulator, 2u> acc{makeSweepAccumulator(), makeSweepAccumulator()};
+
+        std::array<const float*, SWEEP_CHANNELS> y;
+        for (size_t k = 0u; k < SWEEP_CHANNELS; ++k) y[k] = y_data[k].data();
+
+        auto idx = start_idx;
+        for (; idx + 4u <= end_idx; idx += 4u) {
+            const auto offset = uint32_t(idx - start_idx);
+#if CMP_USE_SSE2
+            auto row_0 = _mm_loadu_ps(y[0] + idx);
+            auto row_1 = _mm_loadu_ps(y[1] + idx);
+            auto row_2 = _mm_loadu_ps(y[2] + idx);
+            auto row_3 = _mm_loadu_ps(y[3] + idx);
+            _MM_TRANSPOSE4_PS(row_0, row_1, row_2, row_3);
+#else
+            const auto rows_01 = vtrnq_f32(vld1q_f32(y[0] + idx), vld1q_f32(y[1] + idx));
+            const auto rows_23 = vtrnq_f32(vld1q_f32(y[2] + idx), vld1q_f32(y[3] + idx));
+            const auto row_0 = vcombine_f32(vget_low_f32(rows_01.val[0]), vget_low_f32(rows_23.val[0]));
+            const auto row_1 = vcombine_f32(vget_low_f32(rows_01.val[1]), vget_low_f32(rows_23.val[1]));
+            const auto row_2 = vcombine_f32(vget_high_f32(rows_01.val[0]), vget_high_f32(rows_23.val[0]));
+            const auto row_3 = vcombine_f32(vget_high_f32(rows_01.val[1]), vget_high_f32(rows_23.val[1]));
+#endif
+            updateSweepAccumulator(acc[0], row_0, offset);
+            updateSweepAccumulator(acc[1], row_1, offset + 1u);
+            updateSweepAccumulator(acc[0], row_2, offset + 2u);
+            updateSweepAccumulator(acc[1], row_3, offset + 3u);
+        }
+
+        const auto even = storeSweepAccumulator(acc[0]);
+        const auto odd = storeSweepAccumulator(acc[1]);
+
+        for (size_t k = 0u; k < SWEEP_CHANNELS; ++k) {
+            auto min_val = even.min_val[k], max_val = even.max_val[k];
+            auto min_offset = even.min_offset[k], max_offset = even.max_offset[k];
+
+            if (odd.min_val[k] < min_val ||
+                (odd.min_val[k] == min_val && odd.min_offset[k] < min_offset)) {
+                min_val = odd.min_val[k];
+                min_offset = odd.min_offset[k];
+            }
+            if (odd.max_val[k] > max_val ||
+                (odd.max_val[k] == max_val && odd.max_offset[k] < max_offset)) {
+                max_val = odd.max_val[k];
+                max_offset = odd.max_offset[k];
+            }
+
+            for (auto i = idx; i < end_idx; ++i) {
+                const auto v = y[k][i];
+                if (v < min_val) {
+                    min_val = v;
+                    min_offset = uint32_t(i - start_idx);
+                }
+                if (v > max_val) {
+                    max_val = v;
+                    max_offset = uint32_t(i - start_idx);
+                }
+            }
+
+            if (min_offset == UINT32_MAX || max_offset == UINT32_MAX) {
+                min_max_idxs[k] = findMinMaxIndicesVectorized(y_data[k], start_idx, end_idx);
+            } else {
+                min_max_idxs[k] = {start_idx + min_offset, start_idx + max_offset};
+            }
+        }
+    }
+#endif
+
+    /**
+     * Running version of findMinMaxIndices, used when the pixel column
+     * boundaries are found in the same pass as the min/max values.
+     */
+    template <class FloatType>
+    struct RunningMinMax {
+        void reset() noexcept { has_value = false; }
+
+        void add(size_t idx, FloatType y_value) noexcept {
+            if (!has_value) {
+                // Start from the first value that is not NaN.
+                if (std::isnan(y_value)) return;
+
+                result = {idx, idx, y_value, y_value};
+                has_value = true;
+            } else if (y_value < result.min_val) {
+                result.min_val = y_value;
+                result.min_idx = idx;
+            } else if (y_value > result.max_val) {
+                result.max_val = y_value;
+                result.max_idx = idx;
+            }
+        }
+
+        /** Same as findMinMaxIndices(y_data, start_idx, end_idx). */
+        std::pair<size_t, size_t> get(size_t end_idx) const noexcept {
+            if (!has_value) return {end_idx - 1u, end_idx - 1u};
+
+            return {result.min_idx, result.max_idx};
+        }
+
+        MinMaxIndices<FloatType> result{};
+        bool has_value{false};
+    };
+
+    /**
+     * The single pass of calculateXYPixelPoints and calculateXYIdxs. Calls
+     * 'add_point' with the index of each downsampled sample in increasing
+     * order, and writes the x-indices if requested.
+     */
+    template <class FloatType, class AddPoint>
+    void forEachXYIdx(const Scaling x_scaling,
+                      const Lim<FloatType> x_lim,
+                      const juce::Rectangle<int>& graph_bounds,
+                      const std::vector<FloatType>& x_data,
+                      std::span<const FloatType> y_data,
+                      std::vector<std::size_t>* x_idxs_out,
+                      AddPoint&& add_point) {
+        // x_data & y_data must have the same size
+        jassert(x_data.size() == y_data.size());
+
+        if (x_data.empty() || x_data.size() != y_data.size()) {
+            return;
+        }
+
+        std::size_t last_added_idx = std::numeric_limits<std::size_t>::max();
+
+        const auto add_idx = [&](const std::size_t i) {
+            add_point(i);
+            last_added_idx = i;
+        };
+
+        const auto add_idx_if_not_last = [&](const std::size_t i) {
+            if (i != last_added_idx) add_idx(i);
+        };
+
+        // Handle small datasets without downsampling
+        if (x_data.size() < MIN_POINTS_FOR_DOWNSAMPLING) {
+            for (std::size_t i = 0u; i < x_data.size(); ++i) {
+                add_idx(i);
+                if (x_idxs_out) x_idxs_out->push_back(i);
+            }
+            return;
+        }
+
+        // Same as processPixelColumn, but the min/max are already found.
+        RunningMinMax<FloatType> column_min_max;
+        const auto add_pixel_column = [&](const std::size_t start_idx,
+                                          const std::size_t end_idx) {
+            if (x_idxs_out) x_idxs_out->push_back(start_idx);
+
+            if (end_idx - start_idx <= MAX_POINTS_PER_PIXEL) {
+                for (auto i = start_idx; i < end_idx; ++i) add_idx(i);
+                return;
+            }
+
+            const auto [min_idx, max_idx] = column_min_max.get(end_idx);
+
+            add_idx(start_idx);
+
+            if (min_idx < max_idx) {
+                add_idx_if_not_last(min_idx);
+                add_idx_if_not_last(max_idx);
+            } else {
+                add_idx_if_not_last(max_idx);
+                add_idx_if_not_last(min_idx);
+            }
+
+            if (end_idx - 1 != max_idx && end_idx - 1 != min_idx) {
+                add_idx_if_not_last(end_idx - 1);
+            }
+        };
+
+        // The pixel columns are found like in calculateXIndices, while the
+        // min/max of the current column is tracked in the same pass.
+        const auto [x_scale, x_offset] = getXScaleAndOffset(
+            float(graph_bounds.getWidth()), x_lim, x_scaling);
+        const auto range = findDataRange(x_lim.min, x_lim.max, x_data);
+        const auto inverse_scale = 1.0f / x_scale;
+
+        std::size_t column_start_idx = range.start_idx;
+        float last_added_x = x_data[range.start_idx];
+        float last_diff = 0.f;
+
+        column_min_max.reset();
+        column_min_max.add(range.start_idx, y_data[range.start_idx]);
+
+        for (size_t i = range.start_idx + 1; i < range.end_idx; ++i) {
+            bool is_new_column = false;
+
+            if (x_scaling == Scaling::linear) {
+                const auto current_diff = x_data[i - 1] - x_data[i];
+                is_new_column = shouldAddPoint(x_data[i], last_added_x, inverse_scale,
+                                               last_diff, current_diff);
+                last_diff = current_diff;
+            } else if (x_scaling == Scaling::logarithmic) {
+                is_new_column =
+                    std::log10(std::abs(x_data[i] / last_added_x)) > inverse_scale;
+            }
+
+            if (is_new_column) {
+                last_added_x = x_data[i];
+                add_pixel_column(column_start_idx, i);
+                column_start_idx = i;
+                column_min_max.reset();
+            }
+
+            column_min_max.add(i, y_data[i]);
+        }
+
+        add_pixel_column(column_start_idx, range.end_idx);
+
+        // Ensure the last point is included
+        add_idx_if_not_last(range.end_idx);
+        if (x_idxs_out) x_idxs_out->push_back(range.end_idx);
+    }
 }
 
 template <class ValueType>
@@ -300,7 +701,7 @@ void Downsampler<FloatType>::calculateXIndices(
 template <class FloatType>
 void Downsampler<FloatType>::calculateXYBasedIdxs(
     const std::vector<std::size_t>& x_indices,
-    const std::vector<FloatType>& y_data,
+    std::span<const FloatType> y_data,
     std::vector<std::size_t>& xy_indices_out) 
 {
     if (x_indices.empty()) {
@@ -333,5 +734,307 @@ void Downsampler<FloatType>::calculateXYBasedIdxs(
     xy_indices_out = xy_indices.get();
 }
 
+template <class FloatType>
+void Downsampler<FloatType>::calculateXYBasedIdxsBatched(
+    const std::vector<std::size_t>& x_indices,
+    const std::vector<std::vector<FloatType>>& y_data_list,
+    std::vector<std::vector<std::size_t>>& xy_indices_list_out)
+{
+    const std::vector<std::span<const FloatType>> y_data_spans(
+        y_data_list.begin(), y_data_list.end());
+
+    calculateXYBasedIdxsBatched(x_indices, y_data_spans, xy_indices_list_out);
+}
+
+template <class FloatType>
+void Downsampler<FloatType>::calculateXYBasedIdxsBatched(
+    const std::vector<std::size_t>& x_indices,
+    const std::vector<std::span<const FloatType>>& y_data_list,
+    std::vector<std::vector<std::size_t>>& xy_indices_list_out)
+{
+    xy_indices_list_out.resize(y_data_list.size());
+
+    if (y_data_list.empty()) {
+        return;
+    }
+
+    const auto data_size = y_data_list.front().size();
+    for (const auto y_data : y_data_list) {
+        if (y_data.size() != data_size) {
+            throw std::invalid_argument(
+                "All y_data must have the same size when batched.");
+        }
+    }
+
+    if (x_indices.empty() || data_size < MIN_POINTS_FOR_DOWNSAMPLING) {
+        for (size_t i = 0u; i < y_data_list.size(); ++i) {
+            calculateXYBasedIdxs(x_indices, y_data_list[i], xy_indices_list_out[i]);
+        }
+        return;
+    }
+
+    const auto num_columns = x_indices.size() - 1u;
+
+    // The columns are shared, so the upper bound of the number of output
+    // indices is the same for all channels.
+    size_t max_num_xy_indices = 1u;
+    for (size_t column = 0u; column < num_columns; ++column) {
+        max_num_xy_indices += std::min(x_indices[column + 1u] - x_indices[column],
+                                       MAX_POINTS_PER_PIXEL + 1u);
+    }
+
+    const auto appendChannel = [&](std::span<const FloatType> y_data,
+                                   std::vector<std::size_t>& xy_indices_out) {
+        // Only the bound is zero filled instead of the whole data size.
+        xy_indices_out.clear();
+        fast_vector<std::size_t> xy_indices(xy_indices_out, max_num_xy_indices);
+
+        for (size_t column = 0u; column < num_columns; ++column) {
+            const auto start_idx = x_indices[column];
+            const auto end_idx = x_indices[column + 1u];
+
+            if (end_idx - start_idx <= MAX_POINTS_PER_PIXEL) {
+                appendSmallPixelColumn(start_idx, end_idx, xy_indices);
+            } else {
+                const auto [min_idx, max_idx] =
+                    findMinMaxIndicesVectorized(y_data, start_idx, end_idx);
+                appendPixelColumn(start_idx, end_idx, min_idx, max_idx, xy_indices);
+            }
+        }
+
+        xy_indices.push_back_if_not_in_back(x_indices.back());
+    };
+
+    size_t channel = 0u;
+
+#if CMP_USE_SSE2 || CMP_USE_NEON
+    if constexpr (std::is_same_v<FloatType, float>) {
+        // Narrow columns are faster to scan one channel at a time, the
+        // transpose only pays off when there are many samples per column.
+        const auto use_sweep = x_indices.back() - x_indices.front() >=
+                               MIN_POINTS_PER_SWEEP_COLUMN * num_columns;
+
+        // Groups of SWEEP_CHANNELS channels, a group of two or three is padded
+        // with its last channel and the padded outputs are discarded.
+        while (use_sweep && y_data_list.size() - channel >= 2u) {
+            const auto group_size = std::min(SWEEP_CHANNELS, y_data_list.size() - channel);
+
+            std::array<std::span<const float>, SWEEP_CHANNELS> y_data;
+            std::array<std::vector<std::size_t>, SWEEP_CHANNELS> padded_out;
+            std::array<std::vector<std::size_t>*, SWEEP_CHANNELS> out;
+            for (size_t k = 0u; k < SWEEP_CHANNELS; ++k) {
+                const auto is_padded = k >= group_size;
+                y_data[k] = y_data_list[channel + (is_padded ? group_size - 1u : k)];
+                out[k] = is_padded ? &padded_out[k] : &xy_indices_list_out[channel + k];
+                out[k]->clear();
+            }
+
+            std::array<fast_vector<std::size_t>, SWEEP_CHANNELS> xy_indices{{
+                {*out[0], max_num_xy_indices},
+                {*out[1], max_num_xy_indices},
+                {*out[2], max_num_xy_indices},
+                {*out[3], max_num_xy_indices}}};
+
+            std::array<std::pair<size_t, size_t>, SWEEP_CHANNELS> min_max_idxs;
+            for (size_t column = 0u; column < num_columns; ++column) {
+                const auto start_idx = x_indices[column];
+                const auto end_idx = x_indices[column + 1u];
+
+                if (end_idx - start_idx <= MAX_POINTS_PER_PIXEL) {
+                    for (auto& indices : xy_indices) {
+                        appendSmallPixelColumn(start_idx, end_idx, indices);
+                    }
+                    continue;
+                }
+
+                if (end_idx - start_idx < UINT32_MAX) {
+                    findMinMaxIndicesSweep(y_data, start_idx, end_idx, min_max_idxs);
+                } else {
+                    for (size_t k = 0u; k < SWEEP_CHANNELS; ++k) {
+                        min_max_idxs[k] =
+                            findMinMaxIndicesVectorized(y_data[k], start_idx, end_idx);
+                    }
+                }
+
+                for (size_t k = 0u; k < SWEEP_CHANNELS; ++k) {
+                    appendPixelColumn(start_idx, end_idx, min_max_idxs[k].first,
+                                      min_max_idxs[k].second, xy_indices[k]);
+                }
+            }
+
+            for (auto& indices : xy_indices) {
+                indices.push_back_if_not_in_back(x_indices.back());
+            }
+
+            channel += group_size;
+        }
+    }
+#endif
+
+    for (; channel < y_data_list.size(); ++channel) {
+        appendChannel(y_data_list[channel], xy_indices_list_out[channel]);
+    }
+}
+
+template <class FloatType>
+void Downsampler<FloatType>::calculateXYPixelPoints(
+    const Scaling x_scaling,
+    const Scaling y_scaling,
+    const Lim<FloatType> x_lim,
+    const Lim<FloatType> y_lim,
+    const juce::Rectangle<int>& graph_bounds,
+    const std::vector<FloatType>& x_data,
+    std::span<const FloatType> y_data,
+    PixelPoints& pixel_points_out,
+    std::vector<std::size_t>* x_idxs_out,
+    std::vector<std::size_t>* xy_idxs_out,
+    const std::optional<Lim<FloatType>>& collapse_y_lim,
+    std::vector<std::size_t>* run_positions_out)
+{
+    pixel_points_out.clear();
+    if (x_idxs_out) x_idxs_out->clear();
+    if (xy_idxs_out) xy_idxs_out->clear();
+    if (run_positions_out) run_positions_out->clear();
+
+    const auto [x_scale, x_offset] = getXScaleAndOffset(
+        float(graph_bounds.getWidth()), x_lim, x_scaling);
+    const auto [y_scale, y_offset] = getYScaleAndOffset(
+        float(graph_bounds.getHeight()), y_lim, y_scaling);
+
+    const auto add_pixel_point = [&](const std::size_t i) {
+        const auto x = x_scaling == Scaling::logarithmic
+                           ? getXPixelValueLogarithmic(x_data[i], x_scale, x_offset)
+                           : getXPixelValueLinear(x_data[i], x_scale, x_offset);
+        const auto y = y_scaling == Scaling::logarithmic
+                           ? getYPixelValueLogarithmic(y_data[i], y_scale, y_offset)
+                           : getYPixelValueLinear(y_data[i], y_scale, y_offset);
+
+        pixel_points_out.emplace_back(x, y);
+        if (xy_idxs_out) xy_idxs_out->push_back(i);
+    };
+
+    if (!collapse_y_lim) {
+        forEachXYIdx(x_scaling, x_lim, graph_bounds, x_data, y_data, x_idxs_out,
+                     add_pixel_point);
+        return;
+    }
+
+    // Same as collapseIdxsOutsideYLim, the first and last index of a run are
+    // only known when the run ends. NaN is neither above nor below.
+    const auto collapse_lim = *collapse_y_lim;
+    int run_side = 0;
+    std::size_t run_first_idx = 0u, run_last_idx = 0u;
+
+    const auto end_run = [&]() {
+        if (run_side == 0) return;
+
+        if (run_last_idx != run_first_idx) {
+            if (run_positions_out)
+                run_positions_out->push_back(pixel_points_out.size());
+            add_pixel_point(run_first_idx);
+        }
+        add_pixel_point(run_last_idx);
+        run_side = 0;
+    };
+
+    forEachXYIdx(x_scaling, x_lim, graph_bounds, x_data, y_data, x_idxs_out,
+                 [&](const std::size_t i) {
+        const auto y = y_data[i];
+        const auto side = y > collapse_lim.max ? 1 : y < collapse_lim.min ? -1 : 0;
+
+        if (side != 0 && side == run_side) {
+            run_last_idx = i;
+            return;
+        }
+
+        end_run();
+
+        if (side == 0) {
+            add_pixel_point(i);
+        } else {
+            run_side = side;
+            run_first_idx = run_last_idx = i;
+        }
+    });
+
+    end_run();
+}
+
+template <class FloatType>
+void Downsampler<FloatType>::calculateXYIdxs(
+    const Scaling x_scaling,
+    const Lim<FloatType> x_lim,
+    const juce::Rectangle<int>& graph_bounds,
+    const std::vector<FloatType>& x_data,
+    std::span<const FloatType> y_data,
+    std::vector<std::size_t>& x_idxs_out,
+    std::vector<std::size_t>& xy_idxs_out)
+{
+    x_idxs_out.clear();
+    xy_idxs_out.clear();
+
+    forEachXYIdx(x_scaling, x_lim, graph_bounds, x_data, y_data, &x_idxs_out,
+                 [&](const std::size_t i) { xy_idxs_out.push_back(i); });
+}
+
+template <class FloatType>
+bool Downsampler<FloatType>::collapseIdxsOutsideYLim(
+    std::span<const FloatType> y_data,
+    const Lim<FloatType> y_lim,
+    std::vector<std::size_t>& idxs,
+    std::vector<std::size_t>& run_positions_out)
+{
+    run_positions_out.clear();
+
+    // NaN is neither above nor below, a gap ends the run.
+    const auto getSide = [&](const std::size_t i) {
+        const auto y = y_data[idxs[i]];
+        return y > y_lim.max ? 1 : y < y_lim.min ? -1 : 0;
+    };
+
+    // Compacted in place, the kept indices are never ahead of the read ones.
+    std::size_t num_kept = 0u;
+    for (std::size_t i = 0u; i < idxs.size();) {
+        const auto side = getSide(i);
+
+        auto last = i;
+        if (side != 0) {
+            while (last + 1u < idxs.size() && getSide(last + 1u) == side) ++last;
+        }
+
+        if (last == i) {
+            idxs[num_kept++] = idxs[i++];
+            continue;
+        }
+
+        run_positions_out.push_back(num_kept);
+        idxs[num_kept++] = idxs[i];
+        idxs[num_kept++] = idxs[last];
+        i = last + 1u;
+    }
+
+    idxs.resize(num_kept);
+    return !run_positions_out.empty();
+}
+
+template <class FloatType>
+bool Downsampler<FloatType>::mergeFlaggedIdxs(const SampleFlags& flags,
+                                              std::vector<std::size_t>& idxs) {
+  if (flags.empty() || idxs.empty()) return false;
+
+  std::vector<std::size_t> flagged_idxs;
+  flags.forEachFlagged(idxs.front(), idxs.back() + 1u,
+                       [&](const std::size_t i) { flagged_idxs.push_back(i); });
+
+  if (flagged_idxs.empty()) return false;
+
+  const auto num_idxs = idxs.size();
+  idxs.insert(idxs.end(), flagged_idxs.begin(), flagged_idxs.end());
+  std::inplace_merge(idxs.begin(), idxs.begin() + num_idxs, idxs.end());
+  idxs.erase(std::unique(idxs.begin(), idxs.end()), idxs.end());
+
+  return idxs.size() > num_idxs;
+}
+
 template class Downsampler<float>;
 }  // namespace cmp
@@ -7,7 +7,12 @@
 
 #include "cmp_graph_line.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
+#include <cstring>
+#include <limits>
 #include <mutex>
 #include <numeric>
 #include <stdexcept>
@@ -19,7 +24,7 @@
 namespace cmp {
 
 GraphLineDataView::GraphLineDataView(
-    const std::vector<float>& _x_data, const std::vector<float>& _y_data,
+    const std::vector<float>& _x_data, std::span<const float> _y_data,
     const PixelPoints& _pixel_points,
     const std::vector<std::size_t>& _pixel_point_indices,
     const GraphAttribute& _graph_attribute)
@@ -56,6 +61,8 @@ GraphLine::findClosestPixelPointTo(const juce::Point<float>& this_pixel_point,
   // No pixel points.
   jassert(!m_pixel_points.empty());
 
+  updateMissingPixelPointIndices();
+
   auto closest_pixel_point = juce::Point<float>();
   auto closest_data_point = juce::Point<float>();
   auto closest_i = 0u;
@@ -72,8 +79,8 @@ GraphLine::findClosestPixelPointTo(const juce::Point<float>& this_pixel_point,
       closest_pixel_point = pixel_point;
       closest_i = i;
       closest_data_point =
-          juce::Point<float>(m_x_data[m_xy_indices[i]],
-                             m_y_data[m_xy_indices[i]]);
+          juce::Point<float>(m_x_data[m_xy_indices[i]] - m_x_offset,
+                             getYData()[m_xy_indices[i]]);
     }
     i++;
   }
@@ -89,12 +96,14 @@ std::pair<juce::Point<float>, size_t> GraphLine::findClosestDataPointTo(
   jassert(!m_x_data.empty());
 
   // x_data & y_data must have the same size
-  jassert(m_x_data.size() == m_y_data.size());
+  jassert(m_x_data.size() == getYData().size());
 
   const decltype(m_x_based_ds_indices)* indices = &m_x_based_ds_indices;
   decltype(m_x_based_ds_indices) all_indices;
 
-  if (!only_visible_data_points) {
+  if (only_visible_data_points) {
+    updateMissingPixelPointIndices();
+  } else {
     all_indices.resize(m_x_data.size());
 
     std::iota(all_indices.begin(), all_indices.end(), 0u);
@@ -107,7 +116,8 @@ std::pair<juce::Point<float>, size_t> GraphLine::findClosestDataPointTo(
 
   for (const auto i : *indices) {
     const auto x = m_x_data[i];
-    const auto current_x_dist = std::abs(x - this_data_point.getX());
+    const auto current_x_dist =
+        std::abs(x - m_x_offset - this_data_point.getX());
 
     if (current_x_dist < nearest_x_dist) {
       nearest_x_dist = current_x_dist;
@@ -116,25 +126,97 @@ std::pair<juce::Point<float>, size_t> GraphLine::findClosestDataPointTo(
   }
 
   const auto closest_data_point =
-      juce::Point<float>(m_x_data[nearest_i], m_y_data[nearest_i]);
+      juce::Point<float>(m_x_data[nearest_i] - m_x_offset, getYData()[nearest_i]);
 
   return {closest_data_point, nearest_i};
 }
 
+std::optional<float> GraphLine::getYValueAt(const float x_value) const {
+  if (m_x_data.empty() || m_x_data.size() != getYData().size()) return {};
+
+  auto y_value = 0.0f;
+
+  if (isXDataSorted()) {
+    const auto data_x = x_value + m_x_offset;
+
+    if (data_x < m_x_data.front() || data_x > m_x_data.back()) return {};
+
+    const auto it = std::lower_bound(m_x_data.begin(), m_x_data.end(), data_x);
+    const auto i = std::size_t(std::distance(m_x_data.begin(), it));
+
+    if (*it == data_x) {
+      y_value = getYData()[i];
+    } else {
+      const auto t = (data_x - m_x_data[i - 1u]) / (*it - m_x_data[i - 1u]);
+      y_value = getYData()[i - 1u] + t * (getYData()[i] - getYData()[i - 1u]);
+    }
+  } else {
+    updateMissingPixelPointIndices();
+    if (m_x_based_ds_indices.empty()) return {};
+
+    y_value = findClosestDataPointTo({x_value, 0.0f}, true).first.getY();
+  }
+
+  if (std::isnan(y_value)) return {};
+
+  return y_value;
+}
+
+std::optional<RangeStatistics::Values> GraphLine::getStatisticsBetween(
+    float x_start, float x_end) const {
+  if (m_x_data.empty() || m_x_data.size() != getYData().size()) return {};
+
+  if (!isXDataSorted()) return {};
+
+  if (x_start > x_end) std::swap(x_start, x_end);
+  x_start += m_x_offset;
+  x_end += m_x_offset;
+
+  const auto first =
+      std::lower_bound(m_x_data.begin(), m_x_data.end(), x_start);
+  const auto last = std::upper_bound(first, m_x_data.end(), x_end);
+
+  m_range_statistics.update(getYData());
+
+  return m_range_statistics.getStatistics(
+      getYData(), std::size_t(std::distance(m_x_data.begin(), first)),
+      std::size_t(std::distance(m_x_data.begin(), last)));
+}
+
+bool GraphLine::isXDataSorted() const {
+  // Checked once per x-data, the crosshair calls this on every mouse move.
+  if (!m_is_x_data_sorted) {
+    m_is_x_data_sorted = std::is_sorted(m_x_data.begin(), m_x_data.end());
+  }
+
+  return *m_is_x_data_sorted;
+}
+
+void GraphLine::setXOffset(const float x_offset) noexcept {
+  m_x_offset = x_offset;
+}
+
+float GraphLine::getXOffset() const noexcept { return m_x_offset; }
+
+std::size_t GraphLine::getDataGeneration() const noexcept {
+  return m_data_generation;
+}
+
 juce::Colour GraphLine::getColour() const noexcept {
   return m_graph_attributes.graph_colour.value();
 }
 
 juce::Point<float> GraphLine::getDataPointFromPixelPointIndex(
     size_t pixel_point_index) const {
-  return juce::Point<float>(m_x_data[m_xy_indices[pixel_point_index]],
-                            m_y_data[m_xy_indices[pixel_point_index]]);
+  updateMissingPixelPointIndices();
+  return juce::Point<float>(m_x_data[m_xy_indices[pixel_point_index]] - m_x_offset,
+                            getYData()[m_xy_indices[pixel_point_index]]);
 };
 
 juce::Point<float> GraphLine::getDataPointFromDataPointIndex(
     size_t data_point_index) const {
-  return juce::Point<float>(m_x_data[data_point_index],
-                            m_y_data[data_point_index]);
+  return juce::Point<float>(m_x_data[data_point_index] - m_x_offset,
+                            getYData()[data_point_index]);
 };
 
 void GraphLine::observableValueUpdated(ObserverId id, const bool &new_value)
@@ -145,27 +227,84 @@ void GraphLine::observableValueUpdated(ObserverId id, const bool &new_value)
 void GraphLine::resized() {};
 
 void GraphLine::paint(juce::Graphics& g) {
-  const GraphLineDataView graph_line_data(*this);
+  // The indices are not found on demand, they are kept when a callback or
+  // the must-keep markers need them, see needsPixelPointIndices().
+  const GraphLineDataView graph_line_data(m_x_data, getYData(), m_pixel_points,
+                                          m_xy_indices, m_graph_attributes);
 
   if (m_lookandfeel) {
     const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
 
     auto lnf = static_cast<Plot::LookAndFeelMethods*>(m_lookandfeel);
-    lnf->drawGraphLine(g, graph_line_data, getLocalBounds());
+
+    lnf->drawErrorBars(g, m_error_bar_lines, getColour());
+
+    // The derived traces are drawn behind the live line.
+    for (std::size_t i = 0u; i < m_derived_traces.size(); ++i) {
+      auto graph_attribute = m_derived_traces[i].getDerivedTrace().graph_attribute;
+      if (!graph_attribute.graph_colour)
+        graph_attribute.graph_colour = getColour().withAlpha(0.5f);
+
+      lnf->drawGraphLine(g,
+                         GraphLineDataView(m_x_data, m_derived_y_data[i],
+                                           m_derived_pixel_points[i],
+                                           m_derived_xy_indices[i],
+                                           graph_attribute),
+                         getLocalBounds());
+    }
+
+    // The persistence image holds the current trace as well.
+    if (m_graph_attributes.bars) {
+      lnf->drawBars(g, m_bar_rectangles, graph_line_data);
+    } else if (m_persistence_decay) {
+      renderPersistence();
+      g.drawImageAt(m_persistence_image, 0, 0);
+    } else {
+      lnf->drawGraphLine(g, graph_line_data, getLocalBounds());
+    }
+
+    const auto& must_keep_marker = m_graph_attributes.must_keep_marker;
+    if (must_keep_marker && !m_must_keep_flags.empty() &&
+        !m_xy_indices.empty() && m_xy_indices.size() == m_pixel_points.size()) {
+      PixelPoints must_keep_pixel_points;
+
+      // The flagged samples are merged into the pixel point indices, which are
+      // in increasing order.
+      m_must_keep_flags.forEachFlagged(
+          m_xy_indices.front(), m_xy_indices.back() + 1u,
+          [&](const std::size_t i) {
+            const auto it =
+                std::lower_bound(m_xy_indices.begin(), m_xy_indices.end(), i);
+            if (it != m_xy_indices.end() && *it == i) {
+              must_keep_pixel_points.push_back(
+                  m_pixel_points[std::size_t(it - m_xy_indices.begin())]);
+            }
+          });
+
+      lnf->drawMustKeepMarkers(g, must_keep_pixel_points, *must_keep_marker,
+                               getColour());
+    }
   }
 }
 
 void GraphLine::lookAndFeelChanged() {
   if (auto* lnf = dynamic_cast<Plot::LookAndFeelMethods*>(&getLookAndFeel())) {
     m_lookandfeel = lnf;
+    m_view_cache.clear();
+    m_persistence_colour_map.clear();
     updateXIndicesAndPixelPointsIntern({});
     updateYIndicesAndPixelPointsIntern({});
+    updateDerivedTracePixelPoints();
+    updateErrorBarLines();
+    updateBarRectangles();
   } else {
     m_lookandfeel = nullptr;
   }
 }
 
 void GraphLine::setGraphAttribute(const GraphAttribute& graph_attribute) {
+  const auto was_collapsible = isCollapsible();
+
   if (graph_attribute.dashed_lengths)
     m_graph_attributes.dashed_lengths = graph_attribute.dashed_lengths;
 
@@ -187,23 +326,381 @@ void GraphLine::setGraphAttribute(const GraphAttribute& graph_attribute) {
 
   if (graph_attribute.gradient_colours)
     m_graph_attributes.gradient_colours = graph_attribute.gradient_colours;
+
+  if (graph_attribute.must_keep_marker)
+    m_graph_attributes.must_keep_marker = graph_attribute.must_keep_marker;
+
+  if (graph_attribute.step) m_graph_attributes.step = graph_attribute.step;
+
+  if (graph_attribute.bars) m_graph_attributes.bars = graph_attribute.bars;
+
+  // The pixel points of a collapsed line are not drawn one by one.
+  if (m_lookandfeel && isCollapsible() != was_collapsible) {
+    m_view_cache.clear();
+    updateY();
+  }
+
+  if (graph_attribute.bars) updateBarRectangles();
+}
+
+void GraphLine::setMustKeepFlags(const std::vector<bool>& flags) {
+  m_must_keep_flags.assign(flags);
+  m_data_generation++;
 }
 
-void GraphLine::setYValues(const std::vector<float>& y_data) {
-  if (m_y_data.size() != y_data.size()) m_y_data.resize(y_data.size());
-  std::copy(y_data.begin(), y_data.end(), m_y_data.begin());
+void GraphLine::setErrorBars(const ErrorBars& error_bars) {
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+  m_error_bars = error_bars;
+}
+
+const std::vector<juce::Line<float>>& GraphLine::getErrorBarLines()
+    const noexcept {
+  return m_error_bar_lines;
+}
+
+const juce::RectangleList<float>& GraphLine::getBarRectangles()
+    const noexcept {
+  return m_bar_rectangles;
+}
+
+void GraphLine::setYValues(std::span<const float> y_data) {
+  // The borrowed y-data may have been changed in place, nothing is kept.
+  if (m_borrowed_y_data) {
+    m_borrowed_y_data.reset();
+    m_range_statistics.invalidateFrom(0u);
+  }
+
+  if (m_octave_fraction) {
+    // A smoothed sample depends on its neighbours, nothing is kept.
+    m_range_statistics.invalidateFrom(0u);
+    m_unsmoothed_y_data.assign(y_data.begin(), y_data.end());
+    m_octave_smoother.smooth(m_unsmoothed_y_data, m_y_data);
+  } else {
+    // Keep the statistics index of the blocks that are unchanged, e.g. when
+    // y-data is appended.
+    const auto num_indexed = std::min(
+        m_range_statistics.getNumIndexedSamples(), y_data.size());
+    for (std::size_t i = 0u; i < num_indexed;
+         i += RangeStatistics::block_size) {
+      const auto n = std::min(RangeStatistics::block_size, num_indexed - i);
+      if (std::memcmp(m_y_data.data() + i, y_data.data() + i,
+                      n * sizeof(float)) != 0) {
+        m_range_statistics.invalidateFrom(i);
+        break;
+      }
+    }
+    m_range_statistics.invalidateFrom(y_data.size());
+
+    if (m_y_data.size() != y_data.size()) m_y_data.resize(y_data.size());
+    std::copy(y_data.begin(), y_data.end(), m_y_data.begin());
+  }
+
+  for (std::size_t i = 0u; i < m_derived_traces.size(); ++i)
+    m_derived_traces[i].update(getYData(), m_derived_y_data[i]);
+
+  m_data_generation++;
+}
+
+void GraphLine::setYValuesBorrowed(std::span<const float> y_data) {
+  // The smoothed y-data is owned anyway.
+  if (m_octave_fraction) {
+    setYValues(y_data);
+    return;
+  }
+
+  m_borrowed_y_data = y_data;
+  m_y_data.clear();
+  m_range_statistics.invalidateFrom(0u);
+
+  for (std::size_t i = 0u; i < m_derived_traces.size(); ++i)
+    m_derived_traces[i].update(y_data, m_derived_y_data[i]);
+
+  m_data_generation++;
+}
+
+void GraphLine::makeYDataOwned() {
+  if (!m_borrowed_y_data) return;
+
+  m_y_data.assign(m_borrowed_y_data->begin(), m_borrowed_y_data->end());
+  m_borrowed_y_data.reset();
+}
+
+void GraphLine::setDerivedTraces(
+    const std::vector<DerivedTrace>& derived_traces) {
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+
+  m_derived_traces.clear();
+  for (const auto& derived_trace : derived_traces)
+    m_derived_traces.emplace_back(derived_trace);
+
+  m_derived_y_data.assign(derived_traces.size(), {});
+  m_derived_xy_indices.assign(derived_traces.size(), {});
+  m_derived_pixel_points.assign(derived_traces.size(), {});
+
+  // The traces start from the current y-data.
+  if (!getYData().empty()) {
+    for (std::size_t i = 0u; i < m_derived_traces.size(); ++i)
+      m_derived_traces[i].update(getYData(), m_derived_y_data[i]);
+  }
+}
+
+void GraphLine::resetDerivedTraces() noexcept {
+  for (auto& derived_trace : m_derived_traces) derived_trace.reset();
+}
+
+const std::vector<std::vector<float>>& GraphLine::getDerivedTraceYData()
+    const noexcept {
+  return m_derived_y_data;
 }
 
 void GraphLine::setXValues(const std::vector<float>& x_data) {
   if (m_x_data.size() != x_data.size()) m_x_data.resize(x_data.size());
   std::copy(x_data.begin(), x_data.end(), m_x_data.begin());
+  m_is_x_data_sorted.reset();
+  m_x_data_id = createXDataId();
+  updateOctaveSmoothingWindows();
+  m_data_generation++;
+}
+
+void GraphLine::shareXValues(const GraphLine& graph_line) noexcept {
+  jassert(m_x_data == graph_line.m_x_data);
+
+  m_x_data_id = graph_line.m_x_data_id;
+}
+
+std::size_t GraphLine::createXDataId() noexcept {
+  static std::atomic<std::size_t> next_x_data_id{0u};
+  return next_x_data_id++;
+}
+
+void GraphLine::setOctaveSmoothing(const std::optional<float> octave_fraction) {
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+
+  if (octave_fraction == m_octave_fraction) return;
+
+  if (!octave_fraction) {
+    m_y_data = std::move(m_unsmoothed_y_data);
+    m_unsmoothed_y_data.clear();
+    m_octave_fraction.reset();
+  } else {
+    makeYDataOwned();
+    if (!m_octave_fraction) m_unsmoothed_y_data = m_y_data;
+    m_octave_fraction = octave_fraction;
+    m_octave_smoother.setWindows(m_x_data, *m_octave_fraction);
+    m_octave_smoother.smooth(m_unsmoothed_y_data, m_y_data);
+  }
+
+  m_range_statistics.invalidateFrom(0u);
+  m_data_generation++;
+}
+
+void GraphLine::updateErrorBarLines() {
+  m_error_bar_lines.clear();
+
+  const auto y_data = getYData();
+  const auto size = y_data.size();
+  const auto hasErrors = [&](const std::vector<float>& lower,
+                             const std::vector<float>& upper) {
+    return lower.size() == size && (upper.empty() || upper.size() == size);
+  };
+
+  const auto has_y_errors = hasErrors(m_error_bars.y_lower, m_error_bars.y_upper);
+  const auto has_x_errors = hasErrors(m_error_bars.x_lower, m_error_bars.x_upper);
+
+  if ((!has_y_errors && !has_x_errors) || !m_x_lim || !m_y_lim ||
+      m_x_data.size() != size)
+    return;
+
+  updateMissingPixelPointIndices();
+  if (m_x_based_ds_indices.empty()) return;
+
+  const auto& y_lower = m_error_bars.y_lower;
+  const auto& y_upper =
+      m_error_bars.y_upper.empty() ? y_lower : m_error_bars.y_upper;
+  const auto& x_lower = m_error_bars.x_lower;
+  const auto& x_upper =
+      m_error_bars.x_upper.empty() ? x_lower : m_error_bars.x_upper;
+
+  const auto bounds = juce::Rectangle<float>(
+      float(m_graph_bounds.getWidth()), float(m_graph_bounds.getHeight()));
+  const auto x_lim = getDataXLim();
+
+  // Off-screen ends are clamped, e.g. an interval below zero on a log axis.
+  const auto getXPixel = [&](const float x) {
+    const auto x_pixel =
+        getXPixelCoordinateFromXData(x, bounds, x_lim, m_x_scaling);
+    return std::isnan(x_pixel)
+               ? -1.0f
+               : std::clamp(x_pixel, -1.0f, bounds.getWidth() + 1.0f);
+  };
+  const auto getYPixel = [&](const float y) {
+    const auto y_pixel =
+        getYPixelCoordinateFromYData(y, bounds, m_y_lim, m_y_scaling);
+    return std::isnan(y_pixel)
+               ? bounds.getHeight() + 1.0f
+               : std::clamp(y_pixel, -1.0f, bounds.getHeight() + 1.0f);
+  };
+
+  constexpr auto inf = std::numeric_limits<float>::infinity();
+
+  // The samples of a pixel column are between two x-indices, the last
+  // x-index is a column of its own. One error bar spans all their intervals.
+  const auto& columns = m_x_based_ds_indices;
+  for (std::size_t k = 0u; k < columns.size(); ++k) {
+    const auto first = columns[k];
+    const auto last =
+        std::min(k + 1u < columns.size() ? columns[k + 1u] : first + 1u, size);
+
+    auto y_min = inf, y_max = -inf;
+    auto y_error_min = inf, y_error_max = -inf;
+    auto x_error_min = inf, x_error_max = -inf;
+
+    for (auto i = first; i < last; ++i) {
+      const auto y = y_data[i];
+      if (!std::isfinite(y)) continue;
+
+      y_min = std::min(y_min, y);
+      y_max = std::max(y_max, y);
+
+      if (has_y_errors) {
+        y_error_min = std::min(y_error_min, y - y_lower[i]);
+        y_error_max = std::max(y_error_max, y + y_upper[i]);
+      }
+
+      if (has_x_errors) {
+        x_error_min = std::min(x_error_min, m_x_data[i] - x_lower[i]);
+        x_error_max = std::max(x_error_max, m_x_data[i] + x_upper[i]);
+      }
+    }
+
+    if (y_min > y_max) continue;
+
+    if (y_error_min <= y_error_max) {
+      const auto x_pixel = getXPixel(m_x_data[first]);
+      m_error_bar_lines.emplace_back(x_pixel, getYPixel(y_error_min), x_pixel,
+                                     getYPixel(y_error_max));
+    }
+
+    if (x_error_min <= x_error_max) {
+      const auto y_pixel = getYPixel((y_min + y_max) * 0.5f);
+      m_error_bar_lines.emplace_back(getXPixel(x_error_min), y_pixel,
+                                     getXPixel(x_error_max), y_pixel);
+    }
+  }
+}
+
+void GraphLine::updateBarRectangles() {
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+  m_bar_rectangles.clear();
+
+  if (!m_graph_attributes.bars || !m_x_lim || !m_y_lim) return;
+
+  updateMissingPixelPointIndices();
+  if (m_xy_indices.size() != m_pixel_points.size()) return;
+
+  const auto& bars = *m_graph_attributes.bars;
+
+  const auto width = float(m_graph_bounds.getWidth());
+  const auto height = float(m_graph_bounds.getHeight());
+  const auto [x_scale, x_offset] =
+      getXScaleAndOffset(width, getDataXLim(), m_x_scaling);
+  const auto [y_scale, y_offset] =
+      getYScaleAndOffset(height, m_y_lim, m_y_scaling);
+
+  const auto getXPixel = [&, x_scale = x_scale, x_offset = x_offset](
+                             const float x) {
+    return m_x_scaling == Scaling::logarithmic
+               ? getXPixelValueLogarithmic(x, x_scale, x_offset)
+               : getXPixelValueLinear(x, x_scale, x_offset);
+  };
+
+  // Off-screen ends are clamped, e.g. a baseline of zero on a log y-axis.
+  const auto clampY = [&](const float y) {
+    return std::isnan(y) ? height : std::clamp(y, -1.0f, height + 1.0f);
+  };
+
+  const auto baseline = clampY(
+      m_y_scaling == Scaling::logarithmic
+          ? getYPixelValueLogarithmic(bars.baseline, y_scale, y_offset)
+          : getYPixelValueLinear(bars.baseline, y_scale, y_offset));
+
+  m_bar_rectangles.ensureStorageAllocated(int(m_pixel_points.size()));
+
+  // The stems and the bars no wider than a pixel are merged per pixel column
+  // into one bar spanning all of them, i.e. the column keeps its largest bar.
+  std::optional<juce::Rectangle<float>> column;
+  const auto addColumn = [&] {
+    if (column) m_bar_rectangles.addWithoutMerging(*column);
+    column.reset();
+  };
+
+  for (std::size_t i = 0u; i < m_pixel_points.size(); ++i) {
+    const auto& pixel_point = m_pixel_points[i];
+    if (!std::isfinite(pixel_point.getX()) || std::isnan(pixel_point.getY()))
+      continue;
+
+    const auto y = clampY(pixel_point.getY());
+    const auto top = std::min(y, baseline);
+    const auto bottom = std::max(y, baseline);
+
+    // E.g. a bar that starts below zero on a log x-axis is merged as a one
+    // pixel bar.
+    if (bars.type == BarType::bar) {
+      const auto x = m_x_data[m_xy_indices[i]];
+      const auto left = getXPixel(x - bars.width * 0.5f);
+      const auto right = getXPixel(x + bars.width * 0.5f);
+
+      if (right - left > 1.0f) {
+        addColumn();
+        m_bar_rectangles.addWithoutMerging(
+            juce::Rectangle<float>::leftTopRightBottom(left, top, right, bottom));
+        continue;
+      }
+    }
+
+    const auto column_x = std::floor(pixel_point.getX());
+    const auto bar =
+        juce::Rectangle<float>::leftTopRightBottom(column_x, top, column_x + 1.0f, bottom);
+
+    if (column && column->getX() == column_x) {
+      column = column->getUnion(bar);
+    } else {
+      addColumn();
+      column = bar;
+    }
+  }
+
+  addColumn();
+}
+
+void GraphLine::updateOctaveSmoothingWindows() {
+  if (!m_octave_fraction ||
+      m_octave_smoother.hasWindowsFor(m_x_data, *m_octave_fraction))
+    return;
+
+  // The y-data is set before the x-data, so it is smoothed again here.
+  m_octave_smoother.setWindows(m_x_data, *m_octave_fraction);
+  m_octave_smoother.smooth(m_unsmoothed_y_data, m_y_data);
+  m_range_statistics.invalidateFrom(0u);
+
+  // The derived traces start over from the y-data smoothed with the new
+  // windows.
+  for (std::size_t i = 0u; i < m_derived_traces.size(); ++i) {
+    m_derived_traces[i].reset();
+    m_derived_traces[i].update(getYData(), m_derived_y_data[i]);
+  }
 }
 
 bool GraphLine::setXYValue(const juce::Point<float>& xy_value, size_t index) {
   if (index >= m_x_data.size()) return false;
 
-  m_x_data[index] = xy_value.getX();
+  makeYDataOwned();
+  m_x_data[index] = xy_value.getX() + m_x_offset;
   m_y_data[index] = xy_value.getY();
+  m_is_x_data_sorted.reset();
+  m_x_data_id = createXDataId();
+  m_range_statistics.invalidateFrom(index);
+  m_data_generation++;
 
   return true;
 }
@@ -212,11 +709,17 @@ void GraphLine::movePixelPoint(const juce::Point<float>& d_pixel_point,
                                size_t pixel_point_index) {
   if (pixel_point_index >= m_x_data.size()) return;
 
+  makeYDataOwned();
   m_x_data[pixel_point_index] += d_pixel_point.getX();
   m_y_data[pixel_point_index] += d_pixel_point.getY();
+  m_is_x_data_sorted.reset();
+  m_x_data_id = createXDataId();
+  m_range_statistics.invalidateFrom(pixel_point_index);
+  m_data_generation++;
 }
 
-const std::vector<float>& GraphLine::getYData() const noexcept {
+std::span<const float> GraphLine::getYData() const noexcept {
+  if (m_borrowed_y_data) return *m_borrowed_y_data;
   return m_y_data;
 }
 
@@ -229,6 +732,7 @@ const PixelPoints& GraphLine::getPixelPoints() const noexcept {
 }
 
 const std::vector<size_t>& GraphLine::getPixelPointIndices() const noexcept {
+  updateMissingPixelPointIndices();
   return m_xy_indices;
 }
 
@@ -237,18 +741,123 @@ void GraphLine::updateX() {
   if(!m_x_lim || m_x_data.empty()) return;
 
   updateXIndicesAndPixelPointsIntern(m_indices_to_update);
+
+  // The x- and y-coordinates of a collapsed line are updated together.
+  if (m_downsampling_type != DownsamplingType::xy_downsampling &&
+      isCollapsible())
+    updateYIndicesAndPixelPointsIntern(m_indices_to_update);
+
+  updateDerivedTracePixelPoints();
+  updateErrorBarLines();
+  updateBarRectangles();
 }
 
 void GraphLine::updateY() {
-  if (!m_y_lim || m_y_data.empty()) return;
+  if (!m_y_lim || getYData().empty()) return;
 
   updateYIndicesAndPixelPointsIntern(m_indices_to_update);
+  updateDerivedTracePixelPoints();
+  updateErrorBarLines();
+  updateBarRectangles();
+}
+
+void GraphLine::updateDerivedTracePixelPoints() {
+  if (m_derived_traces.empty() || !m_x_lim || !m_y_lim || !m_lookandfeel)
+    return;
+
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+  auto lnf = static_cast<Plot::LookAndFeelMethods*>(m_lookandfeel);
+
+  updateMissingPixelPointIndices();
+
+  // The traces share the x-data, and therefore the x-indices, of this line.
+  if (m_downsampling_type == DownsamplingType::xy_downsampling &&
+      std::all_of(m_derived_y_data.begin(), m_derived_y_data.end(),
+                  [&](const auto& y_data) {
+                    return y_data.size() == m_x_data.size();
+                  })) {
+    Downsampler<float>::calculateXYBasedIdxsBatched(
+        m_x_based_ds_indices, m_derived_y_data, m_derived_xy_indices);
+  } else {
+    std::fill(m_derived_xy_indices.begin(), m_derived_xy_indices.end(),
+              m_x_based_ds_indices);
+  }
+
+  for (std::size_t i = 0u; i < m_derived_traces.size(); ++i) {
+    auto& pixel_points = m_derived_pixel_points[i];
+    if (m_derived_y_data[i].size() != m_x_data.size()) {
+      pixel_points.clear();
+      continue;
+    }
+
+    lnf->updateXPixelPoints({}, m_x_scaling, getDataXLim(), m_graph_bounds,
+                            m_x_data, m_derived_xy_indices[i], pixel_points);
+    lnf->updateYPixelPoints({}, m_y_scaling, m_y_lim, m_graph_bounds,
+                            m_derived_y_data[i], m_derived_xy_indices[i],
+                            pixel_points);
+  }
+}
+
+float GraphLine::getCollapseMargin() const noexcept {
+  // The runs are collapsed at one graph height outside the graph bounds, far
+  // enough for any stroke to be off-screen.
+  return std::max(float(m_graph_bounds.getHeight()), 1.0f);
+}
+
+Lim<float> GraphLine::getCollapseYLim() const noexcept {
+  const auto height = float(m_graph_bounds.getHeight());
+  const auto margin = getCollapseMargin();
+  const auto bounds =
+      juce::Rectangle<float>(float(m_graph_bounds.getWidth()), height);
+
+  return {getYDataFromYPixelCoordinate(height + margin, bounds, m_y_lim,
+                                       m_y_scaling),
+          getYDataFromYPixelCoordinate(-margin, bounds, m_y_lim, m_y_scaling)};
+}
+
+void GraphLine::clampCollapsedPixelPoints() {
+  if (m_collapsed_run_positions.empty()) return;
+
+  const auto margin = getCollapseMargin();
+  clampCollapsedRuns(m_pixel_points, m_collapsed_run_positions, -margin,
+                     float(m_graph_bounds.getHeight()) + margin,
+                     m_graph_attributes.step.has_value());
+}
+
+void GraphLine::updateCollapsedPixelPointsIntern() {
+  auto lnf = static_cast<Plot::LookAndFeelMethods*>(m_lookandfeel);
+
+  // Only the kept indices are transformed to pixel points.
+  Downsampler<float>::collapseIdxsOutsideYLim(
+      getYData(), getCollapseYLim(), m_xy_indices, m_collapsed_run_positions);
+
+  lnf->updateXPixelPoints({}, m_x_scaling, getDataXLim(), m_graph_bounds,
+                          m_x_data, m_xy_indices, m_pixel_points);
+  lnf->updateYPixelPoints({}, m_y_scaling, m_y_lim, m_graph_bounds, getYData(),
+                          m_xy_indices, m_pixel_points);
+
+  clampCollapsedPixelPoints();
+}
+
+bool GraphLine::isCollapsible() const noexcept {
+  // Points drawn one by one are kept where they are, and the dash pattern
+  // starts at the first point, so it would move with the collapsed runs.
+  return m_y_lim && m_x_data.size() == getYData().size() &&
+         !m_graph_attributes.marker && !m_graph_attributes.on_pixel_point_paint &&
+         !m_graph_attributes.bars && !m_graph_attributes.dashed_lengths;
 }
 
 void GraphLine::updateXIndicesAndPixelPointsIntern(
     const std::vector<size_t>& update_only_these_indices) {
   const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
 
+  if (update_only_these_indices.empty() && restorePixelPointsFromViewCache()) {
+    return;
+  }
+
+  if (m_downsampling_type != DownsamplingType::xy_downsampling)
+    m_are_pixel_point_indices_missing = false;
+
   switch (m_downsampling_type) {
     case DownsamplingType::no_downsampling:
       m_x_based_ds_indices.resize(m_x_data.size());
@@ -257,23 +866,28 @@ void GraphLine::updateXIndicesAndPixelPointsIntern(
       break;
 
     case DownsamplingType::x_downsampling:
-      Downsampler<float>::calculateXIndices(m_x_scaling, m_x_lim, m_graph_bounds, m_x_data,
+      Downsampler<float>::calculateXIndices(m_x_scaling, getDataXLim(), m_graph_bounds, m_x_data,
                                                 m_x_based_ds_indices);
+      Downsampler<float>::mergeFlaggedIdxs(m_must_keep_flags,
+                                           m_x_based_ds_indices);
 
       break;
 
     case DownsamplingType::xy_downsampling:
-      Downsampler<float>::calculateXIndices(m_x_scaling, m_x_lim, m_graph_bounds, m_x_data,
-                                                m_x_based_ds_indices);
+      jassert(update_only_these_indices.empty());
+      updateXYDownsampledPixelPointsIntern();
       return;
-      break;
 
     default:
       break;
   }
 
+  // The pixel points of a collapsed line are found from the y-data as well,
+  // they are updated with the y-coordinates.
+  if (isCollapsible()) return;
+
   auto lnf = static_cast<Plot::LookAndFeelMethods*>(m_lookandfeel);
-  lnf->updateXPixelPoints(update_only_these_indices, m_x_scaling, m_x_lim, m_graph_bounds,
+  lnf->updateXPixelPoints(update_only_these_indices, m_x_scaling, getDataXLim(), m_graph_bounds,
                           m_x_data, m_x_based_ds_indices, m_pixel_points);
 }
 
@@ -282,34 +896,344 @@ void GraphLine::updateYIndicesAndPixelPointsIntern(
   auto lnf = static_cast<Plot::LookAndFeelMethods*>(m_lookandfeel);
   const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
 
+  if (update_only_these_indices.empty() && restorePixelPointsFromViewCache()) {
+    return;
+  }
+
+  if (m_downsampling_type == DownsamplingType::xy_downsampling) {
+    jassert(update_only_these_indices.empty());
+    updateXYDownsampledPixelPointsIntern();
+    return;
+  }
+
   m_xy_indices = m_x_based_ds_indices;
 
-  switch (m_downsampling_type) {
-    case DownsamplingType::no_downsampling:
-      break;
+  if (isCollapsible()) {
+    updateCollapsedPixelPointsIntern();
+    return;
+  }
 
-    case DownsamplingType::x_downsampling:
-      break;
+  // The x-coordinates are missing if the line was collapsed before.
+  if (m_pixel_points.size() != m_xy_indices.size()) {
+    lnf->updateXPixelPoints({}, m_x_scaling, getDataXLim(), m_graph_bounds,
+                            m_x_data, m_xy_indices, m_pixel_points);
+    lnf->updateYPixelPoints({}, m_y_scaling, m_y_lim, m_graph_bounds,
+                            getYData(), m_xy_indices, m_pixel_points);
+    return;
+  }
 
-    case DownsamplingType::xy_downsampling:
-      Downsampler<float>::calculateXYBasedIdxs(m_x_based_ds_indices, m_y_data,
-                                               m_xy_indices);
+  lnf->updateYPixelPoints(update_only_these_indices, m_y_scaling, m_y_lim, m_graph_bounds,
+                          getYData(), m_xy_indices, m_pixel_points);
 
-      lnf->updateXPixelPoints(update_only_these_indices, m_x_scaling, m_x_lim, m_graph_bounds,
+}
+
+Lim<float> GraphLine::getDataXLim() const noexcept {
+  return {m_x_lim.min + m_x_offset, m_x_lim.max + m_x_offset};
+}
+
+ViewKey GraphLine::getViewKey() const noexcept {
+  return {getDataXLim(), m_y_lim, m_graph_bounds, m_x_scaling, m_y_scaling,
+          m_data_generation};
+}
+
+bool GraphLine::restorePixelPointsFromViewCache() {
+  if (m_downsampling_type == DownsamplingType::no_downsampling) return false;
+
+  const auto* cached = m_view_cache.find(getViewKey());
+  if (!cached) return false;
+
+  m_x_based_ds_indices = cached->x_based_ds_indices;
+  m_xy_indices = cached->xy_indices;
+  m_pixel_points = cached->pixel_points;
+  m_are_pixel_point_indices_missing =
+      m_xy_indices.size() != m_pixel_points.size();
+
+  return true;
+}
+
+void GraphLine::storeViewInCache() {
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+
+  // The views of older data can no longer be restored.
+  const auto is_data_changed = m_view_cache_generation != m_data_generation;
+  if (is_data_changed) m_view_cache.clear();
+
+  const auto is_first_store = !m_view_cache_generation;
+  m_view_cache_generation = m_data_generation;
+
+  // Without downsampling the pixel points are as large as the data.
+  if ((is_data_changed && !is_first_store) ||
+      m_downsampling_type == DownsamplingType::no_downsampling || !m_x_lim ||
+      !m_y_lim || m_is_update_deferred)
+    return;
+
+  m_view_cache.insert(getViewKey(),
+                      {m_x_based_ds_indices, m_xy_indices, m_pixel_points});
+}
+
+void GraphLine::setUpdateDeferred(const bool is_update_deferred) noexcept {
+  m_is_update_deferred = is_update_deferred;
+}
+
+void GraphLine::updateXYDownsampledPixelPointsIntern() {
+  // Both limits are needed since x and y are downsampled in the same pass.
+  if (!m_x_lim || !m_y_lim || m_x_data.empty() ||
+      m_x_data.size() != getYData().size())
+    return;
+
+  auto lnf = static_cast<Plot::LookAndFeelMethods*>(m_lookandfeel);
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+
+  // The indices are already found if the x-values are shared with other
+  // graph-lines, see updateXYDownsampledIndicesBatched().
+  const auto is_batched = m_batched_view == getViewKey();
+  m_batched_view.reset();
+  m_are_pixel_point_indices_missing = false;
+
+  // The flagged samples are merged into the indices before the runs are
+  // collapsed, so they need the indices of the whole pass.
+  if (is_batched || (isCollapsible() && !m_must_keep_flags.empty())) {
+    if (!is_batched) {
+      Downsampler<float>::calculateXYIdxs(m_x_scaling, getDataXLim(),
+                                          m_graph_bounds, m_x_data, getYData(),
+                                          m_x_based_ds_indices, m_xy_indices);
+    }
+    Downsampler<float>::mergeFlaggedIdxs(m_must_keep_flags, m_xy_indices);
+
+    if (isCollapsible()) {
+      updateCollapsedPixelPointsIntern();
+    } else {
+      m_collapsed_run_positions.clear();
+      lnf->updateXPixelPoints({}, m_x_scaling, getDataXLim(), m_graph_bounds,
                               m_x_data, m_xy_indices, m_pixel_points);
-      break;
+      lnf->updateYPixelPoints({}, m_y_scaling, m_y_lim, m_graph_bounds,
+                              getYData(), m_xy_indices, m_pixel_points);
+    }
+    return;
+  }
 
-    default:
-      break;
+  // Otherwise the runs outside the y-limits are collapsed in the same pass,
+  // which is a compare per kept index if nothing is collapsed.
+  const auto collapse_y_lim =
+      isCollapsible() ? std::make_optional(getCollapseYLim()) : std::nullopt;
+
+  // Only the hit tests need the indices otherwise, they are found on demand.
+  const auto needs_indices = needsPixelPointIndices();
+  if (!needs_indices) {
+    m_x_based_ds_indices.clear();
+    m_xy_indices.clear();
+  }
+  m_are_pixel_point_indices_missing = !needs_indices;
+
+  lnf->updateXYDownsampledPixelPoints(
+      m_x_scaling, m_y_scaling, getDataXLim(), m_y_lim, m_graph_bounds,
+      m_x_data, getYData(), collapse_y_lim,
+      needs_indices ? &m_x_based_ds_indices : nullptr,
+      needs_indices ? &m_xy_indices : nullptr, &m_collapsed_run_positions,
+      m_pixel_points);
+
+  if (collapse_y_lim) {
+    clampCollapsedPixelPoints();
+  } else if (Downsampler<float>::mergeFlaggedIdxs(m_must_keep_flags, m_xy_indices)) {
+    lnf->updateXPixelPoints({}, m_x_scaling, getDataXLim(), m_graph_bounds, m_x_data,
+                            m_xy_indices, m_pixel_points);
+    lnf->updateYPixelPoints({}, m_y_scaling, m_y_lim, m_graph_bounds, getYData(),
+                            m_xy_indices, m_pixel_points);
   }
+}
 
-  lnf->updateYPixelPoints(update_only_these_indices, m_y_scaling, m_y_lim, m_graph_bounds,
-                          m_y_data, m_xy_indices, m_pixel_points);
+bool GraphLine::needsPixelPointIndices() const noexcept {
+  return !m_must_keep_flags.empty() || !m_derived_traces.empty() ||
+         !m_error_bars.y_lower.empty() || !m_error_bars.x_lower.empty() ||
+         m_graph_attributes.bars || m_graph_attributes.on_pixel_point_paint;
+}
+
+void GraphLine::updateMissingPixelPointIndices() const {
+  if (!m_are_pixel_point_indices_missing) return;
+
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+  m_are_pixel_point_indices_missing = false;
+
+  // The same indices as the pass that found the pixel points, no must-keep
+  // flags are merged since they always keep the indices.
+  Downsampler<float>::calculateXYIdxs(m_x_scaling, getDataXLim(),
+                                      m_graph_bounds, m_x_data, getYData(),
+                                      m_x_based_ds_indices, m_xy_indices);
+
+  if (isCollapsible()) {
+    std::vector<std::size_t> run_positions;
+    Downsampler<float>::collapseIdxsOutsideYLim(
+        getYData(), getCollapseYLim(), m_xy_indices, run_positions);
+  }
+
+  jassert(m_xy_indices.size() == m_pixel_points.size());
+}
+
+bool GraphLine::isXYDownsampledBatchable() const noexcept {
+  return m_graph_line_type == GraphLineType::normal &&
+         m_downsampling_type == DownsamplingType::xy_downsampling &&
+         m_lookandfeel && m_x_lim && m_y_lim && !m_is_update_deferred &&
+         !m_x_data.empty() && m_x_data.size() == getYData().size();
+}
+
+void GraphLine::updateXYDownsampledIndicesBatched(
+    const std::vector<GraphLine*>& graph_lines) {
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+
+  std::vector<bool> is_grouped(graph_lines.size(), false);
+  std::vector<GraphLine*> group;
+  std::vector<std::span<const float>> y_data_list;
+  std::vector<std::size_t> x_indices;
+  std::vector<std::vector<std::size_t>> xy_indices_list;
+
+  for (std::size_t i = 0u; i < graph_lines.size(); ++i) {
+    const auto* first = graph_lines[i];
+    if (is_grouped[i] || !first->isXYDownsampledBatchable()) continue;
+
+    // The graph-lines of a group share the pixel columns.
+    group.clear();
+    for (std::size_t j = i; j < graph_lines.size(); ++j) {
+      auto* graph_line = graph_lines[j];
+      if (!is_grouped[j] && graph_line->isXYDownsampledBatchable() &&
+          graph_line->m_x_data_id == first->m_x_data_id &&
+          graph_line->getDataXLim() == first->getDataXLim() &&
+          graph_line->m_x_scaling == first->m_x_scaling &&
+          graph_line->m_graph_bounds == first->m_graph_bounds) {
+        group.push_back(graph_line);
+        is_grouped[j] = true;
+      }
+    }
+
+    if (group.size() < 2u) continue;
+
+    Downsampler<float>::calculateXIndices(first->m_x_scaling,
+                                          first->getDataXLim(),
+                                          first->m_graph_bounds,
+                                          first->m_x_data, x_indices);
+
+    y_data_list.clear();
+    for (const auto* graph_line : group) y_data_list.push_back(graph_line->getYData());
+
+    Downsampler<float>::calculateXYBasedIdxsBatched(x_indices, y_data_list,
+                                                    xy_indices_list);
+
+    for (std::size_t k = 0u; k < group.size(); ++k) {
+      group[k]->m_x_based_ds_indices = x_indices;
+      group[k]->m_xy_indices = std::move(xy_indices_list[k]);
+      group[k]->m_batched_view = group[k]->getViewKey();
+    }
+  }
 }
 
 void GraphLine::updateXY() {
-  updateX();
-  updateY();
+  // The xy-downsampled pixel points are already fully updated by updateX().
+  // The derived traces are updated once, after both x and y.
+  if (m_downsampling_type == DownsamplingType::xy_downsampling) {
+    updateX();
+  } else {
+    if (m_x_lim && !m_x_data.empty())
+      updateXIndicesAndPixelPointsIntern(m_indices_to_update);
+    updateY();
+  }
+
+  // Every update of the data is added, also if the repaints are coalesced.
+  if (m_persistence_decay) addPersistenceTrace();
+}
+
+void GraphLine::setPersistence(const std::optional<float> decay_per_second) {
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+
+  m_persistence_decay = decay_per_second;
+  m_persistence_view.reset();
+
+  if (!m_persistence_decay) {
+    m_persistence_buffer.setSize(0, 0);
+    m_pending_persistence_buffer.setSize(0, 0);
+    m_has_pending_persistence = false;
+    m_persistence_image = juce::Image();
+  }
+}
+
+ViewKey GraphLine::getPersistenceViewKey() const noexcept {
+  // The x-offset of a trigger and new data do not clear the traces.
+  return {m_x_lim, m_y_lim, m_graph_bounds, m_x_scaling, m_y_scaling, 0u};
+}
+
+void GraphLine::addPersistenceTrace() {
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+
+  if (!m_lookandfeel) return;
+
+  const auto view = getPersistenceViewKey();
+  if (!m_persistence_view || *m_persistence_view != view) {
+    m_persistence_buffer.setSize(m_graph_bounds.getWidth(),
+                                 m_graph_bounds.getHeight());
+    m_pending_persistence_buffer.setSize(m_graph_bounds.getWidth(),
+                                         m_graph_bounds.getHeight());
+    m_persistence_buffer.clear();
+    m_pending_persistence_buffer.clear();
+    m_persistence_decay_time_ms.reset();
+    m_persistence_view = view;
+  }
+
+  // Only the pixels of the trace are touched, the O(width x height) decay and
+  // rendering are done once per frame by renderPersistence().
+  if (const auto& step = m_graph_attributes.step) {
+    m_step_pixel_points.clear();
+    forEachStepVertex(m_pixel_points, *step, [&](const auto& point) {
+      m_step_pixel_points.push_back(point);
+    });
+    m_pending_persistence_buffer.addLines(m_step_pixel_points);
+  } else {
+    m_pending_persistence_buffer.addLines(m_pixel_points);
+  }
+  m_has_pending_persistence = true;
+}
+
+void GraphLine::renderPersistence() {
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+
+  if (!m_lookandfeel) return;
+
+  // A changed view is cleared and shows the current trace.
+  if (!m_persistence_view || *m_persistence_view != getPersistenceViewKey())
+    addPersistenceTrace();
+
+  auto is_render_needed = m_has_pending_persistence ||
+                          !m_persistence_image.isValid();
+
+  if (m_persistence_colour_map.empty() ||
+      m_persistence_colour_map_colour != getColour()) {
+    const auto lnf = static_cast<Plot::LookAndFeelMethods*>(m_lookandfeel);
+    const auto colours = lnf->getPersistenceColourMap(
+        getColour(), PersistenceBuffer::colour_map_size);
+
+    m_persistence_colour_map.clear();
+    for (const auto& colour : colours)
+      m_persistence_colour_map.push_back(colour.getPixelARGB());
+    m_persistence_colour_map_colour = getColour();
+    is_render_needed = true;
+  }
+
+  // The traces fade with the time between the frames that show new traces, so
+  // a static plot keeps its image.
+  if (m_has_pending_persistence) {
+    const auto now_ms = juce::Time::getMillisecondCounterHiRes();
+    if (m_persistence_decay_time_ms) {
+      const auto elapsed_s =
+          std::max(now_ms - *m_persistence_decay_time_ms, 0.0) / 1000.0;
+      m_persistence_buffer.decay(
+          float(std::pow(double(*m_persistence_decay), elapsed_s)));
+    }
+    m_persistence_decay_time_ms = now_ms;
+
+    m_persistence_buffer.add(m_pending_persistence_buffer);
+    m_pending_persistence_buffer.clear();
+    m_has_pending_persistence = false;
+  }
+
+  if (is_render_needed)
+    m_persistence_buffer.renderTo(m_persistence_image, m_persistence_colour_map);
 }
 
 void GraphLine::setType(const GraphLineType graph_line_type) {
@@ -340,17 +1264,20 @@ void GraphLine::observableValueUpdated(ObserverId id, const Lim<float> &new_valu
       m_x_data.resize(2);
       m_x_data.front() = m_x_lim.min;
       m_x_data.back() = m_x_lim.max;
+      m_is_x_data_sorted.reset();
+      m_x_data_id = createXDataId();
     }
-    updateXY();
+    if (!m_is_update_deferred) updateXY();
   }
   else if (id == ObserverId::YLim) {
     m_y_lim = new_value;
     if (m_graph_line_type == GraphLineType::vertical) {
+      m_borrowed_y_data.reset();
       m_y_data.resize(2);
       m_y_data.front() = m_y_lim.min;
       m_y_data.back() = m_y_lim.max;
     }
-    updateY();
+    if (!m_is_update_deferred) updateY();
   }
 }
 
@@ -366,6 +1293,7 @@ void GraphLine::observableValueUpdated(ObserverId id, const DownsamplingType &ne
 {
   if (id == ObserverId::DownsamplingType) {
     m_downsampling_type = new_value;
+    m_view_cache.clear();
     updateXY();
   }
 }
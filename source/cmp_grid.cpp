@@ -38,11 +38,7 @@ void Grid::createLabels() {
   }
 }
 
-void Grid::updateInternal() {
-  if (getBounds().isEmpty()) {
-    return;
-  }
-
+void Grid::createGridLinesAndLabels() {
   // TODO: set use_cached_grids to false when the grid is resized.
   const bool use_cached_grids = false;
 
@@ -72,6 +68,28 @@ void Grid::updateInternal() {
   if (m_grid_type >= GridType::grid_translucent) {
     addTranslucentGridLines();
   }
+}
+
+void Grid::updateInternal() {
+  if (getBounds().isEmpty()) {
+    return;
+  }
+
+  const auto view_key = ViewKey{m_x_lim,     m_y_lim,     m_graph_bounds,
+                                m_x_scaling, m_y_scaling, m_generation};
+
+  if (const auto* cached = m_view_cache.find(view_key)) {
+    m_grid_lines = cached->grid_lines;
+    m_x_axis_labels = cached->x_axis_labels;
+    m_y_axis_labels = cached->y_axis_labels;
+  } else {
+    createGridLinesAndLabels();
+
+    if (m_lookandfeel) {
+      m_view_cache.insert(view_key,
+                          {m_grid_lines, m_x_axis_labels, m_y_axis_labels});
+    }
+  }
 
   if (onGridLabelLengthChanged && m_lookandfeel) {
     const auto lnf = static_cast<Plot::LookAndFeelMethods *>(m_lookandfeel);
@@ -291,6 +309,7 @@ void Grid::paint(juce::Graphics &g) {
 void Grid::lookAndFeelChanged() {
   if (auto *lnf = dynamic_cast<Plot::LookAndFeelMethods *>(&getLookAndFeel())) {
     m_lookandfeel = lnf;
+    m_generation++;
     if (getBounds().getWidth() > 0 && getBounds().getHeight() > 0) {
       updateInternal();
     }
@@ -301,11 +320,16 @@ void Grid::lookAndFeelChanged() {
 
 void Grid::setXLabels(const std::vector<std::string> &x_labels) {
   m_custom_x_labels = x_labels;
+  m_generation++;
   updateInternal();
 }
 
 void Grid::update() { updateInternal(); }
 
+void Grid::setUpdateDeferred(const bool is_update_deferred) noexcept {
+  m_is_update_deferred = is_update_deferred;
+}
+
 void Grid::observableValueUpdated(ObserverId id,
                                   const juce::Rectangle<int> &new_value) {
   if (id == ObserverId::GraphBounds && m_graph_bounds != new_value) {
@@ -327,10 +351,10 @@ void Grid::observableValueUpdated(ObserverId id, const Scaling &new_value) {
 void Grid::observableValueUpdated(ObserverId id, const Lim_f &new_value) {
   if (id == ObserverId::XLim) {
     m_x_lim = new_value;
-    updateInternal();
+    if (!m_is_update_deferred) updateInternal();
   } else if (id == ObserverId::YLim) {
     m_y_lim = new_value;
-    updateInternal();
+    if (!m_is_update_deferred) updateInternal();
   }
 }
 
@@ -338,22 +362,31 @@ void Grid::observableValueUpdated(ObserverId id, const bool &new_value) {
   updateInternal();
 }
 
-void Grid::resized() { updateInternal(); }
+void Grid::resized() {
+  m_generation++;
+  updateInternal();
+}
 
-void Grid::setGridType(const GridType grid_type) { m_grid_type = grid_type; }
+void Grid::setGridType(const GridType grid_type) {
+  m_grid_type = grid_type;
+  m_generation++;
+}
 
 void Grid::setXTicks(const std::vector<float> &x_ticks) {
   m_custom_x_ticks = x_ticks;
+  m_generation++;
   updateInternal();
 }
 
 void Grid::setYLabels(const std::vector<std::string> &y_labels) {
   m_custom_y_labels = y_labels;
+  m_generation++;
   updateInternal();
 }
 
 void Grid::setYTicks(const std::vector<float> &y_ticks) {
   m_custom_y_ticks = y_ticks;
+  m_generation++;
   updateInternal();
 }
 
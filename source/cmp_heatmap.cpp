@@ -0,0 +1,306 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "cmp_heatmap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "cmp_plot.h"
+#include "cmp_simd.h"
+#include "cmp_utils.h"
+
+namespace cmp {
+
+void Heatmap::setData(std::vector<float> values, const std::size_t num_columns,
+                      const Lim_f x_extent, const Lim_f y_extent,
+                      const HeatmapAttribute& heatmap_attribute) {
+  m_owned_values = std::move(values);
+  m_values = m_owned_values;
+
+  setDataInternal(num_columns, x_extent, y_extent, heatmap_attribute);
+}
+
+void Heatmap::setBorrowedData(std::span<const float> values,
+                              const std::size_t num_columns,
+                              const Lim_f x_extent, const Lim_f y_extent,
+                              const HeatmapAttribute& heatmap_attribute) {
+  m_owned_values = {};
+  m_values = values;
+
+  setDataInternal(num_columns, x_extent, y_extent, heatmap_attribute);
+}
+
+void Heatmap::setDataInternal(const std::size_t num_columns,
+                              const Lim_f x_extent, const Lim_f y_extent,
+                              const HeatmapAttribute& heatmap_attribute) {
+  const auto num_rows = num_columns == 0u ? 0u : m_values.size() / num_columns;
+  m_mip_chain.build(m_values, num_rows, num_columns);
+
+  if (heatmap_attribute.colour_map_size !=
+      m_heatmap_attribute.colour_map_size) {
+    m_colour_map.clear();
+  }
+
+  m_x_extent = x_extent;
+  m_y_extent = y_extent;
+  m_heatmap_attribute = heatmap_attribute;
+  m_is_image_outdated = true;
+}
+
+std::size_t Heatmap::getDrawnLevel() const noexcept { return m_drawn_level; }
+
+void Heatmap::getColourIndices(const float* values,
+                               std::uint32_t* colour_indices,
+                               const std::size_t size, const Lim_f value_lim,
+                               const std::size_t num_colours) noexcept {
+  // Each colour spans the same range of values, the max is clamped to the
+  // last colour.
+  const auto range = value_lim.max - value_lim.min;
+  const auto scale = range > 0.0f ? float(num_colours) / range : 0.0f;
+  const auto offset = value_lim.min;
+  const auto max_index = float(num_colours - 1u);
+
+  std::size_t i = 0u;
+
+#if CMP_USE_SSE2
+  const auto scale_4 = _mm_set1_ps(scale);
+  const auto offset_4 = _mm_set1_ps(offset);
+  const auto max_index_4 = _mm_set1_ps(max_index);
+  const auto nan_index_4 = _mm_set1_epi32(int(num_colours));
+
+  for (; i + 4u <= size; i += 4u) {
+    const auto value = _mm_loadu_ps(values + i);
+    const auto is_nan = _mm_castps_si128(_mm_cmpunord_ps(value, value));
+
+    // _mm_max_ps returns zero for NaN, those indices are replaced below.
+    const auto position = _mm_min_ps(
+        _mm_max_ps(_mm_mul_ps(_mm_sub_ps(value, offset_4), scale_4),
+                   _mm_setzero_ps()),
+        max_index_4);
+    const auto index = _mm_cvttps_epi32(position);
+
+    _mm_storeu_si128(
+        reinterpret_cast<__m128i*>(colour_indices + i),
+        _mm_or_si128(_mm_andnot_si128(is_nan, index),
+                     _mm_and_si128(is_nan, nan_index_4)));
+  }
+#elif CMP_USE_NEON
+  const auto scale_4 = vdupq_n_f32(scale);
+  const auto offset_4 = vdupq_n_f32(offset);
+  const auto max_index_4 = vdupq_n_f32(max_index);
+  const auto nan_index_4 = vdupq_n_u32(std::uint32_t(num_colours));
+
+  for (; i + 4u <= size; i += 4u) {
+    const auto value = vld1q_f32(values + i);
+    const auto is_nan = vmvnq_u32(vceqq_f32(value, value));
+
+    const auto position = vminq_f32(
+        vmaxq_f32(vmulq_f32(vsubq_f32(value, offset_4), scale_4),
+                  vdupq_n_f32(0.0f)),
+        max_index_4);
+    const auto index = vcvtq_u32_f32(position);
+
+    vst1q_u32(colour_indices + i, vbslq_u32(is_nan, nan_index_4, index));
+  }
+#endif
+
+  for (; i < size; ++i) {
+    if (std::isnan(values[i])) {
+      colour_indices[i] = std::uint32_t(num_colours);
+      continue;
+    }
+
+    // Written so that NaN, e.g. infinity times a zero scale, becomes zero.
+    const auto position = (values[i] - offset) * scale;
+    colour_indices[i] =
+        std::uint32_t(position > 0.0f ? std::min(position, max_index) : 0.0f);
+  }
+}
+
+void Heatmap::observableValueUpdated(ObserverId id, const Scaling& new_value) {
+  if (id == ObserverId::XScaling) {
+    m_x_scaling = new_value;
+  } else if (id == ObserverId::YScaling) {
+    m_y_scaling = new_value;
+  }
+
+  m_is_image_outdated = true;
+}
+
+void Heatmap::observableValueUpdated(ObserverId id,
+                                     const Lim<float>& new_value) {
+  if (id == ObserverId::XLim) {
+    m_x_lim = new_value;
+  } else if (id == ObserverId::YLim) {
+    m_y_lim = new_value;
+  }
+
+  m_is_image_outdated = true;
+}
+
+void Heatmap::observableValueUpdated(ObserverId id,
+                                     const juce::Rectangle<int>& new_value) {
+  if (id == ObserverId::GraphBounds) {
+    m_graph_bounds = new_value;
+    m_is_image_outdated = true;
+  }
+}
+
+void Heatmap::paint(juce::Graphics& g) {
+  if (!m_lookandfeel) return;
+
+  if (m_is_image_outdated) updateImage();
+
+  if (m_image.isValid())
+    g.drawImageAt(m_image, m_image_position.getX(), m_image_position.getY());
+}
+
+void Heatmap::lookAndFeelChanged() {
+  if (auto* lnf = dynamic_cast<Plot::LookAndFeelMethods*>(&getLookAndFeel())) {
+    m_lookandfeel = lnf;
+  } else {
+    m_lookandfeel = nullptr;
+  }
+
+  m_colour_map.clear();
+  m_is_image_outdated = true;
+}
+
+void Heatmap::updateImage() {
+  m_is_image_outdated = false;
+
+  const auto num_levels = m_mip_chain.getNumLevels();
+  const auto width = m_graph_bounds.getWidth();
+  const auto height = m_graph_bounds.getHeight();
+
+  if (num_levels == 0u || width <= 0 || height <= 0 || !m_x_lim || !m_y_lim ||
+      !(m_x_extent.max > m_x_extent.min) ||
+      !(m_y_extent.max > m_y_extent.min)) {
+    m_image = {};
+    return;
+  }
+
+  if (m_colour_map.empty()) {
+    const auto lnf = static_cast<Plot::LookAndFeelMethods*>(m_lookandfeel);
+    const auto num_colours =
+        std::max<std::size_t>(m_heatmap_attribute.colour_map_size, 1u);
+
+    for (const auto& colour : lnf->getHeatmapColourMap(num_colours))
+      m_colour_map.push_back(colour.getPixelARGB());
+
+    m_colour_map.resize(num_colours, juce::PixelARGB(0, 0, 0, 0));
+    m_colour_map.push_back(juce::PixelARGB(0, 0, 0, 0));
+  }
+
+  // The visible part of the matrix in pixels.
+  const auto bounds = juce::Rectangle<float>(float(width), float(height));
+  const auto left = getXPixelCoordinateFromXData(m_x_extent.min, bounds,
+                                                 m_x_lim, m_x_scaling);
+  const auto right = getXPixelCoordinateFromXData(m_x_extent.max, bounds,
+                                                  m_x_lim, m_x_scaling);
+  const auto top = getYPixelCoordinateFromYData(m_y_extent.max, bounds,
+                                                m_y_lim, m_y_scaling);
+  const auto bottom = getYPixelCoordinateFromYData(m_y_extent.min, bounds,
+                                                   m_y_lim, m_y_scaling);
+
+  if (std::isnan(left) || std::isnan(right) || std::isnan(top) ||
+      std::isnan(bottom)) {
+    m_image = {};
+    return;
+  }
+
+  const auto x_begin = int(std::max(std::floor(std::min(left, right)), 0.0f));
+  const auto x_end = int(std::min(std::ceil(std::max(left, right)), float(width)));
+  const auto y_begin = int(std::max(std::floor(std::min(top, bottom)), 0.0f));
+  const auto y_end = int(std::min(std::ceil(std::max(top, bottom)), float(height)));
+
+  if (x_begin >= x_end || y_begin >= y_end) {
+    m_image = {};
+    return;
+  }
+
+  // The level with one to two cells per pixel along the denser axis.
+  const auto full_level = m_mip_chain.getLevel(0u, m_heatmap_attribute.reduction);
+  const auto cells_per_pixel = std::max(
+      float(full_level.num_columns) / std::max(std::abs(right - left), 1.0f),
+      float(full_level.num_rows) / std::max(std::abs(bottom - top), 1.0f));
+
+  m_drawn_level =
+      cells_per_pixel >= 2.0f
+          ? std::min(std::size_t(std::log2(cells_per_pixel)), num_levels - 1u)
+          : 0u;
+
+  const auto level =
+      m_mip_chain.getLevel(m_drawn_level, m_heatmap_attribute.reduction);
+
+  // The cell of each pixel column and row, at the centre of the pixel.
+  const auto image_width = std::size_t(x_end - x_begin);
+  const auto image_height = std::size_t(y_end - y_begin);
+
+  m_pixel_columns.resize(image_width);
+  for (std::size_t i = 0u; i < image_width; ++i) {
+    const auto x = getXDataFromXPixelCoordinate(float(x_begin) + float(i) + 0.5f,
+                                                bounds, m_x_lim, m_x_scaling);
+    const auto t = (x - m_x_extent.min) / (m_x_extent.max - m_x_extent.min);
+    m_pixel_columns[i] = std::size_t(std::clamp(
+        t * float(level.num_columns), 0.0f, float(level.num_columns - 1u)));
+  }
+
+  m_pixel_rows.resize(image_height);
+  for (std::size_t i = 0u; i < image_height; ++i) {
+    const auto y = getYDataFromYPixelCoordinate(float(y_begin) + float(i) + 0.5f,
+                                                bounds, m_y_lim, m_y_scaling);
+    const auto t = (y - m_y_extent.min) / (m_y_extent.max - m_y_extent.min);
+    m_pixel_rows[i] = std::size_t(std::clamp(t * float(level.num_rows), 0.0f,
+                                             float(level.num_rows - 1u)));
+  }
+
+  const auto value_lim =
+      m_heatmap_attribute.value_lim.value_or(m_mip_chain.getValueLim());
+  const auto num_colours = m_colour_map.size() - 1u;
+
+  if (!m_image.isValid() || m_image.getWidth() != int(image_width) ||
+      m_image.getHeight() != int(image_height)) {
+    m_image = juce::Image(juce::Image::ARGB, int(image_width),
+                          int(image_height), false);
+  }
+
+  m_line_values.resize(image_width);
+  m_line_colour_indices.resize(image_width);
+
+  const juce::Image::BitmapData bitmap(m_image,
+                                       juce::Image::BitmapData::writeOnly);
+
+  for (std::size_t y = 0u; y < image_height; ++y) {
+    auto* line = bitmap.getLinePointer(int(y));
+
+    // Zoomed in, consecutive pixel rows show the same row of cells.
+    if (y > 0u && m_pixel_rows[y] == m_pixel_rows[y - 1u]) {
+      std::memcpy(line, bitmap.getLinePointer(int(y) - 1),
+                  image_width * std::size_t(bitmap.pixelStride));
+      continue;
+    }
+
+    const auto* row_values = level.values + m_pixel_rows[y] * level.num_columns;
+    for (std::size_t x = 0u; x < image_width; ++x)
+      m_line_values[x] = row_values[m_pixel_columns[x]];
+
+    getColourIndices(m_line_values.data(), m_line_colour_indices.data(),
+                     image_width, value_lim, num_colours);
+
+    for (std::size_t x = 0u; x < image_width; ++x) {
+      *reinterpret_cast<juce::PixelARGB*>(line + int(x) * bitmap.pixelStride) =
+          m_colour_map[m_line_colour_indices[x]];
+    }
+  }
+
+  m_image_position = {x_begin, y_begin};
+}
+
+}  // namespace cmp
@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "cmp_heatmap_mip_chain.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace cmp {
+
+void HeatmapMipChain::build(std::span<const float> values,
+                            const std::size_t num_rows,
+                            const std::size_t num_columns) {
+  jassert(values.size() == num_rows * num_columns);
+
+  m_values = values;
+  m_num_rows = num_rows;
+  m_num_columns = num_columns;
+
+  if (values.size() != num_rows * num_columns) m_num_rows = m_num_columns = 0u;
+
+  // The allocations of the previous matrix are reused.
+  std::size_t num_levels = 0u;
+  auto rows = m_num_rows, columns = m_num_columns;
+
+  while (rows * columns > 1u) {
+    const auto* source_min = m_values.data();
+    const auto* source_max = m_values.data();
+    const auto* source_mean = m_values.data();
+
+    if (num_levels > 0u) {
+      const auto& source = m_levels[num_levels - 1u];
+      source_min = source.min.data();
+      source_max = source.max.data();
+      source_mean = source.mean.data();
+    }
+
+    const auto source_columns = columns;
+    const auto source_rows = rows;
+    rows = (rows + 1u) / 2u;
+    columns = (columns + 1u) / 2u;
+
+    if (m_levels.size() <= num_levels) m_levels.emplace_back();
+    auto& level = m_levels[num_levels++];
+    level.num_rows = rows;
+    level.num_columns = columns;
+    level.min.resize(rows * columns);
+    level.max.resize(rows * columns);
+    level.mean.resize(rows * columns);
+
+    for (std::size_t r = 0u; r < rows; ++r) {
+      const auto last_row = std::min(2u * r + 2u, source_rows);
+
+      for (std::size_t c = 0u; c < columns; ++c) {
+        const auto last_column = std::min(2u * c + 2u, source_columns);
+
+        auto min = std::numeric_limits<float>::infinity();
+        auto max = -std::numeric_limits<float>::infinity();
+        auto sum = 0.0f;
+        auto num_finite = 0u;
+
+        for (auto sr = 2u * r; sr < last_row; ++sr) {
+          for (auto sc = 2u * c; sc < last_column; ++sc) {
+            const auto i = sr * source_columns + sc;
+            if (!std::isfinite(source_mean[i])) continue;
+
+            min = std::min(min, source_min[i]);
+            max = std::max(max, source_max[i]);
+            sum += source_mean[i];
+            num_finite++;
+          }
+        }
+
+        const auto i = r * columns + c;
+        if (num_finite == 0u) {
+          level.min[i] = level.max[i] = level.mean[i] =
+              std::numeric_limits<float>::quiet_NaN();
+        } else {
+          level.min[i] = min;
+          level.max[i] = max;
+          level.mean[i] = sum / float(num_finite);
+        }
+      }
+    }
+  }
+
+  m_levels.resize(num_levels);
+}
+
+std::size_t HeatmapMipChain::getNumLevels() const noexcept {
+  return m_num_rows * m_num_columns == 0u ? 0u : m_levels.size() + 1u;
+}
+
+HeatmapMipChain::Level HeatmapMipChain::getLevel(
+    const std::size_t level, const HeatmapReduction reduction) const noexcept {
+  if (level == 0u || level > m_levels.size())
+    return {m_values.data(), m_num_rows, m_num_columns};
+
+  const auto& reduced_level = m_levels[level - 1u];
+  const auto& values = reduction == HeatmapReduction::min   ? reduced_level.min
+                       : reduction == HeatmapReduction::max ? reduced_level.max
+                                                            : reduced_level.mean;
+
+  return {values.data(), reduced_level.num_rows, reduced_level.num_columns};
+}
+
+Lim_f HeatmapMipChain::getValueLim() const noexcept {
+  constexpr auto NaN = std::numeric_limits<float>::quiet_NaN();
+
+  if (getNumLevels() == 0u) return {NaN, NaN};
+
+  // The last level is a single cell.
+  if (m_levels.empty()) {
+    const auto value = m_values.front();
+    return std::isfinite(value) ? Lim_f{value, value} : Lim_f{NaN, NaN};
+  }
+
+  const auto& top = m_levels.back();
+  return {top.min.front(), top.max.front()};
+}
+
+}  // namespace cmp
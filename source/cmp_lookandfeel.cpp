@@ -7,12 +7,14 @@
 
 #include "cmp_lookandfeel.h"
 
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
 #include "cmp_datamodels.h"
+#include "cmp_downsampler.h"
 #include "cmp_graph_line.h"
 #include "cmp_grid.h"
 #include "cmp_label.h"
@@ -31,6 +33,33 @@ const std::pair<int, int> getMaxGridLabelWidth(const cmp::Plot* plot) noexcept {
   return plot->m_grid->getMaxGridLabelWidth();
 };
 
+static void drawMarkers(juce::Graphics& g, const PixelPoints& pixel_points,
+                        const Marker& marker, const float marker_length,
+                        const juce::Colour graph_colour) {
+  const auto marker_path = Marker::getMarkerPathFrom(marker, marker_length);
+
+  for (const auto& point : pixel_points) {
+    auto path = marker_path;
+
+    path.applyTransform(
+        juce::AffineTransform::translation(point.getX(), point.getY()));
+
+    if (marker.FaceColour) {
+      g.setColour(marker.FaceColour.value());
+
+      g.fillPath(path);
+    }
+
+    if (marker.EdgeColour) {
+      g.setColour(marker.EdgeColour.value());
+    } else {
+      g.setColour(graph_colour);
+    }
+
+    g.strokePath(path, marker.edge_stroke_type);
+  }
+}
+
 /*============================================================================*/
 
 PlotLookAndFeel::PlotLookAndFeel() { setDefaultPlotColours(); }
@@ -39,6 +68,9 @@ void PlotLookAndFeel::setDefaultPlotColours() noexcept {
   setColour(Plot::background_colour, juce::Colour(0xff2C3E50));
   setColour(Plot::frame_colour, juce::Colour(0xffcacfd2));
   setColour(Plot::zoom_frame_colour, juce::Colour(0xff99A3A4));
+  setColour(Plot::crosshair_colour, juce::Colour(0xffcacfd2));
+  setColour(Plot::measurement_cursor_colour, juce::Colour(0xfff4d03f));
+  setColour(Plot::overview_window_colour, juce::Colour(0xffcacfd2));
 
   setColour(Plot::grid_colour, juce::Colour(0x7F99A3A4));
   setColour(Plot::transluent_grid_colour, juce::Colour(0x4099A3A4));
@@ -217,6 +249,31 @@ int PlotLookAndFeel::getColourFromGraphID(const std::size_t graph_index) const {
   return GraphColours[graph_index % GraphColours.size()];
 }
 
+std::vector<juce::Colour> PlotLookAndFeel::getHeatmapColourMap(
+    const std::size_t num_colours) const {
+  // Viridis, interpolated between five of its colours.
+  static const std::vector<juce::Colour> key_colours{
+      juce::Colour(0xff440154), juce::Colour(0xff3b528b),
+      juce::Colour(0xff21918c), juce::Colour(0xff5ec962),
+      juce::Colour(0xfffde725)};
+
+  std::vector<juce::Colour> colour_map;
+  colour_map.reserve(num_colours);
+
+  for (std::size_t i = 0u; i < num_colours; ++i) {
+    const auto position =
+        num_colours > 1u ? float(i) / float(num_colours - 1u) *
+                               float(key_colours.size() - 1u)
+                         : 0.0f;
+    const auto key = std::min(std::size_t(position), key_colours.size() - 2u);
+
+    colour_map.push_back(key_colours[key].interpolatedWith(
+        key_colours[key + 1u], position - float(key)));
+  }
+
+  return colour_map;
+}
+
 std::size_t PlotLookAndFeel::getMargin() const noexcept { return 15u; }
 
 std::size_t PlotLookAndFeel::getMarginSmall() const noexcept { return 5u; }
@@ -308,10 +365,27 @@ void PlotLookAndFeel::drawGraphLine(
   auto graph_colour = graph_line_data.graph_attribute.graph_colour.value();
 
   if (pixel_points.size() > 1) {
-    graph_path.startNewSubPath(pixel_points[0]);
-    std::for_each(
-        pixel_points.begin() + 1, pixel_points.end(),
-        [&](const juce::Point<float>& point) { graph_path.lineTo(point); });
+    if (const auto& step = graph_line_data.graph_attribute.step) {
+      // Three floats per vertex, and two or three vertices per pixel point.
+      graph_path.preallocateSpace(
+          int(pixel_points.size()) * (*step == StepType::mid ? 9 : 6));
+
+      auto is_first_vertex = true;
+      forEachStepVertex(pixel_points, *step,
+                        [&](const juce::Point<float>& point) {
+                          if (is_first_vertex) {
+                            graph_path.startNewSubPath(point);
+                            is_first_vertex = false;
+                          } else {
+                            graph_path.lineTo(point);
+                          }
+                        });
+    } else {
+      graph_path.startNewSubPath(pixel_points[0]);
+      std::for_each(
+          pixel_points.begin() + 1, pixel_points.end(),
+          [&](const juce::Point<float>& point) { graph_path.lineTo(point); });
+    }
 
     if (dashed_lengths) {
       stroke_type.createDashedStroke(graph_path, graph_path,
@@ -322,31 +396,8 @@ void PlotLookAndFeel::drawGraphLine(
     g.setColour(graph_colour);
 
     if (marker) {
-      const auto marker_length = float(getMarkerLength());
-
-      const auto marker_path =
-          Marker::getMarkerPathFrom(marker.value(), marker_length);
-
-      for (const auto& point : pixel_points) {
-        auto path = marker_path;
-
-        path.applyTransform(
-            juce::AffineTransform::translation(point.getX(), point.getY()));
-
-        if (marker.value().FaceColour) {
-          g.setColour(marker.value().FaceColour.value());
-
-          g.fillPath(path);
-        }
-
-        if (marker.value().EdgeColour) {
-          g.setColour(marker.value().EdgeColour.value());
-        } else {
-          g.setColour(graph_colour);
-        }
-
-        g.strokePath(path, marker.value().edge_stroke_type);
-      }
+      drawMarkers(g, pixel_points, marker.value(), float(getMarkerLength()),
+                  graph_colour);
     }
 
     if (graph_line_data.graph_attribute.graph_line_opacity) {
@@ -547,6 +598,282 @@ void PlotLookAndFeel::drawTracePoint(juce::Graphics& g,
   }
 }
 
+/** Calls 'add_point' with the bounds of each readout point and 'add_label'
+ * with the text, bounds and colour of each label drawn by drawCrosshair(),
+ * in drawing order and relative the graph bounds. */
+template <class AddPoint, class AddLabel>
+static void forEachCrosshairPart(const juce::Font& font, const int margin,
+                                 const juce::Rectangle<int>& graph_bounds,
+                                 const float crosshair_x,
+                                 const float crosshair_x_value,
+                                 const std::vector<CrosshairReadout>& readouts,
+                                 const juce::Colour x_label_colour,
+                                 AddPoint&& add_point, AddLabel&& add_label) {
+  const auto width = graph_bounds.getWidth();
+  const auto height = graph_bounds.getHeight();
+  const auto label_height = int(font.getHeight()) + margin;
+
+  // Labels are placed to the right of the crosshair unless it is too close
+  // to the right edge of the graph bounds.
+  const auto addLabel = [&](const std::string& text, const int y,
+                            const juce::Colour colour) {
+    const auto label_width = font.getStringWidth(text) + 2 * margin;
+    const auto label_x = int(crosshair_x) + margin + label_width > width
+                             ? int(crosshair_x) - margin - label_width
+                             : int(crosshair_x) + margin;
+    add_label(text, juce::Rectangle<int>(label_x, y, label_width, label_height),
+              colour);
+  };
+
+  addLabel("X: " + valueToStringWithoutTrailingZeros(crosshair_x_value), 0,
+           x_label_colour);
+
+  // Draw the readouts from top to bottom and skip the labels that would
+  // overlap the previous label, the points are always drawn.
+  std::vector<const CrosshairReadout*> sorted_readouts;
+  sorted_readouts.reserve(readouts.size());
+  for (const auto& readout : readouts) sorted_readouts.push_back(&readout);
+
+  std::sort(sorted_readouts.begin(), sorted_readouts.end(),
+            [](const auto* a, const auto* b) {
+              return a->pixel_position.getY() < b->pixel_position.getY();
+            });
+
+  constexpr auto point_size = 6.0f;
+  auto next_free_label_y = label_height;
+
+  for (const auto* readout : sorted_readouts) {
+    const auto position = readout->pixel_position.toFloat();
+
+    add_point(juce::Rectangle<float>(position.getX() - point_size / 2.0f,
+                                     position.getY() - point_size / 2.0f,
+                                     point_size, point_size),
+              readout->colour);
+
+    const auto label_y = readout->pixel_position.getY() - label_height / 2;
+    if (label_y < next_free_label_y || label_y + label_height > height) {
+      continue;
+    }
+
+    addLabel(valueToStringWithoutTrailingZeros(readout->data_value.getY()),
+             label_y, readout->colour);
+    next_free_label_y = label_y + label_height;
+  }
+}
+
+void PlotLookAndFeel::drawCrosshair(
+    juce::Graphics& g, const juce::Rectangle<int>& graph_bounds,
+    const float crosshair_x, const float crosshair_x_value,
+    const std::vector<CrosshairReadout>& readouts) {
+  const juce::Graphics::ScopedSaveState save_state(g);
+  g.reduceClipRegion(graph_bounds);
+  g.setOrigin(graph_bounds.getPosition());
+
+  const auto font = getTraceFont();
+
+  g.setColour(findColour(Plot::crosshair_colour));
+  g.drawVerticalLine(int(crosshair_x), 0.0f, float(graph_bounds.getHeight()));
+
+  g.setFont(font);
+
+  forEachCrosshairPart(
+      font, int(getMarginSmall()), graph_bounds, crosshair_x,
+      crosshair_x_value, readouts, findColour(Plot::trace_label_colour),
+      [&](const juce::Rectangle<float>& point, const juce::Colour colour) {
+        g.setColour(colour);
+        g.fillEllipse(point);
+      },
+      [&](const std::string& text, const juce::Rectangle<int>& bounds,
+          const juce::Colour colour) {
+        g.setColour(findColour(Plot::trace_background_colour));
+        g.fillRect(bounds);
+        g.setColour(colour);
+        g.drawText(text, bounds, juce::Justification::centred);
+      });
+}
+
+juce::RectangleList<int> PlotLookAndFeel::getCrosshairArea(
+    const juce::Rectangle<int>& graph_bounds, const float crosshair_x,
+    const float crosshair_x_value,
+    const std::vector<CrosshairReadout>& readouts) {
+  juce::RectangleList<int> area(
+      juce::Rectangle<int>(int(crosshair_x), 0, 1, graph_bounds.getHeight()));
+
+  forEachCrosshairPart(
+      getTraceFont(), int(getMarginSmall()), graph_bounds, crosshair_x,
+      crosshair_x_value, readouts, juce::Colour(),
+      [&](const juce::Rectangle<float>& point, const juce::Colour) {
+        // One pixel more for the anti-aliased edge.
+        area.addWithoutMerging(point.getSmallestIntegerContainer().expanded(1));
+      },
+      [&](const std::string&, const juce::Rectangle<int>& bounds,
+          const juce::Colour) { area.addWithoutMerging(bounds); });
+
+  area.offsetAll(graph_bounds.getPosition());
+  area.clipTo(graph_bounds);
+  return area;
+}
+
+void PlotLookAndFeel::drawMeasurementCursors(
+    juce::Graphics& g, const juce::Rectangle<int>& graph_bounds,
+    const std::pair<float, float> cursors_x,
+    const std::vector<MeasurementStatistics>& statistics) {
+  const juce::Graphics::ScopedSaveState save_state(g);
+  g.reduceClipRegion(graph_bounds);
+  g.setOrigin(graph_bounds.getPosition());
+
+  const auto height = float(graph_bounds.getHeight());
+  const auto [left_x, right_x] = std::minmax(cursors_x.first, cursors_x.second);
+  const auto cursor_colour = findColour(Plot::measurement_cursor_colour);
+
+  g.setColour(cursor_colour.withAlpha(0.1f));
+  g.fillRect(juce::Rectangle<float>(left_x, 0.0f, right_x - left_x, height));
+
+  g.setColour(cursor_colour);
+  g.drawVerticalLine(int(cursors_x.first), 0.0f, height);
+  g.drawVerticalLine(int(cursors_x.second), 0.0f, height);
+
+  if (statistics.empty()) return;
+
+  // One row per graph line in the top left corner of the graph area.
+  const auto margin = int(getMarginSmall());
+  const auto font = getTraceFont();
+  const auto row_height = int(font.getHeight()) + margin;
+
+  std::vector<std::string> rows;
+  rows.reserve(statistics.size());
+
+  auto max_row_width = 0;
+  for (const auto& stats : statistics) {
+    rows.push_back("min: " + valueToStringWithoutTrailingZeros(stats.min) +
+                   "  max: " + valueToStringWithoutTrailingZeros(stats.max) +
+                   "  mean: " + valueToStringWithoutTrailingZeros(stats.mean) +
+                   "  rms: " + valueToStringWithoutTrailingZeros(stats.rms) +
+                   "  n: " + std::to_string(stats.num_samples));
+    max_row_width = std::max(max_row_width, font.getStringWidth(rows.back()));
+  }
+
+  const auto background = juce::Rectangle<int>(
+      margin, margin, max_row_width + 2 * margin,
+      row_height * int(rows.size()) + margin);
+
+  g.setColour(findColour(Plot::trace_background_colour));
+  g.fillRect(background);
+  g.setFont(font);
+
+  auto row_bounds = background.reduced(margin, 0)
+                        .withTrimmedTop(margin / 2)
+                        .withHeight(row_height);
+  for (std::size_t i = 0u; i < rows.size(); ++i) {
+    g.setColour(statistics[i].colour);
+    g.drawText(rows[i], row_bounds, juce::Justification::centredLeft);
+    row_bounds = row_bounds.translated(0, row_height);
+  }
+}
+
+void PlotLookAndFeel::drawOverviewGraphLine(
+    juce::Graphics& g, const std::vector<Lim_f>& column_y_pixels,
+    const juce::Colour graph_colour) {
+  g.setColour(graph_colour);
+
+  // A vertical line per column from the max to the min y-pixel, joined with
+  // the previous column to keep the line continuous.
+  const Lim_f* prev_column = nullptr;
+  for (std::size_t i = 0u; i < column_y_pixels.size(); ++i) {
+    const auto& column = column_y_pixels[i];
+    if (std::isnan(column.min) || std::isnan(column.max)) {
+      prev_column = nullptr;
+      continue;
+    }
+
+    auto top = column.min;
+    auto bottom = column.max;
+    if (prev_column) {
+      top = std::min(top, prev_column->max);
+      bottom = std::max(bottom, prev_column->min);
+    }
+
+    g.drawVerticalLine(int(i), top, std::max(bottom, top + 1.0f));
+    prev_column = &column;
+  }
+}
+
+void PlotLookAndFeel::drawMustKeepMarkers(juce::Graphics& g,
+                                          const PixelPoints& pixel_points,
+                                          const Marker& marker,
+                                          const juce::Colour graph_colour) {
+  drawMarkers(g, pixel_points, marker, float(getMarkerLength()), graph_colour);
+}
+
+void PlotLookAndFeel::drawErrorBars(
+    juce::Graphics& g, const std::vector<juce::Line<float>>& error_bars,
+    const juce::Colour graph_colour) {
+  if (error_bars.empty()) return;
+
+  juce::Path error_bar_path;
+  error_bar_path.preallocateSpace(int(error_bars.size()) * 6);
+
+  for (const auto& error_bar : error_bars) {
+    error_bar_path.startNewSubPath(error_bar.getStart());
+    error_bar_path.lineTo(error_bar.getEnd());
+  }
+
+  g.setColour(graph_colour);
+  g.strokePath(error_bar_path, juce::PathStrokeType(1.0f));
+}
+
+void PlotLookAndFeel::drawBars(juce::Graphics& g,
+                               const juce::RectangleList<float>& bar_rectangles,
+                               const GraphLineDataView graph_line_data) {
+  const auto& graph_attribute = graph_line_data.graph_attribute;
+  auto graph_colour = graph_attribute.graph_colour.value();
+  if (graph_attribute.graph_line_opacity) {
+    graph_colour =
+        graph_colour.withAlpha(graph_attribute.graph_line_opacity.value());
+  }
+
+  g.setColour(graph_colour);
+  g.fillRectList(bar_rectangles);
+
+  if (graph_attribute.marker) {
+    drawMarkers(g, graph_line_data.pixel_points, graph_attribute.marker.value(),
+                float(getMarkerLength()), graph_attribute.graph_colour.value());
+  }
+}
+
+std::vector<juce::Colour> PlotLookAndFeel::getPersistenceColourMap(
+    const juce::Colour graph_colour, const std::size_t num_colours) const {
+  std::vector<juce::Colour> colour_map(num_colours);
+
+  // Faint traces are lifted to be visible, the brightest turn towards white.
+  for (std::size_t i = 0u; i < num_colours; ++i) {
+    const auto intensity = float(i) / float(std::max<std::size_t>(num_colours - 1u, 1u));
+    const auto whiteness = std::max(intensity - 0.75f, 0.0f) * 2.0f;
+
+    colour_map[i] = graph_colour.interpolatedWith(juce::Colours::white, whiteness)
+                        .withAlpha(std::sqrt(intensity));
+  }
+
+  return colour_map;
+}
+
+void PlotLookAndFeel::drawOverviewWindow(
+    juce::Graphics& g, const juce::Rectangle<int>& bounds,
+    const juce::Rectangle<float>& view_window) {
+  const auto window_colour = findColour(Plot::overview_window_colour);
+  const auto window = view_window.getIntersection(bounds.toFloat());
+
+  // Dim the data outside of the view window.
+  g.setColour(findColour(Plot::background_colour).withAlpha(0.6f));
+  g.fillRect(bounds.toFloat().withRight(window.getX()));
+  g.fillRect(bounds.toFloat().withLeft(window.getRight()));
+
+  g.setColour(window_colour.withAlpha(0.15f));
+  g.fillRect(window);
+  g.setColour(window_colour);
+  g.drawRect(window, 1.0f);
+}
+
 void PlotLookAndFeel::drawSelectionArea(
     juce::Graphics& g, juce::Point<int>& start_coordinates,
     const juce::Point<int>& end_coordinates,
@@ -650,7 +977,7 @@ void PlotLookAndFeel::updateXPixelPoints(
 void PlotLookAndFeel::updateYPixelPoints(
     const std::vector<std::size_t>& update_only_these_indices,
     const Scaling y_scaling, const Lim<float> y_lim, const juce::Rectangle<int> &graph_bounds,
-    const std::vector<float>& y_data,
+    std::span<const float> y_data,
     const std::vector<std::size_t>& pixel_points_indices,
     PixelPoints& pixel_points) noexcept {
   const auto [y_scale, y_offset] = getYScaleAndOffset(
@@ -693,6 +1020,21 @@ void PlotLookAndFeel::updateYPixelPoints(
   }
 }
 
+void PlotLookAndFeel::updateXYDownsampledPixelPoints(
+    const Scaling x_scaling, const Scaling y_scaling, const Lim<float> x_lim,
+    const Lim<float> y_lim, const juce::Rectangle<int>& graph_bounds,
+    const std::vector<float>& x_data, std::span<const float> y_data,
+    const std::optional<Lim<float>>& collapse_y_lim,
+    std::vector<std::size_t>* x_based_indices,
+    std::vector<std::size_t>* pixel_points_indices,
+    std::vector<std::size_t>* collapsed_run_positions,
+    PixelPoints& pixel_points) {
+  Downsampler<float>::calculateXYPixelPoints(
+      x_scaling, y_scaling, x_lim, y_lim, graph_bounds, x_data, y_data,
+      pixel_points, x_based_indices, pixel_points_indices, collapse_y_lim,
+      collapsed_run_positions);
+}
+
 void PlotLookAndFeel::updateVerticalGridLineTicksAuto(
     const juce::Rectangle<int>& bounds,
     const Lim_f& x_lim,
@@ -822,7 +1164,13 @@ PlotLookAndFeel::getDefaultUserInputMapAction() const noexcept {
   action_map[UserInput::left | UserInput::start | UserInput::tracepoint] = UserInputAction::select_tracepoint;
   action_map[UserInput::left | UserInput::end | UserInput::tracepoint] =   UserInputAction::deselect_tracepoint;
 
-  action_map[UserInput::right | UserInput::drag | UserInput::graph_area] = UserInputAction::zoom_reset;
+  action_map[UserInput::right | UserInput::drag | UserInput::graph_area] =                    UserInputAction::zoom_reset;
+  action_map[UserInput::right | UserInput::drag | UserInput::shift | UserInput::graph_area] = UserInputAction::zoom_back;
+  action_map[UserInput::right | UserInput::drag | UserInput::ctrl | UserInput::graph_area] =  UserInputAction::zoom_forward;
+
+  action_map[UserInput::move | UserInput::graph_area] = UserInputAction::move_crosshair;
+
+  action_map[UserInput::left | UserInput::drag | UserInput::measurement_cursor] = UserInputAction::move_measurement_cursor;
   // clang-format on
 
   return action_map;
@@ -0,0 +1,121 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "cmp_octave_smoothing.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace cmp {
+
+namespace {
+
+/** The position of an x-value in sample indices, sample 'i' spans [i, i + 1).
+ */
+double getPosition(const std::vector<float>& x_data, const double x) noexcept {
+  const auto size = x_data.size();
+  const auto upper = std::upper_bound(x_data.begin(), x_data.end(), x);
+
+  if (upper == x_data.begin()) return 0.0;
+  if (upper == x_data.end()) {
+    return x == double(x_data.back()) ? double(size) - 0.5 : double(size);
+  }
+
+  const auto i = std::size_t(upper - x_data.begin()) - 1u;
+  const auto x0 = double(x_data[i]);
+  const auto x1 = double(x_data[i + 1u]);
+
+  return double(i) + 0.5 + (x - x0) / (x1 - x0);
+}
+
+}  // namespace
+
+void FractionalOctaveSmoother::setWindows(const std::vector<float>& x_data,
+                                          const float octave_fraction) {
+  m_x_data = x_data;
+  m_octave_fraction = octave_fraction;
+  m_is_x_data_sorted = std::is_sorted(x_data.begin(), x_data.end());
+  m_windows.clear();
+
+  if (!m_is_x_data_sorted) return;
+
+  const auto size = x_data.size();
+  const auto half_width = std::exp2(0.5 * double(octave_fraction));
+
+  // The end of the last sample is stored as the whole last sample.
+  const auto toIndexAndFraction = [&](const double position) {
+    const auto index = std::size_t(position);
+    if (index >= size) return std::make_pair(size - 1u, 1.0f);
+    return std::make_pair(index, float(position - double(index)));
+  };
+
+  m_windows.resize(size);
+  for (std::size_t i = 0u; i < size; ++i) {
+    auto first = double(i);
+    auto last = double(i + 1u);
+
+    if (x_data[i] > 0.0f) {
+      first = getPosition(x_data, double(x_data[i]) / half_width);
+      last = getPosition(x_data, double(x_data[i]) * half_width);
+    }
+
+    const auto [first_index, first_fraction] = toIndexAndFraction(first);
+    const auto [last_index, last_fraction] = toIndexAndFraction(last);
+    m_windows[i] = {first_index, first_fraction, last_index, last_fraction};
+  }
+}
+
+bool FractionalOctaveSmoother::hasWindowsFor(
+    const std::vector<float>& x_data,
+    const float octave_fraction) const noexcept {
+  return octave_fraction == m_octave_fraction && x_data == m_x_data;
+}
+
+void FractionalOctaveSmoother::smooth(const std::vector<float>& y_data,
+                                      std::vector<float>& smoothed_y_data) {
+  const auto size = y_data.size();
+  smoothed_y_data.resize(size);
+
+  if (!m_is_x_data_sorted || size != m_windows.size()) {
+    std::copy(y_data.begin(), y_data.end(), smoothed_y_data.begin());
+    return;
+  }
+
+  // sums[i] is the sum of the finite values before sample i.
+  m_sums.resize(size + 1u);
+  m_counts.resize(size + 1u);
+  m_sums[0] = 0.0;
+  m_counts[0] = 0.0;
+  for (std::size_t i = 0u; i < size; ++i) {
+    const auto is_finite = std::isfinite(y_data[i]);
+    m_sums[i + 1u] = m_sums[i] + (is_finite ? double(y_data[i]) : 0.0);
+    m_counts[i + 1u] = m_counts[i] + (is_finite ? 1.0 : 0.0);
+  }
+
+  const auto interpolate = [&](const std::vector<double>& prefix,
+                               const std::size_t index, const float fraction) {
+    return prefix[index] +
+           double(fraction) * (prefix[index + 1u] - prefix[index]);
+  };
+
+  for (std::size_t i = 0u; i < size; ++i) {
+    const auto& window = m_windows[i];
+
+    const auto count =
+        interpolate(m_counts, window.last, window.last_fraction) -
+        interpolate(m_counts, window.first, window.first_fraction);
+    const auto sum = interpolate(m_sums, window.last, window.last_fraction) -
+                     interpolate(m_sums, window.first, window.first_fraction);
+
+    smoothed_y_data[i] = count > 0.0
+                             ? float(sum / count)
+                             : std::numeric_limits<float>::quiet_NaN();
+  }
+}
+
+}  // namespace cmp
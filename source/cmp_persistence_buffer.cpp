@@ -0,0 +1,177 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "cmp_persistence_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+#include "cmp_simd.h"
+
+namespace cmp {
+
+void PersistenceBuffer::setSize(const int width, const int height) {
+  if (width == m_width && height == m_height) return;
+
+  m_width = std::max(width, 0);
+  m_height = std::max(height, 0);
+  m_intensities.assign(std::size_t(m_width) * std::size_t(m_height), 0.0f);
+}
+
+void PersistenceBuffer::clear() noexcept {
+  std::fill(m_intensities.begin(), m_intensities.end(), 0.0f);
+}
+
+void PersistenceBuffer::decay(const float factor) noexcept {
+  auto* intensities = m_intensities.data();
+  const auto size = m_intensities.size();
+  std::size_t i = 0u;
+
+#if CMP_USE_SSE2
+  const auto factor_4 = _mm_set1_ps(factor);
+  for (; i + 8u <= size; i += 8u) {
+    _mm_storeu_ps(intensities + i,
+                  _mm_mul_ps(_mm_loadu_ps(intensities + i), factor_4));
+    _mm_storeu_ps(intensities + i + 4u,
+                  _mm_mul_ps(_mm_loadu_ps(intensities + i + 4u), factor_4));
+  }
+#elif CMP_USE_NEON
+  for (; i + 8u <= size; i += 8u) {
+    vst1q_f32(intensities + i, vmulq_n_f32(vld1q_f32(intensities + i), factor));
+    vst1q_f32(intensities + i + 4u,
+              vmulq_n_f32(vld1q_f32(intensities + i + 4u), factor));
+  }
+#endif
+
+  for (; i < size; ++i) intensities[i] *= factor;
+}
+
+void PersistenceBuffer::addLines(const PixelPoints& pixel_points) {
+  if (m_intensities.empty()) return;
+
+  const auto isFinite = [](const juce::Point<float>& point) {
+    return std::isfinite(point.getX()) && std::isfinite(point.getY());
+  };
+
+  for (std::size_t i = 0u; i < pixel_points.size(); ++i) {
+    if (!isFinite(pixel_points[i])) continue;
+
+    const auto has_next =
+        i + 1u < pixel_points.size() && isFinite(pixel_points[i + 1u]);
+
+    // A single point, or a line where the end is added by the next segment.
+    addSegment(pixel_points[i], has_next ? pixel_points[i + 1u] : pixel_points[i]);
+  }
+}
+
+void PersistenceBuffer::add(const PersistenceBuffer& other) noexcept {
+  jassert(other.m_width == m_width && other.m_height == m_height);
+  if (other.m_intensities.size() != m_intensities.size()) return;
+
+  std::transform(m_intensities.begin(), m_intensities.end(),
+                 other.m_intensities.begin(), m_intensities.begin(),
+                 std::plus<float>());
+}
+
+void PersistenceBuffer::addSegment(juce::Point<float> start,
+                                   juce::Point<float> end) {
+  const auto is_point = start == end;
+
+  // Clip the segment to the buffer (Liang-Barsky).
+  const auto x_max = float(m_width) - 1e-3f;
+  const auto y_max = float(m_height) - 1e-3f;
+  const auto dx = end.getX() - start.getX();
+  const auto dy = end.getY() - start.getY();
+
+  auto t_start = 0.0f, t_end = 1.0f;
+  for (const auto& [p, q] : {std::pair{-dx, start.getX()},
+                             std::pair{dx, x_max - start.getX()},
+                             std::pair{-dy, start.getY()},
+                             std::pair{dy, y_max - start.getY()}}) {
+    if (p == 0.0f) {
+      if (q < 0.0f) return;
+    } else {
+      const auto t = q / p;
+      if (p < 0.0f) {
+        t_start = std::max(t_start, t);
+      } else {
+        t_end = std::min(t_end, t);
+      }
+    }
+  }
+  if (t_start > t_end) return;
+
+  // The end pixel is left to the next segment, unless the end is clipped.
+  const auto is_end_included = is_point || t_end < 1.0f;
+
+  end = start + juce::Point<float>(dx * t_end, dy * t_end);
+  start = start + juce::Point<float>(dx * t_start, dy * t_start);
+
+  const auto addPixel = [&](const int x, const int y) {
+    m_intensities[std::size_t(y) * std::size_t(m_width) + std::size_t(x)] +=
+        1.0f;
+  };
+
+  // One pixel per column or row along the major axis, with the minor axis
+  // sampled at the centre of the pixel.
+  const auto is_x_major = std::abs(dx) >= std::abs(dy);
+  const auto major_start = int(is_x_major ? start.getX() : start.getY());
+  const auto major_end = int(is_x_major ? end.getX() : end.getY());
+  const auto major_step = major_end >= major_start ? 1 : -1;
+
+  for (auto major = major_start; major != major_end; major += major_step) {
+    if (is_x_major) {
+      const auto t = std::clamp((float(major) + 0.5f - start.getX()) /
+                                    (end.getX() - start.getX()),
+                                0.0f, 1.0f);
+      addPixel(major, int(start.getY() + t * (end.getY() - start.getY())));
+    } else {
+      const auto t = std::clamp((float(major) + 0.5f - start.getY()) /
+                                    (end.getY() - start.getY()),
+                                0.0f, 1.0f);
+      addPixel(int(start.getX() + t * (end.getX() - start.getX())), major);
+    }
+  }
+
+  if (is_end_included) addPixel(int(end.getX()), int(end.getY()));
+}
+
+void PersistenceBuffer::renderTo(
+    juce::Image& image, const std::vector<juce::PixelARGB>& colour_map) const {
+  jassert(colour_map.size() == colour_map_size);
+  if (m_width <= 0 || m_height <= 0 || colour_map.size() != colour_map_size)
+    return;
+
+  if (!image.isValid() || image.getWidth() != m_width ||
+      image.getHeight() != m_height) {
+    image = juce::Image(juce::Image::ARGB, m_width, m_height, false);
+  }
+
+  const juce::Image::BitmapData bitmap(image,
+                                       juce::Image::BitmapData::writeOnly);
+  const auto max_index = float(colour_map_size - 1u);
+
+  for (int y = 0; y < m_height; ++y) {
+    const auto* intensities = m_intensities.data() + std::size_t(y) * std::size_t(m_width);
+    auto* line = bitmap.getLinePointer(y);
+
+    for (int x = 0; x < m_width; ++x) {
+      const auto index = std::size_t(std::min(intensities[x], 1.0f) * max_index);
+      *reinterpret_cast<juce::PixelARGB*>(line + x * bitmap.pixelStride) =
+          colour_map[index];
+    }
+  }
+}
+
+float PersistenceBuffer::getIntensity(const int x, const int y) const noexcept {
+  if (x < 0 || y < 0 || x >= m_width || y >= m_height) return 0.0f;
+
+  return m_intensities[std::size_t(y) * std::size_t(m_width) + std::size_t(x)];
+}
+
+}  // namespace cmp
@@ -7,6 +7,8 @@
 
 #include "cmp_plot.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <memory>
 #include <stdexcept>
@@ -17,15 +19,22 @@
 #include "cmp_graph_area.h"
 #include "cmp_graph_line.h"
 #include "cmp_grid.h"
+#include "cmp_heatmap.h"
 #include "cmp_label.h"
 #include "cmp_legend.h"
 #include "cmp_lookandfeel.h"
 #include "cmp_trace.h"
+#include "cmp_trigger.h"
 #include "cmp_utils.h"
 #include "juce_core/system/juce_PlatformDefs.h"
 
 namespace cmp {
 
+static std::vector<std::span<const float>> getSpans(
+    const std::vector<std::vector<float>>& data) {
+  return {data.begin(), data.end()};
+}
+
 static std::pair<float, float> findMinMaxValuesInGraphLines(
     const std::vector<std::unique_ptr<cmp::GraphLine>>& graph_lines,
     const bool isXValue) noexcept {
@@ -33,7 +42,8 @@ static std::pair<float, float> findMinMaxValuesInGraphLines(
   auto min_value = std::numeric_limits<float>::max();
 
   for (const auto& graph : graph_lines) {
-    const auto& values = isXValue ? graph->getXData() : graph->getYData();
+    const auto values = isXValue ? std::span<const float>(graph->getXData())
+                                 : graph->getYData();
 
     if (!values.empty()) {
       const auto& current_max = *std::max_element(values.begin(), values.end());
@@ -231,6 +241,31 @@ void Plot::updateYLim(const Lim_f& new_y_lim) {
   }
 }
 
+void Plot::updateXYLim(const Lim_f& new_x_lim, const Lim_f& new_y_lim) {
+  // Update the graph lines and the grid once when both limits are set instead
+  // of once per limit.
+  const auto setUpdateDeferred = [this](const bool is_update_deferred) {
+    m_grid->setUpdateDeferred(is_update_deferred);
+    for (const auto& graph_line : *m_graph_lines) {
+      graph_line->setUpdateDeferred(is_update_deferred);
+    }
+  };
+
+  setUpdateDeferred(true);
+
+  try {
+    updateXLim(new_x_lim);
+    updateYLim(new_y_lim);
+  } catch (...) {
+    setUpdateDeferred(false);
+    m_notify_components_on_update.notify();
+    throw;
+  }
+
+  setUpdateDeferred(false);
+  m_notify_components_on_update.notify();
+}
+
 template <class ValueType>
 static auto getLimOffset(const ValueType min, const ValueType max,
                          const cmp::Scaling scaling) {
@@ -278,6 +313,10 @@ void Plot::yLim(const float min, const float max) {
   m_y_autoscale = false;
 }
 
+Lim_f Plot::getXLim() const noexcept { return m_x_lim.getValue(); }
+
+Lim_f Plot::getYLim() const noexcept { return m_y_lim.getValue(); }
+
 template <typename ValueType>
 static std::pair<std::vector<std::vector<ValueType>>,
                  std::vector<std::vector<ValueType>>>
@@ -303,7 +342,8 @@ void Plot::plotHorizontalLines(const std::vector<float>& y_coordinates,
       prepareDataForVerticalOrHorizontalLines<float>(y_coordinates, m_x_lim);
   if (x_data.empty() || y_data.empty()) return;
 
-  plotInternal<GraphLineType::horizontal>(y_data, x_data, graph_attributes);
+  plotInternal<GraphLineType::horizontal>(getSpans(y_data), x_data,
+                                          graph_attributes);
 }
 
 void Plot::plotVerticalLines(const std::vector<float>& x_coordinates,
@@ -312,17 +352,20 @@ void Plot::plotVerticalLines(const std::vector<float>& x_coordinates,
       prepareDataForVerticalOrHorizontalLines<float>(x_coordinates, m_y_lim);
   if (y_data.empty() || x_data.empty()) return;
 
-  plotInternal<GraphLineType::vertical>(y_data, x_data, graph_attributes);
+  plotInternal<GraphLineType::vertical>(getSpans(y_data), x_data,
+                                        graph_attributes);
 }
 
 template <GraphLineType t_graph_line_type>
-void Plot::plotInternal(const std::vector<std::vector<float>>& y_data,
+void Plot::plotInternal(const std::vector<std::span<const float>>& y_data,
                         const std::vector<std::vector<float>>& x_data,
                         const GraphAttributeList& graph_attributes,
-                        const bool update_y_data_only) {
+                        const bool update_y_data_only,
+                        const bool borrow_y_data) {
   if (update_y_data_only) jassert(!m_graph_lines->empty());
 
-  updateGraphLineYData<t_graph_line_type>(y_data, graph_attributes);
+  updateGraphLineYData<t_graph_line_type>(y_data, graph_attributes,
+                                          borrow_y_data);
 
   if (update_y_data_only) {
     goto skip_update_x_data_label;
@@ -340,11 +383,23 @@ void Plot::plotInternal(const std::vector<std::vector<float>>& y_data,
   }
 
 skip_update_x_data_label:
+  if constexpr (t_graph_line_type == GraphLineType::normal) {
+    if (m_trigger) updateTriggerXOffset();
+
+    // The graph-lines with equal x-data are downsampled in one sweep before
+    // they are updated.
+    std::vector<GraphLine*> graph_lines;
+    graph_lines.reserve(m_graph_lines->size<GraphLineType::any>());
+    for (const auto& graph_line : *m_graph_lines)
+      graph_lines.push_back(graph_line.get());
+    GraphLine::updateXYDownsampledIndicesBatched(graph_lines);
+  }
+
   m_notify_components_on_update.notify();
 }
 
 std::vector<std::vector<float>> Plot::generateXdataRamp(
-    const std::vector<std::vector<float>>& y_data) {
+    const std::vector<std::span<const float>>& y_data) {
   auto generateRamp = [&] {
     std::vector<std::vector<float>> x_data(y_data.size());
     auto x_graph_it = std::begin(x_data);
@@ -362,12 +417,27 @@ std::vector<std::vector<float>> Plot::generateXdataRamp(
 void Plot::plot(const std::vector<std::vector<float>>& y_data,
                 const std::vector<std::vector<float>>& x_data,
                 const GraphAttributeList& graph_attributes) {
-  plotInternal<GraphLineType::normal>(y_data, x_data, graph_attributes);
+  plotInternal<GraphLineType::normal>(getSpans(y_data), x_data,
+                                      graph_attributes);
+  repaint();
+}
+
+void Plot::plotBorrowed(const std::vector<std::span<const float>>& y_data,
+                        const std::vector<std::vector<float>>& x_data,
+                        const GraphAttributeList& graph_attributes) {
+  plotInternal<GraphLineType::normal>(y_data, x_data, graph_attributes, false,
+                                      true);
   repaint();
 }
 
 void Plot::plotUpdateYOnly(const std::vector<std::vector<float>>& y_data) {
-  plotInternal<GraphLineType::normal>(y_data, {}, {}, true);
+  plotInternal<GraphLineType::normal>(getSpans(y_data), {}, {}, true);
+  repaint(m_graph_bounds);
+}
+
+void Plot::plotUpdateYOnlyBorrowed(
+    const std::vector<std::span<const float>>& y_data) {
+  plotInternal<GraphLineType::normal>(y_data, {}, {}, true, true);
   repaint(m_graph_bounds);
 }
 
@@ -408,6 +478,252 @@ void Plot::fillBetween(
   }
 }
 
+void Plot::setMustKeepSamples(const std::vector<std::vector<bool>>& flags) {
+  if (flags.size() > m_graph_lines->size<GraphLineType::normal>()) {
+    throw std::invalid_argument(
+        "More must keep flags than graph lines, call plot() first.");
+  }
+
+  auto flags_it = flags.begin();
+  for (const auto& graph_line : *m_graph_lines) {
+    if (flags_it == flags.end()) break;
+    if (graph_line->getType() != GraphLineType::normal) continue;
+
+    graph_line->setMustKeepFlags(*flags_it++);
+    graph_line->updateXY();
+  }
+
+  repaint(m_graph_bounds);
+}
+
+void Plot::setErrorBars(const std::vector<ErrorBars>& error_bars) {
+  if (error_bars.size() > m_graph_lines->size<GraphLineType::normal>()) {
+    throw std::invalid_argument(
+        "More error bars than graph lines, call plot() first.");
+  }
+
+  auto error_bars_it = error_bars.begin();
+  for (const auto& graph_line : *m_graph_lines) {
+    if (error_bars_it == error_bars.end()) break;
+    if (graph_line->getType() != GraphLineType::normal) continue;
+
+    const auto num_samples = graph_line->getYData().size();
+    for (const auto* errors :
+         {&error_bars_it->y_lower, &error_bars_it->y_upper,
+          &error_bars_it->x_lower, &error_bars_it->x_upper}) {
+      if (!errors->empty() && errors->size() != num_samples)
+        throw std::invalid_argument("The errors must be one per sample.");
+    }
+
+    graph_line->setErrorBars(*error_bars_it++);
+    graph_line->updateXY();
+  }
+
+  repaint(m_graph_bounds);
+}
+
+void Plot::plotHeatmap(std::vector<float> values,
+                       const std::size_t num_columns, const Lim_f& x_extent,
+                       const Lim_f& y_extent,
+                       const HeatmapAttribute& heatmap_attribute) {
+  getHeatmapForNewData(values.size(), num_columns, x_extent, y_extent)
+      .setData(std::move(values), num_columns, x_extent, y_extent,
+               heatmap_attribute);
+  repaint();
+}
+
+void Plot::plotHeatmapBorrowed(std::span<const float> values,
+                               const std::size_t num_columns,
+                               const Lim_f& x_extent, const Lim_f& y_extent,
+                               const HeatmapAttribute& heatmap_attribute) {
+  getHeatmapForNewData(values.size(), num_columns, x_extent, y_extent)
+      .setBorrowedData(values, num_columns, x_extent, y_extent,
+                       heatmap_attribute);
+  repaint();
+}
+
+void Plot::clearHeatmap() {
+  if (!m_heatmap) return;
+
+  removeChildComponent(m_heatmap.get());
+  m_heatmap.reset();
+  repaint(m_graph_bounds);
+}
+
+Heatmap& Plot::getHeatmapForNewData(const std::size_t num_values,
+                                    const std::size_t num_columns,
+                                    const Lim_f& x_extent,
+                                    const Lim_f& y_extent) {
+  if (num_columns == 0u || num_values % num_columns != 0u) {
+    throw std::invalid_argument(
+        "The number of values must be a multiple of the number of columns.");
+  }
+
+  if (!(x_extent.max > x_extent.min) || !(y_extent.max > y_extent.min)) {
+    throw std::invalid_argument("Min value must be lower than max value.");
+  }
+
+  if (!m_heatmap) {
+    m_heatmap = std::make_unique<Heatmap>();
+
+    m_graph_bounds.addObserver(*m_heatmap);
+    m_x_scaling.addObserver(*m_heatmap);
+    m_y_scaling.addObserver(*m_heatmap);
+    m_x_lim.addObserver(*m_heatmap);
+    m_y_lim.addObserver(*m_heatmap);
+
+    m_heatmap->setLookAndFeel(getPlotLookAndFeel());
+    m_heatmap->setBounds(m_graph_bounds);
+
+    addAndMakeVisible(m_heatmap.get());
+    m_heatmap->toBack();
+    m_grid->toBack();
+  }
+
+  // Without graph lines the heatmap decides the limits.
+  if (m_graph_lines->size<GraphLineType::normal>() == 0u &&
+      !m_is_panning_or_zoomed_active) {
+    if (m_x_autoscale) {
+      m_x_lim_start = x_extent;
+      updateXLim(m_x_lim_start);
+    }
+
+    if (m_y_autoscale) {
+      m_y_lim_start = y_extent;
+      updateYLim(m_y_lim_start);
+    }
+  }
+
+  return *m_heatmap;
+}
+
+void Plot::setPersistence(const std::optional<float> decay_per_second) {
+  if (decay_per_second &&
+      !(*decay_per_second >= 0.0f && *decay_per_second < 1.0f)) {
+    throw std::invalid_argument("The decay must be in [0, 1).");
+  }
+
+  for (const auto& graph_line : *m_graph_lines) {
+    if (graph_line->getType() == GraphLineType::normal)
+      graph_line->setPersistence(decay_per_second);
+  }
+
+  m_persistence_decay = decay_per_second;
+  repaint(m_graph_bounds);
+}
+
+void Plot::setOctaveSmoothing(const std::optional<float> octave_fraction) {
+  if (octave_fraction &&
+      !(std::isfinite(*octave_fraction) && *octave_fraction > 0.0f)) {
+    throw std::invalid_argument("The octave fraction must be above zero.");
+  }
+
+  for (const auto& graph_line : *m_graph_lines) {
+    if (graph_line->getType() != GraphLineType::normal) continue;
+
+    graph_line->setOctaveSmoothing(octave_fraction);
+    graph_line->updateXY();
+  }
+
+  m_octave_fraction = octave_fraction;
+  repaint(m_graph_bounds);
+}
+
+void Plot::setDerivedTraces(
+    const std::vector<std::vector<DerivedTrace>>& derived_traces) {
+  if (derived_traces.size() > m_graph_lines->size<GraphLineType::normal>()) {
+    throw std::invalid_argument(
+        "More derived traces than graph lines, call plot() first.");
+  }
+
+  auto derived_traces_it = derived_traces.begin();
+  for (const auto& graph_line : *m_graph_lines) {
+    if (derived_traces_it == derived_traces.end()) break;
+    if (graph_line->getType() != GraphLineType::normal) continue;
+
+    graph_line->setDerivedTraces(*derived_traces_it++);
+    graph_line->updateXY();
+  }
+
+  repaint(m_graph_bounds);
+}
+
+void Plot::resetDerivedTraces() {
+  for (const auto& graph_line : *m_graph_lines) {
+    if (graph_line->getType() == GraphLineType::normal)
+      graph_line->resetDerivedTraces();
+  }
+}
+
+void Plot::setTrigger(const std::optional<Trigger>& trigger) {
+  m_trigger = trigger;
+  m_is_triggered = false;
+
+  // A trigger line that does not exist yet is searched for at the next
+  // update of the y-data.
+  if (m_trigger) {
+    if (m_trigger->graph_line_index <
+        m_graph_lines->size<GraphLineType::normal>())
+      updateTriggerXOffset();
+  } else {
+    for (const auto& graph_line : *m_graph_lines) {
+      if (graph_line->getType() == GraphLineType::normal)
+        graph_line->setXOffset(0.0f);
+    }
+  }
+
+  for (const auto& graph_line : *m_graph_lines) graph_line->updateXY();
+  repaint(m_graph_bounds);
+}
+
+bool Plot::isTriggered() const noexcept { return m_is_triggered; }
+
+void Plot::updateTriggerXOffset() {
+  const GraphLine* trigger_line = nullptr;
+  std::size_t graph_line_index = 0u;
+  for (const auto& graph_line : *m_graph_lines) {
+    if (graph_line->getType() != GraphLineType::normal) continue;
+
+    if (graph_line_index++ == m_trigger->graph_line_index) {
+      trigger_line = graph_line.get();
+      break;
+    }
+  }
+
+  if (!trigger_line) {
+    throw std::range_error("Trigger graph line index out of range.");
+  }
+
+  const auto& x_data = trigger_line->getXData();
+  const auto y_data = trigger_line->getYData();
+
+  m_is_triggered = false;
+  if (x_data.empty() || x_data.size() != y_data.size() ||
+      !trigger_line->isXDataSorted()) {
+    return;
+  }
+
+  // Only the crossings with data for the whole x-limits around them.
+  const auto x_lim = m_x_lim.getValue();
+  const auto first =
+      std::lower_bound(x_data.begin(), x_data.end(), x_data.front() - x_lim.min);
+  const auto last =
+      std::upper_bound(first, x_data.end(), x_data.back() - x_lim.max);
+
+  const auto crossing = TriggerSearch::findLastCrossing(
+      *m_trigger, y_data, std::size_t(std::distance(x_data.begin(), first)),
+      std::size_t(std::distance(x_data.begin(), last)));
+
+  m_is_triggered = crossing.has_value();
+  const auto x_offset =
+      crossing ? x_data[*crossing] : x_data.back() - x_lim.max;
+
+  for (const auto& graph_line : *m_graph_lines) {
+    if (graph_line->getType() == GraphLineType::normal)
+      graph_line->setXOffset(x_offset);
+  }
+}
+
 void cmp::Plot::setDownsamplingType(const DownsamplingType downsampling_type) {
   this->setDownsamplingTypeInternal(downsampling_type);
 }
@@ -524,6 +840,8 @@ void Plot::resizeChildrens() {
       m_frame->setBounds(frame_bound);
       m_selected_area->setBounds(graph_bound);
 
+      if (m_heatmap) m_heatmap->setBounds(graph_bound);
+
       for (const auto& graph_line : *m_graph_lines) {
         if (graph_line) graph_line->setBounds(graph_bound);
       }
@@ -553,6 +871,37 @@ void Plot::paint(juce::Graphics& g) {
   }
 }
 
+void Plot::paintOverChildren(juce::Graphics& g) {
+  if (auto* lnf = getPlotLookAndFeel(); lnf && m_measurement_cursors) {
+    lnf->drawMeasurementCursors(g, m_graph_bounds, *getMeasurementCursorsX(),
+                                getMeasurementStatistics());
+  }
+
+  if (auto* lnf = getPlotLookAndFeel(); lnf && m_crosshair_x) {
+    const auto x_value = getXDataFromXPixelCoordinate(
+        *m_crosshair_x, m_graph_bounds->withZeroOrigin().toFloat(), m_x_lim,
+        m_x_scaling);
+
+    const auto readouts = getCrosshairReadouts(x_value);
+    lnf->drawCrosshair(g, m_graph_bounds, *m_crosshair_x, x_value, readouts);
+    m_crosshair_area =
+        lnf->getCrosshairArea(m_graph_bounds, *m_crosshair_x, x_value, readouts);
+  } else {
+    m_crosshair_area.clear();
+  }
+
+  if (m_pending_input_latencies.empty()) return;
+
+  const auto now_ms = juce::Time::getMillisecondCounterHiRes();
+
+  // Every pending measurement is closed by the first paint after it, the
+  // latencies longer than the histogram range go in its overflow bin.
+  for (const auto& [user_input, start_ms] : m_pending_input_latencies)
+    m_input_latency_histograms[user_input].add(now_ms - start_ms);
+
+  m_pending_input_latencies.clear();
+}
+
 void Plot::parentHierarchyChanged() {
   auto* parentComponent = getParentComponent();
   if (parentComponent) {
@@ -598,14 +947,19 @@ void Plot::addGraphLineInternal(std::unique_ptr<GraphLine>& graph_line,
   graph_line->setBounds(m_graph_bounds);
   graph_line->setType(t_graph_line_type);
 
+  if constexpr (t_graph_line_type == GraphLineType::normal) {
+    if (m_persistence_decay) graph_line->setPersistence(m_persistence_decay);
+    if (m_octave_fraction) graph_line->setOctaveSmoothing(m_octave_fraction);
+  }
+
   addAndMakeVisible(graph_line.get());
   graph_line->toBehind(m_selected_area.get());
 }
 
 template <GraphLineType t_graph_line_type>
 void Plot::updateGraphLineYData(
-    const std::vector<std::vector<float>>& y_data,
-    const GraphAttributeList& graph_attribute_list) {
+    const std::vector<std::span<const float>>& y_data,
+    const GraphAttributeList& graph_attribute_list, const bool borrow_y_data) {
   if (y_data.empty()) return;
 
   UNLIKELY if (y_data.size() != m_graph_lines->size<t_graph_line_type>()) {
@@ -628,7 +982,11 @@ void Plot::updateGraphLineYData(
             "Y_data out of range, internal error, please create an issue "
             "on "
             "Github with a test case that triggers this error.");
-      graph_line->setYValues(*y_data_it++);
+      if (borrow_y_data) {
+        graph_line->setYValuesBorrowed(*y_data_it++);
+      } else {
+        graph_line->setYValues(*y_data_it++);
+      }
     }
   }
 
@@ -648,18 +1006,35 @@ void Plot::updateGraphLineYData(
 }
 
 template void Plot::updateGraphLineYData<GraphLineType::normal>(
-    const std::vector<std::vector<float>>& y_data,
-    const GraphAttributeList& graph_attribute_list);
+    const std::vector<std::span<const float>>& y_data,
+    const GraphAttributeList& graph_attribute_list, const bool borrow_y_data);
 
 template <GraphLineType t_graph_line_type>
 void Plot::updateGraphLineXData(const std::vector<std::vector<float>>& x_data) {
   // There is a bug in the code if this assert happens.
   jassert(x_data.size() == m_graph_lines->size<t_graph_line_type>());
 
+  // The first graph-line with each distinct x-data, the others share it.
+  std::vector<std::pair<const std::vector<float>*, const GraphLine*>>
+      distinct_x_data;
+
   auto x_data_it = x_data.begin();
   for (const auto& graph : *m_graph_lines) {
     if (graph->getType() == t_graph_line_type) {
-      graph->setXValues(*x_data_it++);
+      graph->setXValues(*x_data_it);
+
+      const auto distinct_it =
+          std::find_if(distinct_x_data.begin(), distinct_x_data.end(),
+                       [&](const auto& distinct) {
+                         return *distinct.first == *x_data_it;
+                       });
+      if (distinct_it != distinct_x_data.end()) {
+        graph->shareXValues(*distinct_it->second);
+      } else {
+        distinct_x_data.emplace_back(&*x_data_it, graph.get());
+      }
+
+      ++x_data_it;
     }
   }
 
@@ -673,6 +1048,141 @@ void Plot::setLegend(const StringVector& graph_descriptions) {
   m_legend->setLegend(graph_descriptions);
 }
 
+void Plot::setCrosshairEnabled(const bool crosshair_enabled) {
+  m_is_crosshair_enabled = crosshair_enabled;
+
+  if (!m_is_crosshair_enabled && m_crosshair_x) {
+    m_crosshair_x.reset();
+    repaintCrosshair();
+  }
+}
+
+std::vector<CrosshairReadout> Plot::getCrosshairReadouts(
+    const float x_value) const {
+  std::vector<CrosshairReadout> readouts;
+
+  const auto* lnf = dynamic_cast<LookAndFeelMethods*>(&getLookAndFeel());
+  if (!lnf) return readouts;
+
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+
+  readouts.reserve(m_graph_lines->size<GraphLineType::normal>());
+
+  // The index is counted among the graph lines plotted with 'plot', the same
+  // index as in 'y_data'.
+  std::size_t graph_line_index = 0u;
+  for (const auto& graph_line : *m_graph_lines) {
+    if (graph_line->getType() != GraphLineType::normal) continue;
+
+    if (const auto y_value = graph_line->getYValueAt(x_value)) {
+      const auto data_value = juce::Point<float>(x_value, *y_value);
+
+      readouts.push_back(
+          {graph_line_index, data_value,
+           lnf->getTracePointPositionFrom(m_graph_bounds, m_x_lim, m_x_scaling,
+                                          m_y_lim, m_y_scaling, data_value),
+           graph_line->getColour()});
+    }
+
+    graph_line_index++;
+  }
+
+  return readouts;
+}
+
+void Plot::setMeasurementCursors(const float x_start, const float x_end) {
+  m_measurement_cursors = {x_start, x_end};
+  repaint(m_graph_bounds);
+}
+
+void Plot::removeMeasurementCursors() {
+  m_measurement_cursors.reset();
+  m_dragged_measurement_cursor.reset();
+  repaint(m_graph_bounds);
+}
+
+std::optional<std::pair<float, float>> Plot::getMeasurementCursors()
+    const noexcept {
+  return m_measurement_cursors;
+}
+
+std::vector<MeasurementStatistics> Plot::getMeasurementStatistics() const {
+  std::vector<MeasurementStatistics> statistics;
+  if (!m_measurement_cursors) return statistics;
+
+  const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+
+  statistics.reserve(m_graph_lines->size<GraphLineType::normal>());
+
+  // The index is counted among the graph lines plotted with 'plot', the same
+  // index as in 'y_data'.
+  std::size_t graph_line_index = 0u;
+  for (const auto& graph_line : *m_graph_lines) {
+    if (graph_line->getType() != GraphLineType::normal) continue;
+
+    if (const auto values = graph_line->getStatisticsBetween(
+            m_measurement_cursors->first, m_measurement_cursors->second)) {
+      statistics.push_back({graph_line_index, values->min, values->max,
+                            values->mean, values->rms, values->num_samples,
+                            graph_line->getColour()});
+    }
+
+    graph_line_index++;
+  }
+
+  return statistics;
+}
+
+std::optional<std::pair<float, float>> Plot::getMeasurementCursorsX() const {
+  if (!m_measurement_cursors) return std::nullopt;
+
+  const auto bounds = m_graph_bounds->withZeroOrigin().toFloat();
+
+  return std::make_pair(
+      getXPixelCoordinateFromXData(m_measurement_cursors->first, bounds,
+                                   m_x_lim, m_x_scaling),
+      getXPixelCoordinateFromXData(m_measurement_cursors->second, bounds,
+                                   m_x_lim, m_x_scaling));
+}
+
+LatencyHistogram Plot::getInputLatencyHistogram(
+    const UserInputAction user_input_action) const {
+  const auto it = m_input_latency_histograms.find(user_input_action);
+
+  return it != m_input_latency_histograms.end() ? it->second
+                                                 : LatencyHistogram();
+}
+
+void Plot::resetInputLatencyHistograms() noexcept {
+  m_pending_input_latencies.clear();
+  m_input_latency_histograms.clear();
+}
+
+void Plot::startInputLatencyMeasurement(const UserInputAction user_input) {
+  switch (user_input) {
+    // These actions do not change anything that is painted.
+    case UserInputAction::zoom_in:
+    case UserInputAction::zoom_out:
+    case UserInputAction::create_movable_pixel_point:
+    case UserInputAction::remove_movable_pixel_point:
+    case UserInputAction::none:
+      return;
+    default:
+      break;
+  }
+
+  // The pending measurements are only closed by a paint, e.g. none while the
+  // plot is hidden, so their number is bounded.
+  constexpr auto max_pending_measurements = 1024u;
+  if (m_pending_input_latencies.size() >= max_pending_measurements) return;
+
+  // Both ends are taken from the same monotonic clock. The event time is from
+  // the wall clock, which can jump, so the time in the message queue is not
+  // included.
+  m_pending_input_latencies.emplace_back(
+      user_input, juce::Time::getMillisecondCounterHiRes());
+}
+
 void Plot::addOrRemoveTracePoint(const juce::MouseEvent& event) {
   const auto component_pos = event.eventComponent->getBounds().getPosition();
 
@@ -688,6 +1198,8 @@ void Plot::addOrRemoveTracePoint(const juce::MouseEvent& event) {
 
 void Plot::mouseHandler(const juce::MouseEvent& event,
                         const UserInputAction user_input) {
+  startInputLatencyMeasurement(user_input);
+
   switch (user_input) {
     case UserInputAction::create_tracepoint: {
       addOrRemoveTracePoint(event);
@@ -739,6 +1251,14 @@ void Plot::mouseHandler(const juce::MouseEvent& event,
       resetZoom();
       break;
     }
+    case UserInputAction::zoom_back: {
+      zoomBack();
+      break;
+    }
+    case UserInputAction::zoom_forward: {
+      zoomForward();
+      break;
+    }
     case UserInputAction::create_movable_pixel_point: {
       break;
     }
@@ -753,6 +1273,14 @@ void Plot::mouseHandler(const juce::MouseEvent& event,
     case UserInputAction::remove_movable_pixel_point: {
       break;
     }
+    case UserInputAction::move_crosshair: {
+      moveCrosshair(event);
+      break;
+    }
+    case UserInputAction::move_measurement_cursor: {
+      moveMeasurementCursor(event);
+      break;
+    }
     default: {
       break;
     }
@@ -829,12 +1357,81 @@ void Plot::moveSelectedTracePoints(const juce::MouseEvent& event) {
 }
 
 void Plot::resetZoom() {
+  addViewToZoomHistory();
+
   m_is_panning_or_zoomed_active = false;
-  updateXLim(m_x_lim_start);
-  updateYLim(m_y_lim_start);
+  updateXYLim(m_x_lim_start, m_y_lim_start);
+
+  addViewToZoomHistory();
+  repaint();
+}
+
+void Plot::addViewToZoomHistory() {
+  const auto view = std::make_pair(m_x_lim.getValue(), m_y_lim.getValue());
+
+  // A new view replaces the views ahead of the current view.
+  if (!m_zoom_history.empty()) m_zoom_history.resize(m_zoom_history_index + 1u);
+
+  if (m_zoom_history.empty() || m_zoom_history.back() != view) {
+    m_zoom_history.push_back(view);
+  }
+
+  if (m_zoom_history.size() > max_zoom_history_size) {
+    m_zoom_history.erase(m_zoom_history.begin());
+  }
+
+  m_zoom_history_index = m_zoom_history.size() - 1u;
+  storeViewInGraphLineCaches();
+}
+
+void Plot::storeViewInGraphLineCaches() {
+  for (const auto& graph_line : *m_graph_lines) {
+    graph_line->storeViewInCache();
+  }
+}
+
+void Plot::zoomToViewInHistory(const std::size_t zoom_history_index) {
+  m_zoom_history_index = zoom_history_index;
+
+  const auto& [x_lim, y_lim] = m_zoom_history[m_zoom_history_index];
+
+  m_is_panning_or_zoomed_active =
+      x_lim != m_x_lim_start || y_lim != m_y_lim_start;
+  updateXYLim(x_lim, y_lim);
+  storeViewInGraphLineCaches();
   repaint();
 }
 
+void Plot::updateViewXLim(const Lim_f& new_x_lim) {
+  m_is_panning_or_zoomed_active = true;
+  updateXLim(new_x_lim);
+  repaint();
+}
+
+bool Plot::zoomBack() {
+  // The current view is added if it has been changed since, e.g. by panning.
+  const auto view = std::make_pair(m_x_lim.getValue(), m_y_lim.getValue());
+  if (m_zoom_history.empty() || m_zoom_history[m_zoom_history_index] != view) {
+    addViewToZoomHistory();
+  }
+
+  if (m_zoom_history_index == 0u) return false;
+
+  zoomToViewInHistory(m_zoom_history_index - 1u);
+  return true;
+}
+
+bool Plot::zoomForward() {
+  const auto view = std::make_pair(m_x_lim.getValue(), m_y_lim.getValue());
+  if (m_zoom_history_index + 1u >= m_zoom_history.size() ||
+      m_zoom_history[m_zoom_history_index] != view) {
+    return false;
+  }
+
+  zoomToViewInHistory(m_zoom_history_index + 1u);
+  return true;
+}
+
 void Plot::setStartPosSelectedRegion(const juce::Point<int>& start_position) {
   for (auto& trace_point : m_trace->getTraceLabelPoints()) {
     m_trace->selectTracePoint(trace_point.trace_point.get(), false);
@@ -848,15 +1445,23 @@ void Plot::drawSelectedRegion(const juce::Point<int>& end_position) {
   m_selected_area->repaint();
 }
 
-void Plot::zoomOnSelectedRegion() {
+void Plot::zoomTo(const Lim_f& x_lim, const Lim_f& y_lim) {
+  addViewToZoomHistory();
+
   m_is_panning_or_zoomed_active = true;
+  updateXYLim(x_lim, y_lim);
+
+  addViewToZoomHistory();
+  repaint();
+}
+
+void Plot::zoomOnSelectedRegion() {
   const auto data_bound = m_selected_area->getDataBound<float>();
 
-  updateXLim({data_bound.getX(), data_bound.getX() + data_bound.getWidth()});
-  updateYLim({data_bound.getY(), data_bound.getY() + data_bound.getHeight()});
+  zoomTo({data_bound.getX(), data_bound.getX() + data_bound.getWidth()},
+         {data_bound.getY(), data_bound.getY() + data_bound.getHeight()});
 
   m_selected_area->reset();
-  repaint();
 }
 
 void Plot::selectedTracePointsWithinSelectedArea() {
@@ -918,9 +1523,28 @@ void Plot::mouseDown(const juce::MouseEvent& event) {
     const auto lnf = getPlotLookAndFeel();
     if (m_selected_area.get() == event.eventComponent) {
       if (event.mods.isRightButtonDown()) {
-        mouseHandler(
-            event, lnf->getUserInputAction(UserInput::right | UserInput::drag |
-                                           UserInput::graph_area));
+        auto user_input =
+            UserInput::right | UserInput::drag | UserInput::graph_area;
+
+        if (event.mods.isShiftDown()) {
+          user_input = user_input | UserInput::shift;
+        } else if (event.mods.isCommandDown()) {
+          user_input = user_input | UserInput::ctrl;
+        }
+
+        mouseHandler(event, lnf->getUserInputAction(user_input));
+      } else if (const auto cursors_x = getMeasurementCursorsX()) {
+        // Grab the closest measurement cursor if the mouse is on it.
+        constexpr auto grab_distance = 4.0f;
+
+        const auto mouse_x = m_prev_mouse_position.getX();
+        const auto first_distance = std::abs(cursors_x->first - mouse_x);
+        const auto second_distance = std::abs(cursors_x->second - mouse_x);
+
+        if (std::min(first_distance, second_distance) <= grab_distance) {
+          m_dragged_measurement_cursor =
+              first_distance <= second_distance ? 0u : 1u;
+        }
       }
     }
 
@@ -951,6 +1575,11 @@ void Plot::mouseDrag(const juce::MouseEvent& event) {
       mouseHandler(event,
                    lnf->getUserInputAction(UserInput::left | UserInput::drag |
                                            UserInput::legend));
+    } else if (m_selected_area.get() == event.eventComponent &&
+               m_dragged_measurement_cursor) {
+      mouseHandler(event,
+                   lnf->getUserInputAction(UserInput::left | UserInput::drag |
+                                           UserInput::measurement_cursor));
     } else if (m_selected_area.get() == event.eventComponent &&
                event.mouseWasDraggedSinceMouseDown() &&
                event.getNumberOfClicks() == 1) {
@@ -985,6 +1614,8 @@ void Plot::mouseDrag(const juce::MouseEvent& event) {
 void Plot::mouseUp(const juce::MouseEvent& event) {
   if (isVisible()) {
     const auto lnf = getPlotLookAndFeel();
+    m_dragged_measurement_cursor.reset();
+
     if (m_selected_area.get() == event.eventComponent &&
         m_mouse_drag_state == MouseDragState::drag) {
       if (!event.mods.isRightButtonDown()) {
@@ -1006,6 +1637,22 @@ void Plot::mouseUp(const juce::MouseEvent& event) {
   }
 }
 
+void Plot::mouseMove(const juce::MouseEvent& event) {
+  if (isVisible() && m_is_crosshair_enabled &&
+      m_selected_area.get() == event.eventComponent) {
+    const auto lnf = getPlotLookAndFeel();
+    mouseHandler(event, lnf->getUserInputAction(UserInput::move |
+                                                UserInput::graph_area));
+  }
+}
+
+void Plot::mouseExit(const juce::MouseEvent& event) {
+  if (m_crosshair_x && m_selected_area.get() == event.eventComponent) {
+    m_crosshair_x.reset();
+    repaintCrosshair();
+  }
+}
+
 void Plot::modifierKeysChanged(const juce::ModifierKeys& modifiers) {
   m_modifiers = &modifiers;
 }
@@ -1020,7 +1667,7 @@ void Plot::addSelectableTracePoints() {
   m_trace->clear();
 
   for (const auto& graph_line : *m_graph_lines) {
-    const auto& y_values = graph_line->getYData();
+    const auto y_values = graph_line->getYData();
     size_t data_point_index = 0;
 
     for (; data_point_index < y_values.size(); data_point_index++) {
@@ -1070,6 +1717,48 @@ void Plot::setGraphLineDataChangedCallback(
   m_graph_lines_changed_callback = graph_lines_changed_callback;
 }
 
+void Plot::moveCrosshair(const juce::MouseEvent& event) {
+  m_crosshair_x = getMousePositionRelativeToGraphArea(event).getX();
+  repaintCrosshair();
+}
+
+void Plot::repaintCrosshair() {
+  // Only the crosshair as last painted and at its new position are repainted,
+  // not the whole graph area with all graph lines below it.
+  auto area = m_crosshair_area;
+
+  if (auto* lnf = getPlotLookAndFeel(); lnf && m_crosshair_x) {
+    const auto x_value = getXDataFromXPixelCoordinate(
+        *m_crosshair_x, m_graph_bounds->withZeroOrigin().toFloat(), m_x_lim,
+        m_x_scaling);
+
+    area.add(lnf->getCrosshairArea(m_graph_bounds, *m_crosshair_x, x_value,
+                                   getCrosshairReadouts(x_value)));
+  }
+
+  for (const auto& rectangle : area) repaint(rectangle);
+}
+
+void Plot::moveMeasurementCursor(const juce::MouseEvent& event) {
+  if (!m_measurement_cursors || !m_dragged_measurement_cursor) return;
+
+  const auto x_value = getXDataFromXPixelCoordinate(
+      getMousePositionRelativeToGraphArea(event).getX(),
+      m_graph_bounds->withZeroOrigin().toFloat(), m_x_lim, m_x_scaling);
+
+  if (*m_dragged_measurement_cursor == 0u) {
+    m_measurement_cursors->first = x_value;
+  } else {
+    m_measurement_cursors->second = x_value;
+  }
+
+  repaint(m_graph_bounds);
+
+  if (onMeasurementCursorsChange) {
+    onMeasurementCursorsChange(this, getMeasurementStatistics());
+  }
+}
+
 void Plot::panning(const juce::MouseEvent& event) {
   const auto mouse_pos = getMousePositionRelativeToGraphArea(event);
   const auto d_mouse_pos = mouse_pos - m_prev_mouse_position;
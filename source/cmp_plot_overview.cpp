@@ -0,0 +1,264 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "cmp_plot_overview.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+#include "cmp_graph_line.h"
+#include "cmp_lookandfeel.h"
+#include "cmp_plot.h"
+#include "cmp_utils.h"
+
+namespace cmp {
+
+/** Distance in pixels to grab an edge of the view window. */
+static constexpr float edge_grab_distance = 4.0f;
+
+/** Minimum width in pixels of the view window when resized. */
+static constexpr float min_window_width = 4.0f;
+
+static std::vector<Lim_f> getColumnMinMaxOfUnsortedData(
+    const GraphLine& graph_line, const juce::Rectangle<float>& bounds,
+    const Lim_f x_lim, const Scaling x_scaling, const std::size_t num_columns) {
+  constexpr auto nan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<Lim_f> columns(num_columns, Lim_f(nan, nan));
+
+  const auto& x_data = graph_line.getXData();
+  const auto y_data = graph_line.getYData();
+
+  for (std::size_t i = 0u; i < std::min(x_data.size(), y_data.size()); ++i) {
+    const auto column_x =
+        getXPixelCoordinateFromXData(x_data[i], bounds, x_lim, x_scaling);
+    if (!(column_x >= 0.0f && column_x < float(num_columns)) ||
+        std::isnan(y_data[i])) {
+      continue;
+    }
+
+    auto& column = columns[std::size_t(column_x)];
+    column.min = std::isnan(column.min) ? y_data[i] : std::min(column.min, y_data[i]);
+    column.max = std::isnan(column.max) ? y_data[i] : std::max(column.max, y_data[i]);
+  }
+
+  return columns;
+}
+
+PlotOverview::PlotOverview(Plot& plot) : m_plot{plot} {
+  m_plot.m_x_lim.addObserver(*this);
+  m_plot.m_y_lim.addObserver(*this);
+  m_plot.m_notify_components_on_update.addObserver(*this);
+}
+
+void PlotOverview::observableValueUpdated(ObserverId, const Lim<float>&) {
+  // Only the view window has moved, the image is reused.
+  repaint();
+}
+
+void PlotOverview::observableValueUpdated(ObserverId, const bool&) {
+  repaint();
+}
+
+bool PlotOverview::RenderKey::operator==(const RenderKey& rhs) const noexcept {
+  return x_lim == rhs.x_lim && y_lim == rhs.y_lim &&
+         x_scaling == rhs.x_scaling && y_scaling == rhs.y_scaling &&
+         lookandfeel == rhs.lookandfeel &&
+         data_generations == rhs.data_generations && colours == rhs.colours;
+}
+
+PlotOverview::RenderKey PlotOverview::getRenderKey() const {
+  RenderKey key{m_plot.m_x_lim_start,
+                m_plot.m_y_lim_start,
+                m_plot.m_x_scaling.getValue(),
+                m_plot.m_y_scaling.getValue(),
+                &m_plot.getLookAndFeel(),
+                {},
+                {}};
+
+  for (const auto& graph_line : *m_plot.m_graph_lines) {
+    if (graph_line->getType() != GraphLineType::normal) continue;
+
+    key.data_generations.push_back(graph_line->getDataGeneration());
+    key.colours.push_back(graph_line->getColour());
+  }
+
+  return key;
+}
+
+void PlotOverview::render() {
+  const auto bounds = getLocalBounds();
+  m_image = juce::Image(juce::Image::ARGB, std::max(bounds.getWidth(), 1),
+                        std::max(bounds.getHeight(), 1), true);
+
+  auto* lnf = m_plot.getPlotLookAndFeel();
+  if (!lnf) return;
+
+  juce::Graphics g(m_image);
+  lnf->drawBackground(g, bounds);
+
+  const auto& x_lim = m_plot.m_x_lim_start;
+  const auto& y_lim = m_plot.m_y_lim_start;
+  const auto x_scaling = m_plot.m_x_scaling.getValue();
+  const auto y_scaling = m_plot.m_y_scaling.getValue();
+  if (x_lim.min >= x_lim.max || y_lim.min >= y_lim.max) return;
+
+  const auto float_bounds = bounds.toFloat();
+  const auto num_columns = std::size_t(bounds.getWidth());
+
+  for (const auto& graph_line : *m_plot.m_graph_lines) {
+    if (graph_line->getType() != GraphLineType::normal) continue;
+
+    std::vector<Lim_f> columns;
+
+    // Sorted x-data, the min/max of each column is resolved from the range
+    // statistics index of the graph line without scanning the samples.
+    if (graph_line->isXDataSorted()) {
+      columns.reserve(num_columns);
+      auto column_start =
+          getXDataFromXPixelCoordinate(0.0f, float_bounds, x_lim, x_scaling);
+
+      for (std::size_t c = 0u; c < num_columns; ++c) {
+        const auto column_end = getXDataFromXPixelCoordinate(
+            float(c + 1u), float_bounds, x_lim, x_scaling);
+
+        if (const auto values =
+                graph_line->getStatisticsBetween(column_start, column_end)) {
+          columns.emplace_back(values->min, values->max);
+        } else {
+          columns.emplace_back(std::numeric_limits<float>::quiet_NaN(),
+                               std::numeric_limits<float>::quiet_NaN());
+        }
+
+        column_start = column_end;
+      }
+    } else {
+      columns = getColumnMinMaxOfUnsortedData(*graph_line, float_bounds, x_lim,
+                                              x_scaling, num_columns);
+    }
+
+    // The max y-value has the lowest y-pixel.
+    for (auto& column : columns) {
+      if (std::isnan(column.min)) continue;
+
+      column = Lim_f(
+          getYPixelCoordinateFromYData(column.max, float_bounds, y_lim,
+                                       y_scaling),
+          getYPixelCoordinateFromYData(column.min, float_bounds, y_lim,
+                                       y_scaling));
+    }
+
+    lnf->drawOverviewGraphLine(g, columns, graph_line->getColour());
+  }
+}
+
+void PlotOverview::paint(juce::Graphics& g) {
+  auto* lnf = m_plot.getPlotLookAndFeel();
+  if (!lnf) return;
+
+  {
+    const std::lock_guard<std::recursive_mutex> lock(plot_mutex);
+
+    auto render_key = getRenderKey();
+    if (!m_render_key || !(*m_render_key == render_key)) {
+      render();
+      m_render_key = std::move(render_key);
+    }
+  }
+
+  g.drawImageAt(m_image, 0, 0);
+  lnf->drawOverviewWindow(g, getLocalBounds(), getViewWindow());
+}
+
+void PlotOverview::resized() {
+  m_render_key.reset();
+  repaint();
+}
+
+float PlotOverview::getXPixelFromXData(const float x) const {
+  return getXPixelCoordinateFromXData(x, getLocalBounds().toFloat(),
+                                      m_plot.m_x_lim_start,
+                                      m_plot.m_x_scaling.getValue());
+}
+
+float PlotOverview::getXDataFromXPixel(const float x_pixel) const {
+  return getXDataFromXPixelCoordinate(x_pixel, getLocalBounds().toFloat(),
+                                      m_plot.m_x_lim_start,
+                                      m_plot.m_x_scaling.getValue());
+}
+
+juce::Rectangle<float> PlotOverview::getViewWindow() const {
+  const auto& x_lim = m_plot.m_x_lim.getValue();
+  const auto left = getXPixelFromXData(x_lim.min);
+  const auto right = getXPixelFromXData(x_lim.max);
+
+  return {left, 0.0f, std::max(right - left, 1.0f), float(getHeight())};
+}
+
+void PlotOverview::mouseDown(const juce::MouseEvent& event) {
+  const auto& x_lim_start = m_plot.m_x_lim_start;
+  if (x_lim_start.min >= x_lim_start.max) return;
+
+  m_plot.addViewToZoomHistory();
+
+  const auto window = getViewWindow();
+  const auto x = event.position.getX();
+
+  if (std::abs(x - window.getX()) <= edge_grab_distance) {
+    m_drag_type = DragType::move_start;
+  } else if (std::abs(x - window.getRight()) <= edge_grab_distance) {
+    m_drag_type = DragType::move_end;
+  } else {
+    m_drag_type = DragType::pan;
+
+    // A click outside of the window centres the window on the click.
+    if (x < window.getX() || x > window.getRight()) {
+      const auto half_width = window.getWidth() / 2.0f;
+      m_plot.updateViewXLim({getXDataFromXPixel(x - half_width),
+                             getXDataFromXPixel(x + half_width)});
+    }
+  }
+
+  m_drag_start_x_lim = m_plot.m_x_lim.getValue();
+}
+
+void PlotOverview::mouseDrag(const juce::MouseEvent& event) {
+  const auto& x_lim_start = m_plot.m_x_lim_start;
+  if (x_lim_start.min >= x_lim_start.max) return;
+
+  // Dragged in pixels to pan logarithmic x-axes evenly.
+  const auto distance = float(event.getDistanceFromDragStartX());
+  auto left = getXPixelFromXData(m_drag_start_x_lim.min);
+  auto right = getXPixelFromXData(m_drag_start_x_lim.max);
+
+  switch (m_drag_type) {
+    case DragType::pan:
+      left += distance;
+      right += distance;
+      break;
+    case DragType::move_start:
+      left = std::min(left + distance, right - min_window_width);
+      break;
+    case DragType::move_end:
+      right = std::max(right + distance, left + min_window_width);
+      break;
+    default:
+      break;
+  }
+
+  m_plot.updateViewXLim({getXDataFromXPixel(left), getXDataFromXPixel(right)});
+}
+
+void PlotOverview::mouseUp(const juce::MouseEvent&) {
+  const auto& x_lim_start = m_plot.m_x_lim_start;
+  if (x_lim_start.min >= x_lim_start.max) return;
+
+  m_plot.addViewToZoomHistory();
+}
+
+}  // namespace cmp
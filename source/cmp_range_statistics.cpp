@@ -0,0 +1,149 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "cmp_range_statistics.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace cmp {
+
+namespace {
+
+/** Accumulates samples, NaN values are skipped. */
+struct Accumulator {
+  double sum{0.0}, sum_squared{0.0};
+  std::size_t count{0u};
+  float min{std::numeric_limits<float>::infinity()};
+  float max{-std::numeric_limits<float>::infinity()};
+
+  void add(const float* first, const float* last) noexcept {
+    for (; first != last; ++first) {
+      const auto y = *first;
+      if (std::isnan(y)) continue;
+
+      sum += double(y);
+      sum_squared += double(y) * double(y);
+      ++count;
+      min = std::min(min, y);
+      max = std::max(max, y);
+    }
+  }
+};
+
+}  // namespace
+
+std::size_t RangeStatistics::getNumBlocks() const noexcept {
+  return m_count.size() - 1u;
+}
+
+std::size_t RangeStatistics::getNumIndexedSamples() const noexcept {
+  return getNumBlocks() * block_size;
+}
+
+void RangeStatistics::update(std::span<const float> y_data) {
+  const auto num_blocks = y_data.size() / block_size;
+  if (num_blocks <= getNumBlocks()) return;
+
+  if (m_min.empty()) {
+    m_min.emplace_back();
+    m_max.emplace_back();
+  }
+
+  for (auto block = getNumBlocks(); block < num_blocks; ++block) {
+    const auto* block_begin = y_data.data() + block * block_size;
+
+    Accumulator acc;
+    acc.add(block_begin, block_begin + block_size);
+
+    m_sum.push_back(m_sum.back() + acc.sum);
+    m_sum_squared.push_back(m_sum_squared.back() + acc.sum_squared);
+    m_count.push_back(m_count.back() + acc.count);
+    m_min[0].push_back(acc.min);
+    m_max[0].push_back(acc.max);
+  }
+
+  // Extend each level with the entries that the new blocks complete.
+  for (std::size_t level = 1u; (std::size_t(1u) << level) <= num_blocks;
+       ++level) {
+    if (m_min.size() == level) {
+      m_min.emplace_back();
+      m_max.emplace_back();
+    }
+
+    const auto half = std::size_t(1u) << (level - 1u);
+    const auto num_entries = num_blocks - (half << 1u) + 1u;
+
+    for (auto i = m_min[level].size(); i < num_entries; ++i) {
+      m_min[level].push_back(
+          std::min(m_min[level - 1u][i], m_min[level - 1u][i + half]));
+      m_max[level].push_back(
+          std::max(m_max[level - 1u][i], m_max[level - 1u][i + half]));
+    }
+  }
+}
+
+void RangeStatistics::invalidateFrom(const std::size_t index) {
+  const auto num_blocks = index / block_size;
+  if (num_blocks >= getNumBlocks()) return;
+
+  m_sum.resize(num_blocks + 1u);
+  m_sum_squared.resize(num_blocks + 1u);
+  m_count.resize(num_blocks + 1u);
+
+  for (std::size_t level = 0u; level < m_min.size(); ++level) {
+    const auto span = std::size_t(1u) << level;
+    const auto num_entries = num_blocks >= span ? num_blocks - span + 1u : 0u;
+
+    m_min[level].resize(std::min(m_min[level].size(), num_entries));
+    m_max[level].resize(std::min(m_max[level].size(), num_entries));
+  }
+}
+
+std::optional<RangeStatistics::Values> RangeStatistics::getStatistics(
+    std::span<const float> y_data, std::size_t first,
+    std::size_t last) const {
+  last = std::min(last, y_data.size());
+  if (first >= last) return std::nullopt;
+
+  Accumulator acc;
+
+  // The complete blocks within the range, the rest is scanned.
+  const auto first_block = (first + block_size - 1u) / block_size;
+  const auto last_block = std::min(last / block_size, getNumBlocks());
+
+  if (first_block >= last_block) {
+    acc.add(y_data.data() + first, y_data.data() + last);
+  } else {
+    acc.add(y_data.data() + first, y_data.data() + first_block * block_size);
+    acc.add(y_data.data() + last_block * block_size, y_data.data() + last);
+
+    acc.sum += m_sum[last_block] - m_sum[first_block];
+    acc.sum_squared += m_sum_squared[last_block] - m_sum_squared[first_block];
+    acc.count += m_count[last_block] - m_count[first_block];
+
+    // Two overlapping power of two spans cover the blocks.
+    const auto level = std::size_t(std::bit_width(last_block - first_block)) - 1u;
+    const auto second = last_block - (std::size_t(1u) << level);
+
+    acc.min = std::min({acc.min, m_min[level][first_block], m_min[level][second]});
+    acc.max = std::max({acc.max, m_max[level][first_block], m_max[level][second]});
+  }
+
+  if (acc.count == 0u) return std::nullopt;
+
+  const auto num_samples = double(acc.count);
+
+  // The difference of two prefix sums may end up slightly negative.
+  return Values{acc.min, acc.max, float(acc.sum / num_samples),
+                float(std::sqrt(std::max(acc.sum_squared / num_samples, 0.0))),
+                acc.count};
+}
+
+}  // namespace cmp
@@ -0,0 +1,48 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "cmp_sample_flags.h"
+
+namespace cmp {
+
+void SampleFlags::assign(const std::vector<bool>& flags) {
+  const auto num_words = (flags.size() + samples_per_word - 1u) / samples_per_word;
+
+  m_words.assign(num_words, 0u);
+  m_block_summary.assign((num_words + samples_per_word - 1u) / samples_per_word,
+                         0u);
+  m_size = flags.size();
+  m_num_flagged = 0u;
+
+  for (std::size_t i = 0u; i < flags.size(); ++i) {
+    if (!flags[i]) continue;
+
+    const auto word = i / samples_per_word;
+    m_words[word] |= 1ULL << (i % samples_per_word);
+    m_block_summary[word / samples_per_word] |= 1ULL << (word % samples_per_word);
+    m_num_flagged++;
+  }
+}
+
+void SampleFlags::clear() noexcept {
+  m_words.clear();
+  m_block_summary.clear();
+  m_size = 0u;
+  m_num_flagged = 0u;
+}
+
+bool SampleFlags::empty() const noexcept { return m_num_flagged == 0u; }
+
+std::size_t SampleFlags::size() const noexcept { return m_size; }
+
+bool SampleFlags::test(const std::size_t index) const noexcept {
+  if (index >= m_size) return false;
+
+  return (m_words[index / samples_per_word] >> (index % samples_per_word)) & 1u;
+}
+
+}  // namespace cmp
@@ -0,0 +1,156 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include "cmp_trigger.h"
+
+#include <algorithm>
+
+#include "cmp_simd.h"
+
+namespace cmp {
+
+namespace {
+
+enum class Comparison { below, at_or_above, above, at_or_below };
+
+template <Comparison t_comparison>
+inline bool compare(const float value, const float threshold) noexcept {
+  if constexpr (t_comparison == Comparison::below) return value < threshold;
+  if constexpr (t_comparison == Comparison::at_or_above)
+    return value >= threshold;
+  if constexpr (t_comparison == Comparison::above) return value > threshold;
+  return value <= threshold;
+}
+
+#if CMP_USE_SSE2
+template <Comparison t_comparison>
+inline __m128 compare(const __m128 values, const __m128 threshold) noexcept {
+  // The ordered comparisons are false for NaN, the same as the scalar ones.
+  if constexpr (t_comparison == Comparison::below)
+    return _mm_cmplt_ps(values, threshold);
+  if constexpr (t_comparison == Comparison::at_or_above)
+    return _mm_cmpge_ps(values, threshold);
+  if constexpr (t_comparison == Comparison::above)
+    return _mm_cmpgt_ps(values, threshold);
+  return _mm_cmple_ps(values, threshold);
+}
+#elif CMP_USE_NEON
+template <Comparison t_comparison>
+inline uint32x4_t compare(const float32x4_t values,
+                          const float32x4_t threshold) noexcept {
+  if constexpr (t_comparison == Comparison::below)
+    return vcltq_f32(values, threshold);
+  if constexpr (t_comparison == Comparison::at_or_above)
+    return vcgeq_f32(values, threshold);
+  if constexpr (t_comparison == Comparison::above)
+    return vcgtq_f32(values, threshold);
+  return vcleq_f32(values, threshold);
+}
+#endif
+
+template <Comparison t_comparison>
+std::size_t findFirst(const float* data, std::size_t first,
+                      const std::size_t last, const float threshold) noexcept {
+  // Blocks of 16 samples are skipped as long as no sample matches, the
+  // matching block is then searched sample by sample.
+  constexpr std::size_t block_size = 16u;
+
+#if CMP_USE_SSE2
+  const auto threshold_4 = _mm_set1_ps(threshold);
+
+  for (; first + block_size <= last; first += block_size) {
+    const auto* block = data + first;
+    const auto match =
+        _mm_or_ps(_mm_or_ps(compare<t_comparison>(_mm_loadu_ps(block), threshold_4),
+                            compare<t_comparison>(_mm_loadu_ps(block + 4), threshold_4)),
+                  _mm_or_ps(compare<t_comparison>(_mm_loadu_ps(block + 8), threshold_4),
+                            compare<t_comparison>(_mm_loadu_ps(block + 12), threshold_4)));
+
+    if (_mm_movemask_ps(match) != 0) break;
+  }
+#elif CMP_USE_NEON
+  const auto threshold_4 = vdupq_n_f32(threshold);
+
+  for (; first + block_size <= last; first += block_size) {
+    const auto* block = data + first;
+    const auto match =
+        vorrq_u32(vorrq_u32(compare<t_comparison>(vld1q_f32(block), threshold_4),
+                            compare<t_comparison>(vld1q_f32(block + 4), threshold_4)),
+                  vorrq_u32(compare<t_comparison>(vld1q_f32(block + 8), threshold_4),
+                            compare<t_comparison>(vld1q_f32(block + 12), threshold_4)));
+
+    if (vmaxvq_u32(match) != 0u) break;
+  }
+#endif
+
+  for (; first < last; ++first) {
+    if (compare<t_comparison>(data[first], threshold)) return first;
+  }
+
+  return last;
+}
+
+}  // namespace
+
+std::optional<std::size_t> TriggerSearch::findLastCrossing(
+    const Trigger& trigger, std::span<const float> y_data,
+    const std::size_t first, std::size_t last) {
+  last = std::min(last, y_data.size());
+  if (first >= last) return std::nullopt;
+
+  const auto* data = y_data.data();
+  const auto hysteresis = std::max(trigger.hysteresis, 0.0f);
+  const auto is_rising = trigger.edge == TriggerEdge::rising;
+
+  std::optional<std::size_t> crossing;
+
+  // The samples before 'first' can arm the trigger.
+  for (std::size_t i = 0u;;) {
+    const auto armed =
+        is_rising ? findFirstBelow(data, i, last, trigger.level - hysteresis)
+                  : findFirstAbove(data, i, last, trigger.level + hysteresis);
+    if (armed >= last) break;
+
+    const auto crossed =
+        is_rising ? findFirstAtOrAbove(data, armed + 1u, last, trigger.level)
+                  : findFirstAtOrBelow(data, armed + 1u, last, trigger.level);
+    if (crossed >= last) break;
+
+    if (crossed >= first) crossing = crossed;
+    i = crossed + 1u;
+  }
+
+  return crossing;
+}
+
+std::size_t TriggerSearch::findFirstBelow(const float* data, std::size_t first,
+                                          const std::size_t last,
+                                          const float threshold) noexcept {
+  return findFirst<Comparison::below>(data, first, last, threshold);
+}
+
+std::size_t TriggerSearch::findFirstAtOrAbove(const float* data,
+                                              std::size_t first,
+                                              const std::size_t last,
+                                              const float threshold) noexcept {
+  return findFirst<Comparison::at_or_above>(data, first, last, threshold);
+}
+
+std::size_t TriggerSearch::findFirstAbove(const float* data, std::size_t first,
+                                          const std::size_t last,
+                                          const float threshold) noexcept {
+  return findFirst<Comparison::above>(data, first, last, threshold);
+}
+
+std::size_t TriggerSearch::findFirstAtOrBelow(const float* data,
+                                              std::size_t first,
+                                              const std::size_t last,
+                                              const float threshold) noexcept {
+  return findFirst<Comparison::at_or_below>(data, first, last, threshold);
+}
+
+}  // namespace cmp
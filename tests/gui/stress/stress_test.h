@@ -0,0 +1,400 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#pragma once
+
+#include <juce_gui_extra/juce_gui_extra.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "cmp_plot.h"
+
+/** Settings of the stress test, parsed from the command line.
+ *
+ * Example: --plots 4 --lines 16 --points 100000 --rate 60 --downsampling xy
+ *          --attributes markers,dashed,gradient,opacity
+ */
+struct StressTestSettings {
+  static constexpr auto usage =
+      "Usage: stress_test [--plots N] [--lines N] [--points N] [--rate HZ]\n"
+      "                   [--downsampling none|x|xy]\n"
+      "                   [--attributes markers,dashed,gradient,opacity]";
+
+  int num_plots{1};
+  int num_lines{8};
+  int num_points{10'000};
+  double update_rate_hz{60.0};
+  cmp::DownsamplingType downsampling_type{
+      cmp::DownsamplingType::xy_downsampling};
+  bool markers{false};
+  bool dashed{false};
+  bool gradient{false};
+  bool opacity{false};
+
+  /** @throws std::invalid_argument for an unknown argument or value, or an
+   * argument without a value. */
+  static StressTestSettings fromCommandLine(const juce::String& command_line) {
+    StressTestSettings settings;
+    const auto args = juce::StringArray::fromTokens(command_line, true);
+
+    for (int i = 0; i < args.size(); i += 2) {
+      const auto& key = args[i];
+      if (i + 1 == args.size()) {
+        throw std::invalid_argument("Missing value of " + key.toStdString() +
+                                    ".");
+      }
+      const auto& value = args[i + 1];
+
+      if (key == "--plots") {
+        settings.num_plots = std::max(1, value.getIntValue());
+      } else if (key == "--lines") {
+        settings.num_lines = std::max(1, value.getIntValue());
+      } else if (key == "--points") {
+        settings.num_points = std::max(2, value.getIntValue());
+      } else if (key == "--rate") {
+        settings.update_rate_hz = std::max(0.1, value.getDoubleValue());
+      } else if (key == "--downsampling") {
+        if (value == "none") {
+          settings.downsampling_type = cmp::DownsamplingType::no_downsampling;
+        } else if (value == "x") {
+          settings.downsampling_type = cmp::DownsamplingType::x_downsampling;
+        } else if (value == "xy") {
+          settings.downsampling_type = cmp::DownsamplingType::xy_downsampling;
+        } else {
+          throw std::invalid_argument("Unknown downsampling type.");
+        }
+      } else if (key == "--attributes") {
+        for (const auto& attribute :
+             juce::StringArray::fromTokens(value, ",", "")) {
+          if (attribute == "markers") {
+            settings.markers = true;
+          } else if (attribute == "dashed") {
+            settings.dashed = true;
+          } else if (attribute == "gradient") {
+            settings.gradient = true;
+          } else if (attribute == "opacity") {
+            settings.opacity = true;
+          } else {
+            throw std::invalid_argument("Unknown attribute " +
+                                        attribute.toStdString() + ".");
+          }
+        }
+      } else {
+        throw std::invalid_argument("Unknown argument " + key.toStdString() +
+                                    ".");
+      }
+    }
+
+    return settings;
+  }
+
+  cmp::GraphAttribute getGraphAttribute() const {
+    cmp::GraphAttribute graph_attribute;
+
+    if (markers) graph_attribute.marker = cmp::Marker(cmp::Marker::Type::Circle);
+    if (dashed) graph_attribute.dashed_lengths = std::vector<float>{4.f, 4.f};
+    if (opacity) graph_attribute.graph_line_opacity = 0.5f;
+    if (gradient) {
+      graph_attribute.gradient_colours =
+          std::make_pair(juce::Colours::blue, juce::Colours::transparentBlack);
+    }
+
+    return graph_attribute;
+  }
+
+  juce::String toString() const {
+    const juce::String ds_names[] = {"none", "x", "xy"};
+
+    return juce::String(num_plots) + " plots x " + juce::String(num_lines) +
+           " lines x " + juce::String(num_points) + " points @ " +
+           juce::String(update_rate_hz, 1) + " Hz, downsampling: " +
+           ds_names[int(downsampling_type)];
+  }
+};
+
+/** Running statistics of a single stage in milliseconds. */
+struct StageStatistics {
+  void add(const double ms) {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    m_sum += ms;
+    m_max = std::max(m_max, ms);
+    m_count++;
+  }
+
+  /** Returns {mean, max} since last call and resets. */
+  std::pair<double, double> takeMeanAndMax() {
+    const std::lock_guard<std::mutex> lock(m_mutex);
+    const auto result = std::make_pair(m_count ? m_sum / double(m_count) : 0.0,
+                                       m_max);
+    m_sum = m_max = 0.0;
+    m_count = 0;
+    return result;
+  }
+
+ private:
+  std::mutex m_mutex;
+  double m_sum{0.0}, m_max{0.0};
+  std::size_t m_count{0u};
+};
+
+struct StressStatistics {
+  std::atomic<std::size_t> num_handled{0u}, num_dropped{0u}, num_frames{0u};
+
+  /** From posting an update to the message thread until it is handled. */
+  StageStatistics queue_ms;
+  StageStatistics generate_ms, update_ms, paint_ms;
+};
+
+using StressClock = std::chrono::steady_clock;
+
+static double msBetween(const StressClock::time_point start,
+                        const StressClock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/** Holds a plot and measures the time it takes to paint it and all its
+ * children. */
+class PlotHolder : public juce::Component {
+ public:
+  PlotHolder(StressStatistics& statistics) : m_statistics{statistics} {
+    addAndMakeVisible(plot);
+  }
+
+  void resized() override { plot.setBounds(getLocalBounds()); }
+
+  void paint(juce::Graphics&) override { m_paint_start = StressClock::now(); }
+
+  void paintOverChildren(juce::Graphics&) override {
+    m_statistics.paint_ms.add(msBetween(m_paint_start, StressClock::now()));
+    m_statistics.num_frames++;
+  }
+
+  cmp::Plot plot;
+
+ private:
+  StressStatistics& m_statistics;
+  StressClock::time_point m_paint_start;
+};
+
+/** Draws the measured statistics on top of the plots. */
+class StressOverlay : public juce::Component, private juce::Timer {
+ public:
+  StressOverlay(StressStatistics& statistics, const StressTestSettings& settings)
+      : m_statistics{statistics}, m_settings_text{settings.toString()} {
+    setInterceptsMouseClicks(false, false);
+    startTimer(500);
+  }
+
+  void paint(juce::Graphics& g) override {
+    const auto bounds = getLocalBounds().removeFromTop(116).removeFromLeft(460);
+    g.setColour(juce::Colours::black.withAlpha(0.7f));
+    g.fillRect(bounds);
+    g.setColour(juce::Colours::white);
+    g.setFont(14.0f);
+    g.drawMultiLineText(m_text, bounds.getX() + 8, bounds.getY() + 18,
+                        bounds.getWidth() - 16);
+  }
+
+ private:
+  void timerCallback() override {
+    const auto now = StressClock::now();
+    const auto dt_s = msBetween(m_last_time, now) / 1000.0;
+    m_last_time = now;
+
+    const std::size_t num_frames = m_statistics.num_frames;
+    const std::size_t num_handled = m_statistics.num_handled;
+
+    const auto fps = double(num_frames - m_last_num_frames) / dt_s;
+    const auto ups = double(num_handled - m_last_num_handled) / dt_s;
+    m_last_num_frames = num_frames;
+    m_last_num_handled = num_handled;
+
+    const auto [queue_mean, queue_max] = m_statistics.queue_ms.takeMeanAndMax();
+    const auto [generate_mean, generate_max] =
+        m_statistics.generate_ms.takeMeanAndMax();
+    const auto [update_mean, update_max] =
+        m_statistics.update_ms.takeMeanAndMax();
+    const auto [paint_mean, paint_max] = m_statistics.paint_ms.takeMeanAndMax();
+
+    const auto ms = [](const double mean, const double max) {
+      return juce::String(mean, 2) + " / " + juce::String(max, 2) + " ms";
+    };
+
+    m_text = m_settings_text + "\n" + "FPS: " + juce::String(fps, 1) +
+             ", updates/s: " + juce::String(ups, 1) + ", dropped updates: " +
+             juce::String(std::size_t(m_statistics.num_dropped)) + "\n" +
+             "queue delay (mean / max): " + ms(queue_mean, queue_max) + "\n" +
+             "generate (mean / max): " + ms(generate_mean, generate_max) +
+             "\n" + "update (mean / max): " + ms(update_mean, update_max) +
+             "\n" + "paint (mean / max): " + ms(paint_mean, paint_max);
+
+    repaint();
+  }
+
+  StressStatistics& m_statistics;
+  const juce::String m_settings_text;
+  juce::String m_text;
+  StressClock::time_point m_last_time{StressClock::now()};
+  std::size_t m_last_num_frames{0u}, m_last_num_handled{0u};
+};
+
+/** Component running the stress test.
+ *
+ * A producer thread generates new y-data at the requested rate and posts it to
+ * the message thread where 'plotUpdateYOnly' is called. An update is dropped
+ * if the previous update of the same plot is not handled yet, so at most one
+ * update per plot is queued. The queue delay is the time from posting an
+ * update until the message thread handles it, which grows when the message
+ * thread falls behind.
+ */
+class StressTestComponent : public juce::Component, private juce::Thread {
+ public:
+  StressTestComponent(const StressTestSettings& settings)
+      : juce::Thread("stress data producer"),
+        m_settings{settings},
+        m_overlay{m_statistics, settings} {
+    setSize(1200, 800);
+
+    const auto graph_attribute = m_settings.getGraphAttribute();
+
+    for (int p = 0; p < m_settings.num_plots; ++p) {
+      auto& holder = m_holders.emplace_back(
+          std::make_unique<PlotHolder>(m_statistics));
+      auto& plot = holder->plot;
+
+      plot.setDownsamplingType(m_settings.downsampling_type);
+      plot.yLim(-1.5f, float(m_settings.num_lines) + 0.5f);
+      plot.xLim(1.0f, float(m_settings.num_points));
+      plot.plot(generateYData(0u),
+                {},
+                cmp::GraphAttributeList(std::size_t(m_settings.num_lines),
+                                        graph_attribute));
+
+      addAndMakeVisible(holder.get());
+    }
+
+    m_pending = std::vector<std::atomic<bool>>(m_holders.size());
+    m_posted_data.resize(m_holders.size());
+    m_post_times.resize(m_holders.size());
+
+    addAndMakeVisible(m_overlay);
+
+    startThread();
+  }
+
+  ~StressTestComponent() override { stopThread(2000); }
+
+  void resized() override {
+    auto bounds = getLocalBounds();
+    const auto columns =
+        int(std::ceil(std::sqrt(double(m_holders.size()))));
+    const auto rows = int(std::ceil(double(m_holders.size()) / columns));
+    const auto width = bounds.getWidth() / columns;
+    const auto height = bounds.getHeight() / rows;
+
+    for (std::size_t i = 0; i < m_holders.size(); ++i) {
+      const auto column = int(i) % columns;
+      const auto row = int(i) / columns;
+      m_holders[i]->setBounds(column * width, row * height, width, height);
+    }
+
+    m_overlay.setBounds(bounds);
+  }
+
+ private:
+  void run() override {
+    const auto period = std::chrono::duration_cast<StressClock::duration>(
+        std::chrono::duration<double>(1.0 / m_settings.update_rate_hz));
+    auto next_time = StressClock::now();
+    std::size_t frame{0u};
+
+    while (!threadShouldExit()) {
+      next_time += period;
+      frame++;
+
+      for (std::size_t p = 0; p < m_holders.size(); ++p) {
+        if (m_pending[p].exchange(true)) {
+          m_statistics.num_dropped++;
+          continue;
+        }
+
+        const auto generate_start = StressClock::now();
+        auto y_data = generateYData(frame + p);
+        m_statistics.generate_ms.add(
+            msBetween(generate_start, StressClock::now()));
+
+        {
+          const std::lock_guard<std::mutex> lock(m_data_mutex);
+          m_posted_data[p] = std::move(y_data);
+          m_post_times[p] = StressClock::now();
+        }
+
+        juce::MessageManager::callAsync(
+            [safe_this = juce::Component::SafePointer<StressTestComponent>(this), p] {
+              if (safe_this) safe_this->handleUpdate(p);
+            });
+      }
+
+      std::this_thread::sleep_until(next_time);
+    }
+  }
+
+  void handleUpdate(const std::size_t plot_index) {
+    std::vector<std::vector<float>> y_data;
+    StressClock::time_point post_time;
+    {
+      const std::lock_guard<std::mutex> lock(m_data_mutex);
+      y_data = std::move(m_posted_data[plot_index]);
+      post_time = m_post_times[plot_index];
+    }
+
+    const auto update_start = StressClock::now();
+    m_statistics.queue_ms.add(msBetween(post_time, update_start));
+    m_holders[plot_index]->plot.plotUpdateYOnly(y_data);
+    m_statistics.update_ms.add(msBetween(update_start, StressClock::now()));
+
+    m_pending[plot_index] = false;
+    m_statistics.num_handled++;
+  }
+
+  std::vector<std::vector<float>> generateYData(const std::size_t frame) const {
+    std::vector<std::vector<float>> y_data(std::size_t(m_settings.num_lines));
+
+    const auto w =
+        juce::MathConstants<float>::twoPi * 4.0f / float(m_settings.num_points);
+    const auto phase = float(frame) * 0.05f;
+
+    for (std::size_t l = 0; l < y_data.size(); ++l) {
+      auto& y = y_data[l];
+      y.resize(std::size_t(m_settings.num_points));
+
+      for (std::size_t i = 0; i < y.size(); ++i) {
+        y[i] = float(l) + 0.4f * std::sin(w * float(i) + phase + float(l));
+      }
+    }
+
+    return y_data;
+  }
+
+  const StressTestSettings m_settings;
+  StressStatistics m_statistics;
+  std::vector<std::unique_ptr<PlotHolder>> m_holders;
+  std::vector<std::atomic<bool>> m_pending;
+  std::vector<std::vector<std::vector<float>>> m_posted_data;
+  std::vector<StressClock::time_point> m_post_times;
+  std::mutex m_data_mutex;
+  StressOverlay m_overlay;
+
+  JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StressTestComponent)
+};
@@ -0,0 +1,93 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+#include <iostream>
+
+#include "stress_test.h"
+
+//==============================================================================
+class StressTestApp  : public juce::JUCEApplication
+{
+public:
+    //==============================================================================
+    StressTestApp() {}
+
+    const juce::String getApplicationName() override       { return JUCE_APPLICATION_NAME_STRING; }
+    const juce::String getApplicationVersion() override    { return JUCE_APPLICATION_VERSION_STRING; }
+    bool moreThanOneInstanceAllowed() override             { return true; }
+
+    void initialise (const juce::String& commandLine) override
+    {
+        StressTestSettings settings;
+
+        try
+        {
+            settings = StressTestSettings::fromCommandLine (commandLine);
+        }
+        catch (const std::invalid_argument& e)
+        {
+            std::cerr << e.what() << "\n" << StressTestSettings::usage << std::endl;
+            setApplicationReturnValue (1);
+            quit();
+            return;
+        }
+
+        mainWindow.reset (new MainWindow (getApplicationName(), settings));
+    }
+
+    void shutdown() override
+    {
+        mainWindow = nullptr; // (deletes our window)
+    }
+
+    void systemRequestedQuit() override
+    {
+        quit();
+    }
+
+    void anotherInstanceStarted (const juce::String& commandLine) override
+    {
+        juce::ignoreUnused (commandLine);
+    }
+
+    class MainWindow    : public juce::DocumentWindow
+    {
+    public:
+        MainWindow (juce::String name, const StressTestSettings& settings)
+            : DocumentWindow (name,
+                              juce::Desktop::getInstance().getDefaultLookAndFeel()
+                                                          .findColour (ResizableWindow::backgroundColourId),
+                              DocumentWindow::allButtons)
+        {
+            setUsingNativeTitleBar (true);
+            setContentOwned (new StressTestComponent (settings), true);
+
+           #if JUCE_IOS || JUCE_ANDROID
+            setFullScreen (true);
+           #else
+            setResizable (true, true);
+            centreWithSize (getWidth(), getHeight());
+           #endif
+
+            setVisible (true);
+        }
+
+        void closeButtonPressed() override
+        {
+            JUCEApplication::getInstance()->systemRequestedQuit();
+        }
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MainWindow)
+    };
+
+private:
+    std::unique_ptr<MainWindow> mainWindow;
+};
+
+//==============================================================================
+START_JUCE_APPLICATION (StressTestApp)
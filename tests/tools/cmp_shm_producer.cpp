@@ -0,0 +1,113 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * Shared memory ring buffer producer.
+ *
+ * Writes random walk frames to a shared memory ring buffer at a fixed rate,
+ * standing in for an acquisition process when testing a consumer such as
+ * cmp::ShmRingBufferReader. The ring buffer is removed when the producer
+ * exits.
+ *
+ * Usage: cmp_shm_producer [--name /cmp_daq] [--channels N] [--capacity N]
+ *                         [--rate frames_per_s] [--chunk N] [--seconds N]
+ */
+
+#include <juce_core/juce_core.h>
+
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cmp_shm_ring_buffer.hpp"
+#include "example_generators.h"
+
+namespace {
+
+struct Settings {
+  std::string name{"/cmp_daq"};
+  std::size_t num_channels{4};
+  std::size_t capacity{1u << 20u};
+  double frames_per_second{100'000.0};
+  std::size_t chunk_size{1000};
+  double seconds{60.0};
+};
+
+Settings parseSettings(int argc, char* argv[]) {
+  Settings settings;
+
+  for (int i = 1; i + 1 < argc; i += 2) {
+    const std::string key = argv[i];
+    const std::string value = argv[i + 1];
+
+    if (key == "--name") {
+      settings.name = value;
+    } else if (key == "--channels") {
+      settings.num_channels = std::stoul(value);
+    } else if (key == "--capacity") {
+      settings.capacity = std::stoul(value);
+    } else if (key == "--rate") {
+      settings.frames_per_second = std::stod(value);
+    } else if (key == "--chunk") {
+      settings.chunk_size = std::max<std::size_t>(std::stoul(value), 1u);
+    } else if (key == "--seconds") {
+      settings.seconds = std::stod(value);
+    } else {
+      throw std::invalid_argument("Unknown argument: " + key);
+    }
+  }
+
+  return settings;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const auto settings = parseSettings(argc, argv);
+
+  cmp::ShmRingBufferWriter writer(settings.name, cmp::ShmDataType::float32,
+                                  settings.num_channels, settings.capacity);
+
+  const auto num_frames =
+      std::uint64_t(settings.frames_per_second * settings.seconds);
+
+  auto generator = cmp::InterleavedFrameGenerator<
+      float, cmp::RandomWalkGenerator<float>>(
+      settings.num_channels, [&](const std::size_t channel) {
+        return cmp::RandomWalkGenerator<float>(num_frames, channel);
+      });
+
+  std::vector<float> chunk(settings.chunk_size * settings.num_channels);
+
+  std::cout << "Writing " << num_frames << " frames of "
+            << settings.num_channels << " channels to " << writer.getName()
+            << std::endl;
+
+  // Chunks are written on a fixed schedule, a slow iteration is caught up.
+  const auto start = std::chrono::steady_clock::now();
+  const auto chunk_duration = std::chrono::duration<double>(
+      double(settings.chunk_size) / settings.frames_per_second);
+
+  for (std::uint64_t chunk_index = 0u;; ++chunk_index) {
+    const auto num_written = generator.fill(chunk);
+    if (num_written == 0u) break;
+
+    writer.write<float>(std::span<const float>(
+        chunk.data(), num_written * settings.num_channels));
+
+    std::this_thread::sleep_until(
+        start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    chunk_duration * double(chunk_index + 1u)));
+  }
+
+  std::cout << "Wrote " << writer.getWriteIndex() << " frames" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "cmp_csv_loader.hpp"
+#include "cmp_test_helper.hpp"
+
+static juce::File writeTempFile(const juce::String& text) {
+  auto file = juce::File::createTempFile(".csv");
+  file.replaceWithText(text, false, false, nullptr);
+  return file;
+}
+
+SECTION(CsvLoaderTest, "CSV loader") {
+  TEST("Header, quotes, CRLF and missing fields") {
+    const auto file =
+        writeTempFile("time, \"value\",c\r\n1,2.5,+3\r\n\r\n4,,x\r\n7,8\r\n");
+    const auto csv = cmp::loadCsvColumns(file);
+    file.deleteFile();
+
+    expect(csv.names == std::vector<std::string>{"time", "value", "c"});
+    expectEquals(csv.columns.size(), std::size_t(3));
+    expect(csv.columns[0] == std::vector<float>{1.0f, 4.0f, 7.0f});
+    expectEquals(csv.columns[1][0], 2.5f);
+    expect(std::isnan(csv.columns[1][1]));
+    expectEquals(csv.columns[2][0], 3.0f);
+    expect(std::isnan(csv.columns[2][1]) && std::isnan(csv.columns[2][2]));
+  }
+
+  TEST("TSV without header and without trailing newline") {
+    const auto file = writeTempFile("1\t2\n3\t4");
+    const auto csv = cmp::loadCsvColumns(file);
+    file.deleteFile();
+
+    expect(csv.names.empty());
+    expect(csv.columns ==
+           std::vector<std::vector<float>>{{1.0f, 3.0f}, {2.0f, 4.0f}});
+  }
+
+  TEST("Parallel chunks give the same rows as a single thread") {
+    constexpr std::size_t num_rows = 50'000u;
+
+    juce::String text("x,y\n");
+    for (std::size_t i = 0u; i < num_rows; ++i) {
+      text << juce::String(i) << "," << juce::String(float(i) * 0.5f) << "\n";
+    }
+    const auto file = writeTempFile(text);
+
+    cmp::CsvLoadOptions options;
+    options.min_chunk_size = 1024u;
+    options.num_threads = 1u;
+    const auto single_thread = cmp::loadCsvColumns(file, options);
+
+    auto last_progress = 0.0;
+    auto is_progress_increasing = true;
+    options.num_threads = 7u;
+    options.progress_callback = [&](const double progress) {
+      is_progress_increasing &= progress >= last_progress;
+      last_progress = progress;
+    };
+    const auto multi_thread = cmp::loadCsvColumns(file, options);
+    file.deleteFile();
+
+    expectEquals(single_thread.columns[0].size(), num_rows);
+    expectEquals(single_thread.columns[1][num_rows - 1u],
+                 float(num_rows - 1u) * 0.5f);
+    expect(single_thread.columns == multi_thread.columns);
+    expect(is_progress_increasing);
+    expectEquals(last_progress, 1.0);
+  }
+
+  TEST("Missing file throws") {
+    bool did_throw = false;
+    try {
+      cmp::loadCsvColumns(juce::File::getSpecialLocation(
+                              juce::File::tempDirectory)
+                              .getChildFile("cmp_csv_loader_missing.csv"));
+    } catch (const std::runtime_error&) {
+      did_throw = true;
+    }
+    expect(did_throw);
+  }
+}
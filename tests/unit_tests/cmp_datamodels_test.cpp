@@ -1,5 +1,6 @@
 #include "cmp_datamodels.h"
 #include "cmp_test_helper.hpp"
+#include "cmp_view_cache.h"
 #include <string>
 
 using namespace cmp;
@@ -131,3 +132,91 @@ SECTION(ObservableTest, "Observable class tests") {
     }
   }
 }
+
+SECTION(LatencyHistogramTest, "LatencyHistogram tests") {
+  TEST("Empty histogram") {
+    LatencyHistogram histogram;
+
+    expectEquals(histogram.count, std::size_t(0));
+    expectEquals(histogram.getMean(), 0.0);
+    expectEquals(histogram.getPercentile(99.0), 0.0);
+  }
+
+  TEST("Statistics and percentiles") {
+    LatencyHistogram histogram;
+
+    for (int i = 1; i <= 100; ++i) histogram.add(double(i) * 0.1);
+
+    expectEquals(histogram.count, std::size_t(100));
+    expectWithinAbsoluteError(histogram.getMean(), 5.05, 1e-9);
+    expectWithinAbsoluteError(histogram.min_ms, 0.1, 1e-9);
+    expectWithinAbsoluteError(histogram.max_ms, 10.0, 1e-9);
+
+    // The percentile is the upper edge of the bin.
+    expectWithinAbsoluteError(histogram.getPercentile(50.0), 5.5, 1e-9);
+    expectWithinAbsoluteError(histogram.getPercentile(100.0), 10.0, 1e-9);
+  }
+
+  TEST("Overflow and negative latencies") {
+    LatencyHistogram histogram;
+
+    histogram.add(-1.0);
+    histogram.add(1'000.0);
+
+    expectEquals(histogram.counts.front(), std::size_t(1));
+    expectEquals(histogram.counts.back(), std::size_t(1));
+    expectEquals(histogram.getPercentile(100.0), 1'000.0);
+
+    histogram.reset();
+    expectEquals(histogram.count, std::size_t(0));
+    expectEquals(histogram.counts.back(), std::size_t(0));
+  }
+
+  TEST("Non-finite latencies are clamped") {
+    LatencyHistogram histogram;
+
+    histogram.add(std::numeric_limits<double>::quiet_NaN());
+    histogram.add(-std::numeric_limits<double>::infinity());
+    histogram.add(std::numeric_limits<double>::infinity());
+
+    expectEquals(histogram.count, std::size_t(3));
+    expectEquals(histogram.counts.front(), std::size_t(2));
+    expectEquals(histogram.counts.back(), std::size_t(1));
+    expectEquals(histogram.min_ms, 0.0);
+    expectEquals(histogram.max_ms, std::numeric_limits<double>::max());
+  }
+}
+
+SECTION(ViewCacheTest, "ViewCache tests") {
+  const auto makeKey = [](const float x_max, const std::size_t generation) {
+    return ViewKey{{0.0f, x_max},     {0.0f, 1.0f},     {0, 0, 100, 100},
+                   Scaling::linear, Scaling::linear, generation};
+  };
+
+  TEST("Least recently used view is dropped") {
+    ViewCache<int> cache(2u);
+
+    cache.insert(makeKey(1.0f, 0u), 1);
+    cache.insert(makeKey(2.0f, 0u), 2);
+
+    // Finding the first view makes the second the least recently used.
+    expectEquals(*cache.find(makeKey(1.0f, 0u)), 1);
+    cache.insert(makeKey(3.0f, 0u), 3);
+
+    expectEquals(cache.size(), std::size_t(2));
+    expect(cache.find(makeKey(2.0f, 0u)) == nullptr);
+    expectEquals(*cache.find(makeKey(1.0f, 0u)), 1);
+    expectEquals(*cache.find(makeKey(3.0f, 0u)), 3);
+  }
+
+  TEST("Views of another generation are not found") {
+    ViewCache<int> cache;
+
+    cache.insert(makeKey(1.0f, 0u), 1);
+    cache.insert(makeKey(1.0f, 0u), 4);
+
+    expectEquals(cache.size(), std::size_t(1));
+    expectEquals(*cache.find(makeKey(1.0f, 0u)), 4);
+    expect(cache.find(makeKey(1.0f, 1u)) == nullptr);
+  }
+}
@@ -0,0 +1,88 @@
+#include "cmp_derived_trace.h"
+
+#include <cmath>
+#include <limits>
+
+#include "cmp_test_helper.hpp"
+
+SECTION(DerivedTraceTest, "Derived trace") {
+  TEST("Max and min hold") {
+    cmp::DerivedTraceState max_hold({cmp::DerivedTraceType::max_hold});
+    cmp::DerivedTraceState min_hold({cmp::DerivedTraceType::min_hold});
+    std::vector<float> max_values, min_values;
+
+    // The sizes are not a multiple of the vector width.
+    const std::vector<std::vector<float>> frames{
+        {1, 5, 3, 0, -1, 2, 7},
+        {2, 4, 3, 1, -2, 2, 6},
+        {0, 6, 1, 1, -3, 9, 0}};
+
+    for (const auto& frame : frames) {
+      max_hold.update(frame, max_values);
+      min_hold.update(frame, min_values);
+    }
+
+    expectEquals(max_hold.getNumFrames(), std::size_t(3));
+    expect(max_values == std::vector<float>{2, 6, 3, 1, -1, 9, 7});
+    expect(min_values == std::vector<float>{0, 4, 1, 0, -3, 2, 0});
+  }
+
+  TEST("NaN does not replace a value") {
+    constexpr auto NaN = std::numeric_limits<float>::quiet_NaN();
+
+    cmp::DerivedTraceState max_hold({cmp::DerivedTraceType::max_hold});
+    std::vector<float> values;
+
+    max_hold.update(std::vector<float>{NaN, 1, 2, 3, 4, NaN}, values);
+    max_hold.update(std::vector<float>{5, NaN, 1, 4, 3, NaN}, values);
+
+    expectEquals(values[0], 5.0f);
+    expectEquals(values[1], 1.0f);
+    expectEquals(values[2], 2.0f);
+    expectEquals(values[3], 4.0f);
+    expectEquals(values[4], 4.0f);
+    expect(std::isnan(values[5]));
+  }
+
+  TEST("Exponential average") {
+    cmp::DerivedTraceState average(
+        {cmp::DerivedTraceType::exponential_average, 0.5f});
+    std::vector<float> values;
+
+    average.update(std::vector<float>(9, 4.0f), values);
+    average.update(std::vector<float>(9, 0.0f), values);
+    average.update(std::vector<float>(9, 0.0f), values);
+
+    for (const auto value : values) expectEquals(value, 1.0f);
+  }
+
+  TEST("Average of the last frames") {
+    cmp::DerivedTrace derived_trace{cmp::DerivedTraceType::average};
+    derived_trace.num_frames = 2u;
+    cmp::DerivedTraceState average(derived_trace);
+    std::vector<float> values;
+
+    average.update(std::vector<float>(5, 2.0f), values);
+    for (const auto value : values) expectEquals(value, 2.0f);
+
+    average.update(std::vector<float>(5, 4.0f), values);
+    for (const auto value : values) expectEquals(value, 3.0f);
+
+    average.update(std::vector<float>(5, 8.0f), values);
+    for (const auto value : values) expectEquals(value, 6.0f);
+  }
+
+  TEST("Start over after a reset or a new size") {
+    cmp::DerivedTraceState max_hold({cmp::DerivedTraceType::max_hold});
+    std::vector<float> values;
+
+    max_hold.update(std::vector<float>{5, 5, 5}, values);
+    max_hold.reset();
+    max_hold.update(std::vector<float>{1, 2, 3}, values);
+    expect(values == std::vector<float>{1, 2, 3});
+
+    max_hold.update(std::vector<float>{0, 0, 0, 0}, values);
+    expect(values == std::vector<float>{0, 0, 0, 0});
+    expectEquals(max_hold.getNumFrames(), std::size_t(1));
+  }
+}
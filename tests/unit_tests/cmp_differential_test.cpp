@@ -0,0 +1,606 @@
+/**
+ * Copyright (c) 2022 Frans Rosencrantz
+ *
+ * This software is released under the MIT License.
+ * https://opensource.org/licenses/MIT
+ */
+
+/**
+ * Differential tests of the optimized graph line paths.
+ *
+ * The reference renders every data point, i.e. no downsampling, with its own
+ * pixel transform and the plain PlotLookAndFeel::drawGraphLine. The optimized
+ * modes are rendered through a cmp::Plot and the result is compared pixel by
+ * pixel within a tolerance. Failing cases are shrunk before being reported.
+ *
+ * DownsamplingType::x_downsampling by design discards points sharing the same
+ * x-pixel, its reference renders the points kept by a plain scalar version of
+ * the x-decimation instead of every data point.
+ */
+
+#include <juce_core/juce_core.h>
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "cmp_datamodels.h"
+#include "cmp_graph_line.h"
+#include "cmp_lookandfeel.h"
+#include "cmp_plot.h"
+#include "cmp_test_helper.hpp"
+#include "cmp_utils.h"
+
+namespace {
+
+constexpr int plot_width = 600;
+constexpr int plot_height = 400;
+
+/** Two pixels are equal if the alpha differs less than this. A line moved by
+ * one pixel changes at least one pixel of every row or column it crosses by
+ * half the full intensity or more, so this must stay well below 128. */
+constexpr int intensity_tolerance = 80;
+
+/** Allowed fraction of mismatching pixels. Joints and anti-aliasing of
+ * removed collinear points may differ slightly. */
+constexpr double mismatch_tolerance = 0.005;
+
+/** Number of mismatching pixels always allowed. */
+constexpr std::size_t mismatch_floor = 8u;
+
+struct DiffCase {
+  juce::String name;
+  std::vector<float> x, y;
+  cmp::Scaling x_scaling{cmp::Scaling::linear};
+  cmp::Scaling y_scaling{cmp::Scaling::linear};
+  cmp::Lim_f x_lim, y_lim;
+
+  /** The x-offset the data is plotted with, set from the plot when rendered
+   * since it is found by the trigger. */
+  float x_offset{0.0f};
+
+  std::optional<cmp::StepType> step;
+  std::optional<cmp::Trigger> trigger;
+
+  /** Flag per data point, empty if no samples must be kept. */
+  std::vector<bool> must_keep;
+};
+
+struct OptimizedMode {
+  juce::String name;
+  cmp::DownsamplingType downsampling_type;
+
+  /** Sets up a generated case for the mode.
+   * @return false if the mode does not apply to the case. */
+  bool (*adapt_case)(DiffCase&);
+};
+
+bool isXDataSorted(const DiffCase& diff_case) {
+  return std::is_sorted(diff_case.x.begin(), diff_case.x.end());
+}
+
+bool keepCase(DiffCase&) { return true; }
+
+/** The visible range of the x-decimation is found with a binary search, i.e.
+ * it needs sorted x-data. */
+bool keepSortedCase(DiffCase& diff_case) { return isXDataSorted(diff_case); }
+
+/** Narrows the y-limits to the middle half of the data, the runs outside are
+ * collapsed. */
+bool narrowYLim(DiffCase& diff_case) {
+  const auto [y_min, y_max] = diff_case.y_lim;
+
+  if (diff_case.y_scaling == cmp::Scaling::linear) {
+    const auto quarter = (y_max - y_min) / 4.0f;
+    diff_case.y_lim = {y_min + quarter, y_max - quarter};
+  } else {
+    const auto quarter = std::pow(y_max / y_min, 0.25f);
+    diff_case.y_lim = {y_min * quarter, y_max / quarter};
+  }
+
+  return true;
+}
+
+bool flagMustKeepSamples(DiffCase& diff_case) {
+  if (!isXDataSorted(diff_case)) return false;
+
+  std::mt19937 gen(unsigned(diff_case.x.size()));
+  std::bernoulli_distribution is_flagged(0.002);
+
+  diff_case.must_keep.resize(diff_case.x.size());
+  for (std::size_t i = 0; i < diff_case.must_keep.size(); ++i)
+    diff_case.must_keep[i] = is_flagged(gen);
+
+  return true;
+}
+
+/** Triggers on the middle level of the data and shows half of the data
+ * around the crossing. */
+bool triggerOnMiddleLevel(DiffCase& diff_case) {
+  if (diff_case.x_scaling != cmp::Scaling::linear ||
+      diff_case.y_scaling != cmp::Scaling::linear || !isXDataSorted(diff_case))
+    return false;
+
+  const auto [y_min, y_max] = diff_case.y_lim;
+  diff_case.trigger = cmp::Trigger{cmp::TriggerEdge::rising,
+                                   (y_min + y_max) / 2.0f,
+                                   (y_max - y_min) * 0.05f};
+
+  const auto quarter = (diff_case.x_lim.max - diff_case.x_lim.min) / 4.0f;
+  diff_case.x_lim = {-quarter, quarter};
+
+  return true;
+}
+
+bool drawSteps(DiffCase& diff_case) {
+  diff_case.step = cmp::StepType::post;
+  return true;
+}
+
+/** The optimized modes that must render the same as the reference. */
+const std::vector<OptimizedMode> optimized_modes = {
+    {"xy_downsampling", cmp::DownsamplingType::xy_downsampling, keepCase},
+    {"x_downsampling", cmp::DownsamplingType::x_downsampling, keepSortedCase},
+    {"collapsed y-runs", cmp::DownsamplingType::xy_downsampling, narrowYLim},
+    {"must-keep samples", cmp::DownsamplingType::x_downsampling,
+     flagMustKeepSamples},
+    {"trigger x-offset", cmp::DownsamplingType::xy_downsampling,
+     triggerOnMiddleLevel},
+    {"step vertices", cmp::DownsamplingType::xy_downsampling, drawSteps},
+};
+
+cmp::GraphAttribute referenceGraphAttribute(const DiffCase& diff_case) {
+  cmp::GraphAttribute graph_attribute;
+  graph_attribute.graph_colour = juce::Colours::white;
+  graph_attribute.step = diff_case.step;
+  return graph_attribute;
+}
+
+/** Same as Downsampler::MIN_POINTS_FOR_DOWNSAMPLING. */
+constexpr std::size_t min_points_for_downsampling = 100u;
+
+/** A scalar version of the x-decimation, a point is kept if it is more than
+ * one pixel from the last kept point or if the x-direction changes. The first
+ * and last points and the must-keep samples are always kept. */
+std::vector<std::size_t> getXDecimatedIndices(
+    const DiffCase& diff_case, const juce::Rectangle<int>& graph_bounds) {
+  std::vector<std::size_t> indices(diff_case.x.size());
+  std::iota(indices.begin(), indices.end(), 0u);
+
+  if (diff_case.x.size() < min_points_for_downsampling) return indices;
+
+  const cmp::Lim_f x_lim{diff_case.x_lim.min + diff_case.x_offset,
+                         diff_case.x_lim.max + diff_case.x_offset};
+  const auto [x_scale, x_offset] = cmp::getXScaleAndOffset(
+      float(graph_bounds.getWidth()), x_lim, diff_case.x_scaling);
+  const auto inverse_scale = 1.0f / x_scale;
+
+  indices = {0u};
+  auto last_kept_x = diff_case.x.front();
+  auto last_diff = 0.0f;
+
+  for (std::size_t i = 1; i + 1u < diff_case.x.size(); ++i) {
+    auto is_kept = false;
+
+    if (diff_case.x_scaling == cmp::Scaling::linear) {
+      const auto diff = diff_case.x[i - 1u] - diff_case.x[i];
+      is_kept = std::signbit(last_diff) != std::signbit(diff) ||
+                std::abs(last_kept_x - diff_case.x[i]) > inverse_scale;
+      last_diff = diff;
+    } else {
+      is_kept = std::log10(std::abs(diff_case.x[i] / last_kept_x)) >
+                inverse_scale;
+    }
+
+    if (is_kept) {
+      indices.push_back(i);
+      last_kept_x = diff_case.x[i];
+    }
+  }
+  indices.push_back(diff_case.x.size() - 1u);
+
+  for (std::size_t i = 0; i < diff_case.must_keep.size(); ++i)
+    if (diff_case.must_keep[i]) indices.push_back(i);
+
+  std::sort(indices.begin(), indices.end());
+  indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+
+  return indices;
+}
+
+juce::Image renderReference(const DiffCase& diff_case,
+                            const cmp::DownsamplingType downsampling_type,
+                            const juce::Rectangle<int>& graph_bounds) {
+  const auto [x_scale, x_offset] = cmp::getXScaleAndOffset(
+      float(graph_bounds.getWidth()), diff_case.x_lim, diff_case.x_scaling);
+  const auto [y_scale, y_offset] = cmp::getYScaleAndOffset(
+      float(graph_bounds.getHeight()), diff_case.y_lim, diff_case.y_scaling);
+
+  std::vector<std::size_t> indices(diff_case.x.size());
+  std::iota(indices.begin(), indices.end(), 0u);
+  if (downsampling_type == cmp::DownsamplingType::x_downsampling)
+    indices = getXDecimatedIndices(diff_case, graph_bounds);
+
+  cmp::PixelPoints pixel_points(indices.size());
+
+  for (std::size_t i = 0; i < indices.size(); ++i) {
+    const auto data_x = diff_case.x[indices[i]] - diff_case.x_offset;
+    const auto data_y = diff_case.y[indices[i]];
+
+    const auto x =
+        diff_case.x_scaling == cmp::Scaling::linear
+            ? cmp::getXPixelValueLinear(data_x, x_scale, x_offset)
+            : cmp::getXPixelValueLogarithmic(data_x, x_scale, x_offset);
+    const auto y =
+        diff_case.y_scaling == cmp::Scaling::linear
+            ? cmp::getYPixelValueLinear(data_y, y_scale, y_offset)
+            : cmp::getYPixelValueLogarithmic(data_y, y_scale, y_offset);
+    pixel_points[i] = {x, y};
+  }
+
+  const auto graph_attribute = referenceGraphAttribute(diff_case);
+  const cmp::GraphLineDataView data_view(diff_case.x, diff_case.y,
+                                         pixel_points, indices,
+                                         graph_attribute);
+
+  juce::Image image(juce::Image::ARGB, graph_bounds.getWidth(),
+                    graph_bounds.getHeight(), true);
+  juce::Graphics g(image);
+  cmp::PlotLookAndFeel lnf;
+  lnf.drawGraphLine(g, data_view, graph_bounds.withZeroOrigin());
+
+  return image;
+}
+
+/** Also sets the x-offset of the case to the one the data is plotted with. */
+juce::Image renderOptimized(DiffCase& diff_case, const OptimizedMode& mode,
+                            juce::Rectangle<int>& graph_bounds_out) {
+  cmp::Plot plot(diff_case.x_scaling, diff_case.y_scaling);
+  plot.setBounds(0, 0, plot_width, plot_height);
+  plot.setTrigger(diff_case.trigger);
+  plot.xLim(diff_case.x_lim.min, diff_case.x_lim.max);
+  plot.yLim(diff_case.y_lim.min, diff_case.y_lim.max);
+  plot.setDownsamplingType(mode.downsampling_type);
+  plot.plot({diff_case.y}, {diff_case.x},
+            {referenceGraphAttribute(diff_case)});
+  if (!diff_case.must_keep.empty())
+    plot.setMustKeepSamples({diff_case.must_keep});
+
+  const auto graph_line = getChildComponentHelper<cmp::GraphLine>(plot).front();
+  graph_bounds_out = graph_line->getBounds();
+  diff_case.x_offset = graph_line->getXOffset();
+
+  juce::Image image(juce::Image::ARGB, graph_bounds_out.getWidth(),
+                    graph_bounds_out.getHeight(), true);
+  juce::Graphics g(image);
+  graph_line->paintEntireComponent(g, true);
+
+  return image;
+}
+
+int alphaAt(const juce::Image& image, const int x, const int y) {
+  if (x < 0 || y < 0 || x >= image.getWidth() || y >= image.getHeight())
+    return 0;
+  return image.getPixelAt(x, y).getAlpha();
+}
+
+/** Counts the pixels that differ between 'a' and 'b'. The pixels are compared
+ * one to one, a neighbourhood would hide lines moved by one pixel. */
+std::size_t countMismatchingPixels(const juce::Image& a,
+                                   const juce::Image& b) {
+  std::size_t num_mismatches{0u};
+
+  for (int y = 0; y < std::max(a.getHeight(), b.getHeight()); ++y) {
+    for (int x = 0; x < std::max(a.getWidth(), b.getWidth()); ++x) {
+      if (std::abs(alphaAt(a, x, y) - alphaAt(b, x, y)) > intensity_tolerance)
+        num_mismatches++;
+    }
+  }
+
+  return num_mismatches;
+}
+
+std::size_t countLitPixels(const juce::Image& image) {
+  std::size_t num_lit{0u};
+  for (int y = 0; y < image.getHeight(); ++y)
+    for (int x = 0; x < image.getWidth(); ++x)
+      if (alphaAt(image, x, y) > intensity_tolerance) num_lit++;
+  return num_lit;
+}
+
+/** @return the number of mismatching pixels if the images differ, else 0. */
+std::size_t compareImages(const juce::Image& reference,
+                          const juce::Image& image) {
+  const auto num_mismatches = countMismatchingPixels(reference, image);
+  const auto num_lit = std::max(countLitPixels(reference), std::size_t(1u));
+
+  const auto allowed = std::max(
+      mismatch_floor, std::size_t(mismatch_tolerance * double(num_lit)));
+
+  return num_mismatches > allowed ? num_mismatches : 0u;
+}
+
+/** @return the number of mismatching pixels if the case fails, else 0. */
+std::size_t renderAndCompare(DiffCase diff_case, const OptimizedMode& mode) {
+  juce::Rectangle<int> graph_bounds;
+  const auto optimized = renderOptimized(diff_case, mode, graph_bounds);
+  const auto reference =
+      renderReference(diff_case, mode.downsampling_type, graph_bounds);
+
+  return compareImages(reference, optimized);
+}
+
+/** Shrinks a failing case by removing chunks of data points as long as the
+ * case keeps failing, i.e. delta debugging on the data points. */
+DiffCase minimize(DiffCase failing_case, const OptimizedMode& mode) {
+  std::size_t num_chunks = 2u;
+
+  while (failing_case.x.size() > 2u) {
+    const auto chunk_size =
+        std::max(failing_case.x.size() / num_chunks, std::size_t(1u));
+    bool reduced = false;
+
+    for (std::size_t start = 0; start < failing_case.x.size();
+         start += chunk_size) {
+      auto candidate = failing_case;
+      const auto end = std::min(start + chunk_size, candidate.x.size());
+
+      candidate.x.erase(candidate.x.begin() + long(start),
+                        candidate.x.begin() + long(end));
+      candidate.y.erase(candidate.y.begin() + long(start),
+                        candidate.y.begin() + long(end));
+      if (!candidate.must_keep.empty()) {
+        candidate.must_keep.erase(candidate.must_keep.begin() + long(start),
+                                  candidate.must_keep.begin() + long(end));
+      }
+
+      if (candidate.x.size() >= 2u && renderAndCompare(candidate, mode)) {
+        failing_case = std::move(candidate);
+        num_chunks = std::max(num_chunks - 1u, std::size_t(2u));
+        reduced = true;
+        break;
+      }
+    }
+
+    if (!reduced) {
+      if (chunk_size == 1u) break;
+      num_chunks = std::min(num_chunks * 2u, failing_case.x.size());
+    }
+  }
+
+  return failing_case;
+}
+
+juce::String toString(const DiffCase& diff_case) {
+  constexpr std::size_t max_printed_points = 64u;
+
+  juce::String text = diff_case.name + " (" +
+                      juce::String(diff_case.x.size()) + " points):";
+  for (std::size_t i = 0;
+       i < std::min(diff_case.x.size(), max_printed_points); ++i) {
+    text << " (" << diff_case.x[i] << ", " << diff_case.y[i] << ")";
+  }
+  if (diff_case.x.size() > max_printed_points) text << " ...";
+
+  return text;
+}
+
+/*============================================================================*/
+
+std::vector<float> linearX(const std::size_t size) {
+  std::vector<float> x(size);
+  std::iota(x.begin(), x.end(), 0.0f);
+  return x;
+}
+
+void fitLimits(DiffCase& diff_case) {
+  const auto finite = [](const float v) { return std::isfinite(v); };
+
+  auto y_min = std::numeric_limits<float>::max();
+  auto y_max = std::numeric_limits<float>::lowest();
+  for (const auto y : diff_case.y) {
+    if (!finite(y)) continue;
+    y_min = std::min(y_min, y);
+    y_max = std::max(y_max, y);
+  }
+
+  const auto [x_min, x_max] =
+      std::minmax_element(diff_case.x.begin(), diff_case.x.end());
+
+  diff_case.x_lim = {*x_min, *x_max};
+  diff_case.y_lim = {y_min, y_max};
+
+  if (diff_case.y_scaling == cmp::Scaling::linear) {
+    const auto margin = std::max((y_max - y_min) * 0.05f, 1e-3f);
+    diff_case.y_lim = {y_min - margin, y_max + margin};
+  }
+}
+
+DiffCase randomNoise(std::mt19937& gen, const std::size_t size) {
+  std::normal_distribution<float> dist(0.0f, 1.0f);
+
+  DiffCase diff_case{"random noise", linearX(size), std::vector<float>(size)};
+  for (auto& y : diff_case.y) y = dist(gen);
+
+  fitLimits(diff_case);
+  return diff_case;
+}
+
+DiffCase spikes(std::mt19937& gen, const std::size_t size) {
+  std::uniform_int_distribution<std::size_t> position(0u, size - 1u);
+  std::uniform_real_distribution<float> height(-100.0f, 100.0f);
+
+  DiffCase diff_case{"spikes", linearX(size), std::vector<float>(size, 0.0f)};
+  for (auto i = 0; i < 20; ++i) diff_case.y[position(gen)] = height(gen);
+
+  fitLimits(diff_case);
+  return diff_case;
+}
+
+DiffCase plateaus(std::mt19937& gen, const std::size_t size) {
+  std::uniform_int_distribution<std::size_t> length(1u, size / 10u);
+  std::uniform_real_distribution<float> level(-1.0f, 1.0f);
+
+  DiffCase diff_case{"plateaus", linearX(size), std::vector<float>(size)};
+  for (std::size_t i = 0; i < size;) {
+    const auto end = std::min(size, i + length(gen));
+    std::fill(diff_case.y.begin() + long(i), diff_case.y.begin() + long(end),
+              level(gen));
+    i = end;
+  }
+
+  fitLimits(diff_case);
+  return diff_case;
+}
+
+DiffCase nanRuns(std::mt19937& gen, const std::size_t size) {
+  auto diff_case = randomNoise(gen, size);
+  diff_case.name = "NaN runs";
+
+  std::uniform_int_distribution<std::size_t> position(0u, size - 1u);
+  std::uniform_int_distribution<std::size_t> length(1u, 200u);
+  for (auto run = 0; run < 10; ++run) {
+    const auto start = position(gen);
+    const auto end = std::min(size, start + length(gen));
+    std::fill(diff_case.y.begin() + long(start),
+              diff_case.y.begin() + long(end),
+              std::numeric_limits<float>::quiet_NaN());
+  }
+
+  return diff_case;
+}
+
+/** The x-limits always cover all x-values since non-monotonic x-data is only
+ * supported for the visible range. */
+DiffCase nonMonotonicX(std::mt19937& gen, const std::size_t size) {
+  std::normal_distribution<float> step(0.2f, 1.0f);
+  std::normal_distribution<float> dist(0.0f, 1.0f);
+
+  DiffCase diff_case{"non-monotonic x", std::vector<float>(size),
+                     std::vector<float>(size)};
+  auto x = 0.0f;
+  for (std::size_t i = 0; i < size; ++i) {
+    x += step(gen);
+    diff_case.x[i] = x;
+    diff_case.y[i] = dist(gen);
+  }
+
+  fitLimits(diff_case);
+  return diff_case;
+}
+
+DiffCase denormals(std::mt19937& gen, const std::size_t size) {
+  std::uniform_real_distribution<float> mantissa(-1.0f, 1.0f);
+  std::uniform_int_distribution<std::size_t> position(0u, size - 1u);
+
+  const auto denormal_min = std::numeric_limits<float>::denorm_min();
+
+  DiffCase diff_case{"denormals", linearX(size), std::vector<float>(size)};
+  for (auto& y : diff_case.y) y = mantissa(gen) * 1000.0f * denormal_min;
+  for (auto i = 0; i < 10; ++i) diff_case.y[position(gen)] = mantissa(gen);
+
+  fitLimits(diff_case);
+  return diff_case;
+}
+
+DiffCase logRanges(std::mt19937& gen, const std::size_t size) {
+  std::normal_distribution<float> exponent(0.0f, 1.5f);
+
+  DiffCase diff_case{"log ranges", std::vector<float>(size),
+                     std::vector<float>(size)};
+  diff_case.x_scaling = cmp::Scaling::logarithmic;
+  diff_case.y_scaling = cmp::Scaling::logarithmic;
+
+  for (std::size_t i = 0; i < size; ++i) {
+    diff_case.x[i] = std::pow(10.0f, 6.0f * float(i) / float(size - 1u));
+    diff_case.y[i] = std::pow(10.0f, exponent(gen));
+  }
+
+  fitLimits(diff_case);
+  return diff_case;
+}
+
+/** Moves all lines by one pixel by moving the limits the other way. */
+DiffCase shiftOnePixel(DiffCase diff_case, const bool vertically,
+                       const juce::Rectangle<int>& graph_bounds) {
+  auto& lim = vertically ? diff_case.y_lim : diff_case.x_lim;
+  const auto size = float(vertically ? graph_bounds.getHeight()
+                                     : graph_bounds.getWidth());
+  const auto pixel = (lim.max - lim.min) / size;
+
+  lim = {lim.min - pixel, lim.max - pixel};
+  diff_case.name << (vertically ? " moved up" : " moved right");
+  return diff_case;
+}
+
+}  // namespace
+
+SECTION(DifferentialTest, "Differential rendering") {
+  using Generator = DiffCase (*)(std::mt19937&, const std::size_t);
+  const std::vector<Generator> generators = {
+      randomNoise, spikes, plateaus, nanRuns, nonMonotonicX, denormals,
+      logRanges};
+
+  constexpr unsigned num_seeds = 3u;
+  constexpr std::size_t num_points = 20'000u;
+
+  TEST("A line moved by one pixel differs") {
+    const juce::Rectangle<int> graph_bounds{0, 0, plot_width, plot_height};
+
+    for (const auto generator : {Generator(spikes), Generator(plateaus)}) {
+      std::mt19937 gen(0u);
+      const auto diff_case = generator(gen, num_points);
+      const auto reference = renderReference(
+          diff_case, cmp::DownsamplingType::no_downsampling, graph_bounds);
+
+      for (const auto vertically : {false, true}) {
+        const auto shifted = shiftOnePixel(diff_case, vertically, graph_bounds);
+        const auto image = renderReference(
+            shifted, cmp::DownsamplingType::no_downsampling, graph_bounds);
+
+        expect(compareImages(reference, image) > 0u,
+               shifted.name + " is not detected");
+      }
+    }
+  }
+
+  TEST("Trigger cases are plotted with an x-offset") {
+    std::mt19937 gen(0u);
+    auto diff_case = randomNoise(gen, num_points);
+    expect(triggerOnMiddleLevel(diff_case));
+
+    const OptimizedMode trigger_mode{"trigger",
+                                     cmp::DownsamplingType::xy_downsampling,
+                                     triggerOnMiddleLevel};
+    juce::Rectangle<int> graph_bounds;
+    renderOptimized(diff_case, trigger_mode, graph_bounds);
+    expect(diff_case.x_offset != 0.0f);
+  }
+
+  for (const auto& mode : optimized_modes) {
+    TEST("Reference vs " + mode.name) {
+      for (const auto generator : generators) {
+        for (unsigned seed = 0u; seed < num_seeds; ++seed) {
+          std::mt19937 gen(seed);
+          auto diff_case = generator(gen, num_points);
+          if (!mode.adapt_case(diff_case)) continue;
+
+          const auto num_mismatches = renderAndCompare(diff_case, mode);
+          expect(num_mismatches == 0u,
+                 diff_case.name + ", seed " + juce::String(seed) + ": " +
+                     juce::String(num_mismatches) + " pixels differ");
+
+          if (num_mismatches) {
+            logMessage("Minimized failing case: " +
+                       toString(minimize(diff_case, mode)));
+          }
+        }
+      }
+    }
+  }
+}
@@ -1,5 +1,10 @@
 #include "cmp_downsampler.h"
 #include "cmp_test_helper.hpp"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
 #include <vector>
 
 class DownsamplerTest : public juce::UnitTest {
@@ -141,6 +146,252 @@ public:
             expect(std::find(xy_indices.begin(), xy_indices.end(), 198) != xy_indices.end());
             expect(std::find(xy_indices.begin(), xy_indices.end(), 199) != xy_indices.end());
         }
+
+        TEST("Batched XY downsampling equals per channel downsampling") {
+            // Small data that is not downsampled, short and long pixel
+            // columns with a length that is not a multiple of the vector width,
+            // and channels that are swept four at a time with a remainder.
+            std::mt19937 gen(42);
+            std::normal_distribution<float> noise(0.0f, 1.0f);
+
+            for (const std::size_t num_channels : {2u, 3u, 13u})
+            for (const std::size_t num_points : {50u, 2'000u, 200'000u}) {
+                std::vector<float> x_data(num_points);
+                std::iota(x_data.begin(), x_data.end(), 0.f);
+
+                std::vector<std::vector<float>> y_data_list(num_channels);
+                for (std::size_t c = 0; c < num_channels; ++c) {
+                    auto& y_data = y_data_list[c];
+                    y_data.resize(num_points);
+                    for (auto& y : y_data) y = noise(gen);
+
+                    // NaN runs at the start of some columns and a constant
+                    // channel with ties.
+                    for (std::size_t i = c * 7; i < num_points; i += 997) {
+                        std::fill_n(y_data.begin() + i,
+                                    std::min<std::size_t>(c * 40, num_points - i),
+                                    std::numeric_limits<float>::quiet_NaN());
+                    }
+                    if (c == 3) std::fill(y_data.begin(), y_data.end(), 1.0f);
+
+                    // A pixel column of only NaN, and infinite values.
+                    if (c == 1) {
+                        std::fill_n(y_data.begin(), std::min<std::size_t>(2'500u, num_points),
+                                    std::numeric_limits<float>::quiet_NaN());
+                        y_data[num_points / 2] = std::numeric_limits<float>::infinity();
+                        y_data[num_points / 2 + 1] = -std::numeric_limits<float>::infinity();
+                    }
+                }
+
+                std::vector<std::size_t> x_indices;
+                cmp::Downsampler<float>::calculateXIndices(
+                    cmp::Scaling::linear,
+                    {0.f, float(num_points)},
+                    juce::Rectangle<int>(0, 0, 100, 100),
+                    x_data,
+                    x_indices
+                );
+
+                std::vector<std::vector<std::size_t>> batched_indices;
+                cmp::Downsampler<float>::calculateXYBasedIdxsBatched(
+                    x_indices, y_data_list, batched_indices);
+
+                expectEquals(batched_indices.size(), num_channels);
+                for (std::size_t c = 0; c < num_channels; ++c) {
+                    std::vector<std::size_t> xy_indices;
+                    cmp::Downsampler<float>::calculateXYBasedIdxs(
+                        x_indices, y_data_list[c], xy_indices);
+
+                    expect(batched_indices[c] == xy_indices,
+                           "Channel " + juce::String(c) + " with " +
+                               juce::String(num_points) + " points differs.");
+                }
+            }
+        }
+
+        TEST("Batched XY downsampling requires equal sizes") {
+            std::vector<std::vector<float>> y_data_list{std::vector<float>(200),
+                                                        std::vector<float>(100)};
+            std::vector<std::size_t> x_indices{0, 199};
+            std::vector<std::vector<std::size_t>> xy_indices;
+
+            bool did_throw = false;
+            try {
+                cmp::Downsampler<float>::calculateXYBasedIdxsBatched(
+                    x_indices, y_data_list, xy_indices);
+            } catch (const std::invalid_argument&) {
+                did_throw = true;
+            }
+            expect(did_throw);
+        }
+
+        TEST("Single pass XY pixel points equal the index based path") {
+            std::mt19937 gen(7);
+            std::normal_distribution<float> noise(0.0f, 1.0f);
+            const auto graph_bounds = juce::Rectangle<int>(0, 0, 100, 100);
+
+            for (const auto scaling : {cmp::Scaling::linear, cmp::Scaling::logarithmic}) {
+                for (const std::size_t num_points : {50u, 5'000u, 100'000u}) {
+                    std::vector<float> x_data(num_points), y_data(num_points);
+                    std::iota(x_data.begin(), x_data.end(), 1.f);
+                    for (auto& y : y_data) y = noise(gen);
+                    for (std::size_t i = 0; i < num_points; i += 1'013) {
+                        std::fill_n(y_data.begin() + i,
+                                    std::min<std::size_t>(60, num_points - i),
+                                    std::numeric_limits<float>::quiet_NaN());
+                    }
+
+                    const cmp::Lim<float> x_lim{10.f, float(num_points) / 2.f};
+
+                    std::vector<std::size_t> x_indices, xy_indices;
+                    cmp::Downsampler<float>::calculateXIndices(
+                        scaling, x_lim, graph_bounds, x_data, x_indices);
+                    cmp::Downsampler<float>::calculateXYBasedIdxs(
+                        x_indices, y_data, xy_indices);
+
+                    cmp::PixelPoints pixel_points;
+                    std::vector<std::size_t> fused_x_indices, fused_xy_indices;
+                    cmp::Downsampler<float>::calculateXYPixelPoints(
+                        scaling, cmp::Scaling::linear, x_lim, {-3.f, 3.f},
+                        graph_bounds, x_data, y_data, pixel_points,
+                        &fused_x_indices, &fused_xy_indices);
+
+                    expect(fused_x_indices == x_indices,
+                           "X indices differ for " + juce::String(num_points) + " points.");
+                    expect(fused_xy_indices == xy_indices,
+                           "XY indices differ for " + juce::String(num_points) + " points.");
+                    expectEquals(pixel_points.size(), fused_xy_indices.size());
+
+                    std::vector<std::size_t> single_pass_x_indices, single_pass_xy_indices;
+                    cmp::Downsampler<float>::calculateXYIdxs(
+                        scaling, x_lim, graph_bounds, x_data, y_data,
+                        single_pass_x_indices, single_pass_xy_indices);
+
+                    expect(single_pass_x_indices == x_indices);
+                    expect(single_pass_xy_indices == xy_indices);
+
+                    // Collapsing in the pass equals collapsing the indices
+                    // afterwards, and nothing is collapsed inside wide limits.
+                    for (const auto& collapse_y_lim : {cmp::Lim<float>{-0.5f, 0.5f},
+                                                      cmp::Lim<float>{-10.f, 10.f}}) {
+                        auto collapsed_xy_indices = xy_indices;
+                        std::vector<std::size_t> run_positions, fused_run_positions;
+                        cmp::Downsampler<float>::collapseIdxsOutsideYLim(
+                            y_data, collapse_y_lim, collapsed_xy_indices, run_positions);
+
+                        cmp::PixelPoints collapsed_pixel_points;
+                        cmp::Downsampler<float>::calculateXYPixelPoints(
+                            scaling, cmp::Scaling::linear, x_lim, {-3.f, 3.f},
+                            graph_bounds, x_data, y_data, collapsed_pixel_points,
+                            &fused_x_indices, &fused_xy_indices, collapse_y_lim,
+                            &fused_run_positions);
+
+                        expect(fused_xy_indices == collapsed_xy_indices);
+                        expect(fused_run_positions == run_positions);
+                        expectEquals(collapsed_pixel_points.size(),
+                                     collapsed_xy_indices.size());
+
+                        if (run_positions.empty()) {
+                            expect(fused_xy_indices == xy_indices);
+                        } else {
+                            expect(collapsed_pixel_points.size() < pixel_points.size());
+                        }
+                    }
+                }
+            }
+        }
+
+        TEST("Collapse indices outside the y-limits") {
+            const auto nan = std::numeric_limits<float>::quiet_NaN();
+
+            // The y-limits are [-1, 1].
+            const std::vector<float> y_data{0.f, 2.f, 3.f, 4.f, 0.f, -2.f, 0.f,
+                                            5.f, nan, 6.f, -3.f, -4.f, -5.f};
+            std::vector<std::size_t> indices(y_data.size());
+            std::iota(indices.begin(), indices.end(), 0u);
+
+            std::vector<std::size_t> run_positions;
+            expect(cmp::Downsampler<float>::collapseIdxsOutsideYLim(
+                y_data, {-1.f, 1.f}, indices, run_positions));
+
+            // A single sample outside, or one split by NaN, is not a run. Runs
+            // on different sides are collapsed separately.
+            expect(indices == std::vector<std::size_t>{0, 1, 3, 4, 5, 6, 7, 8, 9, 10, 12});
+            expect(run_positions == std::vector<std::size_t>{1, 9});
+
+            std::vector<std::size_t> inside_indices{0, 4, 6};
+            expect(!cmp::Downsampler<float>::collapseIdxsOutsideYLim(
+                y_data, {-1.f, 1.f}, inside_indices, run_positions));
+            expect(inside_indices == std::vector<std::size_t>{0, 4, 6});
+            expect(run_positions.empty());
+        }
+
+        TEST("Sample flags visit the flagged samples of a range") {
+            std::vector<bool> flags(20000, false);
+            for (const auto i : {0u, 63u, 64u, 4095u, 4096u, 12345u, 19999u})
+                flags[i] = true;
+
+            cmp::SampleFlags sample_flags;
+            sample_flags.assign(flags);
+
+            expect(!sample_flags.empty());
+            expectEquals(sample_flags.size(), flags.size());
+
+            for (const auto [first, last] : {std::pair<std::size_t, std::size_t>{0u, 20000u},
+                                             {1u, 4096u},
+                                             {64u, 64u},
+                                             {4000u, 12346u},
+                                             {12346u, 30000u}}) {
+                std::vector<std::size_t> visited, expected;
+                sample_flags.forEachFlagged(first, last, [&](const std::size_t i) {
+                    visited.push_back(i);
+                });
+                for (auto i = first; i < std::min(last, flags.size()); ++i)
+                    if (flags[i]) expected.push_back(i);
+
+                expect(visited == expected,
+                       "Range [" + juce::String(first) + ", " + juce::String(last) + ")");
+            }
+
+            sample_flags.clear();
+            expect(sample_flags.empty());
+            expect(!sample_flags.test(0u));
+        }
+
+        TEST("Flagged samples survive XY downsampling") {
+            constexpr std::size_t num_points = 100000;
+            std::vector<float> x_data(num_points);
+            std::vector<float> y_data(num_points, 0.0f);
+            std::iota(x_data.begin(), x_data.end(), 0.f);
+            y_data[100] = 10.f;
+
+            // A sample that is neither a min nor a max of its pixel column.
+            const std::size_t flagged_index = 54321;
+            std::vector<bool> flags(num_points, false);
+            flags[flagged_index] = true;
+
+            cmp::SampleFlags sample_flags;
+            sample_flags.assign(flags);
+
+            std::vector<std::size_t> x_indices, xy_indices;
+            cmp::Downsampler<float>::calculateXIndices(
+                cmp::Scaling::linear, {0.f, float(num_points)},
+                juce::Rectangle<int>(0, 0, 100, 100), x_data, x_indices);
+            cmp::Downsampler<float>::calculateXYBasedIdxs(x_indices, y_data,
+                                                          xy_indices);
+
+            expect(std::find(xy_indices.begin(), xy_indices.end(), flagged_index) ==
+                   xy_indices.end());
+
+            const auto num_xy_indices = xy_indices.size();
+            expect(cmp::Downsampler<float>::mergeFlaggedIdxs(sample_flags, xy_indices));
+            expectEquals(xy_indices.size(), num_xy_indices + 1u);
+            expect(std::is_sorted(xy_indices.begin(), xy_indices.end()));
+            expect(std::binary_search(xy_indices.begin(), xy_indices.end(), flagged_index));
+
+            // Merging again adds nothing.
+            expect(!cmp::Downsampler<float>::mergeFlaggedIdxs(sample_flags, xy_indices));
+        }
     }
 };
 
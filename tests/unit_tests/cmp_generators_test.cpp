@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "cmp_test_helper.hpp"
+#include "example_generators.h"
+
+template <class Generator>
+static std::vector<float> readAllInChunks(Generator& generator,
+                                          const std::size_t chunk_size) {
+  std::vector<float> samples;
+  while (!generator.isExhausted()) {
+    const auto chunk = generator.nextChunk(chunk_size);
+    samples.insert(samples.end(), chunk.begin(), chunk.end());
+  }
+  return samples;
+}
+
+SECTION(GeneratorsTest, "Example generators") {
+  auto expectEqualsLambda = [&](auto a, auto b) { expectEquals(a, b); };
+
+  TEST("Output is independent of the chunk size") {
+    cmp::RandomWalkGenerator<float> random_walk(10'000u, 42u);
+    const auto single_chunk = readAllInChunks(random_walk, 10'000u);
+
+    random_walk.reset();
+    const auto small_chunks = readAllInChunks(random_walk, 37u);
+
+    expectEqualVectors(single_chunk, small_chunks, expectEqualsLambda);
+  }
+
+  TEST("Same seed gives same sequence") {
+    cmp::NoiseGenerator<float> noise_1(1'000u, 7u), noise_2(1'000u, 7u),
+        noise_3(1'000u, 8u);
+
+    const auto samples_1 = noise_1.nextChunk(1'000u);
+    expectEqualVectors(samples_1, noise_2.nextChunk(1'000u),
+                       expectEqualsLambda);
+    expect(samples_1 != noise_3.nextChunk(1'000u));
+  }
+
+  TEST("Fill stops at the end of the sequence") {
+    cmp::StepGenerator<float> steps(100u, 1u, 10u);
+    std::vector<float> samples(64u);
+
+    expectEquals(steps.fill(samples), std::size_t(64u));
+    expectEquals(steps.fill(samples), std::size_t(36u));
+    expectEquals(steps.fill(samples), std::size_t(0u));
+    expect(steps.isExhausted());
+  }
+
+  TEST("NaN dropouts are inserted in runs") {
+    cmp::NaNDropoutGenerator<float, cmp::NoiseGenerator<float>> dropouts(
+        cmp::NoiseGenerator<float>(10'000u, 1u), 2u, 0.1, 50u);
+    const auto samples = dropouts.nextChunk(10'000u);
+
+    std::size_t num_nans{0u};
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+      if (!std::isnan(samples[i])) continue;
+      num_nans++;
+      // A whole block of 50 samples is dropped.
+      expect(std::isnan(samples[i - i % 50u]));
+    }
+    expect(num_nans > 0u && num_nans % 50u == 0u);
+  }
+
+  TEST("Irregular x is increasing") {
+    cmp::IrregularXGenerator<float> x_generator(1'000u, 3u, 1.0, 0.9);
+    const auto x = x_generator.nextChunk(1'000u);
+    expect(std::is_sorted(x.begin(), x.end()));
+  }
+
+  TEST("Interleaved frames") {
+    const auto create_channel = [](const std::size_t c) {
+      return cmp::NoiseGenerator<float>(100u, c);
+    };
+    cmp::InterleavedFrameGenerator<float, cmp::NoiseGenerator<float>> frames(
+        3u, create_channel);
+
+    std::vector<float> interleaved(3u * 100u);
+    expectEquals(frames.fill(interleaved), std::size_t(100u));
+
+    for (std::size_t c = 0; c < 3u; ++c) {
+      auto channel = create_channel(c);
+      const auto expected = channel.nextChunk(100u);
+      for (std::size_t f = 0; f < 100u; ++f) {
+        expectEquals(interleaved[f * 3u + c], expected[f]);
+      }
+    }
+  }
+}
@@ -0,0 +1,92 @@
+#include "cmp_heatmap.h"
+
+#include <cmath>
+#include <limits>
+
+#include "cmp_heatmap_mip_chain.h"
+#include "cmp_test_helper.hpp"
+
+SECTION(HeatmapTest, "Heatmap") {
+  TEST("Mip chain reductions") {
+    // 3x3 matrix, the cells of the last row and column have no neighbours.
+    const std::vector<float> values{1, 2, 3,
+                                    4, 5, 6,
+                                    7, 8, 9};
+
+    cmp::HeatmapMipChain mip_chain;
+    mip_chain.build(values, 3u, 3u);
+
+    expectEquals(mip_chain.getNumLevels(), std::size_t(3u));
+
+    const auto level_0 = mip_chain.getLevel(0u, cmp::HeatmapReduction::mean);
+    expect(level_0.values == values.data());
+
+    const auto min = mip_chain.getLevel(1u, cmp::HeatmapReduction::min);
+    const auto max = mip_chain.getLevel(1u, cmp::HeatmapReduction::max);
+    const auto mean = mip_chain.getLevel(1u, cmp::HeatmapReduction::mean);
+
+    expectEquals(mean.num_rows, std::size_t(2u));
+    expectEquals(mean.num_columns, std::size_t(2u));
+
+    const std::vector<float> expected_min{1, 3, 7, 9};
+    const std::vector<float> expected_max{5, 6, 8, 9};
+    const std::vector<float> expected_mean{3, 4.5f, 7.5f, 9};
+
+    for (std::size_t i = 0u; i < 4u; ++i) {
+      expectEquals(min.values[i], expected_min[i]);
+      expectEquals(max.values[i], expected_max[i]);
+      expectEquals(mean.values[i], expected_mean[i]);
+    }
+
+    const auto top = mip_chain.getLevel(2u, cmp::HeatmapReduction::max);
+    expectEquals(top.num_rows * top.num_columns, std::size_t(1u));
+    expectEquals(top.values[0], 9.f);
+
+    const auto value_lim = mip_chain.getValueLim();
+    expectEquals(value_lim.min, 1.f);
+    expectEquals(value_lim.max, 9.f);
+  }
+
+  TEST("Mip chain leaves out non-finite values") {
+    constexpr auto NaN = std::numeric_limits<float>::quiet_NaN();
+    constexpr auto inf = std::numeric_limits<float>::infinity();
+    const std::vector<float> values{NaN, 2, NaN, NaN,
+                                    inf, 4, NaN, NaN};
+
+    cmp::HeatmapMipChain mip_chain;
+    mip_chain.build(values, 2u, 4u);
+
+    const auto mean = mip_chain.getLevel(1u, cmp::HeatmapReduction::mean);
+    expectEquals(mean.values[0], 3.f);
+    expect(std::isnan(mean.values[1]));
+
+    const auto value_lim = mip_chain.getValueLim();
+    expectEquals(value_lim.min, 2.f);
+    expectEquals(value_lim.max, 4.f);
+
+    mip_chain.build(std::vector<float>(4u, NaN), 2u, 2u);
+    expect(std::isnan(mip_chain.getValueLim().min));
+  }
+
+  TEST("Colour indices") {
+    constexpr auto NaN = std::numeric_limits<float>::quiet_NaN();
+    constexpr auto inf = std::numeric_limits<float>::infinity();
+
+    // Seven values to cover both the vectorized and the scalar loop.
+    const std::vector<float> values{-5.f, 0.f, 2.49f, 2.5f, 10.f, NaN, inf};
+    std::vector<std::uint32_t> colour_indices(values.size());
+
+    cmp::Heatmap::getColourIndices(values.data(), colour_indices.data(),
+                                   values.size(), {0.f, 10.f}, 4u);
+
+    const std::vector<std::uint32_t> expected{0u, 0u, 0u, 1u, 3u, 4u, 3u};
+    for (std::size_t i = 0u; i < values.size(); ++i)
+      expectEquals(colour_indices[i], expected[i]);
+
+    // Equal limits map all values to the first colour.
+    cmp::Heatmap::getColourIndices(values.data(), colour_indices.data(),
+                                   values.size(), {1.f, 1.f}, 4u);
+    expectEquals(colour_indices[4], 0u);
+    expectEquals(colour_indices[5], 4u);
+  }
+}
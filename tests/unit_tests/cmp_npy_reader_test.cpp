@@ -0,0 +1,149 @@
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "cmp_npy_reader.hpp"
+#include "cmp_test_helper.hpp"
+
+template <class ValueType>
+static juce::File writeNpyFile(const std::string& descr,
+                               const std::string& fortran_order,
+                               const std::string& shape,
+                               const std::vector<ValueType>& values) {
+  auto header = "{'descr': '" + descr + "', 'fortran_order': " +
+                fortran_order + ", 'shape': " + shape + ", }";
+  header.append(64u - (10u + header.size() + 1u) % 64u, ' ');
+  header += '\n';
+
+  std::string bytes("\x93NUMPY\x01\x00", 8u);
+  bytes += char(header.size() & 0xffu);
+  bytes += char(header.size() >> 8u);
+  bytes += header;
+  bytes.append(reinterpret_cast<const char*>(values.data()),
+               values.size() * sizeof(ValueType));
+
+  auto file = juce::File::createTempFile(".npy");
+  file.replaceWithData(bytes.data(), bytes.size());
+  return file;
+}
+
+SECTION(NpyReaderTest, "Npy reader") {
+  const std::vector<float> values{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+  const std::vector<std::vector<float>> columns{
+      {0, 3, 6, 9}, {1, 4, 7, 10}, {2, 5, 8, 11}};
+
+  TEST("2-D float32 array in C order") {
+    const auto file = writeNpyFile("<f4", "False", "(4, 3)", values);
+    {
+      const auto array = cmp::NpyArray(file);
+
+      expect(array.getDataType() == cmp::NpyDataType::float32);
+      expectEquals(array.getNumLines(), std::size_t(3));
+      expectEquals(array.getNumPointsPerLine(), std::size_t(4));
+      expect(array.getLines() == columns);
+      expect(array.getLine(1) == columns[1]);
+      expectEquals(array.getData<float>()[5], 5.0f);
+    }
+    file.deleteFile();
+  }
+
+  TEST("2-D float64 array in Fortran order and 1-D int16 array") {
+    std::vector<double> fortran_values;
+    for (const auto& column : columns) {
+      fortran_values.insert(fortran_values.end(), column.begin(), column.end());
+    }
+
+    const auto f8_file = writeNpyFile("<f8", "True", "(4, 3)", fortran_values);
+    const auto i2_file = writeNpyFile("<i2", "False", "(3,)",
+                                      std::vector<std::int16_t>{1, -2, 3});
+    {
+      const auto f8_array = cmp::NpyArray(f8_file);
+      expect(f8_array.isFortranOrder());
+      expect(f8_array.getLines() == columns);
+
+      const auto i2_array = cmp::NpyArray(i2_file);
+      expectEquals(i2_array.getNumLines(), std::size_t(1));
+      expect(i2_array.getLine(0) == std::vector<float>{1.0f, -2.0f, 3.0f});
+    }
+    f8_file.deleteFile();
+    i2_file.deleteFile();
+  }
+
+  TEST("Line views of a float32 array in Fortran order") {
+    std::vector<float> fortran_values;
+    for (const auto& column : columns) {
+      fortran_values.insert(fortran_values.end(), column.begin(), column.end());
+    }
+
+    const auto f4_file = writeNpyFile("<f4", "True", "(4, 3)", fortran_values);
+    const auto c_file = writeNpyFile("<f4", "False", "(4, 3)", values);
+    {
+      const auto f4_array = cmp::NpyArray(f4_file);
+      const auto line_views = f4_array.getLineViews();
+
+      expectEquals(line_views.size(), std::size_t(3));
+      for (std::size_t i = 0u; i < line_views.size(); ++i) {
+        expect(std::vector<float>(line_views[i].begin(),
+                                  line_views[i].end()) == columns[i]);
+        expect(line_views[i].data() ==
+               f4_array.getData<float>().data() + i * 4u);
+      }
+
+      bool did_throw = false;
+      try {
+        [[maybe_unused]] const auto c_views =
+            cmp::NpyArray(c_file).getLineViews();
+      } catch (const std::invalid_argument&) {
+        did_throw = true;
+      }
+      expect(did_throw);
+    }
+    f4_file.deleteFile();
+    c_file.deleteFile();
+  }
+
+  TEST("Unsupported data type and too large raw shape throw") {
+    const auto file = writeNpyFile("<i8", "False", "(12,)",
+                                   std::vector<std::int64_t>(12u, 0));
+
+    bool did_throw_type = false;
+    try {
+      [[maybe_unused]] const cmp::NpyArray array(file);
+    } catch (const std::runtime_error&) {
+      did_throw_type = true;
+    }
+
+    bool did_throw_shape = false;
+    try {
+      [[maybe_unused]] const cmp::NpyArray array(
+          file, cmp::NpyDataType::float32, {1000u, 3u});
+    } catch (const std::invalid_argument&) {
+      did_throw_shape = true;
+    }
+    file.deleteFile();
+
+    expect(did_throw_type);
+    expect(did_throw_shape);
+  }
+
+  TEST("Shapes that overflow throw") {
+    // 2^62 * 4 elements wrap around to zero, 2^62 elements of four bytes too.
+    const std::vector<std::string> shapes{"(4611686018427387904, 4)",
+                                          "(4611686018427387904,)",
+                                          "(99999999999999999999999,)"};
+
+    for (const auto& shape : shapes) {
+      const auto file = writeNpyFile("<f4", "False", shape, values);
+
+      bool did_throw = false;
+      try {
+        [[maybe_unused]] const cmp::NpyArray array(file);
+      } catch (const std::runtime_error&) {
+        did_throw = true;
+      }
+      file.deleteFile();
+
+      expect(did_throw);
+    }
+  }
+}
@@ -0,0 +1,65 @@
+#include "cmp_octave_smoothing.h"
+
+#include <cmath>
+#include <limits>
+
+#include "cmp_test_helper.hpp"
+
+SECTION(OctaveSmoothingTest, "Octave smoothing") {
+  TEST("Constant y-data is unchanged") {
+    std::vector<float> x_data(513);
+    for (std::size_t i = 0u; i < x_data.size(); ++i) x_data[i] = float(i) * 43.f;
+
+    cmp::FractionalOctaveSmoother smoother;
+    smoother.setWindows(x_data, 1.f / 3.f);
+    expect(smoother.hasWindowsFor(x_data, 1.f / 3.f));
+    expect(!smoother.hasWindowsFor(x_data, 1.f / 6.f));
+
+    std::vector<float> smoothed_y_data;
+    smoother.smooth(std::vector<float>(x_data.size(), 2.f), smoothed_y_data);
+
+    for (const auto y : smoothed_y_data) expectWithinAbsoluteError(y, 2.f, 1e-5f);
+  }
+
+  TEST("Window of one octave") {
+    // The window of x = 4 is [2^1.5, 2^2.5], i.e. the sample positions
+    // [2.83, 5.66] where sample i spans [i - 0.5, i + 0.5).
+    const std::vector<float> x_data{0, 1, 2, 3, 4, 5, 6, 7};
+    const std::vector<float> y_data{0, 0, 0, 0, 8, 0, 0, 0};
+
+    cmp::FractionalOctaveSmoother smoother;
+    smoother.setWindows(x_data, 1.f);
+
+    std::vector<float> smoothed_y_data;
+    smoother.smooth(y_data, smoothed_y_data);
+
+    const auto width = std::exp2(2.5f) - std::exp2(1.5f);
+    expectWithinAbsoluteError(smoothed_y_data[4], 8.f / width, 1e-4f);
+    expectEquals(smoothed_y_data[0], 0.f);
+    expectEquals(smoothed_y_data[7], 0.f);
+  }
+
+  TEST("Non-finite values are left out") {
+    constexpr auto NaN = std::numeric_limits<float>::quiet_NaN();
+    const std::vector<float> x_data{10, 11, 12, 13, 14, 1000};
+
+    cmp::FractionalOctaveSmoother smoother;
+    smoother.setWindows(x_data, 1.f / 3.f);
+
+    std::vector<float> smoothed_y_data;
+    smoother.smooth({1, NaN, 1, 1, 1, NaN}, smoothed_y_data);
+
+    for (std::size_t i = 0u; i < 5u; ++i)
+      expectWithinAbsoluteError(smoothed_y_data[i], 1.f, 1e-5f);
+    expect(std::isnan(smoothed_y_data[5]));
+  }
+
+  TEST("Unsorted x-data is not smoothed") {
+    cmp::FractionalOctaveSmoother smoother;
+    smoother.setWindows({3, 1, 2}, 1.f);
+
+    std::vector<float> smoothed_y_data;
+    smoother.smooth({1, 2, 3}, smoothed_y_data);
+    expect(smoothed_y_data == std::vector<float>{1, 2, 3});
+  }
+}
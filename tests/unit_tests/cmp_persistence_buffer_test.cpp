@@ -0,0 +1,78 @@
+#include "cmp_persistence_buffer.h"
+
+#include <limits>
+
+#include "cmp_test_helper.hpp"
+
+SECTION(PersistenceBufferTest, "Persistence buffer") {
+  TEST("Lines are added once per pixel") {
+    cmp::PersistenceBuffer buffer;
+    buffer.setSize(10, 5);
+
+    // A horizontal and a vertical line sharing the pixel (5, 2).
+    buffer.addLines({{0.5f, 2.5f}, {5.5f, 2.5f}, {5.5f, 4.5f}});
+
+    for (int x = 0; x <= 5; ++x) expectEquals(buffer.getIntensity(x, 2), 1.0f);
+    expectEquals(buffer.getIntensity(5, 3), 1.0f);
+    expectEquals(buffer.getIntensity(5, 4), 1.0f);
+    expectEquals(buffer.getIntensity(6, 2), 0.0f);
+    expectEquals(buffer.getIntensity(0, 0), 0.0f);
+  }
+
+  TEST("Intensities decay") {
+    cmp::PersistenceBuffer buffer;
+    buffer.setSize(37, 3);
+    buffer.addLines({{0.0f, 1.0f}, {36.5f, 1.0f}});
+
+    buffer.decay(0.5f);
+    buffer.addLines({{0.0f, 0.0f}, {36.5f, 0.0f}});
+    buffer.decay(0.5f);
+
+    for (int x = 0; x < 37; ++x) {
+      expectEquals(buffer.getIntensity(x, 1), 0.25f);
+      expectEquals(buffer.getIntensity(x, 0), 0.5f);
+    }
+  }
+
+  TEST("Buffers are added") {
+    cmp::PersistenceBuffer buffer, pending;
+    buffer.setSize(9, 2);
+    pending.setSize(9, 2);
+    buffer.addLines({{0.0f, 0.5f}, {8.5f, 0.5f}});
+    pending.addLines({{0.0f, 0.5f}, {8.5f, 0.5f}, {8.5f, 1.5f}});
+
+    buffer.decay(0.5f);
+    buffer.add(pending);
+
+    for (int x = 0; x < 9; ++x) expectEquals(buffer.getIntensity(x, 0), 1.5f);
+    expectEquals(buffer.getIntensity(8, 1), 1.0f);
+    expectEquals(buffer.getIntensity(0, 1), 0.0f);
+  }
+
+  TEST("Lines are clipped and broken by NaN") {
+    cmp::PersistenceBuffer buffer;
+    buffer.setSize(4, 4);
+
+    constexpr auto NaN = std::numeric_limits<float>::quiet_NaN();
+    buffer.addLines({{-100.0f, 1.5f}, {100.0f, 1.5f}, {NaN, NaN},
+                     {2.5f, -50.0f}, {2.5f, 1e9f}});
+
+    for (int x = 0; x < 4; ++x) expectEquals(buffer.getIntensity(x, 1), x == 2 ? 2.0f : 1.0f);
+    expectEquals(buffer.getIntensity(2, 0), 1.0f);
+    expectEquals(buffer.getIntensity(2, 3), 1.0f);
+    expectEquals(buffer.getIntensity(1, 0), 0.0f);
+  }
+
+  TEST("Resizing clears the intensities") {
+    cmp::PersistenceBuffer buffer;
+    buffer.setSize(4, 4);
+    buffer.addLines({{1.0f, 1.0f}});
+    expectEquals(buffer.getIntensity(1, 1), 1.0f);
+
+    buffer.setSize(4, 4);
+    expectEquals(buffer.getIntensity(1, 1), 1.0f);
+
+    buffer.setSize(5, 4);
+    expectEquals(buffer.getIntensity(1, 1), 0.0f);
+  }
+}
@@ -1,12 +1,61 @@
 #include "cmp_plot.h"
 
 #include <juce_core/juce_core.h>
+#include <algorithm>
+#include <cmath>
 #include <memory>
 
 #include "cmp_datamodels.h"
+#include "cmp_downsampler.h"
 #include "cmp_graph_line.h"
+#include "cmp_heatmap.h"
 #include "cmp_test_helper.hpp"
 #include "cmp_lookandfeel.h"
+#include "cmp_plot_overview.h"
+#include "cmp_utils.h"
+
+/** Records the vertices of the step lines that are drawn. */
+struct StepVertexCaptureLookAndFeel : public cmp::PlotLookAndFeel {
+  void drawGraphLine(juce::Graphics &g,
+                     const cmp::GraphLineDataView graph_line_data,
+                     const juce::Rectangle<int> &graph_line_bounds) override {
+    if (const auto &step = graph_line_data.graph_attribute.step) {
+      step_vertices.clear();
+      cmp::forEachStepVertex(
+          graph_line_data.pixel_points, *step,
+          [&](const auto &vertex) { step_vertices.push_back(vertex); });
+    }
+
+    cmp::PlotLookAndFeel::drawGraphLine(g, graph_line_data, graph_line_bounds);
+  }
+
+  cmp::PixelPoints step_vertices;
+};
+
+/** Counts the xy-downsampled pixel point updates and records if the indices
+ * were requested. */
+struct XYDownsamplingCountLookAndFeel : public cmp::PlotLookAndFeel {
+  void updateXYDownsampledPixelPoints(
+      const cmp::Scaling x_scaling, const cmp::Scaling y_scaling,
+      const cmp::Lim<float> x_lim, const cmp::Lim<float> y_lim,
+      const juce::Rectangle<int> &graph_bounds,
+      const std::vector<float> &x_data, std::span<const float> y_data,
+      const std::optional<cmp::Lim<float>> &collapse_y_lim,
+      std::vector<std::size_t> *x_based_indices,
+      std::vector<std::size_t> *pixel_points_indices,
+      std::vector<std::size_t> *collapsed_run_positions,
+      cmp::PixelPoints &pixel_points) override {
+    num_updates++;
+    are_indices_requested = x_based_indices && pixel_points_indices;
+    cmp::PlotLookAndFeel::updateXYDownsampledPixelPoints(
+        x_scaling, y_scaling, x_lim, y_lim, graph_bounds, x_data, y_data,
+        collapse_y_lim, x_based_indices, pixel_points_indices,
+        collapsed_run_positions, pixel_points);
+  }
+
+  std::size_t num_updates{0u};
+  bool are_indices_requested{false};
+};
 
 SECTION(PlotClass, "Plot class") {
   auto expectEqualsLambda = [&](auto a, auto b) { expectEquals(a, b); };
@@ -79,6 +128,641 @@ SECTION(PlotClass, "Plot class") {
     expectEqualVectors(graph_lines[2]->getYData(), y_data3, expectEqualsLambda);
   }
 
+  TEST("Step line") {
+    StepVertexCaptureLookAndFeel look_and_feel;
+    cmp::Plot step_plot;
+    step_plot.setLookAndFeel(&look_and_feel);
+    step_plot.setBounds(0, 0, 400, 300);
+
+    cmp::GraphAttribute step_attribute;
+    step_attribute.step = cmp::StepType::post;
+    step_plot.plot({{0.f, 1.f, 0.f}}, {{1.f, 2.f, 3.f}}, {step_attribute});
+
+    const auto graph_line =
+        getChildComponentHelper<cmp::GraphLine>(step_plot).front();
+    expect(graph_line->getGraphAttribute().step == cmp::StepType::post);
+
+    expect(step_plot.createComponentSnapshot(step_plot.getLocalBounds())
+               .isValid());
+
+    // Post steps: a horizontal and a vertical segment per pixel point.
+    const auto& vertices = look_and_feel.step_vertices;
+    expectEquals(vertices.size(), std::size_t(5u));
+    for (std::size_t i = 1u; i < vertices.size(); i += 2u) {
+      expectEquals(vertices[i].getY(), vertices[i - 1u].getY());
+      expectEquals(vertices[i].getX(), vertices[i + 1u].getX());
+    }
+
+    step_plot.setLookAndFeel(nullptr);
+  }
+
+  TEST("Crosshair readouts") {
+    cmp::Plot crosshair_plot;
+    crosshair_plot.setBounds(0, 0, 400, 300);
+    crosshair_plot.plot({y_data1, y_data2, {1.f, 2.f}},
+                        {x_data1, x_data2, {3.f, 1.f}});
+    crosshair_plot.plotHorizontalLines({150.f});
+
+    const auto readouts = crosshair_plot.getCrosshairReadouts(1.5f);
+
+    // The horizontal line is not part of the readouts, the unsorted line
+    // returns the value of the closest data point.
+    expectEquals(readouts.size(), std::size_t(3));
+    expectEquals(readouts[0].graph_line_index, std::size_t(0));
+    expectEquals(readouts[0].data_value.getY(), 150.f);
+    expectEquals(readouts[1].data_value.getY(), 250.f);
+    expectEquals(readouts[2].data_value.getX(), 1.5f);
+
+    const auto outside_readouts = crosshair_plot.getCrosshairReadouts(3.5f);
+    expectEquals(outside_readouts.size(), std::size_t(2));
+    expectEquals(outside_readouts[0].graph_line_index, std::size_t(1));
+    expectEquals(outside_readouts[0].data_value.getY(), 450.f);
+
+    // Only the crosshair column, the readout points and the labels are
+    // repainted when the crosshair is moved.
+    cmp::PlotLookAndFeel lnf;
+    const auto graph_bounds = juce::Rectangle<int>(50, 20, 300, 250);
+    const std::vector<cmp::CrosshairReadout> area_readouts{
+        {0u, {1.5f, 2.f}, {100, 40}, juce::Colours::red},
+        {1u, {1.5f, 3.f}, {100, 200}, juce::Colours::blue}};
+    const auto area =
+        lnf.getCrosshairArea(graph_bounds, 100.f, 1.5f, area_readouts);
+
+    expect(area.containsRectangle({150, 20, 1, 250}));
+    expect(graph_bounds.contains(area.getBounds()));
+    for (const auto& readout : area_readouts) {
+      expect(area.containsPoint(
+          graph_bounds.getPosition() + readout.pixel_position));
+    }
+
+    auto num_area_pixels = 0;
+    for (const auto& rectangle : area)
+      num_area_pixels += rectangle.getWidth() * rectangle.getHeight();
+    expectLessThan(num_area_pixels,
+                   graph_bounds.getWidth() * graph_bounds.getHeight() / 4);
+  }
+
+  TEST("Measurement statistics") {
+    cmp::Plot measurement_plot;
+    measurement_plot.setBounds(0, 0, 400, 300);
+    measurement_plot.plot({y_data1, y_data2, {1.f, 2.f}},
+                          {x_data1, x_data2, {3.f, 1.f}});
+
+    expect(measurement_plot.getMeasurementStatistics().empty());
+
+    // The cursors can be in any order, the unsorted line is left out.
+    measurement_plot.setMeasurementCursors(3.5f, 1.5f);
+    const auto statistics = measurement_plot.getMeasurementStatistics();
+
+    expectEquals(statistics.size(), std::size_t(2));
+    expectEquals(statistics[0].graph_line_index, std::size_t(0));
+    expectEquals(statistics[0].num_samples, std::size_t(1));
+    expectEquals(statistics[0].mean, 200.f);
+    expectEquals(statistics[1].min, 300.f);
+    expectEquals(statistics[1].max, 400.f);
+    expectEquals(statistics[1].mean, 350.f);
+    expectWithinAbsoluteError(statistics[1].rms, std::sqrt(125000.f), 1e-2f);
+
+    measurement_plot.removeMeasurementCursors();
+    expect(!measurement_plot.getMeasurementCursors());
+  }
+
+  TEST("Zoom history") {
+    cmp::Plot zoom_plot;
+    zoom_plot.setBounds(0, 0, 400, 300);
+    zoom_plot.plot({y_data2}, {x_data2});
+
+    // Setting the limits directly is not part of the zoom history.
+    zoom_plot.xLim(2.f, 3.f);
+    zoom_plot.yLim(200.f, 500.f);
+    expect(!zoom_plot.zoomBack());
+    expect(!zoom_plot.zoomForward());
+
+    const auto expectView = [&](const cmp::Lim_f &x_lim,
+                                const cmp::Lim_f &y_lim) {
+      expect(zoom_plot.getXLim() == x_lim);
+      expect(zoom_plot.getYLim() == y_lim);
+    };
+
+    const auto start_x_lim = cmp::Lim_f(2.f, 3.f);
+    const auto start_y_lim = cmp::Lim_f(200.f, 500.f);
+
+    // Zoom twice, then back and forward through the views.
+    zoom_plot.zoomTo({2.f, 2.5f}, {250.f, 400.f});
+    zoom_plot.zoomTo({2.1f, 2.2f}, {300.f, 350.f});
+    expectView({2.1f, 2.2f}, {300.f, 350.f});
+
+    expect(zoom_plot.zoomBack());
+    expectView({2.f, 2.5f}, {250.f, 400.f});
+    expect(zoom_plot.zoomBack());
+    expectView(start_x_lim, start_y_lim);
+    expect(!zoom_plot.zoomBack());
+    expectView(start_x_lim, start_y_lim);
+
+    expect(zoom_plot.zoomForward());
+    expectView({2.f, 2.5f}, {250.f, 400.f});
+    expect(zoom_plot.zoomForward());
+    expectView({2.1f, 2.2f}, {300.f, 350.f});
+    expect(!zoom_plot.zoomForward());
+    expectView({2.1f, 2.2f}, {300.f, 350.f});
+
+    // A new zoom drops the views ahead of the current view.
+    expect(zoom_plot.zoomBack());
+    zoom_plot.zoomTo({2.4f, 2.6f}, {200.f, 300.f});
+    expect(!zoom_plot.zoomForward());
+    expect(zoom_plot.zoomBack());
+    expectView({2.f, 2.5f}, {250.f, 400.f});
+    expect(zoom_plot.zoomForward());
+    expectView({2.4f, 2.6f}, {200.f, 300.f});
+    expect(!zoom_plot.zoomForward());
+  }
+
+  TEST("Zoom history is capped") {
+    cmp::Plot zoom_plot;
+    zoom_plot.setBounds(0, 0, 400, 300);
+    zoom_plot.plot({y_data2}, {x_data2});
+    zoom_plot.xLim(0.f, 100.f);
+    zoom_plot.yLim(0.f, 1000.f);
+
+    // 40 zooms after the start view, the 32 newest views are kept.
+    for (auto i = 0; i < 40; ++i)
+      zoom_plot.zoomTo({float(i), float(i) + 10.f}, {0.f, 1000.f});
+
+    std::size_t num_zoom_backs = 0u;
+    while (zoom_plot.zoomBack()) num_zoom_backs++;
+
+    expectEquals(num_zoom_backs, std::size_t(31));
+    expect(zoom_plot.getXLim() == cmp::Lim_f(8.f, 18.f));
+  }
+
+  TEST("Zoom history restores cached views") {
+    XYDownsamplingCountLookAndFeel lnf;
+    cmp::Plot zoom_plot;
+    zoom_plot.setLookAndFeel(&lnf);
+    zoom_plot.setBounds(0, 0, 400, 300);
+    zoom_plot.setDownsamplingType(cmp::DownsamplingType::xy_downsampling);
+
+    std::vector<float> y_data(100'000);
+    for (std::size_t i = 0u; i < y_data.size(); ++i)
+      y_data[i] = std::sin(float(i) * 0.001f);
+
+    zoom_plot.xLim(1.f, 100'000.f);
+    zoom_plot.yLim(-1.f, 1.f);
+    zoom_plot.plot({y_data});
+
+    const auto graph_line =
+        getChildComponentHelper<cmp::GraphLine>(zoom_plot).front();
+    const auto start_indices = graph_line->getPixelPointIndices();
+    const auto start_pixel_points = graph_line->getPixelPoints();
+    const auto data_generation = graph_line->getDataGeneration();
+
+    zoom_plot.zoomTo({1'000.f, 50'000.f}, {-0.5f, 0.5f});
+    const auto zoomed_indices = graph_line->getPixelPointIndices();
+    expect(zoomed_indices != start_indices);
+
+    // Both views are cached, going back and forward does not downsample.
+    const auto num_updates = lnf.num_updates;
+
+    expect(zoom_plot.zoomBack());
+    expectEquals(lnf.num_updates, num_updates);
+    expect(graph_line->getPixelPointIndices() == start_indices);
+    expect(graph_line->getPixelPoints() == start_pixel_points);
+
+    expect(zoom_plot.zoomForward());
+    expectEquals(lnf.num_updates, num_updates);
+    expect(graph_line->getPixelPointIndices() == zoomed_indices);
+    expectEquals(graph_line->getDataGeneration(), data_generation);
+
+    // New data can not be restored from the cache.
+    zoom_plot.plotUpdateYOnly({y_data});
+    const auto num_updates_new_data = lnf.num_updates;
+    expect(zoom_plot.zoomBack());
+    expectGreaterThan(lnf.num_updates, num_updates_new_data);
+
+    zoom_plot.setLookAndFeel(nullptr);
+  }
+
+  TEST("Pixel point indices found on demand") {
+    XYDownsamplingCountLookAndFeel lnf;
+    cmp::Plot ds_plot;
+    ds_plot.setLookAndFeel(&lnf);
+    ds_plot.setBounds(0, 0, 400, 300);
+    ds_plot.setDownsamplingType(cmp::DownsamplingType::xy_downsampling);
+
+    std::vector<float> y_data(10'000);
+    for (std::size_t i = 0u; i < y_data.size(); ++i)
+      y_data[i] = std::sin(float(i) * 0.01f);
+
+    ds_plot.xLim(1.f, 10'000.f);
+    ds_plot.yLim(-1.f, 1.f);
+    ds_plot.plot({y_data});
+
+    // Nothing but the hit tests read the indices of a plain line.
+    expect(!lnf.are_indices_requested);
+
+    const auto graph_line =
+        getChildComponentHelper<cmp::GraphLine>(ds_plot).front();
+    std::vector<std::size_t> x_indices, xy_indices;
+    cmp::Downsampler<float>::calculateXYIdxs(
+        cmp::Scaling::linear, {1.f, 10'000.f}, graph_line->getBounds(),
+        graph_line->getXData(), graph_line->getYData(), x_indices, xy_indices);
+
+    expect(graph_line->getPixelPointIndices() == xy_indices);
+    expectEquals(graph_line->getPixelPointIndices().size(),
+                 graph_line->getPixelPoints().size());
+
+    const auto& pixel_point = graph_line->getPixelPoints()[10];
+    expectEquals(std::get<2>(graph_line->findClosestPixelPointTo(pixel_point)),
+                 xy_indices[10]);
+
+    // The bars are found from the indices when the pixel points are.
+    cmp::GraphAttribute stem_attribute;
+    stem_attribute.bars = cmp::BarAttribute{cmp::BarType::stem};
+    ds_plot.plot({y_data}, {}, {stem_attribute});
+    expect(lnf.are_indices_requested);
+    expect(getChildComponentHelper<cmp::GraphLine>(ds_plot)
+               .front()
+               ->getPixelPointIndices() == xy_indices);
+
+    ds_plot.setLookAndFeel(nullptr);
+  }
+
+  TEST("Overview") {
+    cmp::Plot overview_plot;
+    overview_plot.setBounds(0, 0, 400, 300);
+    overview_plot.plot({y_data2}, {x_data2});
+    overview_plot.xLim(2.f, 3.f);
+
+    cmp::PlotOverview overview(overview_plot);
+    overview.setBounds(0, 0, 200, 40);
+    const auto image = overview.createComponentSnapshot(overview.getLocalBounds());
+    expect(image.isValid());
+
+    // Rendering the overview does not change the view of the plot.
+    expect(!overview_plot.zoomBack());
+  }
+
+  TEST("Trigger") {
+    cmp::Plot trigger_plot;
+    trigger_plot.setBounds(0, 0, 400, 300);
+
+    // A sine with a period of 100 samples shifted in by 37 samples per update.
+    const auto createWindow = [](const std::size_t num_shifted) {
+      std::vector<float> y_data(1000);
+      for (std::size_t i = 0u; i < y_data.size(); ++i) {
+        y_data[i] = std::sin(float(i + num_shifted) * 2.f *
+                             juce::MathConstants<float>::pi / 100.f);
+      }
+      return y_data;
+    };
+
+    trigger_plot.plot({createWindow(0u)});
+    trigger_plot.setTrigger(cmp::Trigger{cmp::TriggerEdge::rising, 0.5f, 0.1f});
+    trigger_plot.xLim(-20.f, 200.f);
+
+    for (const auto num_shifted : {37u, 74u, 111u}) {
+      trigger_plot.plotUpdateYOnly({createWindow(num_shifted)});
+      expect(trigger_plot.isTriggered());
+
+      // The first sample at or above the level, sin(2 * pi * 9 / 100), is at
+      // x = 0 and the peak 16 samples later.
+      const auto readouts = trigger_plot.getCrosshairReadouts(0.f);
+      expectEquals(readouts.size(), std::size_t(1));
+      expectWithinAbsoluteError(readouts[0].data_value.getY(), 0.5358f, 1e-3f);
+      expectWithinAbsoluteError(
+          trigger_plot.getCrosshairReadouts(16.f)[0].data_value.getY(), 1.f, 1e-3f);
+    }
+
+    // Without a crossing the newest data is shown.
+    trigger_plot.plotUpdateYOnly({std::vector<float>(1000, 1.f)});
+    expect(!trigger_plot.isTriggered());
+
+    trigger_plot.setTrigger(std::nullopt);
+    expect(!trigger_plot.isTriggered());
+  }
+
+  TEST("Trigger before plot") {
+    cmp::Plot trigger_plot;
+    trigger_plot.setBounds(0, 0, 400, 300);
+
+    std::vector<float> y_data(1000);
+    for (std::size_t i = 0u; i < y_data.size(); ++i)
+      y_data[i] = std::sin(float(i) * 2.f * juce::MathConstants<float>::pi / 100.f);
+
+    // The trigger line is searched for when the y-data is updated.
+    trigger_plot.setTrigger(cmp::Trigger{cmp::TriggerEdge::rising, 0.5f, 0.1f});
+    expect(!trigger_plot.isTriggered());
+
+    trigger_plot.xLim(-20.f, 200.f);
+    trigger_plot.plot({y_data});
+    expect(trigger_plot.isTriggered());
+
+    trigger_plot.setTrigger(cmp::Trigger{cmp::TriggerEdge::rising, 0.5f, 0.1f, 1u});
+    expectThrowsType<std::range_error>(
+        [&] { trigger_plot.plotUpdateYOnly({y_data}); });
+  }
+
+  TEST("Persistence") {
+    cmp::Plot persistence_plot;
+    persistence_plot.setBounds(0, 0, 400, 300);
+    persistence_plot.plot({y_data2}, {x_data2});
+
+    expectThrowsType<std::invalid_argument>(
+        [&] { persistence_plot.setPersistence(1.f); });
+
+    persistence_plot.setPersistence(0.8f);
+    for (const auto offset : {0.f, 10.f, 20.f}) {
+      persistence_plot.plotUpdateYOnly({{200.f + offset, 300.f, 400.f, 500.f}});
+    }
+    expect(persistence_plot.createComponentSnapshot(persistence_plot.getLocalBounds())
+               .isValid());
+
+    persistence_plot.setPersistence(std::nullopt);
+  }
+
+  TEST("Derived traces") {
+    cmp::Plot derived_plot;
+    derived_plot.setBounds(0, 0, 400, 300);
+    derived_plot.plot({y_data2}, {x_data2});
+
+    expectThrowsType<std::invalid_argument>(
+        [&] { derived_plot.setDerivedTraces({{}, {}}); });
+
+    derived_plot.setDerivedTraces({{{cmp::DerivedTraceType::max_hold}}});
+    for (const auto offset : {0.f, 30.f, 10.f}) {
+      derived_plot.plotUpdateYOnly({{200.f + offset, 300.f, 400.f, 500.f}});
+    }
+    expect(derived_plot.createComponentSnapshot(derived_plot.getLocalBounds())
+               .isValid());
+  }
+
+  TEST("Octave smoothing") {
+    cmp::Plot smoothing_plot;
+    smoothing_plot.setBounds(0, 0, 400, 300);
+    smoothing_plot.plot({{1.f, 0.f, 1.f, 0.f, 1.f, 0.f, 1.f, 0.f}},
+                        {{1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f}});
+
+    expectThrowsType<std::invalid_argument>(
+        [&] { smoothing_plot.setOctaveSmoothing(0.f); });
+
+    // The window of x = 7 spans the samples [4.45, 8) of which 1.55 are one.
+    smoothing_plot.setOctaveSmoothing(1.f);
+    expectWithinAbsoluteError(
+        smoothing_plot.getCrosshairReadouts(7.f)[0].data_value.getY(),
+        1.55f / 3.55f, 1e-3f);
+
+    smoothing_plot.setOctaveSmoothing(std::nullopt);
+    expectEquals(smoothing_plot.getCrosshairReadouts(7.f)[0].data_value.getY(),
+                 1.f);
+  }
+
+  TEST("Bars and stems") {
+    cmp::Plot bar_plot;
+    bar_plot.setBounds(0, 0, 400, 300);
+
+    // More bars than pixel columns, they are merged per column.
+    std::vector<float> y_data(10'000);
+    for (std::size_t i = 0u; i < y_data.size(); ++i)
+      y_data[i] = float(i % 17) - 8.f;
+
+    cmp::GraphAttribute bar_attribute;
+    bar_attribute.bars = cmp::BarAttribute{cmp::BarType::bar, 0.8f, 0.f};
+
+    cmp::GraphAttribute stem_attribute;
+    stem_attribute.bars = cmp::BarAttribute{cmp::BarType::stem};
+    stem_attribute.marker = cmp::Marker(cmp::Marker::Type::Circle);
+
+    bar_plot.plot({y_data, {1.f, 2.f, 3.f}}, {}, {bar_attribute, stem_attribute});
+
+    for (const auto* graph_line : getChildComponentHelper<cmp::GraphLine>(bar_plot))
+      expect(graph_line->getGraphAttribute().bars.has_value());
+
+    expect(bar_plot.createComponentSnapshot(bar_plot.getLocalBounds()).isValid());
+
+    // More stems than pixel columns, at most one merged stem per column.
+    cmp::Plot stem_plot;
+    stem_plot.setBounds(0, 0, 400, 300);
+    stem_plot.setDownsamplingType(cmp::DownsamplingType::no_downsampling);
+    stem_plot.plot({y_data}, {}, {stem_attribute});
+
+    const auto stem_line =
+        getChildComponentHelper<cmp::GraphLine>(stem_plot).front();
+    const auto& stems = stem_line->getBarRectangles();
+
+    expect(!stems.isEmpty());
+    expectLessOrEqual(stems.getNumRectangles(), stem_line->getWidth());
+    for (const auto& stem : stems) expectEquals(stem.getWidth(), 1.f);
+
+    // A few wide bars.
+    bar_plot.xLim(0.f, 10.f);
+    expect(bar_plot.createComponentSnapshot(bar_plot.getLocalBounds()).isValid());
+  }
+
+  TEST("Error bars") {
+    cmp::Plot error_bar_plot;
+    error_bar_plot.setBounds(0, 0, 400, 300);
+    error_bar_plot.plot({std::vector<float>(10'000, 0.f)});
+    error_bar_plot.yLim(-10.f, 10.f);
+
+    expectThrowsType<std::invalid_argument>(
+        [&] { error_bar_plot.setErrorBars({{{1.f, 2.f}}}); });
+
+    std::vector<float> y_errors(10'000);
+    for (std::size_t i = 0u; i < y_errors.size(); ++i)
+      y_errors[i] = float(i % 10);
+    error_bar_plot.setErrorBars({{y_errors}});
+
+    // More samples than pixel columns, each merged bar spans [-9, 9].
+    const auto graph_line =
+        getChildComponentHelper<cmp::GraphLine>(error_bar_plot).front();
+    const auto& error_bar_lines = graph_line->getErrorBarLines();
+
+    expect(!error_bar_lines.empty());
+    expect(error_bar_lines.size() < 1'000u);
+
+    const auto graph_height = float(graph_line->getHeight());
+    for (const auto& error_bar : error_bar_lines) {
+      expectEquals(error_bar.getStartX(), error_bar.getEndX());
+      expectWithinAbsoluteError(error_bar.getStartY() - error_bar.getEndY(),
+                                graph_height * 18.f / 20.f, 1.f);
+    }
+  }
+
+  TEST("Collapse runs outside the y-range") {
+    cmp::Plot zoomed_plot;
+    zoomed_plot.setBounds(0, 0, 400, 300);
+    zoomed_plot.setDownsamplingType(cmp::DownsamplingType::no_downsampling);
+
+    std::vector<float> y_data(10'000);
+    for (std::size_t i = 0u; i < y_data.size(); ++i)
+      y_data[i] = std::sin(float(i) * 0.01f);
+
+    zoomed_plot.plot({y_data});
+    const auto graph_line =
+        getChildComponentHelper<cmp::GraphLine>(zoomed_plot).front();
+    expectEquals(graph_line->getPixelPoints().size(), y_data.size());
+
+    // Only the samples close to the zero crossings are visible.
+    zoomed_plot.yLim(-0.1f, 0.1f);
+    const auto& pixel_points = graph_line->getPixelPoints();
+    expect(pixel_points.size() < y_data.size() / 4u);
+    expectEquals(graph_line->getPixelPointIndices().size(), pixel_points.size());
+
+    const auto height = float(graph_line->getHeight());
+    for (const auto& pixel_point : pixel_points) {
+      expect(pixel_point.getY() >= -height - 0.5f);
+      expect(pixel_point.getY() <= 2.f * height + 0.5f);
+    }
+
+    // The dash pattern starts at the first point, a dashed line is kept whole.
+    cmp::GraphAttribute dashed;
+    dashed.dashed_lengths = std::vector<float>{4.f, 4.f};
+    graph_line->setGraphAttribute(dashed);
+    expectEquals(graph_line->getPixelPoints().size(), y_data.size());
+
+    // The xy-downsampled indices are collapsed before they are transformed.
+    cmp::Plot xy_plot;
+    xy_plot.setBounds(0, 0, 400, 300);
+    xy_plot.setDownsamplingType(cmp::DownsamplingType::xy_downsampling);
+    xy_plot.plot({y_data});
+
+    const auto xy_graph_line =
+        getChildComponentHelper<cmp::GraphLine>(xy_plot).front();
+    const auto num_xy_pixel_points = xy_graph_line->getPixelPoints().size();
+    xy_plot.yLim(-0.1f, 0.1f);
+    expect(xy_graph_line->getPixelPoints().size() < num_xy_pixel_points / 2u);
+  }
+
+  TEST("Graph lines sharing x-data") {
+    std::vector<std::vector<float>> y_data(5, std::vector<float>(100'000));
+    for (std::size_t c = 0u; c < y_data.size(); ++c) {
+      for (std::size_t i = 0u; i < y_data[c].size(); ++i)
+        y_data[c][i] = std::sin(float(i) * 0.0005f * float(c + 1u));
+    }
+
+    const auto setUpPlot = [](cmp::Plot& plot_to_set_up) {
+      plot_to_set_up.setBounds(0, 0, 400, 300);
+      plot_to_set_up.setDownsamplingType(cmp::DownsamplingType::xy_downsampling);
+      plot_to_set_up.xLim(1.f, 100'000.f);
+      plot_to_set_up.yLim(-0.5f, 0.5f);
+    };
+
+    // The generated x-data of the graph lines is equal, they are downsampled
+    // together.
+    cmp::Plot shared_plot;
+    setUpPlot(shared_plot);
+    shared_plot.plot(y_data);
+
+    const auto expectEqualToSingleLines = [&] {
+      const auto graph_lines = getChildComponentHelper<cmp::GraphLine>(shared_plot);
+      expectEquals(graph_lines.size(), y_data.size());
+
+      for (std::size_t c = 0u; c < y_data.size(); ++c) {
+        cmp::Plot single_plot;
+        setUpPlot(single_plot);
+        single_plot.plot({y_data[c]});
+        const auto single_line =
+            getChildComponentHelper<cmp::GraphLine>(single_plot).front();
+
+        expect(graph_lines[c]->getPixelPointIndices() ==
+               single_line->getPixelPointIndices());
+        expect(graph_lines[c]->getPixelPoints() == single_line->getPixelPoints());
+      }
+    };
+
+    expectEqualToSingleLines();
+
+    // The x-data is kept shared when only the y-data is updated.
+    for (auto& y : y_data) std::reverse(y.begin(), y.end());
+    shared_plot.plotUpdateYOnly(y_data);
+    expectEqualToSingleLines();
+  }
+
+  TEST("Borrowed y-data") {
+    std::vector<std::vector<float>> y_data(2, std::vector<float>(10'000));
+    for (std::size_t c = 0u; c < y_data.size(); ++c) {
+      for (std::size_t i = 0u; i < y_data[c].size(); ++i)
+        y_data[c][i] = std::cos(float(i) * 0.003f * float(c + 1u));
+    }
+    const std::vector<std::span<const float>> y_views(y_data.begin(),
+                                                      y_data.end());
+
+    cmp::Plot owned_plot, borrowed_plot;
+    for (auto* plot_to_set_up : {&owned_plot, &borrowed_plot}) {
+      plot_to_set_up->setBounds(0, 0, 400, 300);
+      plot_to_set_up->setDownsamplingType(cmp::DownsamplingType::xy_downsampling);
+      plot_to_set_up->xLim(1.f, 10'000.f);
+      plot_to_set_up->yLim(-1.f, 1.f);
+    }
+
+    owned_plot.plot(y_data);
+    borrowed_plot.plotBorrowed(y_views);
+
+    const auto owned_lines = getChildComponentHelper<cmp::GraphLine>(owned_plot);
+    const auto borrowed_lines =
+        getChildComponentHelper<cmp::GraphLine>(borrowed_plot);
+
+    const auto expectEqualToOwned = [&] {
+      for (std::size_t c = 0u; c < y_data.size(); ++c) {
+        expect(borrowed_lines[c]->getPixelPointIndices() ==
+               owned_lines[c]->getPixelPointIndices());
+        expect(borrowed_lines[c]->getPixelPoints() ==
+               owned_lines[c]->getPixelPoints());
+      }
+    };
+
+    // The y-data is not copied.
+    for (std::size_t c = 0u; c < y_data.size(); ++c)
+      expect(borrowed_lines[c]->getYData().data() == y_data[c].data());
+    expectEqualToOwned();
+
+    // Changed in place and plotted again.
+    for (auto& y : y_data) std::reverse(y.begin(), y.end());
+    owned_plot.plotUpdateYOnly(y_data);
+    borrowed_plot.plotUpdateYOnlyBorrowed(y_views);
+    expectEqualToOwned();
+
+    // Changing a value through the graph line copies the y-data first.
+    const auto first_y = y_data[0][0];
+    borrowed_lines[0]->setXYValue({1.f, 0.25f}, 0u);
+    expect(borrowed_lines[0]->getYData().data() != y_data[0].data());
+    expectEquals(borrowed_lines[0]->getYData()[0], 0.25f);
+    expectEquals(borrowed_lines[0]->getYData()[1], y_data[0][1]);
+    expectEquals(y_data[0][0], first_y);
+  }
+
+  TEST("Heatmap") {
+    cmp::Plot heatmap_plot;
+    heatmap_plot.setBounds(0, 0, 400, 300);
+
+    expectThrowsType<std::invalid_argument>([&] {
+      heatmap_plot.plotHeatmap(std::vector<float>(10u), 3u, {0.f, 1.f},
+                               {0.f, 1.f});
+    });
+    expectThrowsType<std::invalid_argument>([&] {
+      heatmap_plot.plotHeatmap(std::vector<float>(9u), 3u, {1.f, 1.f},
+                               {0.f, 1.f});
+    });
+
+    // Far more cells than pixels, a reduced level of the mip chain is drawn.
+    std::vector<float> values(4096u * 4096u);
+    for (std::size_t i = 0u; i < values.size(); ++i)
+      values[i] = float(i % 4096u);
+
+    heatmap_plot.plotHeatmapBorrowed(values, 4096u, {0.f, 10.f}, {-1.f, 1.f});
+
+    const auto image =
+        heatmap_plot.createComponentSnapshot(heatmap_plot.getLocalBounds());
+    expect(image.isValid());
+
+    const auto heatmap =
+        getChildComponentHelper<cmp::Heatmap>(heatmap_plot).front();
+    expect(heatmap->getDrawnLevel() > 0u);
+
+    heatmap_plot.clearHeatmap();
+    expect(getChildComponentHelper<cmp::Heatmap>(heatmap_plot).empty());
+  }
+
   TEST("Set colour"){
     cmp::Plot plot_tmp;
     plot_tmp.getLookAndFeel().setColour(cmp::Plot::grid_colour, juce::Colours::red);
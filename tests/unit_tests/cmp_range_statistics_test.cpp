@@ -0,0 +1,94 @@
+#include "cmp_range_statistics.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "cmp_test_helper.hpp"
+
+static cmp::RangeStatistics::Values scanRange(const std::vector<float>& y_data,
+                                              const std::size_t first,
+                                              const std::size_t last) {
+  cmp::RangeStatistics::Values values{std::numeric_limits<float>::max(),
+                                      std::numeric_limits<float>::lowest(),
+                                      0.0f, 0.0f, 0u};
+  double sum = 0.0, sum_squared = 0.0;
+
+  for (auto i = first; i < last; ++i) {
+    if (std::isnan(y_data[i])) continue;
+    values.min = std::min(values.min, y_data[i]);
+    values.max = std::max(values.max, y_data[i]);
+    sum += y_data[i];
+    sum_squared += double(y_data[i]) * y_data[i];
+    values.num_samples++;
+  }
+
+  values.mean = float(sum / double(values.num_samples));
+  values.rms = float(std::sqrt(sum_squared / double(values.num_samples)));
+  return values;
+}
+
+SECTION(RangeStatisticsTest, "Range statistics") {
+  std::mt19937 gen(7);
+  std::normal_distribution<float> dist(1.0f, 2.0f);
+
+  std::vector<float> y_data(5000u);
+  for (auto& y : y_data) y = dist(gen);
+  y_data[1234] = std::numeric_limits<float>::quiet_NaN();
+
+  const auto expectSameAsScan = [&](const cmp::RangeStatistics& statistics,
+                                    const std::size_t first,
+                                    const std::size_t last) {
+    const auto values = statistics.getStatistics(y_data, first, last);
+    const auto expected = scanRange(y_data, first, last);
+
+    expect(values.has_value());
+    expectEquals(values->min, expected.min);
+    expectEquals(values->max, expected.max);
+    expectEquals(values->num_samples, expected.num_samples);
+    expectWithinAbsoluteError(values->mean, expected.mean, 1e-4f);
+    expectWithinAbsoluteError(values->rms, expected.rms, 1e-4f);
+  };
+
+  TEST("Any range equals a scan of the range") {
+    cmp::RangeStatistics statistics;
+    statistics.update(y_data);
+
+    expectEquals(statistics.getNumIndexedSamples(),
+                 y_data.size() / cmp::RangeStatistics::block_size *
+                     cmp::RangeStatistics::block_size);
+
+    std::uniform_int_distribution<std::size_t> index(0u, y_data.size());
+    for (auto i = 0; i < 200; ++i) {
+      const auto [first, last] = std::minmax(index(gen), index(gen));
+      if (first != last) expectSameAsScan(statistics, first, last);
+    }
+
+    expectSameAsScan(statistics, 0u, y_data.size());
+    expectSameAsScan(statistics, 1233u, 1235u);
+    expect(!statistics.getStatistics(y_data, 1234u, 1235u));
+    expect(!statistics.getStatistics(y_data, 10u, 10u));
+  }
+
+  TEST("Appended and changed data") {
+    cmp::RangeStatistics statistics;
+    const auto full_y_data = y_data;
+
+    y_data.resize(1000u);
+    statistics.update(y_data);
+    expectSameAsScan(statistics, 10u, 990u);
+
+    y_data = full_y_data;
+    statistics.update(y_data);
+    expectSameAsScan(statistics, 10u, 4990u);
+
+    y_data[3000] = 100.0f;
+    statistics.invalidateFrom(3000u);
+    expect(statistics.getNumIndexedSamples() <= 3000u);
+    statistics.update(y_data);
+    expectSameAsScan(statistics, 10u, 4990u);
+    expectEquals(statistics.getStatistics(y_data, 0u, y_data.size())->max,
+                 100.0f);
+  }
+}
@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "cmp_remote_data_source.hpp"
+#include "cmp_test_helper.hpp"
+
+SECTION(RemoteDataSourceTest, "Remote data source") {
+  std::vector<float> x_data(10000), y_data(10000);
+  for (std::size_t i = 0u; i < x_data.size(); ++i) {
+    x_data[i] = float(i) * 0.01f;
+    y_data[i] = std::sin(float(i) * 0.013f) * float(i % 97u);
+  }
+
+  const auto expectColumnsEqualToData = [&](const auto& columns) {
+    for (const auto& column : columns) {
+      const auto first = std::lower_bound(x_data.begin(), x_data.end(), column.x_start);
+      const auto last = std::lower_bound(first, x_data.end(), column.x_end);
+      if (first == last || std::size_t(last - first) != column.num_samples) continue;
+
+      const auto offset = std::distance(x_data.begin(), first);
+      const auto [min, max] = std::minmax_element(y_data.begin() + offset,
+                                                  y_data.begin() + offset + (last - first));
+      expectEquals(column.min_y, *min);
+      expectEquals(column.max_y, *max);
+      expectEquals(column.first_y, y_data[std::size_t(offset)]);
+    }
+  };
+
+  TEST("Columns over loopback and cached columns on pan") {
+    cmp::RemoteDataServer server;
+    server.setLine(0, x_data, y_data);
+    const auto port = server.start();
+
+    cmp::RemoteDataClient client("127.0.0.1", port);
+    const auto info = client.getInfo();
+    expectEquals(info.size(), std::size_t(1));
+    expectEquals(info[0].num_samples, std::uint64_t(10000));
+
+    const auto columns = client.getColumns(0, {10.f, 30.f}, 200);
+    expectEquals(columns.size(), std::size_t(200));
+    expectEquals(client.getNumReceivedColumns(), std::size_t(200));
+    expectColumnsEqualToData(columns);
+
+    // Panning 10 columns only requests the 10 new columns.
+    expectColumnsEqualToData(client.getColumns(0, {11.f, 31.f}, 200));
+    expectEquals(client.getNumReceivedColumns(), std::size_t(210));
+
+    const auto [x, y] = cmp::RemoteDataClient::toXYData(columns);
+    expectEquals(x.size(), y.size());
+    expectGreaterThan(x.size(), columns.size());
+  }
+
+  TEST("Appended and replaced lines") {
+    cmp::RemoteDataServer server;
+    server.setLine(0, x_data, y_data);
+    cmp::RemoteDataClient client("127.0.0.1", server.start());
+
+    client.getColumns(0, {90.f, 110.f}, 200);
+
+    std::vector<float> appended_x(1000), appended_y(1000);
+    for (std::size_t i = 0u; i < appended_x.size(); ++i) {
+      appended_x[i] = 100.f + float(i) * 0.01f;
+      appended_y[i] = float(i);
+    }
+    server.appendToLine(0, appended_x, appended_y);
+    x_data.insert(x_data.end(), appended_x.begin(), appended_x.end());
+    y_data.insert(y_data.end(), appended_y.begin(), appended_y.end());
+
+    expectColumnsEqualToData(client.getColumns(0, {90.f, 110.f}, 200));
+
+    std::fill(y_data.begin(), y_data.end(), 1.f);
+    server.setLine(0, x_data, y_data);
+    expectColumnsEqualToData(client.getColumns(0, {90.f, 110.f}, 200));
+
+    bool did_throw = false;
+    try {
+      client.getColumns(1, {90.f, 110.f}, 200);
+    } catch (const std::invalid_argument&) {
+      did_throw = true;
+    }
+    expect(did_throw);
+  }
+
+  TEST("Stop with a partial request") {
+    cmp::RemoteDataServer server;
+    server.setLine(0, x_data, y_data);
+
+    juce::StreamingSocket socket;
+    expect(socket.connect("127.0.0.1", server.start(), 1000));
+
+    // Only the magic of the request header, the connection waits for the rest.
+    const unsigned char magic[4] = {0u, 0u, 0u, 0u};
+    expectEquals(socket.write(magic, 4), 4);
+    juce::Thread::sleep(50);
+
+    server.stop();
+  }
+}
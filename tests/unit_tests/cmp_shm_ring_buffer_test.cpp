@@ -0,0 +1,95 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "cmp_shm_ring_buffer.hpp"
+#include "cmp_test_helper.hpp"
+
+SECTION(ShmRingBufferTest, "Shared memory ring buffer") {
+  TEST("New frames are shifted into the windows") {
+    cmp::ShmRingBufferWriter writer("/cmp_shm_test_1", cmp::ShmDataType::int16,
+                                    2u, 8u);
+    cmp::ShmRingBufferReader reader("/cmp_shm_test_1");
+    expectEquals(reader.getNumChannels(), std::size_t(2));
+    expectEquals(reader.getCapacity(), std::size_t(8));
+
+    std::vector<std::vector<float>> windows(2u, std::vector<float>(5u, 0.f));
+
+    writer.write<std::int16_t>(std::vector<std::int16_t>{1, -1, 2, -2, 3, -3});
+    expectEquals(reader.readNewFrames(windows), std::size_t(3));
+    expect(windows[0] == std::vector<float>{0.f, 0.f, 1.f, 2.f, 3.f});
+    expect(windows[1] == std::vector<float>{0.f, 0.f, -1.f, -2.f, -3.f});
+    expectEquals(reader.readNewFrames(windows), std::size_t(0));
+  }
+
+  TEST("Overwritten frames are dropped") {
+    cmp::ShmRingBufferWriter writer("/cmp_shm_test_2", cmp::ShmDataType::float32,
+                                    1u, 8u);
+    cmp::ShmRingBufferReader reader("/cmp_shm_test_2");
+
+    std::vector<float> frames(20u);
+    for (std::size_t i = 0u; i < frames.size(); ++i) frames[i] = float(i);
+    writer.write<float>(frames);
+
+    std::vector<std::vector<float>> windows(1u, std::vector<float>(10u, 0.f));
+    expectEquals(reader.readNewFrames(windows), std::size_t(20));
+    expectEquals(reader.getNumDroppedFrames(), std::uint64_t(12));
+    expect(std::isnan(windows[0][1]));
+    expectEquals(windows[0][2], 12.f);
+    expectEquals(windows[0][9], 19.f);
+  }
+
+  TEST("New frames overwrite the oldest samples of the ring windows") {
+    cmp::ShmRingBufferWriter writer("/cmp_shm_test_4", cmp::ShmDataType::float32,
+                                    2u, 8u);
+    cmp::ShmRingBufferReader reader("/cmp_shm_test_4");
+    cmp::ShmChannelWindows windows(2u, 4u);
+    expect(std::isnan(windows.getWindow(0).front()));
+
+    writer.write<float>(std::vector<float>{1.f, -1.f, 2.f, -2.f, 3.f, -3.f});
+    expectEquals(reader.readNewFrames(windows), std::size_t(3));
+    expect(std::isnan(windows.getWindow(0)[0]));
+    expectEquals(windows.getWindow(0)[1], 1.f);
+    expectEquals(windows.getWindow(1)[3], -3.f);
+
+    // The window wraps around, and is still contiguous from oldest to newest.
+    writer.write<float>(std::vector<float>{4.f, -4.f, 5.f, -5.f});
+    expectEquals(reader.readNewFrames(windows), std::size_t(2));
+    const auto window = windows.getWindow(0);
+    expect(std::vector<float>(window.begin(), window.end()) ==
+           std::vector<float>{2.f, 3.f, 4.f, 5.f});
+
+    // Overwritten frames are NaN.
+    std::vector<float> frames(2u * 12u);
+    for (std::size_t i = 0u; i < frames.size(); ++i) frames[i] = float(i / 2u + 6u);
+    writer.write<float>(frames);
+    expectEquals(reader.readNewFrames(windows), std::size_t(12));
+    expectEquals(reader.getNumDroppedFrames(), std::uint64_t(4));
+    expectEquals(windows.getWindow(1)[0], 14.f);
+    expectEquals(windows.getWindow(1)[3], 17.f);
+  }
+
+  TEST("Invalid windows and value types throw") {
+    cmp::ShmRingBufferWriter writer("/cmp_shm_test_3", cmp::ShmDataType::float64,
+                                    2u, 8u);
+    cmp::ShmRingBufferReader reader("/cmp_shm_test_3");
+
+    bool did_throw_value_type = false;
+    try {
+      writer.write<float>(std::vector<float>{1.f, 2.f});
+    } catch (const std::invalid_argument&) {
+      did_throw_value_type = true;
+    }
+
+    bool did_throw_windows = false;
+    try {
+      std::vector<std::vector<float>> windows(1u, std::vector<float>(4u));
+      reader.readNewFrames(windows);
+    } catch (const std::invalid_argument&) {
+      did_throw_windows = true;
+    }
+
+    expect(did_throw_value_type);
+    expect(did_throw_windows);
+  }
+}
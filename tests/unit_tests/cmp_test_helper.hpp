@@ -19,7 +19,7 @@ static std::vector<ComponentType*> getChildComponentHelper(
   return child_components;
 }
 
-static void expectEqualVectors(const std::vector<float>& v1,
+static void expectEqualVectors(std::span<const float> v1,
                                const std::vector<float>& v2,
                                const auto expectEquals) {
   expectEquals(v1.size(), v2.size());
@@ -0,0 +1,96 @@
+#include "cmp_trigger.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "cmp_test_helper.hpp"
+
+static std::optional<std::size_t> findLastCrossingScalar(
+    const cmp::Trigger& trigger, const std::vector<float>& y_data,
+    const std::size_t first, const std::size_t last) {
+  std::optional<std::size_t> crossing;
+  auto is_armed = false;
+
+  for (std::size_t i = 0u; i < std::min(last, y_data.size()); ++i) {
+    const auto y = y_data[i];
+
+    if (trigger.edge == cmp::TriggerEdge::rising) {
+      if (y < trigger.level - trigger.hysteresis) {
+        is_armed = true;
+      } else if (is_armed && y >= trigger.level) {
+        is_armed = false;
+        if (i >= first) crossing = i;
+      }
+    } else {
+      if (y > trigger.level + trigger.hysteresis) {
+        is_armed = true;
+      } else if (is_armed && y <= trigger.level) {
+        is_armed = false;
+        if (i >= first) crossing = i;
+      }
+    }
+  }
+
+  return crossing;
+}
+
+SECTION(TriggerSearchTest, "Trigger search") {
+  TEST("Last crossing equals a scalar search") {
+    std::mt19937 gen(11);
+    std::normal_distribution<float> noise(0.0f, 0.2f);
+
+    for (const auto num_samples : {0u, 1u, 15u, 16u, 17u, 1000u, 4099u}) {
+      std::vector<float> y_data(num_samples);
+      for (std::size_t i = 0u; i < y_data.size(); ++i) {
+        y_data[i] = std::sin(float(i) * 0.05f) + noise(gen);
+      }
+      if (num_samples > 500u) {
+        y_data[300] = std::numeric_limits<float>::quiet_NaN();
+      }
+
+      for (const auto edge : {cmp::TriggerEdge::rising, cmp::TriggerEdge::falling}) {
+        for (const auto hysteresis : {0.0f, 0.3f}) {
+          const cmp::Trigger trigger{edge, 0.1f, hysteresis};
+          const auto first = num_samples / 4u;
+          const auto last = num_samples - num_samples / 4u;
+
+          expect(cmp::TriggerSearch::findLastCrossing(trigger, y_data, first, last) ==
+                     findLastCrossingScalar(trigger, y_data, first, last),
+                 "Differs for " + juce::String(num_samples) + " samples.");
+        }
+      }
+    }
+  }
+
+  TEST("Hysteresis ignores noise around the level") {
+    // Wiggles around the level, then a clean rising edge at index 40.
+    std::vector<float> y_data(64, 0.0f);
+    for (std::size_t i = 0u; i < 32u; ++i) y_data[i] = i % 2u ? 0.05f : -0.05f;
+    for (std::size_t i = 32u; i < 40u; ++i) y_data[i] = -1.0f;
+    for (std::size_t i = 40u; i < 64u; ++i) y_data[i] = 1.0f;
+
+    const cmp::Trigger trigger{cmp::TriggerEdge::rising, 0.0f, 0.5f};
+    expect(cmp::TriggerSearch::findLastCrossing(trigger, y_data, 0u, 64u) ==
+           std::optional<std::size_t>(40u));
+
+    const cmp::Trigger falling_trigger{cmp::TriggerEdge::falling, 0.0f, 0.5f};
+    expect(!cmp::TriggerSearch::findLastCrossing(falling_trigger, y_data, 0u, 64u));
+  }
+
+  TEST("First sample on one side of a threshold") {
+    std::vector<float> data(100, 0.0f);
+    data[37] = std::numeric_limits<float>::quiet_NaN();
+    data[73] = 2.0f;
+
+    expectEquals(cmp::TriggerSearch::findFirstAbove(data.data(), 0u, 100u, 1.0f),
+                 std::size_t(73));
+    expectEquals(cmp::TriggerSearch::findFirstAtOrAbove(data.data(), 74u, 100u, 1.0f),
+                 std::size_t(100));
+    expectEquals(cmp::TriggerSearch::findFirstBelow(data.data(), 0u, 100u, 0.0f),
+                 std::size_t(100));
+    expectEquals(cmp::TriggerSearch::findFirstAtOrBelow(data.data(), 37u, 100u, 0.0f),
+                 std::size_t(38));
+  }
+}
@@ -103,5 +103,54 @@ TEST("Float to string: 0.0") {
   std::string result = cmp::valueToStringWithoutTrailingZeros(num);
   expectEquals(result, expected);
 }
+
+TEST("Step vertices") {
+  const cmp::PixelPoints pixel_points{{0.f, 0.f}, {2.f, 4.f}, {6.f, 2.f}};
+
+  const auto getVertices = [&](const cmp::StepType step_type) {
+    cmp::PixelPoints vertices;
+    cmp::forEachStepVertex(pixel_points, step_type,
+                           [&](const auto& point) { vertices.push_back(point); });
+    return vertices;
+  };
+
+  expect(getVertices(cmp::StepType::pre) ==
+         cmp::PixelPoints{{0.f, 0.f}, {0.f, 4.f}, {2.f, 4.f}, {2.f, 2.f}, {6.f, 2.f}});
+  expect(getVertices(cmp::StepType::post) ==
+         cmp::PixelPoints{{0.f, 0.f}, {2.f, 0.f}, {2.f, 4.f}, {6.f, 4.f}, {6.f, 2.f}});
+  expect(getVertices(cmp::StepType::mid) ==
+         cmp::PixelPoints{{0.f, 0.f}, {1.f, 0.f}, {1.f, 4.f}, {2.f, 4.f},
+                          {4.f, 4.f}, {4.f, 2.f}, {6.f, 2.f}});
+}
+
+TEST("Clamp collapsed runs") {
+  // The y-range is [0, 10], runs are clamped at -10 and 20. The run below
+  // from x = 1 to 3 and the run above at the end are collapsed.
+  const cmp::PixelPoints pixel_points{{0.f, 5.f},   {1.f, 35.f},  {3.f, 80.f},
+                                      {4.f, 5.f},   {5.f, -40.f}, {6.f, 5.f},
+                                      {7.f, -25.f}, {8.f, -90.f}};
+  const std::vector<std::size_t> run_positions{1, 6};
+
+  // The runs end at the crossings of the segments into and out of them, the
+  // run at the end is clamped at its own x-value.
+  auto clamped = pixel_points;
+  cmp::clampCollapsedRuns(clamped, run_positions, -10.f, 20.f, false);
+  expect(clamped == cmp::PixelPoints{{0.f, 5.f},    {0.5f, 20.f}, {3.8f, 20.f},
+                                     {4.f, 5.f},    {5.f, -40.f}, {6.f, 5.f},
+                                     {6.5f, -10.f}, {8.f, -10.f}});
+
+  clamped = pixel_points;
+  cmp::clampCollapsedRuns(clamped, run_positions, -10.f, 20.f, true);
+  expect(clamped[1] == juce::Point<float>(1.f, 20.f));
+  expect(clamped[2] == juce::Point<float>(3.f, 20.f));
+
+  // Adjacent runs on both sides cross the lines on the same segment.
+  cmp::PixelPoints adjacent{{0.f, -50.f}, {1.f, -60.f}, {2.f, 30.f}, {3.f, 40.f}};
+  cmp::clampCollapsedRuns(adjacent, {0, 2}, -10.f, 20.f, false);
+  expectWithinAbsoluteError(adjacent[1].getX(), 1.f + 50.f / 90.f, 1e-5f);
+  expectWithinAbsoluteError(adjacent[2].getX(), 1.f + 80.f / 90.f, 1e-5f);
+  expectEquals(adjacent[1].getY(), -10.f);
+  expectEquals(adjacent[2].getY(), 20.f);
+}
 }
-;
\ No newline at end of file
+;